@@ -6,9 +6,26 @@
 #include <ESP32Time.h>
 #include <LovyanGFX.hpp>
 #include <NimBLEDevice.h>
-#include <Preferences.h>
 #include <Timber.h>
-
+#include <esp_heap_caps.h>
+
+#include "always_on.h"
+#include "analog_hands.h"
+#include "asset_decoder.h"
+#include "boot_profile.h"
+#include "face_catalog.h"
+#include "face_install.h"
+#include "file_list.h"
+#include "i18n_labels.h"
+#include "json_ingest.h"
+#include "mem_governor.h"
+#include "nav_controller.h"
+#include "power_governor.h"
+#include "qr_cache.h"
+#include "racing.h"
+#include "screen_registry.h"
+#include "settings_store.h"
+#include "transition.h"
 #include "ui/ui.h"
 #include <lvgl.h>
 
@@ -20,7 +37,9 @@
 
 #define FLASH FFat
 #define F_NAME "FATFS"
-#define buf_size 10
+
+/* Minimum LVGL heap block kept free by evicting unused screens */
+#define SCREEN_TRIM_FREE (16 * 1024)
 
 class LGFX : public lgfx::LGFX_Device {
 
@@ -35,8 +54,10 @@ public:
       auto cfg = _bus_instance.config();
 
       // SPIバスの設定
-      cfg.spi_host = SPI; // 使用するSPIを選択  ESP32-S2,C3 : SPI2_HOST or
-                          // SPI3_HOST / ESP32 : VSPI_HOST or HSPI_HOST
+      cfg.spi_host =
+          (spi_host_device_t)Board::spi_host; // 使用するSPIを選択  ESP32-S2,C3
+                                              // : SPI2_HOST or SPI3_HOST /
+                                              // ESP32 : VSPI_HOST or HSPI_HOST
       // ※ ESP-IDFバージョンアップに伴い、VSPI_HOST ,
       // HSPI_HOSTの記述は非推奨になるため、エラーが出る場合は代わりにSPI2_HOST
       // , SPI3_HOSTを使用してください。
@@ -51,10 +72,10 @@ public:
                            // 2=ch / SPI_DMA_CH_AUTO=自動設定)
       // ※
       // ESP-IDFバージョンアップに伴い、DMAチャンネルはSPI_DMA_CH_AUTO(自動設定)が推奨になりました。1ch,2chの指定は非推奨になります。
-      cfg.pin_sclk = SCLK; // SPIのSCLKピン番号を設定
-      cfg.pin_mosi = MOSI; // SPIのCLKピン番号を設定
-      cfg.pin_miso = MISO; // SPIのMISOピン番号を設定 (-1 = disable)
-      cfg.pin_dc = DC;     // SPIのD/Cピン番号を設定  (-1 = disable)
+      cfg.pin_sclk = Board::sclk; // SPIのSCLKピン番号を設定
+      cfg.pin_mosi = Board::mosi; // SPIのCLKピン番号を設定
+      cfg.pin_miso = Board::miso; // SPIのMISOピン番号を設定 (-1 = disable)
+      cfg.pin_dc = Board::dc;     // SPIのD/Cピン番号を設定  (-1 = disable)
 
       _bus_instance.config(cfg); // 設定値をバスに反映します。
       _panel_instance.setBus(&_bus_instance); // バスをパネルにセットします。
@@ -64,26 +85,26 @@ public:
       auto cfg =
           _panel_instance.config(); // 表示パネル設定用の構造体を取得します。
 
-      cfg.pin_cs = CS; // CSが接続されているピン番号   (-1 = disable)
-      cfg.pin_rst = RST; // RSTが接続されているピン番号  (-1 = disable)
+      cfg.pin_cs = Board::cs; // CSが接続されているピン番号   (-1 = disable)
+      cfg.pin_rst = Board::rst; // RSTが接続されているピン番号  (-1 = disable)
       cfg.pin_busy = -1; // BUSYが接続されているピン番号 (-1 = disable)
 
       // ※ 以下の設定値はパネル毎に一般的な初期値が設定さ
       // BUSYが接続されているピン番号 (-1 =
       // disable)れていますので、不明な項目はコメントアウトして試してみてください。
 
-      cfg.memory_width = WIDTH; // ドライバICがサポートしている最大の幅
-      cfg.memory_height = HEIGHT; // ドライバICがサポートしている最大の高さ
-      cfg.panel_width = WIDTH;   // 実際に表示可能な幅
-      cfg.panel_height = HEIGHT; // 実際に表示可能な高さ
-      cfg.offset_x = OFFSET_X;   // パネルのX方向オフセット量
-      cfg.offset_y = OFFSET_Y;   // パネルのY方向オフセット量
+      cfg.memory_width = Board::width; // ドライバICがサポートしている最大の幅
+      cfg.memory_height = Board::height; // ドライバICがサポートしている最大の高さ
+      cfg.panel_width = Board::width;   // 実際に表示可能な幅
+      cfg.panel_height = Board::height; // 実際に表示可能な高さ
+      cfg.offset_x = Board::offset_x; // パネルのX方向オフセット量
+      cfg.offset_y = Board::offset_y; // パネルのY方向オフセット量
       cfg.offset_rotation = 0; // 值在旋转方向的偏移0~7（4~7是倒置的）
       cfg.dummy_read_pixel = 8; // 在读取像素之前读取的虚拟位数
       cfg.dummy_read_bits = 1; // 读取像素以外的数据之前的虚拟读取位数
       cfg.readable = false; // 如果可以读取数据，则设置为 true
       cfg.invert = true;    // 如果面板的明暗反转，则设置为 true
-      cfg.rgb_order = RGB_ORDER; // 如果面板的红色和蓝色被交换，则设置为 true
+      cfg.rgb_order = Board::rgb_order; // 如果面板的红色和蓝色被交换，则设置为 true
       cfg.dlen_16bit = false; // 对于以 16 位单位发送数据长度的面板，设置为 true
       cfg.bus_shared = false; // 如果总线与 SD 卡共享，则设置为 true（使用
                               // drawJpgFile 等执行总线控制）
@@ -96,7 +117,7 @@ public:
           _light_instance
               .config(); // Get the structure for backlight configuration.
 
-      cfg.pin_bl = BL;     // pin number to which the backlight is connected
+      cfg.pin_bl = Board::bl; // pin number to which the backlight is connected
       cfg.invert = false;  // true to invert backlight brightness
       cfg.freq = 44100;    // backlight PWM frequency
       cfg.pwm_channel = 1; // PWM channel number to use
@@ -110,18 +131,18 @@ public:
       auto cfg = _touch_instance.config();
 
       cfg.x_min = 0; // タッチスクリーンから得られる最小のX値(生の値)
-      cfg.x_max = WIDTH; // タッチスクリーンから得られる最大のX値(生の値)
+      cfg.x_max = Board::width; // タッチスクリーンから得られる最大のX値(生の値)
       cfg.y_min = 0; // タッチスクリーンから得られる最小のY値(生の値)
-      cfg.y_max = HEIGHT; // タッチスクリーンから得られる最大のY値(生の値)
-      cfg.pin_int = TP_INT; // INTが接続されているピン番号
-      // cfg.pin_rst = TP_RST;
+      cfg.y_max = Board::height; // タッチスクリーンから得られる最大のY値(生の値)
+      cfg.pin_int = Board::tp_int; // INTが接続されているピン番号
+      // cfg.pin_rst = Board::tp_rst;
       cfg.bus_shared = false; // 画面と共通のバスを使用している場合 trueを設定
       cfg.offset_rotation =
           0; // 表示とタッチの向きのが一致しない場合の調整 0~7の値で設定
       cfg.i2c_port = 0;      // 使用するI2Cを選択 (0 or 1)
       cfg.i2c_addr = 0x15;   // I2Cデバイスアドレス番号
-      cfg.pin_sda = I2C_SDA; // SDAが接続されているピン番号
-      cfg.pin_scl = I2C_SCL; // SCLが接続されているピン番号
+      cfg.pin_sda = Board::i2c_sda; // SDAが接続されているピン番号
+      cfg.pin_scl = Board::i2c_scl; // SCLが接続されているピン番号
       cfg.freq = 400000;     // I2Cクロックを設定
 
       _touch_instance.config(cfg);
@@ -135,34 +156,128 @@ public:
 
 LGFX tft;
 
-Preferences prefs;
+ChronosESP32 watch("Chronos C3");
+NvsSettingsBackend nvsBackend("my-app");
+SettingsStore settings(nvsBackend);
+
+PowerGovernor governor;
+
+// always-on face shown instead of turning the screen off (SETTING_AOD)
+#define AOD_BRIGHTNESS 8
+#define AOD_CPU_MHZ 80
+#define AOD_POLL_MS 100 // touch polling while the face is shown
+AlwaysOnFace aod;
+static uint16_t aodBuf[Board::width * AOD_BUF_LINES];
+static uint32_t aodCpuMhz;
 
-static const uint32_t screenWidth = WIDTH;
-static const uint32_t screenHeight = HEIGHT;
 
 static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf[2][screenWidth * buf_size];
+static lv_color_t buf[board_draw_buf_pixels<Board>()];
+// second buffer on the heap, the memory governor can give it back
+static lv_color_t *buf2;
 
 lv_obj_t *lastActScr;
 
 String customFacePaths[15];
 int customFaceIndex;
 
-// watchface transfer
-int cSize, pos, recv;
-uint32_t total, currentRecv;
-bool last;
-String fName;
-uint8_t buf1[1024];
-uint8_t buf2[1024];
-static bool writeFile = false, transfer = false, wSwitch = true;
-static int wLen1 = 0, wLen2 = 0;
-bool start = false;
+// installed faces, read from the catalog instead of parsing every file
+#define FACE_DIR "/ffat"
+bool parseFace(const char *path, CatalogEntry &entry);
+FaceCatalog catalog(FACE_DIR, ".wf", parseFace);
+
+// watchface transfer, install packets from the Chronos data callback are
+// queued and run by the loop, each reply goes back over BLE
+FileInstallStorage installStorage(FACE_DIR, &catalog);
+FaceInstaller installer(installStorage);
+#define INSTALL_PACKET_MAX 520
+#define INSTALL_QUEUE_LEN 4
+struct InstallPacket {
+  uint16_t len;
+  uint8_t data[INSTALL_PACKET_MAX];
+};
+QueueHandle_t installQueue;
 int lastCustom;
+// set by the BLE task, the loop suspends the transfer when the link drops
+static volatile bool linkDropped = false;
+
+// JSON payloads and face files are decoded member by member into fixed
+// structs, documents stay below INGEST_HEAP_LIMIT
+uint32_t bootClock();
+JsonIngest ingest(INGEST_HEAP_LIMIT, bootClock);
+
+// the catalog, customFacePaths and the ingest are used by the loop and,
+// with FAST_START, by the boot task while it scans the faces
+SemaphoreHandle_t facesMutex;
+
+bool lockFaces(TickType_t wait) {
+  return xSemaphoreTake(facesMutex, wait) == pdTRUE;
+}
+
+void unlockFaces() { xSemaphoreGive(facesMutex); }
 
-TaskHandle_t gameHandle = NULL;
+// set by the deferred boot task
+static volatile bool fsMounted = false, bleStarted = false, bootDone = false;
 
 void setTimeout(int i);
+void bootPrint(const char *line);
+
+// memory governor shed actions, cheapest first
+static void shedCaches(uint32_t deficit) {
+  asset_cache_release(deficit);
+  hands_cache_release(deficit);
+  qr_cache_clear();
+  lv_img_cache_invalidate_src(NULL);
+}
+
+static void shedScreens(uint32_t deficit) {
+  screen_registry_trim(SCREEN_TRIM_FREE + deficit);
+}
+
+static void degradeTransitions(uint32_t deficit) {
+  transition_set_mode(TRANSITION_LEGACY); // no snapshot buffers
+}
+
+static void restoreTransitions() { transition_set_mode(TRANSITION_AUTO); }
+
+static void singleDrawBuffer(uint32_t deficit) {
+  if (buf2 == NULL) {
+    return;
+  }
+  // outside lv_timer_handler, only the DMA transfer can still read it
+  tft.waitDMA();
+  lv_disp_draw_buf_init(&draw_buf, buf, NULL, board_draw_buf_pixels<Board>());
+  heap_caps_free(buf2);
+  buf2 = NULL;
+}
+
+static void restoreDrawBuffer() {
+  if (buf2 != NULL) {
+    return;
+  }
+  buf2 = (lv_color_t *)heap_caps_malloc(sizeof(buf),
+                                        MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  if (buf2 == NULL) {
+    return; // the single buffer still works
+  }
+  tft.waitDMA();
+  lv_disp_draw_buf_init(&draw_buf, buf, buf2, board_draw_buf_pixels<Board>());
+}
+
+static bool reserveScreen(uint32_t bytes) {
+  return mem_governor_reserve(bytes, 0);
+}
+
+void setupMemory() {
+  mem_governor_begin(mem_budget_for_board(), bootPrint);
+  mem_governor_add(MEM_SHED_CACHES, "caches", shedCaches);
+  mem_governor_add(MEM_UNLOAD_SCREENS, "screens", shedScreens);
+  mem_governor_add(MEM_DEGRADE, "legacy transitions", degradeTransitions,
+                   restoreTransitions);
+  mem_governor_add(MEM_DEGRADE, "single draw buffer", singleDrawBuffer,
+                   restoreDrawBuffer);
+  screen_registry_set_reserve_cb(reserveScreen);
+}
 
 void hal_setup(void);
 void hal_loop(void);
@@ -177,8 +292,20 @@ void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area,
     tft.endWrite();
   }
 
-  tft.pushImageDMA(area->x1, area->y1, area->x2 - area->x1 + 1,
-                   area->y2 - area->y1 + 1, (lgfx::swap565_t *)&color_p->full);
+  // rows hidden by the round bezel are not sent, the check compiles away on
+  // square panels
+  int16_t w = area->x2 - area->x1 + 1;
+  int16_t y1 = area->y1, y2 = area->y2;
+  if (board_visible_rows<Board>(area->x1, area->x2, y1, y2)) {
+    tft.pushImageDMA(area->x1, y1, w, y2 - y1 + 1,
+                     (lgfx::swap565_t *)&color_p[(y1 - area->y1) * w].full);
+  }
+  if (lv_disp_flush_is_last(disp)) {
+    boot_first_frame();
+  }
+  if (buf2 == NULL) {
+    tft.waitDMA(); // LVGL draws the next area into the same buffer
+  }
   lv_disp_flush_ready(disp); /* tell lvgl that flushing is done */
 }
 
@@ -188,16 +315,21 @@ void my_touchpad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data) {
   bool touched;
   uint8_t gesture;
   uint16_t touchX, touchY;
-  touched = tft.getTouch(&touchX, &touchY);
+  touched = tft.getTouchRaw(&touchX, &touchY);
   if (!touched) {
     data->state = LV_INDEV_STATE_REL;
   } else {
     data->state = LV_INDEV_STATE_PR;
+    governor.activity(millis());
 
     /*Set the coordinates*/
-    data->point.x = touchX;
-    data->point.y = touchY;
+    int16_t x, y;
+    board_touch_point<Board>(touchX, touchY, x, y);
+    data->point.x = x;
+    data->point.y = y;
   }
+  // released samples keep the last point
+  nav_input(data->point.x, data->point.y, touched);
 }
 
 String heapUsage() {
@@ -216,34 +348,436 @@ void logCallback(Level level, unsigned long time, String message) {
 
 void my_log_cb(const char *buf) { Serial.write(buf, strlen(buf)); }
 
+uint32_t bootClock() { return micros(); }
+
+void bootPrint(const char *line) { Serial.print(line); }
+
+void drawSplash() {
+  // splash.h holds a RGB565 bitmap of the full panel
+  tft.pushImage(0, 0, Board::width, Board::height, (const uint16_t *)splash);
+}
+
+/* FFat file read in small blocks */
+class FileSource : public IngestSource {
+public:
+  explicit FileSource(File &file) : file(file), len(0), pos(0) {}
+  int read() {
+    if (pos == len) {
+      len = file.read(buf, sizeof(buf));
+      pos = 0;
+      if (len == 0) {
+        return -1;
+      }
+    }
+    return buf[pos++];
+  }
+
+private:
+  File &file;
+  uint8_t buf[64];
+  size_t len;
+  size_t pos;
+};
+
+static bool countElement(JsonVariantConst element, uint16_t index, void *out) {
+  CatalogEntry *entry = (CatalogEntry *)out;
+  entry->elements = index + 1;
+  // only the hands are drawn around a pivot
+  if ((element["pvX"] | 0) != 0 || (element["pvY"] | 0) != 0) {
+    entry->analog = 1;
+  }
+  return true;
+}
+
+static bool countAsset(JsonVariantConst element, uint16_t index, void *out) {
+  ((CatalogEntry *)out)->assets = index + 1;
+  return true;
+}
+
+// the picker only needs the counts, elements and assets are not stored
+static const IngestField faceFields[] = {
+    INGEST_STRING_FIELD(CatalogEntry, "name", name),
+    INGEST_STRING_FIELD(CatalogEntry, "preview", preview),
+    INGEST_ARRAY_FIELD("elements", "{\"pvX\":true,\"pvY\":true}",
+                       countElement),
+    INGEST_ARRAY_FIELD("assets", NULL, countAsset),
+};
+
+#define FACE_FOUND_NAME (1 << 0)
+#define FACE_FOUND_ELEMENTS (1 << 2)
+
+/* The thumbnail pixels follow the LVGL image header of the preview */
+static uint32_t previewOffset(const char *preview) {
+  String path = preview[0] == '/' ? String(preview) : "/" + String(preview);
+  File file = FLASH.open(path);
+  if (!file) {
+    return 0; // not installed yet, the picker shows the name only
+  }
+  lv_img_header_t header;
+  bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+            header.cf != LV_IMG_CF_UNKNOWN && header.w > 0 && header.h > 0;
+  file.close();
+  return ok ? sizeof(header) : 0;
+}
+
+/* Catalog parser, only runs for faces that are new or changed */
+bool parseFace(const char *path, CatalogEntry &entry) {
+  File file = FLASH.open(path + strlen(FACE_DIR));
+  if (!file) {
+    return false;
+  }
+  entry.name[0] = '\0';
+  entry.preview[0] = '\0';
+  entry.preview_offset = 0;
+  entry.elements = 0;
+  entry.assets = 0;
+  entry.analog = 0;
+
+  FileSource src(file);
+  uint32_t found;
+  bool ok = ingest.parse(src, faceFields,
+                         sizeof(faceFields) / sizeof(faceFields[0]), &entry,
+                         &found);
+  file.close();
+  if (!ok || !(found & FACE_FOUND_ELEMENTS)) {
+    return false; // not a face
+  }
+  if (!(found & FACE_FOUND_NAME)) {
+    strlcpy(entry.name, entry.file, sizeof(entry.name));
+  }
+  if (entry.preview[0] != '\0') {
+    entry.preview_offset = previewOffset(entry.preview);
+  }
+  return true;
+}
+
+void listCustomFaces();
+
+/* Installer validator, the temporary file has to parse as a face */
+bool validateFace(InstallStorage &storage, const char *name, uint32_t size,
+                  FaceSummary &summary) {
+  char path[CATALOG_NAME_MAX + 16];
+  snprintf(path, sizeof(path), FACE_DIR "/%s.part", name);
+  CatalogEntry entry;
+  memset(&entry, 0, sizeof(entry));
+  strlcpy(entry.file, name, sizeof(entry.file));
+  entry.size = size;
+  return parseFace(path, entry);
+}
+
+/* BLE task: keep install packets for the loop, a dropped packet is resent
+ * from the offset in the next reply */
+void onBleData(uint8_t *data, int len) {
+  if (len <= 0 || len > INSTALL_PACKET_MAX ||
+      !FaceInstaller::isPacket(data, len)) {
+    return;
+  }
+  InstallPacket packet;
+  packet.len = len;
+  memcpy(packet.data, data, len);
+  xQueueSend(installQueue, &packet, 0);
+}
+
+/* BLE task: a reconnect before the loop ran keeps the transfer going */
+void onBleConnection(bool connected) { linkDropped = !connected; }
+
+void runInstallPackets() {
+  InstallPacket packet;
+  while (xQueueReceive(installQueue, &packet, 0) == pdTRUE) {
+    uint8_t reply[INSTALL_REPLY_SIZE];
+    InstallStatus status = installer.packet(packet.data, packet.len, reply);
+    watch.sendCommand(reply, sizeof(reply));
+    if (status == INSTALL_DONE) {
+      Serial.printf("Installed %s, %u bytes\n", installer.installed().name,
+                    (unsigned)installer.installed().size);
+      listCustomFaces(); // the storage added it to the catalog
+    } else if (status == INSTALL_INVALID || status == INSTALL_FILE_CRC) {
+      Serial.printf("Install rejected (%d)\n", status);
+    }
+  }
+}
+
+void listCustomFaces() {
+  customFaceIndex = 0;
+  for (uint16_t i = 0; i < catalog.count() && customFaceIndex < 15; i++) {
+    customFacePaths[customFaceIndex++] = "/" + String(catalog.entry(i).file);
+  }
+}
+
+void scanCustomFaces() {
+  catalog.load();
+  CatalogSync sync = catalog.sync();
+  Serial.printf("faces: %u kept, %u parsed, %u removed, %u invalid\n",
+                sync.kept, sync.parsed, sync.removed, sync.failed);
+  listCustomFaces();
+}
+
+/* Inline the stage closes a boot stage, from the boot task it is deferred */
+static void markStage(const char *stage, uint32_t start) {
+#ifdef FAST_START
+  boot_mark_deferred(stage, start);
+#else
+  boot_mark(stage);
+#endif
+}
+
+void mountFlash() {
+  uint32_t start = boot_now_us();
+  fsMounted = FLASH.begin(true, "/ffat", Board::max_file_open);
+  if (!fsMounted) {
+    Timber.e(F_NAME " mount failed");
+  }
+  markStage("fs mount", start);
+
+  start = boot_now_us();
+  if (fsMounted) {
+    lockFaces(portMAX_DELAY);
+    scanCustomFaces();
+    const char *pending = installer.pending();
+    if (pending) {
+      Serial.printf("Interrupted install of %s, resumes on the next transfer\n",
+                    pending);
+    }
+    unlockFaces();
+  }
+  markStage("face scan", start);
+}
+
+void startBle() {
+  uint32_t start = boot_now_us();
+  watch.setDataCallback(onBleData);
+  watch.setConnectionCallback(onBleConnection);
+  watch.begin();
+  bleStarted = true;
+  markStage("ble", start);
+}
+
+// file browser, the directory is read by filesTask and shown by file_list
+DirPager files;
+SemaphoreHandle_t filesMutex;
+lv_obj_t *filesScreen;
+lv_obj_t *filesList;
+// built before the boot task mounted FFat, the loop opens it afterwards
+bool filesWaiting;
+
+void lockFiles(bool lock) {
+  if (lock) {
+    xSemaphoreTake(filesMutex, portMAX_DELAY);
+  } else {
+    xSemaphoreGive(filesMutex);
+  }
+}
+
+/* Reads the open directory a page at a time, off the UI loop */
+void filesTask(void *param) {
+  for (;;) {
+    lockFiles(true);
+    bool more = files.step(DIR_PAGE);
+    lockFiles(false);
+    vTaskDelay(more ? 1 : pdMS_TO_TICKS(FILE_LIST_POLL_MS));
+  }
+}
+
+void fileOpened(const char *path, const DirEntry &entry) {
+  Serial.printf("file: %s, %u bytes\n", path, (unsigned)entry.size);
+}
+
+void filesScreenInit() {
+  filesScreen = lv_obj_create(NULL);
+  filesList =
+      file_list_create(filesScreen, &files, FACE_DIR, lockFiles, fileOpened);
+  filesWaiting = !fsMounted;
+  if (!filesWaiting) {
+    file_list_open(filesList, FACE_DIR);
+  }
+}
+
+void filesScreenDestroy() {
+  filesList = NULL;
+  filesWaiting = false;
+}
+
+// swipe navigation, the file browser is left of home
+void setupNavigation() {
+  int8_t home = nav_add("home", &ui_demoScreen);
+  int8_t filesId = nav_add("files", &filesScreen);
+  nav_link(home, NAV_LEFT, filesId);
+  nav_link(filesId, NAV_RIGHT, home);
+  nav_begin(home, bootClock);
+}
+
+void setupFiles() {
+  filesMutex = xSemaphoreCreateMutex();
+  screen_registry_add("files", &filesScreen, filesScreenInit,
+                      filesScreenDestroy, false);
+  xTaskCreate(filesTask, "files", 4096, NULL, 1, NULL);
+  setupNavigation();
+}
+
+/* Work moved out of the boot sequence, runs after the first frame */
+void bootTask(void *param) {
+  mountFlash();
+  startBle();
+  bootDone = true;
+  vTaskDelete(NULL);
+}
+
+void setTimeout(int i) { governor.setTimeout(settingTimeoutMs(i)); }
+
+void applyPower() {
+  lv_disp_t *display = lv_disp_get_default();
+  if (display) {
+    lv_timer_set_period(display->refr_timer, governor.refreshPeriod());
+  }
+  tft.setBrightness(governor.brightness());
+}
+
+uint32_t aodSeconds(uint16_t *millis) {
+  if (millis) {
+    *millis = watch.getMillis();
+  }
+  return watch.getHour(true) * 3600 + watch.getMinute() * 60 +
+         watch.getSecond();
+}
+
+void enterAod() {
+  AodConfig cfg;
+  cfg.screen_w = Board::width;
+  cfg.screen_h = Board::height;
+  cfg.h24 = watch.is24Hour();
+  aod = AlwaysOnFace(cfg);
+  aod.enter();
+
+  // LVGL is not run while the face is shown, the panel is written directly
+  tft.fillScreen(TFT_BLACK);
+  tft.setBrightness(AOD_BRIGHTNESS);
+  aodCpuMhz = getCpuFrequencyMhz();
+  setCpuFrequencyMhz(AOD_CPU_MHZ);
+}
+
+void exitAod() {
+  setCpuFrequencyMhz(aodCpuMhz);
+  aod.exit();
+  governor.activity(millis());
+  governor.update(millis());
+  lv_obj_invalidate(lv_scr_act()); // the panel no longer matches the screen
+  applyPower();
+}
+
+void loopAod() {
+  uint16_t touchX, touchY;
+  if (tft.getTouch(&touchX, &touchY)) {
+    exitAod();
+    return;
+  }
+  uint16_t ms;
+  uint32_t secs = aodSeconds(&ms);
+  AodRect r = aod.update(secs);
+  for (int16_t y = 0; y < r.h && r.w; y += AOD_BUF_LINES) {
+    int16_t lines = min(r.h - y, AOD_BUF_LINES);
+    aod.render(y, lines, aodBuf);
+    tft.pushImage(r.x, r.y + y, r.w, lines, (lgfx::swap565_t *)aodBuf);
+  }
+  delay(min(AlwaysOnFace::sleepMs(secs, ms), (uint32_t)AOD_POLL_MS));
+}
+
+void onBrightnessChange(lv_event_t *e) {
+  lv_obj_t *slider = lv_event_get_target(e);
+  int value = lv_slider_get_value(slider);
+  governor.setBrightness(value);
+  tft.setBrightness(governor.brightness());
+  settings.set(SETTING_BRIGHTNESS, value, millis());
+}
+
+void onTimeoutChange(lv_event_t *e) {
+  lv_obj_t *obj = lv_event_get_target(e);
+  uint16_t sel = lv_dropdown_get_selected(obj);
+  setTimeout(sel);
+  settings.set(SETTING_TIMEOUT, sel, millis());
+}
+
+void onWatchfaceChange(lv_event_t *e) {
+  intptr_t index = (intptr_t)lv_event_get_user_data(e);
+  settings.set(SETTING_WATCHFACE, index, millis());
+}
+
+void onLanguageChange(lv_event_t *e) {
+  lv_obj_t *obj = lv_event_get_target(e);
+  uint16_t index = lv_dropdown_get_selected(obj);
+  settings.set(SETTING_LANGUAGE, index, millis());
+  i18n_set_language(i18n_language_from(index));
+}
+
+static void bindStrings(lv_obj_t *screen) { i18n_bind_screen(screen); }
+
+void onGameOpened() {
+#ifdef ENABLE_GAME_RACING
+  racing_open(lv_scr_act());
+#endif
+}
+
+void onGameClosed() {
+#ifdef ENABLE_GAME_RACING
+  racing_close();
+#endif
+}
+
 void hal_setup() {
 
+  boot_profile_begin(bootClock);
+
   Serial.begin(115200); /* prepare for possible serial debug */
 
   Timber.setLogCallback(logCallback);
 
   Timber.i("Starting up device");
+  boot_mark("serial");
 
-  prefs.begin("my-app");
+  settings.begin();
+  setTimeout(settings.get(SETTING_TIMEOUT));
+  governor.setBrightness(settings.get(SETTING_BRIGHTNESS));
+  boot_mark("settings");
 
+#ifdef FAST_START
+  // splash first, everything else happens behind it
+  tft.init();
+  tft.initDMA();
+  tft.startWrite();
+  drawSplash();
+  tft.setBrightness(governor.brightness());
+  boot_first_frame();
+  boot_mark("tft + splash");
+#else
   tft.init();
   tft.initDMA();
   tft.startWrite();
   tft.fillScreen(TFT_BLACK);
+  boot_mark("tft");
+#endif
 
   Serial.println(heapUsage());
 
   lv_init();
-
-  lv_disp_draw_buf_init(&draw_buf, buf[0], buf[1], screenWidth * buf_size);
+  asset_decoder_init();
+  setupMemory();
+  installQueue = xQueueCreate(INSTALL_QUEUE_LEN, sizeof(InstallPacket));
+  facesMutex = xSemaphoreCreateMutex();
+  installer.setValidator(validateFace);
+  installer.setExtension(".wf"); // the catalog only lists these
+  boot_mark("lv_init");
+
+  buf2 = (lv_color_t *)heap_caps_malloc(sizeof(buf),
+                                        MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  lv_disp_draw_buf_init(&draw_buf, buf, buf2, board_draw_buf_pixels<Board>());
 
   /*Initialize the display*/
   static lv_disp_drv_t disp_drv;
   lv_disp_drv_init(&disp_drv);
   /*Change the following line to your display resolution*/
-  disp_drv.hor_res = screenWidth;
-  disp_drv.ver_res = screenHeight;
+  disp_drv.hor_res = Board::width;
+  disp_drv.ver_res = Board::height;
   disp_drv.flush_cb = my_disp_flush;
+  disp_drv.monitor_cb = transition_monitor_cb;
   disp_drv.draw_buf = &draw_buf;
   lv_disp_drv_register(&disp_drv);
 
@@ -256,30 +790,112 @@ void hal_setup() {
 
   lv_log_register_print_cb(my_log_cb);
   lv_disp_t *dispp = lv_disp_get_default();
+  boot_mark("drivers");
 
   // lv_label_set_text(ui_aboutText, about.c_str());
 
-  tft.setBrightness(200);
+#ifndef FAST_START
+  tft.setBrightness(governor.brightness());
+#endif
+
+#if LV_FONT_SIMSUN_16_CJK
+  i18n_begin(i18n_language_from(settings.get(SETTING_LANGUAGE)),
+             &lv_font_simsun_16_cjk);
+#else
+  i18n_begin(i18n_language_from(settings.get(SETTING_LANGUAGE)), NULL);
+#endif
+  screen_registry_set_built_cb(bindStrings);
 
   ui_init();
+  i18n_bind_screens(NULL);
+  setupFiles();
+  governor.begin(millis());
+  boot_mark("ui_init");
+  screen_registry_report();
+
+#ifdef FAST_START
+  xTaskCreate(bootTask, "boot", 8192, NULL, 1, NULL);
+#else
+  mountFlash();
+  startBle();
+  bootDone = true;
+#endif
 
   Timber.i("Setup done");
 }
 
 void hal_loop() {
-  if (!transfer) {
-    lv_timer_handler(); /* let the GUI do its work */
-
-    static uint32_t last_flush = 0;
-    uint32_t now = millis();
-    if (now - last_flush > 1000) { // Print every second
-      Serial.println("LVGL timer handled");
-      last_flush = now;
+  static bool bootReported = false;
+  if (bootDone && !bootReported) {
+    boot_report(bootPrint);
+    bootReported = true;
+  }
+  if (bleStarted) {
+    watch.loop();
+    // packets wait in the queue while the boot task holds the faces
+    if (lockFaces(0)) {
+      runInstallPackets();
+      if (linkDropped) {
+        linkDropped = false;
+        installer.suspend(); // committed chunks are kept for a resume
+      }
+      unlockFaces();
     }
+  }
+  settings.loop(millis());
+  if (filesWaiting && fsMounted) {
+    filesWaiting = false;
+    file_list_open(filesList, FACE_DIR);
+  }
 
-    delay(15); // Increased delay
-
-    lv_disp_t *display = lv_disp_get_default();
-    lv_obj_t *actScr = lv_disp_get_scr_act(display);
+  if (aod.active() && installer.active()) {
+    exitAod(); // the always-on face polls too slowly for a transfer
+  }
+  if (aod.active()) {
+    loopAod();
+    return;
   }
+  lv_timer_handler(); /* let the GUI do its work */
+
+  static uint32_t last_flush = 0;
+  uint32_t now = millis();
+#ifdef ENABLE_GAME_RACING
+  racing_update(now);
+  if (racing_running()) {
+    governor.animating(now);
+  }
+#endif
+  // a transfer keeps the short loop delay so the packet queue drains
+  if (lv_anim_count_running() || installer.active()) {
+    governor.animating(now);
+  }
+  if (governor.update(now)) {
+    applyPower();
+    if (governor.state() == POWER_OFF && settings.get(SETTING_AOD)) {
+      enterAod();
+    }
+  }
+  if (now - last_flush > 1000) { // Print every second
+    Serial.println("LVGL timer handled");
+    mem_governor_check();
+    last_flush = now;
+  }
+  static uint32_t last_stats = 0;
+  if (now - last_stats > 60000) {
+    char line[96];
+    governor.format(line, sizeof(line));
+    Serial.print(line);
+    if (lockFaces(0)) {
+      ingest.format(line, sizeof(line));
+      unlockFaces();
+      Serial.print(line);
+    }
+    mem_governor_report();
+    last_stats = now;
+  }
+
+  delay(governor.loopDelay());
+
+  lv_disp_t *display = lv_disp_get_default();
+  lv_obj_t *actScr = lv_disp_get_scr_act(display);
 }
@@ -36,6 +36,10 @@
 
 // #define ENABLE_GAME_RACING
 
+// show the splash in the first frame, mount the filesystem, scan custom
+// faces and start BLE in a background task after boot
+#define FAST_START
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -1,7 +1,10 @@
 #include <unistd.h>
 #include <ctime>
 #include <cstring>
+#include <cstdlib>
+#include <chrono>
 #include <stdio.h>
+#ifndef HEADLESS
 #define SDL_MAIN_HANDLED /*To fix SDL's "undefined reference to WinMain" issue*/
 #include SDL_INCLUDE_PATH
 #include "display/monitor.h"
@@ -9,10 +12,40 @@
 #include "indev/mousewheel.h"
 #include "indev/keyboard.h"
 #include "sdl/sdl.h"
+#endif
 #include "app_hal.h"
+#include "headless.h"
 
 #include <lvgl.h>
 #include "ui/ui.h"
+#include "transition.h"
+#include "screen_registry.h"
+#include "boot_profile.h"
+#include "settings_store.h"
+#include "power_governor.h"
+#include "racing.h"
+#include "asset_decoder.h"
+#include "analog_hands.h"
+#include "qr_cache.h"
+#include "mem_governor.h"
+#include "notification_store.h"
+#include "weather_model.h"
+#include "time_format.h"
+#include "label_layout.h"
+#include "curve_list.h"
+#include "i18n_labels.h"
+#include "file_list.h"
+#include "nav_controller.h"
+
+#ifdef NATIVE_BENCHMARK
+#include "bench.h"
+#endif
+#ifdef GOLDEN
+#include "golden.h"
+#endif
+#ifdef SOAK
+#include "soak.h"
+#endif
 
 
 struct Notification
@@ -23,14 +56,9 @@ struct Notification
     const char *message;
 };
 
-struct Weather
-{
-    int icon;
-    int day;
-    int temp;
-    int high;
-    int low;
-};
+
+/* Minimum LVGL heap block kept free by evicting unused screens */
+#define SCREEN_TRIM_FREE (16 * 1024)
 
 void hal_setup(void);
 void hal_loop(void);
@@ -51,7 +79,7 @@ Notification notifications[10] = {
     {.icon = 0x0F, .app = "Twitter", .time = "18:00", .message = "Breaking news: SpaceX launches its latest satellite into orbit. The advancements in space exploration never cease to amaze us. Let's stay updated on the latest developments and continue to support the incredible work being done in the field of aerospace engineering."},
     {.icon = 0x07, .app = "Tencent", .time = "13:40", .message = "Your gaming buddy is online. Ready for a match? It's time to put our skills to the test and embark on another thrilling gaming adventure together. Let's strategize, communicate, and emerge victorious as a team!"}};
 
-Weather weather[7] = {
+WeatherDay weather[7] = {
     {.icon = 0, .day = 0, .temp = 21, .high = 22, .low = 18},
     {.icon = 4, .day = 1, .temp = 25, .high = 26, .low = 24},
     {.icon = 5, .day = 2, .temp = 23, .high = 24, .low = 17},
@@ -61,8 +89,14 @@ Weather weather[7] = {
     {.icon = 2, .day = 6, .temp = 24, .high = 26, .low = 19},
 };
 
-const char *daysWk[7] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
-const char *months[12] = {"January", "February", "March", "April", "May", "June", "July", "August", "September", "October", "November", "December"};
+MemorySettingsBackend settingsBackend;
+SettingsStore settings(settingsBackend);
+PowerGovernor governor;
+
+NotificationStore notificationStore;
+WeatherModel weatherModel;
+
+#ifndef HEADLESS
 /**
  * A task to measure the elapsed time for LittlevGL
  * @param data unused
@@ -80,6 +114,126 @@ static int tick_thread(void *data)
 
     return 0;
 }
+#endif
+
+static time_t fixed_time;
+
+time_t hal_time(void)
+{
+#ifdef VIRTUAL_TIME
+    return fixed_time ? fixed_time : headless_time();
+#else
+    return fixed_time ? fixed_time : time(0);
+#endif
+}
+
+void hal_set_time(time_t t)
+{
+    fixed_time = t;
+}
+
+static void log_cb(const char *buf)
+{
+    printf("%s", buf);
+}
+
+static uint32_t boot_clock()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void boot_print(const char *line)
+{
+    printf("%s", line);
+}
+
+/* Memory governor shed actions, cheapest first */
+static void shed_caches(uint32_t deficit)
+{
+    asset_cache_release(deficit);
+    hands_cache_release(deficit);
+    qr_cache_clear();
+    lv_img_cache_invalidate_src(NULL);
+}
+
+static void shed_screens(uint32_t deficit)
+{
+    screen_registry_trim(SCREEN_TRIM_FREE + deficit);
+}
+
+static void degrade_transitions(uint32_t deficit)
+{
+    transition_set_mode(TRANSITION_LEGACY);
+}
+
+static void restore_transitions()
+{
+    transition_set_mode(TRANSITION_AUTO);
+}
+
+static bool reserve_screen(uint32_t bytes)
+{
+    return mem_governor_reserve(bytes, 0);
+}
+
+static void setup_memory()
+{
+    mem_governor_begin(mem_budget_for_board(), boot_print);
+    mem_governor_add(MEM_SHED_CACHES, "caches", shed_caches);
+    mem_governor_add(MEM_UNLOAD_SCREENS, "screens", shed_screens);
+    mem_governor_add(MEM_DEGRADE, "legacy transitions", degrade_transitions, restore_transitions);
+    screen_registry_set_reserve_cb(reserve_screen);
+}
+
+#ifndef HEADLESS
+static void mouse_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
+{
+    sdl_mouse_read(indev_drv, data);
+    /* the benchmark replays its own swipes */
+#ifndef NATIVE_BENCHMARK
+    nav_input(data->point.x, data->point.y, data->state == LV_INDEV_STATE_PR);
+#endif
+    if (data->state == LV_INDEV_STATE_PR)
+    {
+        governor.activity(lv_tick_get());
+    }
+}
+
+/* The window stands in for the panel, the backlight level scales the pixels */
+static uint8_t backlight = LV_OPA_COVER;
+
+static void display_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    bool last = lv_disp_flush_is_last(disp_drv);
+    if (backlight < LV_OPA_COVER)
+    {
+        uint32_t count = lv_area_get_size(area);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            color_p[i] = lv_color_mix(color_p[i], lv_color_black(), backlight);
+        }
+    }
+    sdl_display_flush(disp_drv, area, color_p);
+    if (last)
+    {
+        boot_first_frame();
+    }
+}
+#endif
+
+/* Show the governor's backlight level, as the esp32 sets the panel's */
+static void apply_brightness()
+{
+#ifndef HEADLESS
+    uint8_t level = governor.brightness();
+    if (level != backlight)
+    {
+        backlight = level;
+        lv_obj_invalidate(lv_scr_act());
+    }
+#endif
+}
 
 void onLoadHome(lv_event_t *e) {}
 
@@ -91,11 +245,47 @@ void onWeatherLoad(lv_event_t *e) {}
 
 void onNotificationsOpen(lv_event_t *e) {}
 
-void onBrightnessChange(lv_event_t *e) {}
+void onBrightnessChange(lv_event_t *e)
+{
+    lv_obj_t *slider = lv_event_get_target(e);
+    governor.setBrightness(lv_slider_get_value(slider));
+    apply_brightness();
+    settings.set(SETTING_BRIGHTNESS, lv_slider_get_value(slider), lv_tick_get());
+}
 
-void onScrollMode(lv_event_t *e) {}
+/* Round lists bend along the bezel, see curve_list.h */
+#define CURVE_RADIUS (SDL_HOR_RES / 2)
 
-void onTimeoutChange(lv_event_t *e) {}
+static void apply_scroll_mode(bool curved)
+{
+    lv_obj_t *lists[] = {ui_settingsList, ui_appList, ui_gameList};
+    for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); i++)
+    {
+        if (curved)
+        {
+            curve_list_attach(lists[i], CURVE_RADIUS);
+        }
+        else
+        {
+            curve_list_detach(lists[i]);
+        }
+    }
+}
+
+void onScrollMode(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    bool curved = lv_obj_has_state(obj, LV_STATE_CHECKED);
+    settings.set(SETTING_CIRCULAR, curved, lv_tick_get());
+    apply_scroll_mode(curved);
+}
+
+void onTimeoutChange(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    governor.setTimeout(settingTimeoutMs(lv_dropdown_get_selected(obj)));
+    settings.set(SETTING_TIMEOUT, lv_dropdown_get_selected(obj), lv_tick_get());
+}
 
 void onBatteryChange(lv_event_t *e) {}
 
@@ -107,13 +297,13 @@ void onMusicPlay(lv_event_t *e)
 void onMusicPrevious(lv_event_t *e)
 {
     lv_label_set_text(ui_callName, "World");
-    lv_scr_load_anim(ui_callScreen, LV_SCR_LOAD_ANIM_FADE_IN, 500, 0, false);
+    transition_load(ui_callScreen, LV_SCR_LOAD_ANIM_FADE_IN, 500, 0);
 }
 
 void onMusicNext(lv_event_t *e)
 {
     lv_label_set_text(ui_cameraLabel, "Click capture to close to close");
-    lv_scr_load_anim(ui_cameraScreen, LV_SCR_LOAD_ANIM_FADE_IN, 500, 0, false);
+    transition_load(ui_cameraScreen, LV_SCR_LOAD_ANIM_FADE_IN, 500, 0);
 }
 
 void onStartSearch(lv_event_t *e) {}
@@ -130,19 +320,41 @@ void onAlertState(lv_event_t *e) {}
 
 void onLanguageChange(lv_event_t *e)
 {
+    lv_obj_t *obj = lv_event_get_target(e);
+    uint16_t index = lv_dropdown_get_selected(obj);
+    settings.set(SETTING_LANGUAGE, index, lv_tick_get());
+    i18n_set_language(i18n_language_from(index));
+}
 
+static void bind_strings(lv_obj_t *screen)
+{
+    i18n_bind_screen(screen);
 }
 
 
-void onWatchfaceChange(lv_event_t *e) {}
+void onWatchfaceChange(lv_event_t *e)
+{
+    intptr_t index = (intptr_t)lv_event_get_user_data(e);
+    settings.set(SETTING_WATCHFACE, index, lv_tick_get());
+}
 
 void onFaceSelected(lv_event_t *e) {}
 
 void onCustomFaceSelected(int pathIndex) {}
 
-void onGameOpened(){}
+void onGameOpened()
+{
+#ifdef ENABLE_GAME_RACING
+    racing_open(lv_scr_act());
+#endif
+}
 
-void onGameClosed(){}
+void onGameClosed()
+{
+#ifdef ENABLE_GAME_RACING
+    racing_close();
+#endif
+}
 
 bool loadCustomFace(const char *file) 
 {
@@ -153,13 +365,19 @@ void onMessageClick(lv_event_t *e)
 {
     // Your code here
     // int index = (int)lv_event_get_user_data(e);
-    intptr_t index = (intptr_t)lv_event_get_user_data(e);
+    intptr_t id = (intptr_t)lv_event_get_user_data(e);
 
-    index %= 10;
+    int index = notificationStore.find(id);
+    if (index < 0)
+    {
+        return;
+    }
+    const NotificationRecord &n = notificationStore.get(index);
 
-    lv_label_set_text(ui_messageTime, notifications[index].time);
-    lv_label_set_text(ui_messageContent, notifications[index].message);
-    setNotificationIcon(ui_messageIcon, notifications[index].icon);
+    lv_label_set_text(ui_messageTime, n.time);
+    label_layout_attach(ui_messageContent); /* breaks lines once per message */
+    lv_label_set_text(ui_messageContent, n.message);
+    setNotificationIcon(ui_messageIcon, n.icon);
 
     lv_obj_scroll_to_y(ui_messagePanel, 0, LV_ANIM_ON);
     lv_obj_add_flag(ui_messageList, LV_OBJ_FLAG_HIDDEN);
@@ -168,7 +386,7 @@ void onMessageClick(lv_event_t *e)
 
 void onCaptureClick(lv_event_t *e)
 {
-    lv_scr_load_anim(ui_home, LV_SCR_LOAD_ANIM_FADE_IN, 500, 0, false);
+    transition_load(ui_home, LV_SCR_LOAD_ANIM_FADE_IN, 500, 0);
 }
 
 void addFaceList(lv_obj_t *parent, Face face){}
@@ -180,21 +398,27 @@ void setupWeather()
     lv_obj_clear_flag(ui_weatherPanel, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_flag(ui_forecastPanel, LV_OBJ_FLAG_HIDDEN);
 
-    const char *updateTime = "Updated at\n10:47";
-    lv_label_set_text(ui_weatherCity, "Nairobi");
-    lv_label_set_text(ui_weatherUpdateTime, updateTime);
-    lv_label_set_text_fmt(ui_weatherCurrentTemp, "%d°C", weather[0].temp);
+    weatherModel.setCity("Nairobi");
+    weatherModel.setUpdated(10, 47);
+    weatherModel.update(weather, 7);
+    weatherModel.takeChanges();
 
-    setWeatherIcon(ui_weatherCurrentIcon, weather[0].icon, true);
+    const WeatherDay &today = weatherModel.today();
+    lv_label_set_text(ui_weatherCity, weatherModel.city());
+    lv_label_set_text_fmt(ui_weatherUpdateTime, "Updated at\n%02d:%02d", weatherModel.updated() / 60, weatherModel.updated() % 60);
+    lv_label_set_text_fmt(ui_weatherCurrentTemp, "%d°C", today.temp);
 
-    lv_label_set_text_fmt(ui_weatherTemp, "%d°C", weather[0].temp);
-    setWeatherIcon(ui_weatherIcon, weather[0].icon, true);
+    setWeatherIcon(ui_weatherCurrentIcon, today.icon, true);
+
+    lv_label_set_text_fmt(ui_weatherTemp, "%d°C", today.temp);
+    setWeatherIcon(ui_weatherIcon, today.icon, true);
 
     lv_obj_clean(ui_forecastList);
 
-    for (int i = 0; i < 7; i++)
+    for (int i = 0; i < weatherModel.count(); i++)
     {
-        addForecast(weather[i].day, weather[i].temp, weather[i].icon);
+        const WeatherDay &d = weatherModel.day(i);
+        addForecast(d.day, d.temp, d.icon);
     }
 }
 
@@ -202,9 +426,19 @@ void setupNotifications()
 {
     lv_obj_clean(ui_messageList);
 
-    for (int i = 0; i < 10; i++)
+    if (notificationStore.count() == 0)
+    {
+        /* oldest first, so the list shows them in the original order */
+        for (int i = 9; i >= 0; i--)
+        {
+            notificationStore.add(notifications[i].icon, notifications[i].app, notifications[i].time, notifications[i].message);
+        }
+    }
+
+    for (int i = 0; i < notificationStore.count(); i++)
     {
-        addNotificationList(notifications[i].icon, notifications[i].message, i);
+        const NotificationRecord &n = notificationStore.get(i);
+        addNotificationList(n.icon, n.message, n.id);
     }
 
     lv_obj_scroll_to_y(ui_messageList, 1, LV_ANIM_ON);
@@ -212,21 +446,117 @@ void setupNotifications()
     lv_obj_add_flag(ui_messagePanel, LV_OBJ_FLAG_HIDDEN);
 }
 
+/* File browser over a host directory, see file_list.h */
+#ifndef FILES_ROOT
+#define FILES_ROOT "."
+#endif
+
+static DirPager files;
+static lv_obj_t *files_screen;
+
+/* The device reads from a task, here a page per LVGL tick is enough */
+static void files_step(lv_timer_t *timer)
+{
+    files.step(DIR_PAGE);
+}
+
+static void files_opened(const char *path, const DirEntry &entry)
+{
+    printf("file: %s, %u bytes\n", path, (unsigned)entry.size);
+}
+
+static void files_screen_init(void)
+{
+    files_screen = lv_obj_create(NULL);
+    lv_obj_t *list = file_list_create(files_screen, &files, FILES_ROOT, NULL, files_opened);
+    file_list_open(list, FILES_ROOT);
+}
+
+/* Swipe navigation, the file browser is left of home, see nav_controller.h */
+static void setup_navigation(void)
+{
+    int8_t home = nav_add("home", &ui_demoScreen);
+    int8_t files_id = nav_add("files", &files_screen);
+    nav_link(home, NAV_LEFT, files_id);
+    nav_link(files_id, NAV_RIGHT, home);
+    nav_begin(home, boot_clock);
+}
+
 void setupFiles()
 {
+    screen_registry_add("files", &files_screen, files_screen_init, NULL, false);
+    lv_timer_create(files_step, 5, NULL);
+    setup_navigation();
+}
 
-    // addListDrive("C:/", 16777216, 8456213);
-    // addListDrive("D:/", 6456326, 456213);
 
-    addListDir("watchface");
-    addListDir("extracted");
-    addListDir("bluetooth");
+#ifdef VIRTUAL_TIME
+/* Simulated day: a notification arrives and wakes the screen, the user
+ * touches it now and then, the screen timeout does the rest */
+static void sim_notification(uint32_t count)
+{
+    const Notification &n = notifications[count % 10];
+    notificationStore.add(n.icon, n.app, n.time, n.message);
+    governor.activity(lv_tick_get());
+    setupNotifications();
+}
 
-    addListFile("kenya.bin", 152453);
-    addListFile("kenya.wf", 453);
-    addListFile("list.txt", 2453);
+static void sim_touch(uint32_t count)
+{
+    governor.activity(lv_tick_get());
 }
+#endif
 
+#ifdef SOAK
+/* Call an event handler the way LVGL does for a click */
+static void soak_click(lv_event_cb_t cb, lv_obj_t *target, intptr_t user_data)
+{
+    lv_event_t e;
+    memset(&e, 0, sizeof(e));
+    e.target = target;
+    e.current_target = target;
+    e.code = LV_EVENT_CLICKED;
+    e.user_data = (void *)user_data;
+    cb(&e);
+}
+
+/* A new notification replaces the oldest, one is opened, the list closes it */
+static void soak_notification(uint32_t cycle)
+{
+    const Notification &n = notifications[cycle % 10];
+    notificationStore.add(n.icon, n.app, n.time, n.message);
+    setupNotifications();
+    const NotificationRecord &r = notificationStore.get(cycle % notificationStore.count());
+    soak_click(onMessageClick, ui_messageList, r.id);
+}
+
+static void soak_weather(uint32_t cycle)
+{
+    weather[0].temp = 15 + cycle % 20;
+    setupWeather();
+}
+
+/* The next registered screen, built again if it was evicted */
+static void soak_screen(uint32_t cycle)
+{
+    uint32_t count = screen_registry_count();
+    if (count == 0)
+    {
+        return;
+    }
+    const screen_entry_t *e = screen_registry_entry(cycle % count);
+    lv_disp_load_scr(screen_registry_get(e->handle));
+    update_faces();
+}
+#endif
+
+/* Runs from the first timer handler call, after the boot sequence */
+static void setup_files_deferred(lv_timer_t *timer)
+{
+    uint32_t start = boot_now_us();
+    setupFiles();
+    boot_mark_deferred("files", start);
+}
 
 void hal_setup(void)
 {
@@ -236,7 +566,24 @@ void hal_setup(void)
     setenv("DBUS_FATAL_WARNINGS", "0", 1);
 #endif
 
+    boot_profile_begin(boot_clock);
+    settings.begin();
+
+    PowerConfig power;
+    power.active_loop_ms = 5;
+    governor = PowerGovernor(power);
+    governor.setBrightness(settings.get(SETTING_BRIGHTNESS));
+    governor.setTimeout(settingTimeoutMs(settings.get(SETTING_TIMEOUT)));
+
+#ifdef HEADLESS
+    headless_init();
+#endif
+
     lv_init();
+    lv_log_register_print_cb(log_cb);
+    asset_decoder_init();
+    setup_memory();
+    boot_mark("lv_init");
 
     /* Add a display
      * Use the 'monitor' driver which creates window on PC's monitor to simulate a display*/
@@ -247,30 +594,56 @@ void hal_setup(void)
 
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);           /*Basic initialization*/
-    disp_drv.flush_cb = sdl_display_flush; /*Used when `LV_VDB_SIZE != 0` in lv_conf.h (buffered drawing)*/
+#ifdef HEADLESS
+    disp_drv.flush_cb = headless_flush;    /*Render into a RAM framebuffer*/
+#else
+    disp_drv.flush_cb = display_flush;     /*Used when `LV_VDB_SIZE != 0` in lv_conf.h (buffered drawing)*/
+#endif
     disp_drv.draw_buf = &disp_buf;
     disp_drv.hor_res = SDL_HOR_RES;
     disp_drv.ver_res = SDL_VER_RES;
+    disp_drv.monitor_cb = transition_monitor_cb;
     // disp_drv.disp_fill = monitor_fill;      /*Used when `LV_VDB_SIZE == 0` in lv_conf.h (unbuffered drawing)*/
     // disp_drv.disp_map = monitor_map;        /*Used when `LV_VDB_SIZE == 0` in lv_conf.h (unbuffered drawing)*/
     lv_disp_drv_register(&disp_drv);
 
+#ifndef HEADLESS
     /* Add the mouse as input device
      * Use the 'mouse' driver which reads the PC's mouse*/
     static lv_indev_drv_t indev_drv;
     lv_indev_drv_init(&indev_drv); /*Basic initialization*/
     indev_drv.type = LV_INDEV_TYPE_POINTER;
-    indev_drv.read_cb = sdl_mouse_read; /*This function will be called periodically (by the library) to get the mouse position and state*/
+    indev_drv.read_cb = mouse_read;     /*This function will be called periodically (by the library) to get the mouse position and state*/
     lv_indev_drv_register(&indev_drv);
 
     sdl_init();
+#endif
+    boot_mark("drivers");
+
+#if LV_FONT_SIMSUN_16_CJK
+    i18n_begin(i18n_language_from(settings.get(SETTING_LANGUAGE)), &lv_font_simsun_16_cjk);
+#else
+    i18n_begin(i18n_language_from(settings.get(SETTING_LANGUAGE)), NULL);
+#endif
+    screen_registry_set_built_cb(bind_strings);
 
     ui_init();
+    i18n_bind_screens(NULL);
+    governor.begin(lv_tick_get());
+    apply_brightness();
+    boot_mark("ui_init");
 
     setupNotifications();
     setupWeather();
+    boot_mark("notifications + weather");
 
+#ifdef FAST_START
+    lv_timer_t *files = lv_timer_create(setup_files_deferred, 0, NULL);
+    lv_timer_set_repeat_count(files, 1);
+#else
     setupFiles();
+    boot_mark("files");
+#endif
 
     // int wf = 4; // load watchface 4
     // if (wf >= numFaces)
@@ -280,44 +653,96 @@ void hal_setup(void)
     // ui_home = *faces[wf].watchface; 
     // lv_disp_load_scr(ui_home);
 
-    circular = true;
+    /* curve lists instead of the per-event transform of the ui lists */
+    circular = false;
+    apply_scroll_mode(settings.get(SETTING_CIRCULAR));
     lv_obj_scroll_to_y(ui_settingsList, 1, LV_ANIM_ON);
     lv_obj_scroll_to_y(ui_appList, 1, LV_ANIM_ON);
     lv_obj_scroll_to_y(ui_appInfoPanel, 1, LV_ANIM_ON);
     lv_obj_scroll_to_y(ui_gameList, 1, LV_ANIM_ON);
-    lv_obj_add_state(ui_Switch2, LV_STATE_CHECKED);
+    if (settings.get(SETTING_CIRCULAR))
+    {
+        lv_obj_add_state(ui_Switch2, LV_STATE_CHECKED);
+    }
+    boot_mark("ui state");
 
-    
+#ifdef VIRTUAL_TIME
+    headless_clock().every(SIM_NOTIFY_MS, sim_notification);
+    headless_clock().every(SIM_TOUCH_MS, sim_touch);
+#endif
+
+#ifndef HEADLESS
     /* Tick init.
      * You have to call 'lv_tick_inc()' in periodically to inform LittelvGL about how much time were elapsed
      * Create an SDL thread to do this*/
     SDL_CreateThread(tick_thread, "tick", NULL);
+#endif
+
+#ifdef GOLDEN
+    int mismatches = golden_run();
+#endif
+
+#ifdef NATIVE_BENCHMARK
+    bench_run();
+#endif
+
+#ifdef GOLDEN
+    exit(mismatches ? 1 : 0);
+#endif
+
+#ifdef SOAK
+    soak_add("notification", soak_notification);
+    soak_add("weather", soak_weather);
+    soak_add("screen", soak_screen);
+    exit(soak_run());
+#endif
 }
 
 void hal_loop(void)
 {
+    bool boot_reported = false;
+    uint32_t last_check = 0;
     while (1)
     {
-        SDL_Delay(5);
+        if (!boot_reported && boot_first_frame_us())
+        {
+            boot_report(boot_print);
+            boot_reported = true;
+        }
+
+        hal_delay(governor.loopDelay());
         lv_task_handler();
+        if (lv_anim_count_running())
+        {
+            governor.animating(lv_tick_get());
+        }
+        if (governor.update(lv_tick_get()))
+        {
+            lv_timer_set_period(lv_disp_get_default()->refr_timer, governor.refreshPeriod());
+            apply_brightness();
+            printf("power: %s, refresh %ums, backlight %u\n", PowerGovernor::name(governor.state()),
+                   (unsigned)governor.refreshPeriod(), (unsigned)governor.brightness());
+        }
+        if (lv_tick_elaps(last_check) >= 250)
+        {
+            mem_governor_check();
+            last_check = lv_tick_get();
+        }
+        if (settings.loop(lv_tick_get()))
+        {
+            printf("settings committed, %u writes / %u commits\n", (unsigned)settingsBackend.writes, (unsigned)settingsBackend.commits);
+        }
         if (ui_home == ui_clockScreen)
         {
-            time_t now = time(0);
-            tm *ltm = localtime(&now);
-
-            int second = ltm->tm_sec;
-            int minute = ltm->tm_min;
-            int hour = ltm->tm_hour;
-            bool am = hour < 12;
-            int day = ltm->tm_mday;
-            int month = 1 + ltm->tm_mon;    // Month starts from 0
-            int year = 1900 + ltm->tm_year; // Year is since 1900
-            int weekday = ltm->tm_wday;
-
-            lv_label_set_text_fmt(ui_hourLabel, "%02d", hour);
-            lv_label_set_text_fmt(ui_dayLabel, "%s", daysWk[weekday]);
-            lv_label_set_text_fmt(ui_minuteLabel, "%02d", minute);
-            lv_label_set_text_fmt(ui_dateLabel, "%02d\n%s", day, months[month - 1]);
+            time_t now = hal_time();
+            ClockTime t = clock_time(*localtime(&now));
+            char date[24];
+            clock_format_date(date, sizeof(date), t);
+
+            lv_label_set_text_fmt(ui_hourLabel, "%02d", t.hour);
+            lv_label_set_text(ui_dayLabel, clock_weekday_name(t.weekday));
+            lv_label_set_text_fmt(ui_minuteLabel, "%02d", t.minute);
+            lv_label_set_text(ui_dateLabel, date);
             lv_label_set_text(ui_amPmLabel, "");
         }
         else
@@ -325,15 +750,31 @@ void hal_loop(void)
             update_faces();
         }
 
-        // this works just okay on native, esp32 implementation is different
-        ui_games_update();
-        
+#ifdef ENABLE_GAME_RACING
+        // same fixed timestep loop as the esp32
+        racing_update(lv_tick_get());
+        if (racing_running())
+        {
+            governor.animating(lv_tick_get());
+        }
+#endif
+
+#ifdef HEADLESS
+        if (headless_done())
+        {
+            char line[96];
+            governor.format(line, sizeof(line));
+            printf("%s", line);
+            headless_report();
+            exit(0);
+        }
+#endif
     }
 }
 
 void update_faces()
 {
-    time_t now = time(0);
+    time_t now = hal_time();
     tm *ltm = localtime(&now);
 
     // Extract time fields
@@ -33,6 +33,11 @@
 
 #define ENABLE_GAME_RACING
 
+// populate the file browser after the first frame
+#define FAST_START
+
+#include <time.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,6 +46,17 @@ extern "C" {
 void hal_setup(void);
 void hal_loop(void);
 
+/**
+ * Clock used by the watchfaces, `time(0)` unless a fixed time is set
+ */
+time_t hal_time(void);
+
+/**
+ * Show a fixed time, e.g. for reference images
+ * @param t seconds since the epoch, 0 for the system clock
+ */
+void hal_set_time(time_t t);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -0,0 +1,1052 @@
+#ifdef NATIVE_BENCHMARK
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <unistd.h>
+#include <dirent.h>
+#include <lvgl.h>
+
+#include "bench.h"
+#include "headless.h"
+#include "transition.h"
+#include "racing.h"
+#include "asset.h"
+#include "asset_decoder.h"
+#include "analog_hands.h"
+#include "qr_cache.h"
+#include "face_install.h"
+#include "face_catalog.h"
+#include "label_layout.h"
+#include "curve_list.h"
+#include "i18n_labels.h"
+#include "nav_controller.h"
+#include "screen_registry.h"
+
+#define BENCH_TRANSITIONS 10
+#define BENCH_LIST_ITEMS 20
+#define BENCH_LABELS 60
+#define BENCH_SWITCHES 90
+#define BENCH_SWIPES 12
+
+/**
+ * A screen roughly as heavy as the watch screens, gradient background,
+ * arcs and labels
+ */
+static lv_obj_t *bench_screen(lv_color_t color)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr, color, 0);
+    lv_obj_set_style_bg_grad_color(scr, lv_color_black(), 0);
+    lv_obj_set_style_bg_grad_dir(scr, LV_GRAD_DIR_VER, 0);
+
+    for (int i = 0; i < 3; i++)
+    {
+        lv_obj_t *arc = lv_arc_create(scr);
+        lv_obj_set_size(arc, 220 - i * 40, 220 - i * 40);
+        lv_arc_set_value(arc, 30 + i * 20);
+        lv_obj_center(arc);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        lv_obj_t *label = lv_label_create(scr);
+        lv_label_set_text_fmt(label, "Line %d 12:34", i);
+        lv_obj_align(label, LV_ALIGN_TOP_MID, 0, 30 + i * 22);
+    }
+    return scr;
+}
+
+static void bench_wait(void)
+{
+    while (transition_active())
+    {
+        hal_delay(5);
+        lv_timer_handler();
+    }
+    /* let the last frame settle */
+    hal_delay(20);
+    lv_timer_handler();
+}
+
+static void bench_transitions(TransitionMode mode, const char *name, lv_scr_load_anim_t anim)
+{
+    lv_obj_t *a = bench_screen(lv_palette_main(LV_PALETTE_BLUE));
+    lv_obj_t *b = bench_screen(lv_palette_main(LV_PALETTE_RED));
+    lv_obj_t *prev = lv_scr_act();
+
+    lv_disp_load_scr(a);
+    lv_timer_handler();
+
+    transition_set_mode(mode);
+
+    FrameStats total;
+    total.reset();
+    uint32_t snapshot_ms = 0;
+    bool snapshot = false;
+    for (int i = 0; i < BENCH_TRANSITIONS; i++)
+    {
+        transition_load(i % 2 ? a : b, anim, 500, 0);
+        snapshot = transition_stats().snapshot;
+        bench_wait();
+
+        const TransitionStats &s = transition_stats();
+        snapshot_ms += s.snapshot_ms;
+        total.merge(s.frames);
+    }
+
+    char line[160];
+    total.format(line, sizeof(line), name);
+    printf("%s", line);
+    printf("%s: mode=%s snapshot_avg=%.2fms\n", name, snapshot ? "snapshot" : "legacy",
+           (float)snapshot_ms / BENCH_TRANSITIONS);
+
+    lv_disp_load_scr(prev);
+    lv_obj_del(a);
+    lv_obj_del(b);
+    transition_set_mode(TRANSITION_AUTO);
+}
+
+static void bench_racing(void)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_t *prev = lv_scr_act();
+    lv_disp_load_scr(scr);
+
+    if (!racing_open(scr))
+    {
+        printf("racing: open failed\n");
+        return;
+    }
+
+    FrameStats render;
+    render.reset();
+    uint32_t start = lv_tick_get();
+    uint32_t last_input = start;
+    while (lv_tick_elaps(start) < 5000)
+    {
+        if (lv_tick_elaps(last_input) > 300)
+        {
+            /* replayed input: weave between the lanes */
+            racing_input((lv_tick_get() / 300) % 2 ? GAME_INPUT_LEFT : GAME_INPUT_RIGHT);
+            racing_input(GAME_INPUT_PRESS);
+            last_input = lv_tick_get();
+        }
+        hal_delay(5);
+        uint32_t t = lv_tick_get();
+        racing_update(t);
+        lv_timer_handler();
+        render.add(lv_tick_elaps(t));
+    }
+
+    char line[160];
+    racing_loop().frames().format(line, sizeof(line), "racing frame interval");
+    printf("%s", line);
+    render.format(line, sizeof(line), "racing update+render");
+    printf("%s", line);
+    printf("racing: fps=%.1f dropped_steps=%u score=%u\n",
+           racing_loop().frames().avg() > 0 ? 1000.0f / racing_loop().frames().avg() : 0.0f,
+           (unsigned)racing_loop().dropped(), (unsigned)racing_score());
+
+    racing_close();
+    lv_disp_load_scr(prev);
+    lv_obj_del(scr);
+}
+
+/**
+ * Synthetic watchface background: flat areas, a few rings and a noisy band,
+ * roughly what the face images look like after RGB565 conversion
+ */
+static void bench_face_pixels(uint16_t *px, int w, int h)
+{
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            int dx = x - w / 2, dy = y - h / 2;
+            int r = (dx * dx + dy * dy) / 256;
+            uint16_t c = 0x0000;
+            if (r % 12 < 2)
+                c = 0xFFFF;
+            else if (y > h * 3 / 4 && y < h * 3 / 4 + 20)
+                c = (uint16_t)((x * 31 + y * 17) & 0xFFFF);
+            else if (r < 30)
+                c = 0x2104;
+            px[y * w + x] = c;
+        }
+    }
+}
+
+static void bench_assets(void)
+{
+    const int w = SDL_HOR_RES, h = SDL_VER_RES, runs = 50;
+    uint16_t *raw = (uint16_t *)malloc(w * h * 2);
+    uint8_t *packed = (uint8_t *)malloc(w * h * 3);
+    uint32_t *rows = (uint32_t *)malloc(h * sizeof(uint32_t));
+    uint8_t *out = (uint8_t *)malloc(w * h * 2);
+    bench_face_pixels(raw, w, h);
+
+    uint32_t size = 0;
+    for (int y = 0; y < h; y++)
+    {
+        rows[y] = size;
+        size += asset_rle_encode_row((const uint8_t *)(raw + y * w), w, 2, packed + size);
+    }
+
+    asset_sheet_t sheet = {(uint16_t)w, (uint16_t)h, ASSET_FORMAT_RGB565, ASSET_CODEC_RLE, rows, packed, size};
+    asset_t asset = {&sheet, 0, 0, (uint16_t)w, (uint16_t)h};
+
+    /* wall clock, lv_tick does not advance without hal_delay */
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++)
+    {
+        asset_decode(&asset, out);
+    }
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    uint32_t raw_size = w * h * 2;
+    printf("assets: %dx%d rgb565 %u -> %u bytes (%.1f%%), %s\n", w, h, (unsigned)raw_size,
+           (unsigned)(size + h * sizeof(uint32_t)), 100.0f * (size + h * sizeof(uint32_t)) / raw_size,
+           memcmp(out, raw, raw_size) == 0 ? "roundtrip ok" : "ROUNDTRIP FAILED");
+    printf("assets: decode %d frames in %.1f ms, %.3f ms/frame, %.1f MB/s\n", runs, ms, ms / runs,
+           ms > 0 ? (float)raw_size * runs / 1000.0f / ms : 0.0f);
+
+    free(raw);
+    free(packed);
+    free(rows);
+    free(out);
+}
+
+#define HAND_W 12
+#define HAND_H 100
+
+/* Tapered hand, opaque core with soft edges, like the face hand images */
+static uint8_t hand_pixels[HAND_W * HAND_H * LV_IMG_PX_SIZE_ALPHA_BYTE];
+
+static const lv_img_dsc_t *bench_hand_img(void)
+{
+    static lv_img_dsc_t dsc;
+    for (int y = 0; y < HAND_H; y++)
+    {
+        int half = 1 + (HAND_H - y) * (HAND_W / 2 - 1) / HAND_H;
+        for (int x = 0; x < HAND_W; x++)
+        {
+            uint8_t *p = &hand_pixels[(y * HAND_W + x) * LV_IMG_PX_SIZE_ALPHA_BYTE];
+            int d = LV_ABS(2 * x + 1 - HAND_W) / 2;
+            lv_color_t c = lv_color_white();
+            memcpy(p, &c, sizeof(c));
+            p[LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = d < half ? LV_OPA_COVER : d == half ? LV_OPA_50 : LV_OPA_TRANSP;
+        }
+    }
+    dsc.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+    dsc.header.w = HAND_W;
+    dsc.header.h = HAND_H;
+    dsc.data_size = sizeof(hand_pixels);
+    dsc.data = hand_pixels;
+    return &dsc;
+}
+
+/**
+ * One simulated minute of a three hand face, rendered once per second.
+ * The redraw cost is the render time of each second tick.
+ */
+static void bench_hands(HandMode mode, const char *name)
+{
+    lv_obj_t *scr = bench_screen(lv_palette_main(LV_PALETTE_GREY));
+    lv_obj_t *prev = lv_scr_act();
+    lv_disp_load_scr(scr);
+
+    HandConfig cfg = {};
+    cfg.cx = SDL_HOR_RES / 2;
+    cfg.cy = SDL_VER_RES / 2;
+    cfg.img = bench_hand_img();
+    cfg.pivot_x = HAND_W / 2;
+    cfg.pivot_y = HAND_H - 10;
+    cfg.length = HAND_H - 10;
+    cfg.tail = 10;
+    cfg.width = 4;
+    cfg.color = lv_color_white();
+
+    hand_t *hour = hand_create(scr, cfg, mode);
+    cfg.length = cfg.length * 2 / 3;
+    hand_t *minute = hand_create(scr, cfg, mode);
+    cfg.width = 2;
+    cfg.color = lv_palette_main(LV_PALETTE_RED);
+    hand_t *second = hand_create(scr, cfg, mode);
+    lv_refr_now(NULL);
+
+    hands_stats_reset();
+    FrameStats ticks;
+    ticks.reset();
+    float total_ms = 0;
+    for (uint32_t t = 10 * 3600 + 8 * 60; t < 10 * 3600 + 9 * 60; t++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        hand_set(hour, t % 43200, 43200);
+        hand_set(minute, t % 3600, 3600);
+        hand_set(second, t % 60, 60);
+        lv_refr_now(NULL);
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        total_ms += ms;
+        ticks.add((uint32_t)ms);
+    }
+
+    const HandStats &s = hands_stats();
+    printf("hands %-9s: %.3f ms per second tick, %u px invalidated per tick, cache %u/%u hits %u bytes\n", name,
+           total_ms / 60, (unsigned)(s.invalidated_px / 60), (unsigned)s.cache_hits,
+           (unsigned)(s.cache_hits + s.cache_misses), (unsigned)s.cache_used);
+
+    hand_delete(hour);
+    hand_delete(minute);
+    hand_delete(second);
+    lv_disp_load_scr(prev);
+    lv_obj_del(scr);
+}
+
+#define BENCH_QR_OPENS 20
+
+static const char *qr_links[] = {
+    "https://github.com/fbiego/esp32-c3-mini",
+    "https://play.google.com/store/apps/details?id=com.fbiego.chronos",
+    "https://www.youtube.com/@fbiego",
+};
+
+/**
+ * Open a QR screen with three links, render it and close it again.
+ * Legacy encodes and draws through lv_qrcode on every open, the cache only
+ * encodes on the first one.
+ */
+static float bench_qr_open(bool cached)
+{
+    lv_obj_t *prev = lv_scr_act();
+    auto start = std::chrono::steady_clock::now();
+
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_disp_load_scr(scr);
+    for (int i = 0; i < 3; i++)
+    {
+        lv_obj_t *qr;
+        if (cached)
+        {
+            qr = qr_view_create(scr, 150);
+            qr_view_set_text(qr, qr_links[i]);
+        }
+        else
+        {
+            qr = lv_qrcode_create(scr, 150, lv_color_black(), lv_color_white());
+            lv_qrcode_update(qr, qr_links[i], strlen(qr_links[i]));
+        }
+        lv_obj_set_pos(qr, 45, 45 + i * 160);
+    }
+    lv_refr_now(NULL);
+
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    lv_disp_load_scr(prev);
+    lv_obj_del(scr);
+    return ms;
+}
+
+static void bench_qr(void)
+{
+    float legacy = 0, cached = 0;
+    for (int i = 0; i < BENCH_QR_OPENS; i++)
+    {
+        legacy += bench_qr_open(false);
+    }
+    qr_cache_clear();
+    for (int i = 0; i < BENCH_QR_OPENS; i++)
+    {
+        cached += bench_qr_open(true);
+    }
+    const QrCacheStats &s = qr_cache_stats();
+    printf("qr lv_qrcode: %.3f ms per open\n", legacy / BENCH_QR_OPENS);
+    printf("qr cached   : %.3f ms per open, %u encodes, %u hits, %.1fx\n", cached / BENCH_QR_OPENS,
+           (unsigned)s.encodes, (unsigned)s.hits, cached > 0 ? legacy / cached : 0.0f);
+}
+
+#define INSTALL_FILE_SIZE 150000
+#define INSTALL_CHUNK 512
+
+static uint32_t sim_rand(uint32_t *state)
+{
+    *state = *state * 1103515245 + 12345;
+    return (*state >> 16) & 0x7FFF;
+}
+
+/**
+ * Send a face over a lossy link: `loss` and `corrupt` per mille of the
+ * chunks are dropped or damaged and the link drops every `drop_every`
+ * bytes. After a drop the watch either suspends cleanly or loses power
+ * (`power_loss`), then the transfer resumes on a new installer.
+ * @return bytes sent, 0 if the installed file is wrong
+ */
+static uint32_t sim_install(const char *dir, const uint8_t *file, uint32_t loss, uint32_t corrupt,
+                            uint32_t drop_every, bool power_loss, InstallStats *stats)
+{
+    FileInstallStorage storage(dir);
+    uint32_t file_crc = install_crc32(0, file, INSTALL_FILE_SIZE);
+    uint32_t seed = 7, sent = 0, next_drop = drop_every;
+    uint8_t chunk[INSTALL_CHUNK];
+    InstallStatus status = INSTALL_OK;
+    memset(stats, 0, sizeof(*stats));
+
+    while (status != INSTALL_DONE)
+    {
+        FaceInstaller installer(storage, 4096);
+        if (installer.begin("sim.bin", INSTALL_FILE_SIZE, file_crc) != INSTALL_OK)
+        {
+            return 0;
+        }
+        uint32_t pos = installer.offset();
+        bool link = true;
+        while (link && status != INSTALL_DONE)
+        {
+            uint32_t len = INSTALL_FILE_SIZE - pos < INSTALL_CHUNK ? INSTALL_FILE_SIZE - pos : INSTALL_CHUNK;
+            if (len == 0)
+            {
+                pos = installer.offset(); /* wait for the resend request */
+                continue;
+            }
+            memcpy(chunk, file + pos, len);
+            uint32_t crc = install_crc32(0, chunk, len);
+            sent += len;
+            uint32_t r = sim_rand(&seed) % 1000;
+            if (r < loss)
+            {
+                pos += len; /* lost, the sender does not know */
+            }
+            else
+            {
+                if (r < loss + corrupt)
+                {
+                    chunk[sim_rand(&seed) % len] ^= 0x5A;
+                }
+                status = installer.write(pos, chunk, len, crc);
+                if (status == INSTALL_RESEND)
+                    pos = installer.offset();
+                else if (status == INSTALL_OK || status == INSTALL_DUPLICATE)
+                    pos += len;
+                else if (status != INSTALL_DONE)
+                    return 0;
+            }
+            if (drop_every && sent >= next_drop && status != INSTALL_DONE)
+            {
+                next_drop += drop_every;
+                link = false;
+                if (!power_loss)
+                {
+                    installer.suspend();
+                }
+            }
+        }
+        const InstallStats &s = installer.stats();
+        stats->chunks += s.chunks;
+        stats->resends += s.resends;
+        stats->duplicates += s.duplicates;
+        stats->resumes += s.resumes;
+        stats->resumed_bytes += s.resumed_bytes;
+        stats->commits += s.commits;
+        if (power_loss)
+        {
+            storage.closeTemp();
+        }
+    }
+
+    /* the installed file must match */
+    char path[128];
+    snprintf(path, sizeof(path), "%s/sim.bin", dir);
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return 0;
+    }
+    static uint8_t check[INSTALL_FILE_SIZE];
+    bool same = fread(check, 1, INSTALL_FILE_SIZE, f) == INSTALL_FILE_SIZE && memcmp(check, file, INSTALL_FILE_SIZE) == 0;
+    fclose(f);
+    remove(path);
+    return same ? sent : 0;
+}
+
+static void bench_install(void)
+{
+    static uint8_t file[INSTALL_FILE_SIZE];
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < INSTALL_FILE_SIZE; i++)
+    {
+        file[i] = sim_rand(&seed);
+    }
+
+    char dir[] = "/tmp/installXXXXXX";
+    if (mkdtemp(dir) == NULL)
+    {
+        printf("install: no temp dir\n");
+        return;
+    }
+
+    struct
+    {
+        const char *name;
+        uint32_t loss, corrupt, drop_every;
+        bool power_loss;
+    } cases[] = {
+        {"clean", 0, 0, 0, false},
+        {"5% loss", 50, 10, 0, false},
+        {"drops", 50, 10, 40000, false},
+        {"power loss", 50, 10, 40000, true},
+        {"bad link", 200, 50, 25000, true},
+    };
+
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        InstallStats st;
+        uint32_t sent = sim_install(dir, file, cases[i].loss, cases[i].corrupt, cases[i].drop_every,
+                                    cases[i].power_loss, &st);
+        printf("install %-10s: %s sent=%u (%.2fx) resends=%u resumes=%u commits=%u\n", cases[i].name,
+               sent ? "ok" : "FAILED", (unsigned)sent, (float)sent / INSTALL_FILE_SIZE, (unsigned)st.resends,
+               (unsigned)st.resumes, (unsigned)st.commits);
+    }
+
+    /* a file that does not match its CRC is not installed */
+    FileInstallStorage storage(dir);
+    FaceInstaller installer(storage);
+    installer.begin("bad.bin", INSTALL_CHUNK, 0x12345678);
+    InstallStatus status = installer.write(0, file, INSTALL_CHUNK, install_crc32(0, file, INSTALL_CHUNK));
+    printf("install bad crc   : %s\n", status == INSTALL_FILE_CRC && storage.tempSize("bad.bin") == 0 ? "rejected" : "FAILED");
+
+    const char *left[] = {"install.jnl", "bad.bin.part"};
+    for (unsigned i = 0; i < sizeof(left) / sizeof(left[0]); i++)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "%s/%s", dir, left[i]);
+        remove(path);
+    }
+    rmdir(dir);
+}
+
+#define BENCH_FACES 20
+
+/* Synthetic .wf face, a json layout with a few dozen elements */
+static void bench_write_face(const char *dir, int index)
+{
+    char path[96];
+    snprintf(path, sizeof(path), "%s/face%02d.wf", dir, index);
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+        return;
+    fprintf(f, "{\"name\":\"Face %d\",\"preview\":\"face%02d/preview.bin\",\"assets\":[", index, index);
+    for (int i = 0; i < 20; i++)
+        fprintf(f, "%s\"face%02d/asset%02d.bin\"", i ? "," : "", index, i);
+    fprintf(f, "],\"elements\":[");
+    for (int i = 0; i < 40; i++)
+        fprintf(f, "%s{\"id\":%d,\"x\":%d,\"y\":%d,\"pvX\":0,\"pvY\":0,\"image\":%d}", i ? "," : "", i, i * 5, i * 3, i % 20);
+    fprintf(f, "]}");
+    fclose(f);
+}
+
+/* Same work as the esp32 parser: read the whole file and pick the summary */
+static bool bench_parse_face(const char *path, CatalogEntry &entry)
+{
+    static char text[8192];
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return false;
+    size_t n = fread(text, 1, sizeof(text) - 1, f);
+    fclose(f);
+    text[n] = 0;
+
+    const char *name = strstr(text, "\"name\":\"");
+    if (name == NULL)
+        return false;
+    name += 8;
+    const char *end = strchr(name, '"');
+    snprintf(entry.name, sizeof(entry.name), "%.*s", (int)(end - name), name);
+    for (const char *p = strstr(text, "\"id\""); p; p = strstr(p + 1, "\"id\""))
+        entry.elements++;
+    return true;
+}
+
+static float bench_ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void bench_catalog(void)
+{
+    char dir[] = "/tmp/facesXXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return;
+    for (int i = 0; i < BENCH_FACES; i++)
+        bench_write_face(dir, i);
+
+    /* picker without a catalog: every face file is opened and parsed */
+    auto start = std::chrono::steady_clock::now();
+    int parsed = 0;
+    DIR *d = opendir(dir);
+    struct dirent *de;
+    while (d && (de = readdir(d)) != NULL)
+    {
+        char path[320];
+        CatalogEntry e = {};
+        snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+        if (strstr(de->d_name, ".wf") && bench_parse_face(path, e))
+            parsed++;
+    }
+    if (d)
+        closedir(d);
+    float scan = bench_ms_since(start);
+
+    FaceCatalog catalog(dir, ".wf", bench_parse_face);
+    start = std::chrono::steady_clock::now();
+    catalog.load();
+    CatalogSync first = catalog.sync();
+    float build = bench_ms_since(start);
+
+    /* picker open: load the catalog, check the directory */
+    FaceCatalog picker(dir, ".wf", bench_parse_face);
+    start = std::chrono::steady_clock::now();
+    picker.load();
+    CatalogSync warm = picker.sync();
+    float open = bench_ms_since(start);
+
+    bench_write_face(dir, BENCH_FACES);
+    start = std::chrono::steady_clock::now();
+    CatalogSync added = picker.sync();
+    float add = bench_ms_since(start);
+
+    printf("catalog: scan+parse %d faces %.3f ms\n", parsed, scan);
+    printf("catalog: first build %.3f ms (parsed %u)\n", build, first.parsed);
+    printf("catalog: picker open %.3f ms (kept %u, parsed %u), %.1fx\n", open, warm.kept, warm.parsed,
+           open > 0 ? scan / open : 0.0f);
+    printf("catalog: one face added %.3f ms (kept %u, parsed %u)\n", add, added.kept, added.parsed);
+
+    for (int i = 0; i <= BENCH_FACES; i++)
+    {
+        char path[96];
+        snprintf(path, sizeof(path), "%s/face%02d.wf", dir, i);
+        remove(path);
+    }
+    char path[96];
+    snprintf(path, sizeof(path), "%s/faces.cat", dir);
+    remove(path);
+    rmdir(dir);
+}
+
+static const char *bench_message =
+    "Trending topic: #TravelTuesday. Share your latest adventures! Whether it's a breathtaking landscape, a "
+    "delicious local dish, or an unforgettable cultural experience, your travel stories never fail to captivate "
+    "your audience. Let's share another exciting chapter of your journey!";
+
+/**
+ * Scroll a long notification like the message panel does, with the label
+ * drawn by LVGL or from the layout cache
+ */
+static void bench_message_scroll(bool cached, const char *name)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_t *prev = lv_scr_act();
+    lv_disp_load_scr(scr);
+
+    lv_obj_t *panel = lv_obj_create(scr);
+    lv_obj_set_size(panel, SDL_HOR_RES, SDL_VER_RES);
+    lv_obj_set_flex_flow(panel, LV_FLEX_FLOW_COLUMN);
+    lv_obj_t *header = lv_label_create(panel); /* icon and time */
+    lv_label_set_text(header, "Weibo 07:30");
+    lv_obj_set_height(header, 60);
+    lv_obj_t *content = lv_label_create(panel);
+    lv_obj_set_width(content, SDL_HOR_RES - 60);
+    lv_label_set_long_mode(content, LV_LABEL_LONG_WRAP);
+    lv_label_set_text(content, bench_message);
+    if (cached)
+    {
+        label_layout_attach(content);
+    }
+    lv_refr_now(NULL);
+
+    TextLayoutStats before = label_layout_stats();
+    lv_coord_t range = lv_obj_get_scroll_bottom(panel);
+    float total_ms = 0, max_ms = 0;
+    int frames = 0;
+    for (int pass = 0; pass < 4; pass++)
+    {
+        for (lv_coord_t y = 0; y <= range; y += 2)
+        {
+            auto start = std::chrono::steady_clock::now();
+            lv_obj_scroll_to_y(panel, pass % 2 ? range - y : y, LV_ANIM_OFF);
+            lv_refr_now(NULL);
+            float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            total_ms += ms;
+            max_ms = ms > max_ms ? ms : max_ms;
+            frames++;
+        }
+    }
+
+    const TextLayoutStats &s = label_layout_stats();
+    printf("message %-6s: %d scroll frames over %d px, %.3f ms avg, %.3f ms max, layouts %u hits %u computed\n", name,
+           frames, (int)range, frames ? total_ms / frames : 0.0f, max_ms, (unsigned)(s.hits - before.hits),
+           (unsigned)(s.misses - before.misses));
+
+    lv_disp_load_scr(prev);
+    lv_obj_del(scr);
+}
+
+/**
+ * The round list effect as the ui lists had it: on every scroll event a
+ * square root, translate_x and opa for every child of a flex column
+ */
+static void bench_legacy_curve_cb(lv_event_t *e)
+{
+    lv_obj_t *cont = lv_event_get_target(e);
+    lv_area_t cont_a;
+    lv_obj_get_coords(cont, &cont_a);
+    lv_coord_t cont_y_center = cont_a.y1 + lv_area_get_height(&cont_a) / 2;
+    lv_coord_t r = SDL_HOR_RES / 2;
+
+    uint32_t n = lv_obj_get_child_cnt(cont);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        lv_obj_t *child = lv_obj_get_child(cont, i);
+        lv_area_t child_a;
+        lv_obj_get_coords(child, &child_a);
+        lv_coord_t diff_y = LV_ABS(child_a.y1 + lv_area_get_height(&child_a) / 2 - cont_y_center);
+        lv_coord_t x;
+        if (diff_y >= r)
+        {
+            x = r;
+        }
+        else
+        {
+            lv_sqrt_res_t res;
+            lv_sqrt(r * r - diff_y * diff_y, &res, 0x8000);
+            x = r - res.i;
+        }
+        lv_obj_set_style_translate_x(child, x, 0);
+        lv_obj_set_style_opa(child, LV_OPA_COVER - lv_map(x, 0, r, LV_OPA_TRANSP, LV_OPA_COVER), 0);
+    }
+}
+
+/* Pixels waiting to be redrawn */
+static uint32_t bench_invalid_px(void)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+    uint32_t px = 0;
+    for (uint16_t i = 0; i < disp->inv_p; i++)
+    {
+        if (!disp->inv_area_joined[i])
+        {
+            px += lv_area_get_size(&disp->inv_areas[i]);
+        }
+    }
+    return px;
+}
+
+/**
+ * Fling a round list down and back up, frame by frame, with the legacy
+ * per-event effect or a curve list
+ */
+static void bench_curve_list(bool curved, const char *name)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_t *prev = lv_scr_act();
+    lv_disp_load_scr(scr);
+
+    lv_obj_t *list = lv_obj_create(scr);
+    lv_obj_set_size(list, SDL_HOR_RES, SDL_VER_RES);
+    lv_obj_center(list);
+    lv_obj_set_flex_flow(list, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(list, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_row(list, 10, 0);
+    lv_obj_set_scroll_dir(list, LV_DIR_VER);
+    for (int i = 0; i < BENCH_LIST_ITEMS; i++)
+    {
+        lv_obj_t *item = lv_btn_create(list);
+        lv_obj_set_size(item, SDL_HOR_RES * 2 / 3, 50);
+        lv_obj_t *label = lv_label_create(item);
+        lv_label_set_text_fmt(label, "Setting %d", i);
+        lv_obj_center(label);
+    }
+    if (curved)
+    {
+        curve_list_attach(list, SDL_HOR_RES / 2);
+    }
+    else
+    {
+        lv_obj_add_event_cb(list, bench_legacy_curve_cb, LV_EVENT_SCROLL, NULL);
+        lv_event_send(list, LV_EVENT_SCROLL, NULL);
+    }
+    lv_refr_now(NULL);
+
+    curve_list_stats_reset();
+    float total_ms = 0, max_ms = 0;
+    uint64_t px = 0;
+    int frames = 0;
+    for (int pass = 0; pass < 4; pass++)
+    {
+        /* released at 40 px per frame, slowing down like the scroll throw */
+        for (lv_coord_t v = 40; v > 0; v = v * 15 / 16)
+        {
+            auto start = std::chrono::steady_clock::now();
+            lv_obj_scroll_by_bounded(list, 0, pass % 2 ? v : -v, LV_ANIM_OFF);
+            lv_obj_update_layout(scr);
+            px += bench_invalid_px();
+            lv_refr_now(NULL);
+            float ms = bench_ms_since(start);
+            total_ms += ms;
+            max_ms = ms > max_ms ? ms : max_ms;
+            frames++;
+        }
+    }
+
+    const CurveListStats &s = curve_list_stats();
+    printf("curve list %-6s: %d frames, %.3f ms avg, %.3f ms max, %u px redrawn per frame", name, frames,
+           frames ? total_ms / frames : 0.0f, max_ms, frames ? (unsigned)(px / frames) : 0);
+    if (curved)
+    {
+        printf(", %u visited %u moved in %u scrolls", (unsigned)s.visited, (unsigned)s.moved, (unsigned)s.scrolls);
+    }
+    printf("\n");
+
+    lv_disp_load_scr(prev);
+    lv_obj_del(scr);
+}
+
+/**
+ * Switch the language of a screen of bound labels, the switch alone and
+ * with the first frame, and check the LVGL heap does not change
+ */
+static void bench_language(void)
+{
+    for (int lang = 0; lang < LANG_COUNT; lang++)
+    {
+        const I18nLanguageDesc &l = i18n_languages[lang];
+        uint32_t bytes = 0;
+        for (int id = 0; id < STR_COUNT; id++)
+        {
+            bytes += strlen(l.strings[id]) + 1;
+        }
+        const lv_font_t *font = i18n_font((I18nLanguage)lang);
+        printf("language %s: %u bytes of strings, %u glyphs, %u missing from %s\n", l.code, (unsigned)bytes,
+               (unsigned)l.glyph_count, (unsigned)i18n_missing((I18nLanguage)lang),
+               font ? "the wide font" : "the default font");
+    }
+
+    /* the labels as a generated UI would hold them, in globals */
+    static lv_obj_t *scr;
+    static lv_obj_t *labels[BENCH_LABELS];
+    static I18nLabel table[BENCH_LABELS];
+    scr = lv_obj_create(NULL);
+    lv_obj_t *prev = lv_scr_act();
+    lv_disp_load_scr(scr);
+    lv_obj_t *list = lv_obj_create(scr);
+    lv_obj_set_size(list, SDL_HOR_RES, SDL_VER_RES);
+    lv_obj_set_flex_flow(list, LV_FLEX_FLOW_COLUMN);
+    for (int i = 0; i < BENCH_LABELS; i++)
+    {
+        labels[i] = lv_label_create(list);
+        table[i].screen = &scr;
+        table[i].label = &labels[i];
+        table[i].id = (I18nString)(i % STR_COUNT);
+    }
+    I18nLanguage start = i18n_language();
+    i18n_set_language(LANG_EN);
+    i18n_set_labels(table, BENCH_LABELS);
+    uint16_t bound = i18n_bind_screen(scr);
+    lv_refr_now(NULL);
+
+    lv_mem_monitor_t before, after;
+    lv_mem_monitor(&before);
+    float switch_ms = 0, switch_max = 0, frame_ms = 0;
+    uint32_t churn = 0;
+    for (int i = 1; i <= BENCH_SWITCHES; i++)
+    {
+        lv_mem_monitor_t mon;
+        auto start_time = std::chrono::steady_clock::now();
+        i18n_set_language((I18nLanguage)(i % LANG_COUNT));
+        float ms = bench_ms_since(start_time);
+        lv_mem_monitor(&mon);
+        churn += mon.used_cnt != before.used_cnt || mon.free_size != before.free_size;
+        lv_refr_now(NULL);
+        frame_ms += bench_ms_since(start_time);
+        switch_ms += ms;
+        switch_max = ms > switch_max ? ms : switch_max;
+    }
+    lv_mem_monitor(&after);
+
+    printf("language switch: %u labels, %.3f ms avg, %.3f ms max, %.3f ms with the frame\n", (unsigned)bound,
+           switch_ms / BENCH_SWITCHES, switch_max, frame_ms / BENCH_SWITCHES);
+    printf("language switch: %u of %d switches changed the heap, %d blocks and %d bytes after all\n",
+           (unsigned)churn, BENCH_SWITCHES, (int)after.used_cnt - (int)before.used_cnt,
+           (int)before.free_size - (int)after.free_size);
+
+    i18n_set_language(start);
+    i18n_set_labels(NULL, 0);
+    lv_disp_load_scr(prev);
+    lv_obj_del(scr);
+}
+
+static uint32_t bench_clock_us()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/* Stand-ins for the watch screens around home */
+static lv_obj_t *bench_nav_home, *bench_nav_weather, *bench_nav_notifications, *bench_nav_control;
+
+static void bench_nav_home_init(void)
+{
+    bench_nav_home = bench_screen(lv_palette_main(LV_PALETTE_BLUE));
+}
+
+static void bench_nav_weather_init(void)
+{
+    bench_nav_weather = bench_screen(lv_palette_main(LV_PALETTE_ORANGE));
+}
+
+static void bench_nav_notifications_init(void)
+{
+    bench_nav_notifications = bench_screen(lv_palette_main(LV_PALETTE_GREEN));
+}
+
+static void bench_nav_control_init(void)
+{
+    bench_nav_control = bench_screen(lv_palette_main(LV_PALETTE_PURPLE));
+}
+
+/**
+ * Replay a swipe at 60 Hz with the LVGL loop running between samples
+ * @return ms from the release sample to the first frame of the transition
+ */
+static float bench_swipe(NavDir dir)
+{
+    const int dx[NAV_DIRS] = {-12, 12, 0, 0};
+    const int dy[NAV_DIRS] = {0, 0, -12, 12};
+    lv_coord_t x = SDL_HOR_RES / 2, y = SDL_VER_RES / 2;
+    nav_input(x, y, true);
+    for (int i = 0; i < 8; i++)
+    {
+        hal_delay(16);
+        lv_timer_handler();
+        x += dx[dir];
+        y += dy[dir];
+        nav_input(x, y, true);
+    }
+    hal_delay(16);
+    lv_timer_handler();
+
+    auto start_time = std::chrono::steady_clock::now();
+    nav_input(x, y, false);
+    lv_refr_now(NULL);
+    float ms = bench_ms_since(start_time);
+    bench_wait();
+    return ms;
+}
+
+/**
+ * Swipe from home to a neighbour and back, the neighbour is deleted before
+ * each swipe so it has to be built, during the swipe or on release
+ */
+static void bench_navigation(bool prefetch, const char *name)
+{
+    static int8_t home = -1, weather, notifications, control;
+    if (home < 0)
+    {
+        screen_registry_add("nav home", &bench_nav_home, bench_nav_home_init, NULL, true);
+        screen_registry_add("nav weather", &bench_nav_weather, bench_nav_weather_init, NULL, false);
+        screen_registry_add("nav notifications", &bench_nav_notifications, bench_nav_notifications_init, NULL, false);
+        screen_registry_add("nav control", &bench_nav_control, bench_nav_control_init, NULL, false);
+        home = nav_add("home", &bench_nav_home);
+        weather = nav_add("weather", &bench_nav_weather);
+        notifications = nav_add("notifications", &bench_nav_notifications);
+        control = nav_add("control", &bench_nav_control);
+        if (control < 0)
+        {
+            printf("navigation: graph full\n");
+            return;
+        }
+        nav_link(home, NAV_LEFT, weather);
+        nav_link(weather, NAV_RIGHT, home);
+        nav_link(home, NAV_UP, notifications);
+        nav_link(notifications, NAV_DOWN, home);
+        nav_link(home, NAV_DOWN, control);
+        nav_link(control, NAV_UP, home);
+    }
+    if (control < 0)
+    {
+        return;
+    }
+    lv_obj_t *prev = lv_scr_act();
+    nav_begin(home, bench_clock_us);
+    lv_disp_load_scr(screen_registry_get(&bench_nav_home));
+    nav_set_prefetch(prefetch);
+    nav_stats_reset();
+
+    /* weather most of the time, like checking it from the watch face */
+    const NavDir out[4] = {NAV_LEFT, NAV_UP, NAV_LEFT, NAV_DOWN};
+    const NavDir back[4] = {NAV_RIGHT, NAV_DOWN, NAV_RIGHT, NAV_UP};
+    lv_obj_t **targets[4] = {&bench_nav_weather, &bench_nav_notifications, &bench_nav_weather, &bench_nav_control};
+    float total = 0, max = 0;
+    for (int i = 0; i < BENCH_SWIPES; i++)
+    {
+        screen_registry_evict(targets[i % 4]);
+        float ms = bench_swipe(out[i % 4]);
+        total += ms;
+        max = ms > max ? ms : max;
+        bench_swipe(back[i % 4]);
+    }
+
+    const NavStats &s = nav_stats();
+    printf("navigation %s: %.3f ms avg, %.3f ms max release to first frame\n", name, total / BENCH_SWIPES, max);
+    printf("navigation %s: %u swipes, %u ready, %u partial, %u cold, %u wasted, %.3f ms preparing\n", name,
+           (unsigned)s.swipes, (unsigned)s.ready, (unsigned)s.partial, (unsigned)s.cold, (unsigned)s.wasted,
+           s.prefetch_us / 1000.0f);
+
+    nav_set_prefetch(true);
+    lv_disp_load_scr(prev);
+}
+
+void bench_run(void)
+{
+    printf("=== transition benchmark (%dx%d, %d runs) ===\n", SDL_HOR_RES, SDL_VER_RES, BENCH_TRANSITIONS);
+    bench_transitions(TRANSITION_LEGACY, "fade legacy", LV_SCR_LOAD_ANIM_FADE_IN);
+    bench_transitions(TRANSITION_SNAPSHOT, "fade snapshot", LV_SCR_LOAD_ANIM_FADE_IN);
+    bench_transitions(TRANSITION_LEGACY, "move legacy", LV_SCR_LOAD_ANIM_MOVE_LEFT);
+    bench_transitions(TRANSITION_SNAPSHOT, "move snapshot", LV_SCR_LOAD_ANIM_MOVE_LEFT);
+
+    printf("=== racing benchmark (%dx%d canvas, %u ms step) ===\n", RACING_WIDTH, RACING_HEIGHT, GAME_STEP_MS);
+    bench_racing();
+
+    printf("=== asset benchmark ===\n");
+    bench_assets();
+
+    printf("=== analog hands benchmark (60 s) ===\n");
+    bench_hands(HAND_MODE_TRANSFORM, "transform");
+    bench_hands(HAND_MODE_LINE, "line");
+    bench_hands(HAND_MODE_TABLE, "table");
+
+    printf("=== qr benchmark (%d opens, 3 codes) ===\n", BENCH_QR_OPENS);
+    bench_qr();
+
+    printf("=== watchface install (%u bytes, %u byte chunks) ===\n", INSTALL_FILE_SIZE, INSTALL_CHUNK);
+    bench_install();
+
+    printf("=== face catalog (%d faces) ===\n", BENCH_FACES);
+    bench_catalog();
+
+    printf("=== message scroll (%u chars) ===\n", (unsigned)strlen(bench_message));
+    bench_message_scroll(false, "lvgl");
+    bench_message_scroll(true, "cached");
+
+    printf("=== curved list (%d items) ===\n", BENCH_LIST_ITEMS);
+    bench_curve_list(false, "legacy");
+    bench_curve_list(true, "curve");
+
+    printf("=== language switch (%d languages, %d strings) ===\n", LANG_COUNT, STR_COUNT);
+    bench_language();
+
+    printf("=== navigation (%d swipes from home) ===\n", BENCH_SWIPES);
+    bench_navigation(false, "cold");
+    bench_navigation(true, "prefetch");
+}
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/**
+ * Native benchmarks, built with `-D NATIVE_BENCHMARK` (env:emulator_benchmark)
+ * Results are printed to stdout.
+ */
+void bench_run(void);
+
+#endif /*BENCH_H*/
@@ -0,0 +1,147 @@
+#ifdef GOLDEN
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "app_hal.h"
+#include "golden.h"
+#include "golden_image.h"
+#include "headless.h"
+#include "screen_registry.h"
+
+#define GOLDEN_SCENES_MAX 32
+#define GOLDEN_PIXELS (SDL_HOR_RES * SDL_VER_RES)
+
+struct GoldenScene
+{
+    const char *name;
+    void (*show)(void);
+};
+
+static GoldenScene scenes[GOLDEN_SCENES_MAX];
+static int scene_count;
+
+/* 2024-05-11 10:08:36 and 23:59:59 UTC, a classic watch time and a day rollover */
+static const time_t golden_times[] = {1715422116, 1715471999};
+
+static uint16_t reference[GOLDEN_PIXELS];
+static int missing; // no reference yet, reported but not a failure
+
+void update_faces();
+
+void golden_add(const char *name, void (*show)(void))
+{
+    if (scene_count < GOLDEN_SCENES_MAX)
+    {
+        scenes[scene_count].name = name;
+        scenes[scene_count].show = show;
+        scene_count++;
+    }
+}
+
+static void make_dir(const char *path)
+{
+    if (mkdir(path, 0755) != 0 && errno != EEXIST)
+    {
+        printf("golden: cannot create %s\n", path);
+    }
+}
+
+/* Render the active screen and compare it with its reference */
+static bool check(const char *name, const char *stamp, bool update)
+{
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+
+    const uint16_t *frame = (const uint16_t *)headless_framebuffer();
+    char path[160];
+    snprintf(path, sizeof(path), GOLDEN_DIR "/%dx%d/%s_%s.g565", SDL_HOR_RES, SDL_VER_RES, name, stamp);
+
+    if (update)
+    {
+        bool ok = golden_save(path, frame, SDL_HOR_RES, SDL_VER_RES, LV_COLOR_16_SWAP);
+        printf("golden: %-24s %s %s\n", name, stamp, ok ? "written" : "WRITE FAILED");
+        return ok;
+    }
+
+    uint16_t w, h;
+    if (!golden_load(path, reference, GOLDEN_PIXELS, &w, &h, LV_COLOR_16_SWAP) || w != SDL_HOR_RES || h != SDL_VER_RES)
+    {
+        printf("golden: %-24s %s MISSING %s (warning, write it with GOLDEN_UPDATE=1)\n", name, stamp, path);
+        missing++;
+        return true;
+    }
+
+    GoldenTolerance tolerance = {GOLDEN_CHANNEL, GOLDEN_MAX_PIXELS};
+    GoldenResult r = golden_compare(frame, reference, w, h, tolerance, LV_COLOR_16_SWAP);
+    if (r.match)
+    {
+        printf("golden: %-24s %s ok (%u px within tolerance, max delta %u)\n", name, stamp, (unsigned)r.differing, (unsigned)r.max_delta);
+        return true;
+    }
+
+    char diff[160];
+    snprintf(diff, sizeof(diff), ".pio/golden/%s_%s_diff.ppm", name, stamp);
+    make_dir(".pio");
+    make_dir(".pio/golden");
+    golden_save_diff(diff, frame, reference, w, h, tolerance, LV_COLOR_16_SWAP);
+    printf("golden: %-24s %s FAILED %u px differ (max delta %u) in %d,%d - %d,%d, see %s\n", name, stamp,
+           (unsigned)r.differing, (unsigned)r.max_delta, r.x1, r.y1, r.x2, r.y2, diff);
+    return false;
+}
+
+int golden_run(void)
+{
+    bool update = getenv("GOLDEN_UPDATE") != NULL;
+    /* the references are rendered in UTC */
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    if (update)
+    {
+        char dir[96];
+        snprintf(dir, sizeof(dir), GOLDEN_DIR "/%dx%d", SDL_HOR_RES, SDL_VER_RES);
+        make_dir(GOLDEN_DIR);
+        make_dir(dir);
+    }
+
+    lv_obj_t *start = lv_scr_act();
+    int failures = 0, checks = 0;
+    missing = 0;
+    for (size_t t = 0; t < sizeof(golden_times) / sizeof(golden_times[0]); t++)
+    {
+        char stamp[16];
+        strftime(stamp, sizeof(stamp), "%H%M%S", gmtime(&golden_times[t]));
+        hal_set_time(golden_times[t]);
+        update_faces();
+
+        for (uint32_t i = 0; i < screen_registry_count(); i++)
+        {
+            const screen_entry_t *e = screen_registry_entry(i);
+            lv_disp_load_scr(screen_registry_get(e->handle));
+            failures += !check(e->name, stamp, update);
+            checks++;
+        }
+        for (int i = 0; i < scene_count; i++)
+        {
+            scenes[i].show();
+            failures += !check(scenes[i].name, stamp, update);
+            checks++;
+        }
+    }
+
+    hal_set_time(0);
+    lv_disp_load_scr(start);
+    printf("golden: %d of %d checks %s\n", checks - failures - missing, checks, update ? "written" : "passed");
+    if (missing)
+    {
+        printf("golden: %d references missing\n", missing);
+    }
+    fflush(stdout);
+    return failures;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+/**
+ * Reference image check, built with `-D GOLDEN` (env:emulator_golden)
+ * Renders every registered screen and the added scenes at fixed times into
+ * the headless framebuffer and compares them with the references in
+ * GOLDEN_DIR/<width>x<height>/. Run with GOLDEN_UPDATE=1 to write the
+ * references instead.
+ */
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "test/golden"
+#endif
+
+/* Allowed difference per color channel (0 - 255) and number of pixels past it */
+#ifndef GOLDEN_CHANNEL
+#define GOLDEN_CHANNEL 0
+#endif
+
+#ifndef GOLDEN_MAX_PIXELS
+#define GOLDEN_MAX_PIXELS 0
+#endif
+
+/**
+ * Add a scene that is not a registered screen, e.g. a watchface
+ * @param name file name of the reference
+ * @param show loads the scene
+ */
+void golden_add(const char *name, void (*show)(void));
+
+/**
+ * Check (or write) every reference
+ * @return number of mismatches
+ */
+int golden_run(void);
+
+#endif /*GOLDEN_H*/
@@ -0,0 +1,166 @@
+#ifdef HEADLESS
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "headless.h"
+#include "screen_registry.h"
+#include "boot_profile.h"
+#include "analog_hands.h"
+#include "mem_governor.h"
+
+static lv_color_t framebuffer[SDL_HOR_RES * SDL_VER_RES];
+
+static uint64_t boot_us;
+static uint64_t last_tick_us;
+static uint32_t frames;
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void print_heap(void)
+{
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    printf("lvgl heap: used=%u/%u max=%u biggest_free=%u frag=%u%%\n",
+           (unsigned)(mon.total_size - mon.free_size), (unsigned)mon.total_size,
+           (unsigned)mon.max_used, (unsigned)mon.free_biggest_size, (unsigned)mon.frag_pct);
+#endif
+}
+
+#ifdef VIRTUAL_TIME
+static SimClock sim;
+static uint32_t report_frames;
+
+static void sim_tick(uint32_t ms)
+{
+    lv_tick_inc(ms);
+}
+
+/* Progress of a long run, frames since the last line and the heap */
+static void sim_report(uint32_t count)
+{
+    uint32_t minutes = (uint32_t)(sim.millis() / 60000);
+    printf("sim %02u:%02u wall %ums frames %u, ", (unsigned)(minutes / 60), (unsigned)(minutes % 60),
+           (unsigned)((now_us() - boot_us) / 1000), (unsigned)(frames - report_frames));
+    report_frames = frames;
+    print_heap();
+}
+
+SimClock &headless_clock(void)
+{
+    return sim;
+}
+
+time_t headless_time(void)
+{
+    return sim.time();
+}
+#endif
+
+void headless_init(void)
+{
+    boot_us = now_us();
+    last_tick_us = boot_us;
+#ifdef VIRTUAL_TIME
+    sim.begin(SIM_START ? (time_t)SIM_START : time(0), sim_tick);
+    sim.every(SIM_REPORT_MS, sim_report);
+#endif
+}
+
+void headless_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
+{
+    int32_t w = area->x2 - area->x1 + 1;
+    for (int32_t y = area->y1; y <= area->y2; y++)
+    {
+        memcpy(&framebuffer[y * SDL_HOR_RES + area->x1], color_p, w * sizeof(lv_color_t));
+        color_p += w;
+    }
+
+    if (lv_disp_flush_is_last(disp))
+    {
+        boot_first_frame();
+        frames++;
+    }
+    lv_disp_flush_ready(disp);
+}
+
+const lv_color_t *headless_framebuffer(void)
+{
+    return framebuffer;
+}
+
+void headless_delay(uint32_t ms)
+{
+#ifdef VIRTUAL_TIME
+    sim.advance(ms); /* ticks LVGL, no sleep */
+#else
+    usleep(ms * 1000);
+
+    uint64_t now = now_us();
+    uint32_t elapsed = (now - last_tick_us) / 1000;
+    if (elapsed)
+    {
+        lv_tick_inc(elapsed);
+        last_tick_us += (uint64_t)elapsed * 1000;
+    }
+#endif
+}
+
+uint32_t headless_elapsed(void)
+{
+#ifdef VIRTUAL_TIME
+    return (uint32_t)sim.millis();
+#else
+    return (now_us() - boot_us) / 1000;
+#endif
+}
+
+bool headless_done(void)
+{
+    return headless_elapsed() >= HEADLESS_RUN_MS;
+}
+
+void headless_report(void)
+{
+    printf("=== headless report (%dx%d, %u ms) ===\n", SDL_HOR_RES, SDL_VER_RES, (unsigned)headless_elapsed());
+    printf("boot to first frame: %u us\n", (unsigned)boot_first_frame_us());
+    printf("frames: %u\n", (unsigned)frames);
+#ifdef VIRTUAL_TIME
+    uint32_t wall_ms = (now_us() - boot_us) / 1000 + 1;
+    printf("simulated %u s in %u ms (%ux), %u events\n", (unsigned)(sim.millis() / 1000), (unsigned)wall_ms,
+           (unsigned)(sim.millis() / wall_ms), (unsigned)sim.fired());
+#endif
+    print_heap();
+
+    const HandStats &hands = hands_stats();
+    if (hands.updates)
+    {
+        /* redraw cost of the analog hands, per second of run time */
+        uint32_t seconds = headless_elapsed() / 1000 + 1;
+        printf("hands: %u updates, %u px/s invalidated, table cache %u/%u hits %u bytes\n",
+               (unsigned)hands.updates, (unsigned)(hands.invalidated_px / seconds),
+               (unsigned)hands.cache_hits, (unsigned)(hands.cache_hits + hands.cache_misses),
+               (unsigned)hands.cache_used);
+    }
+
+    mem_governor_report();
+
+    for (uint32_t i = 0; i < screen_registry_count(); i++)
+    {
+        const screen_entry_t *e = screen_registry_entry(i);
+        printf("screen %-16s %-8s builds=%u build=%ums heap=%u\n", e->name,
+               *e->handle ? "resident" : "-", (unsigned)e->builds,
+               (unsigned)e->build_ms, (unsigned)e->heap_size);
+    }
+    fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <lvgl.h>
+
+/**
+ * Headless native build (env:emulator_headless, `-D HEADLESS`)
+ * Renders into a RAM framebuffer instead of an SDL window, runs for
+ * HEADLESS_RUN_MS and prints a report (boot to first frame, LVGL heap,
+ * screen build costs) before exiting.
+ *
+ * With `-D VIRTUAL_TIME` (env:emulator_simulate) the LVGL tick and the
+ * watch clock come from a simulated clock that `headless_delay` advances
+ * without sleeping, so HEADLESS_RUN_MS of simulated time runs flat out.
+ */
+
+#ifndef HEADLESS_RUN_MS
+#define HEADLESS_RUN_MS 10000
+#endif
+
+/* Simulated start time in seconds since the epoch, 0 for the system clock */
+#ifndef SIM_START
+#define SIM_START 0
+#endif
+
+/* Simulated events: incoming notifications and screen touches */
+#ifndef SIM_NOTIFY_MS
+#define SIM_NOTIFY_MS (20 * 60000)
+#endif
+
+#ifndef SIM_TOUCH_MS
+#define SIM_TOUCH_MS (47 * 60000)
+#endif
+
+/* Heap and frame line printed every simulated SIM_REPORT_MS */
+#ifndef SIM_REPORT_MS
+#define SIM_REPORT_MS 3600000
+#endif
+
+#ifdef HEADLESS
+#define hal_delay(ms) headless_delay(ms)
+#else
+#include SDL_INCLUDE_PATH
+#define hal_delay(ms) SDL_Delay(ms)
+#endif
+
+void headless_init(void);
+void headless_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p);
+const lv_color_t *headless_framebuffer(void);
+
+/**
+ * Sleep and advance the LVGL tick by the elapsed time
+ */
+void headless_delay(uint32_t ms);
+
+/**
+ * Milliseconds since `headless_init`, simulated with VIRTUAL_TIME
+ */
+uint32_t headless_elapsed(void);
+
+#ifdef VIRTUAL_TIME
+#include "sim_clock.h"
+
+/**
+ * Simulated clock, add periodic events (notifications, touches) with
+ * `headless_clock().every`
+ */
+SimClock &headless_clock(void);
+
+/**
+ * Simulated wall clock
+ */
+time_t headless_time(void);
+#endif
+
+bool headless_done(void);
+void headless_report(void);
+
+#endif /*HEADLESS_H*/
@@ -0,0 +1,119 @@
+#ifdef SOAK
+
+#include <stdio.h>
+
+#include <lvgl.h>
+
+#include "headless.h"
+#include "screen_registry.h"
+#include "soak.h"
+#include "soak_monitor.h"
+
+#define SOAK_ACTIONS_MAX 16
+#define SOAK_FRAME_MS 20
+
+struct SoakAction
+{
+    const char *name;
+    void (*action)(uint32_t cycle);
+};
+
+static SoakAction actions[SOAK_ACTIONS_MAX];
+static int action_count;
+
+void soak_add(const char *name, void (*action)(uint32_t cycle))
+{
+    if (action_count < SOAK_ACTIONS_MAX)
+    {
+        actions[action_count].name = name;
+        actions[action_count].action = action;
+        action_count++;
+    }
+}
+
+/* Let timers, animations and scrolling run for `ms` of (virtual) time */
+static void settle(uint32_t ms)
+{
+    for (uint32_t t = 0; t < ms; t += SOAK_FRAME_MS)
+    {
+        hal_delay(SOAK_FRAME_MS);
+        lv_timer_handler();
+    }
+}
+
+static uint32_t count_objects(lv_obj_t *obj)
+{
+    uint32_t n = 1;
+    uint32_t children = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < children; i++)
+    {
+        n += count_objects(lv_obj_get_child(obj, i));
+    }
+    return n;
+}
+
+static SoakSample measure(void)
+{
+    SoakSample s;
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    s.used = mon.total_size - mon.free_size;
+    s.biggest_free = mon.free_biggest_size;
+
+    lv_disp_t *disp = lv_disp_get_default();
+    s.objects = count_objects(lv_disp_get_layer_top(disp)) + count_objects(lv_disp_get_layer_sys(disp));
+    for (uint32_t i = 0; i < disp->screen_cnt; i++)
+    {
+        s.objects += count_objects(disp->screens[i]);
+    }
+    return s;
+}
+
+static void cycle(uint32_t n)
+{
+    for (uint32_t i = 0; i < screen_registry_count(); i++)
+    {
+        const screen_entry_t *e = screen_registry_entry(i);
+        lv_disp_load_scr(screen_registry_get(e->handle));
+        settle(SOAK_STEP_MS);
+    }
+    for (int i = 0; i < action_count; i++)
+    {
+        actions[i].action(n);
+        settle(SOAK_STEP_MS);
+    }
+}
+
+int soak_run(void)
+{
+    static SoakMonitor monitor;
+    lv_obj_t *start = lv_scr_act();
+
+    printf("soak: %u cycles of %u screens and %d actions\n", (unsigned)SOAK_CYCLES,
+           (unsigned)screen_registry_count(), action_count);
+    for (uint32_t n = 0; n < SOAK_CYCLES; n++)
+    {
+        cycle(n);
+        if ((n + 1) % SOAK_CHECKPOINT_CYCLES == 0)
+        {
+            /* same screen at every checkpoint */
+            lv_disp_load_scr(start);
+            settle(SOAK_STEP_MS);
+
+            SoakSample s = measure();
+            monitor.add(s);
+            printf("soak: cycle %u heap used=%u biggest_free=%u objects=%u\n", (unsigned)(n + 1),
+                   (unsigned)s.used, (unsigned)s.biggest_free, (unsigned)s.objects);
+        }
+    }
+
+    char report[256];
+    monitor.format(report, sizeof(report));
+    printf("%s", report);
+    bool ok = monitor.passed();
+    printf("soak: %s after %u checkpoints\n", ok ? "passed" : "FAILED", (unsigned)monitor.count());
+    fflush(stdout);
+    return ok ? 0 : 1;
+}
+
+#endif
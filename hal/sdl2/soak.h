@@ -0,0 +1,40 @@
+#ifndef SOAK_H
+#define SOAK_H
+
+#include <stdint.h>
+
+/**
+ * Soak test, built with `-D SOAK` (env:emulator_soak)
+ * Repeats every registered screen and the added actions (notifications,
+ * weather, face switches) SOAK_CYCLES times in virtual time, records the
+ * LVGL heap, largest free block and object count every
+ * SOAK_CHECKPOINT_CYCLES cycles and fails on steady growth.
+ */
+
+#ifndef SOAK_CYCLES
+#define SOAK_CYCLES 5000
+#endif
+
+#ifndef SOAK_CHECKPOINT_CYCLES
+#define SOAK_CHECKPOINT_CYCLES 50
+#endif
+
+/* Simulated time between two steps of a cycle */
+#ifndef SOAK_STEP_MS
+#define SOAK_STEP_MS 600
+#endif
+
+/**
+ * Add an action repeated in every cycle, e.g. open and close a notification
+ * @param name used in logs
+ * @param action called with the cycle number
+ */
+void soak_add(const char *name, void (*action)(uint32_t cycle));
+
+/**
+ * Run all cycles
+ * @return 0 if no metric kept growing
+ */
+int soak_run(void);
+
+#endif /*SOAK_H*/
@@ -50,7 +50,9 @@
 #if LV_MEM_CUSTOM == 0
     /*Size of the memory available for `lv_mem_alloc()` in bytes (>= 2kB)*/
     //#define LV_MEM_SIZE (192U*1024U)          /*[bytes]*/
+    #ifndef LV_MEM_SIZE
     #define LV_MEM_SIZE (120U*1024U)
+    #endif
 
 /*Set an address for the memory pool instead of allocating it as a normal array. Can be in external SRAM too.*/
     #define LV_MEM_ADR 0     /*0: unused*/
@@ -262,7 +264,18 @@
 
 /*Add a custom handler when assert happens e.g. to restart the MCU*/
 #define LV_ASSERT_HANDLER_INCLUDE <stdint.h>
-#define LV_ASSERT_HANDLER while(1);   /*Halt by default*/
+/*Report the memory governor state (lib/memory) and restart instead of halting.
+ *Unit tests do not link lib/memory and keep the default*/
+#if defined(PIO_UNIT_TESTING)
+#define LV_ASSERT_HANDLER while(1);
+#else
+#ifdef __cplusplus
+extern "C" void mem_governor_fault(void);
+#else
+void mem_governor_fault(void);
+#endif
+#define LV_ASSERT_HANDLER mem_governor_fault(); while(1);
+#endif
 
 /*-------------
  * Others
@@ -678,7 +691,7 @@
  *----------*/
 
 /*1: Enable API to take snapshot for object*/
-#define LV_USE_SNAPSHOT 0
+#define LV_USE_SNAPSHOT 1
 
 /*1: Enable Monkey test*/
 #define LV_USE_MONKEY 0
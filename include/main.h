@@ -1,122 +1,10 @@
-
 #include <ChronosESP32.h>
 
-#ifdef ESPC3
-
-// screen configs
-#define WIDTH 240
-#define HEIGHT 240
-#define OFFSET_X 0
-#define OFFSET_Y 0
-#define RGB_ORDER false
-
-// touch
-#define I2C_SDA 4
-#define I2C_SCL 5
-#define TP_INT 0
-#define TP_RST 1
-
-// display
-#define SPI SPI2_HOST
-
-#define SCLK 6
-#define MOSI 7
-#define MISO -1
-#define DC 2
-#define CS 10
-#define RST -1
-
-#define BL 3
-
-#define MAX_FILE_OPEN 10
-
-#elif ESPS3_1_28
-
-// screen configs
-#define WIDTH 240
-#define HEIGHT 240
-#define OFFSET_X 0
-#define OFFSET_Y 0
-#define RGB_ORDER false
-
-// touch
-#define I2C_SDA 6
-#define I2C_SCL 7
-#define TP_INT 5
-#define TP_RST 13
-
-// display
-#define SPI SPI2_HOST
-
-#define SCLK 10
-#define MOSI 11
-#define MISO 12
-#define DC 8
-#define CS 9
-#define RST 14
-
-#define BL 2
-
-#define MAX_FILE_OPEN 50
+#include "board_traits.h"
 
-#elif ESPS3_1_69
-
-// screen configs
-#define WIDTH 240
-#define HEIGHT 280
-#define OFFSET_X 0
-#define OFFSET_Y 20
-#define RGB_ORDER true
-
-// touch
-#define I2C_SDA 11
-#define I2C_SCL 10
-#define TP_INT 14
-#define TP_RST 13
-
-// display
-#define SPI SPI2_HOST
-
-#define SCLK 6
-#define MOSI 7
-#define MISO -1
-#define DC 4
-#define CS 5
-#define RST 8
-
-#define BL 15
-
-#define MAX_FILE_OPEN 20
+// pins, panel geometry and limits of the board, see lib/board
+typedef BoardTraits<BOARD_CURRENT> Board;
 
+#ifdef ESPS3_1_69
 #define CS_CONFIG CS_240x296_191_RTF
-
-#else
-
-// screen configs
-#define WIDTH 240
-#define HEIGHT 240
-#define OFFSET_X 0
-#define OFFSET_Y 0
-#define RGB_ORDER false
-
-// touch
-#define I2C_SDA 21
-#define I2C_SCL 22
-#define TP_INT 14
-#define TP_RST 5
-
-// display
-#define SPI VSPI_HOST
-
-#define SCLK 18
-#define MOSI 23
-#define MISO -1
-#define DC 4
-#define CS 15
-#define RST 13
-
-#define BL 2
-
-#define MAX_FILE_OPEN 10
-
 #endif
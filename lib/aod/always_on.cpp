@@ -0,0 +1,164 @@
+#include "always_on.h"
+#include "blit.h"
+#include <string.h>
+
+// seven segment layout, bit 0 = a (top) ... bit 6 = g (middle)
+static const uint8_t digit_segments[10] = {0x3F, 0x06, 0x5B, 0x4F, 0x66,
+                                           0x6D, 0x7D, 0x07, 0x7F, 0x6F};
+
+// burn-in protection, one position per hour
+static const int8_t shift_x[9] = {0, 1, 1, 0, -1, -1, -1, 0, 1};
+static const int8_t shift_y[9] = {0, 0, 1, 1, 1, 0, -1, -1, -1};
+
+#define TEXT_LEN 5
+
+static AodRect rect_union(const AodRect &a, const AodRect &b) {
+  if (a.w == 0) {
+    return b;
+  }
+  if (b.w == 0) {
+    return a;
+  }
+  int16_t x1 = a.x < b.x ? a.x : b.x;
+  int16_t y1 = a.y < b.y ? a.y : b.y;
+  int16_t x2 = a.x + a.w > b.x + b.w ? a.x + a.w : b.x + b.w;
+  int16_t y2 = a.y + a.h > b.y + b.h ? a.y + a.h : b.y + b.h;
+  AodRect r = {x1, y1, (int16_t)(x2 - x1), (int16_t)(y2 - y1)};
+  return r;
+}
+
+AlwaysOnFace::AlwaysOnFace(const AodConfig &config)
+    : config(config), origin_x(0), origin_y(0), drawn_x(0), drawn_y(0),
+      shown(false), fresh(true) {
+  memset(&counters, 0, sizeof(counters));
+  memset(&dirty, 0, sizeof(dirty));
+  memset(text, ' ', sizeof(text));
+  memset(drawn, ' ', sizeof(drawn));
+}
+
+void AlwaysOnFace::enter() {
+  shown = true;
+  fresh = true;
+}
+
+void AlwaysOnFace::exit() { shown = false; }
+
+uint32_t AlwaysOnFace::sleepMs(uint32_t seconds, uint16_t millis) {
+  return (60 - seconds % 60) * 1000 - millis;
+}
+
+int16_t AlwaysOnFace::glyphX(uint8_t slot) const {
+  int16_t step = config.digit_w + config.gap;
+  if (slot <= 2) {
+    return slot * step;
+  }
+  // the colon is one segment wide
+  return 2 * step + config.thickness + config.gap + (slot - 3) * step;
+}
+
+void AlwaysOnFace::layout(uint32_t seconds, int16_t &x, int16_t &y) const {
+  int16_t width = glyphX(TEXT_LEN - 1) + config.digit_w;
+  uint8_t pos = (seconds / 3600) % 9;
+  x = (config.screen_w - width) / 2 + shift_x[pos] * config.shift;
+  y = (config.screen_h - config.digit_h) / 2 + shift_y[pos] * config.shift;
+}
+
+AodRect AlwaysOnFace::textArea() const {
+  AodRect r = {drawn_x, drawn_y,
+               (int16_t)(glyphX(TEXT_LEN - 1) + config.digit_w),
+               (int16_t)config.digit_h};
+  return r;
+}
+
+AodRect AlwaysOnFace::update(uint32_t seconds) {
+  uint32_t minutes = (seconds / 60) % 1440;
+  uint8_t hour = minutes / 60, minute = minutes % 60;
+  if (!config.h24) {
+    hour %= 12;
+    hour = hour == 0 ? 12 : hour;
+  }
+  text[0] = (config.h24 || hour >= 10) ? '0' + hour / 10 : ' ';
+  text[1] = '0' + hour % 10;
+  text[2] = ':';
+  text[3] = '0' + minute / 10;
+  text[4] = '0' + minute % 10;
+  layout(seconds, origin_x, origin_y);
+
+  AodRect area = {0, 0, 0, 0};
+  if (fresh || origin_x != drawn_x || origin_y != drawn_y) {
+    // everything moves, clear where the text was
+    if (!fresh) {
+      area = textArea();
+    }
+    AodRect now = {origin_x, origin_y,
+                   (int16_t)(glyphX(TEXT_LEN - 1) + config.digit_w),
+                   (int16_t)config.digit_h};
+    area = rect_union(area, now);
+  } else {
+    for (uint8_t i = 0; i < TEXT_LEN; i++) {
+      if (text[i] != drawn[i]) {
+        AodRect glyph = {(int16_t)(origin_x + glyphX(i)), origin_y,
+                         (int16_t)(i == 2 ? config.thickness : config.digit_w),
+                         (int16_t)config.digit_h};
+        area = rect_union(area, glyph);
+      }
+    }
+  }
+
+  dirty = area;
+  if (area.w == 0) {
+    counters.skipped++;
+    return area;
+  }
+  memcpy(drawn, text, sizeof(drawn));
+  drawn_x = origin_x;
+  drawn_y = origin_y;
+  fresh = false;
+  counters.updates++;
+  counters.pixels += (uint32_t)area.w * area.h;
+  return area;
+}
+
+void AlwaysOnFace::render(int16_t y, int16_t lines, uint16_t *buf) const {
+  Framebuffer fb = {buf, dirty.w, lines};
+  blit_fill(fb, 0, 0, dirty.w, lines, config.background);
+
+  int w = config.digit_w, h = config.digit_h, t = config.thickness;
+  int mid = (h - t) / 2;
+  int span = w - 2 * t;        // horizontal segments
+  int upper = mid - t;         // upper vertical segments
+  int lower = h - mid - 2 * t; // lower vertical segments
+  // segments a - g: x, y, w, h
+  const int seg[7][4] = {
+      {t, 0, span, t},            // a
+      {w - t, t, t, upper},       // b
+      {w - t, mid + t, t, lower}, // c
+      {t, h - t, span, t},        // d
+      {0, mid + t, t, lower},     // e
+      {0, t, t, upper},           // f
+      {t, mid, span, t},          // g
+  };
+
+  int16_t top = origin_y - dirty.y - y;
+  for (uint8_t i = 0; i < TEXT_LEN; i++) {
+    int16_t left = origin_x + glyphX(i) - dirty.x;
+    if (left >= dirty.w || left + w <= 0 || top >= lines || top + h <= 0) {
+      continue;
+    }
+    if (text[i] == ':') {
+      blit_fill(fb, left, top + h / 3 - t / 2, t, t, config.color);
+      blit_fill(fb, left, top + 2 * h / 3 - t / 2, t, t, config.color);
+      continue;
+    }
+    if (text[i] < '0' || text[i] > '9') {
+      continue;
+    }
+    uint8_t mask = digit_segments[text[i] - '0'];
+    for (uint8_t s = 0; s < 7; s++) {
+      if (mask & (1 << s)) {
+        blit_fill(fb, left + seg[s][0], top + seg[s][1], seg[s][2], seg[s][3],
+                  config.color);
+      }
+    }
+  }
+}
@@ -0,0 +1,109 @@
+#ifndef ALWAYS_ON_H
+#define ALWAYS_ON_H
+
+#include <stdint.h>
+
+/**
+ * Always-on display: a minimal face showing HH:MM in seven segment digits.
+ *
+ * While it is shown the LVGL loop is suspended. The caller wakes up once
+ * per minute (`sleepMs`), asks `update` for the rectangle that changed
+ * (only the digits that differ from the last update) and renders it in
+ * bands of a few lines into a tiny buffer that is written straight to a
+ * window of the panel. Driven by the caller's clock, so the scheduling runs
+ * unchanged against a simulated clock in the native tests.
+ */
+
+#ifndef AOD_BUF_LINES
+#define AOD_BUF_LINES 8
+#endif
+
+struct AodRect {
+  int16_t x;
+  int16_t y;
+  int16_t w; // 0 if nothing changed
+  int16_t h;
+};
+
+struct AodConfig {
+  uint16_t screen_w;
+  uint16_t screen_h;
+  uint16_t digit_w;
+  uint16_t digit_h;
+  uint16_t thickness; // segment thickness
+  uint16_t gap;       // between glyphs
+  uint16_t color;     // framebuffer byte order, as `lv_color_t.full`
+  uint16_t background;
+  bool h24;
+  uint8_t shift; // burn-in protection, moves the face by up to this many
+                 // pixels every hour
+
+  AodConfig()
+      : screen_w(240), screen_h(240), digit_w(28), digit_h(52),
+        thickness(6), gap(6), color(0xFFFF), background(0), h24(true),
+        shift(4) {}
+};
+
+struct AodStats {
+  uint32_t updates; // wake-ups that changed the face
+  uint32_t skipped; // wake-ups with nothing to draw
+  uint64_t pixels;  // pixels written to the panel
+};
+
+class AlwaysOnFace {
+public:
+  AlwaysOnFace(const AodConfig &config = AodConfig());
+
+  /**
+   * Start showing the face, the next update draws all of it
+   */
+  void enter();
+  void exit();
+  bool active() const { return shown; }
+
+  /**
+   * Time to sleep until the next minute starts
+   * @param seconds current time, seconds since midnight (or the epoch)
+   * @param millis milliseconds into the current second
+   */
+  static uint32_t sleepMs(uint32_t seconds, uint16_t millis);
+
+  /**
+   * Prepare the face for `seconds`
+   * @return area to write, `w` is 0 if the face did not change
+   */
+  AodRect update(uint32_t seconds);
+
+  /**
+   * Render lines of the area returned by `update`
+   * @param y first line, relative to the area
+   * @param lines number of lines, at most AOD_BUF_LINES
+   * @param buf `area.w * lines` pixels
+   */
+  void render(int16_t y, int16_t lines, uint16_t *buf) const;
+
+  /**
+   * Bounding box of the time text as last drawn
+   */
+  AodRect textArea() const;
+
+  const AodStats &stats() const { return counters; }
+
+private:
+  int16_t glyphX(uint8_t slot) const;
+  void layout(uint32_t seconds, int16_t &x, int16_t &y) const;
+
+  AodConfig config;
+  AodStats counters;
+  char text[6];     // "HH:MM", ' ' for a blank digit
+  char drawn[6];    // as on the panel
+  int16_t origin_x; // top left of the text
+  int16_t origin_y;
+  int16_t drawn_x;
+  int16_t drawn_y;
+  AodRect dirty;
+  bool shown;
+  bool fresh; // nothing drawn since `enter`
+};
+
+#endif /*ALWAYS_ON_H*/
@@ -0,0 +1,139 @@
+#include "asset.h"
+#include <string.h>
+
+uint8_t asset_pixel_size(uint8_t format) {
+  switch (format) {
+  case ASSET_FORMAT_A8:
+    return 1;
+  case ASSET_FORMAT_RGB565A8:
+    return 3;
+  default:
+    return 2;
+  }
+}
+
+uint32_t asset_decoded_size(const asset_t *asset) {
+  return (uint32_t)asset->w * asset->h *
+         asset_pixel_size(asset->sheet->format);
+}
+
+static inline void fill(uint8_t *dst, const uint8_t *px, uint16_t n,
+                        uint8_t size) {
+  if (size == 1) {
+    memset(dst, px[0], n);
+  } else if (size == 2) {
+    uint16_t v;
+    memcpy(&v, px, 2);
+    uint16_t *d = (uint16_t *)dst;
+    if (((uintptr_t)dst & 1) == 0) {
+      while (n--) {
+        *d++ = v;
+      }
+    } else {
+      while (n--) {
+        memcpy(dst, px, 2);
+        dst += 2;
+      }
+    }
+  } else {
+    while (n--) {
+      memcpy(dst, px, size);
+      dst += size;
+    }
+  }
+}
+
+static void decode_rle(const uint8_t *p, uint16_t skip, uint16_t len,
+                       uint8_t size, uint8_t *dst) {
+  while (len) {
+    uint8_t c = *p++;
+    uint16_t n = (c & 0x7F) + 1;
+    if (c & 0x80) {
+      const uint8_t *px = p;
+      p += size;
+      if (skip >= n) {
+        skip -= n;
+        continue;
+      }
+      n -= skip;
+      skip = 0;
+      if (n > len) {
+        n = len;
+      }
+      fill(dst, px, n, size);
+    } else {
+      const uint8_t *src = p;
+      p += (uint32_t)n * size;
+      if (skip >= n) {
+        skip -= n;
+        continue;
+      }
+      src += (uint32_t)skip * size;
+      n -= skip;
+      skip = 0;
+      if (n > len) {
+        n = len;
+      }
+      memcpy(dst, src, (uint32_t)n * size);
+    }
+    dst += (uint32_t)n * size;
+    len -= n;
+  }
+}
+
+void asset_decode_line(const asset_t *asset, uint16_t x, uint16_t y,
+                       uint16_t len, uint8_t *dst) {
+  const asset_sheet_t *s = asset->sheet;
+  uint8_t size = asset_pixel_size(s->format);
+  const uint8_t *row = s->data + s->rows[asset->y + y];
+
+  if (s->codec == ASSET_CODEC_RAW) {
+    memcpy(dst, row + (uint32_t)(asset->x + x) * size, (uint32_t)len * size);
+  } else {
+    decode_rle(row, asset->x + x, len, size, dst);
+  }
+}
+
+void asset_decode(const asset_t *asset, uint8_t *dst) {
+  uint32_t stride = (uint32_t)asset->w * asset_pixel_size(asset->sheet->format);
+  for (uint16_t y = 0; y < asset->h; y++) {
+    asset_decode_line(asset, 0, y, asset->w, dst);
+    dst += stride;
+  }
+}
+
+size_t asset_rle_encode_row(const uint8_t *src, uint16_t count,
+                            uint8_t pixel_size, uint8_t *dst) {
+  uint8_t *out = dst;
+  uint16_t i = 0;
+  while (i < count) {
+    // length of the run starting at i
+    uint16_t run = 1;
+    while (i + run < count && run < 128 &&
+           memcmp(src + (uint32_t)(i + run) * pixel_size,
+                  src + (uint32_t)i * pixel_size, pixel_size) == 0) {
+      run++;
+    }
+    if (run >= 2) {
+      *out++ = 0x80 | (run - 1);
+      memcpy(out, src + (uint32_t)i * pixel_size, pixel_size);
+      out += pixel_size;
+      i += run;
+      continue;
+    }
+    // literals until the next run of 2 or more
+    uint16_t lit = 1;
+    while (i + lit < count && lit < 128 &&
+           !(i + lit + 1 < count &&
+             memcmp(src + (uint32_t)(i + lit) * pixel_size,
+                    src + (uint32_t)(i + lit + 1) * pixel_size,
+                    pixel_size) == 0)) {
+      lit++;
+    }
+    *out++ = lit - 1;
+    memcpy(out, src + (uint32_t)i * pixel_size, (uint32_t)lit * pixel_size);
+    out += (uint32_t)lit * pixel_size;
+    i += lit;
+  }
+  return out - dst;
+}
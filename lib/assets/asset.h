@@ -0,0 +1,93 @@
+#ifndef ASSET_H
+#define ASSET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Packed image assets generated by support/asset_packer.py
+ *
+ * A sheet holds one or more images (an atlas). Every row is compressed on
+ * its own and `rows` gives the offset of each row, so any frame or line
+ * can be decoded without touching the rest of the sheet.
+ *
+ * RLE stream, per row: a control byte `c` followed by
+ *  c & 0x80: one pixel repeated (c & 0x7F) + 1 times
+ *  else:     (c + 1) literal pixels
+ * A pixel is 1 (A8), 2 (RGB565) or 3 (RGB565 + A8) bytes, in the LVGL
+ * framebuffer byte order.
+ */
+
+enum {
+  ASSET_FORMAT_RGB565 = 0, /* LV_IMG_CF_TRUE_COLOR */
+  ASSET_FORMAT_RGB565A8,   /* LV_IMG_CF_TRUE_COLOR_ALPHA */
+  ASSET_FORMAT_A8,         /* LV_IMG_CF_ALPHA_8BIT */
+};
+
+enum {
+  ASSET_CODEC_RAW = 0,
+  ASSET_CODEC_RLE,
+};
+
+typedef struct {
+  uint16_t width;
+  uint16_t height;
+  uint8_t format;
+  uint8_t codec;
+  const uint32_t *rows; /* offset of every row in data */
+  const uint8_t *data;
+  uint32_t data_size;
+} asset_sheet_t;
+
+typedef struct {
+  const asset_sheet_t *sheet;
+  uint16_t x; /* frame inside the sheet */
+  uint16_t y;
+  uint16_t w;
+  uint16_t h;
+} asset_t;
+
+uint8_t asset_pixel_size(uint8_t format);
+
+/**
+ * Decoded size of a frame in bytes
+ */
+uint32_t asset_decoded_size(const asset_t *asset);
+
+/**
+ * Decode part of one line of a frame
+ * @param asset frame to decode
+ * @param x first pixel, relative to the frame
+ * @param y line, relative to the frame
+ * @param len number of pixels
+ * @param dst destination, `len * asset_pixel_size` bytes
+ */
+void asset_decode_line(const asset_t *asset, uint16_t x, uint16_t y,
+                       uint16_t len, uint8_t *dst);
+
+/**
+ * Decode a whole frame
+ * @param dst destination, `asset_decoded_size` bytes, rows packed
+ */
+void asset_decode(const asset_t *asset, uint8_t *dst);
+
+/**
+ * RLE encode one row (reference encoder, same as the packer)
+ * @param src row pixels
+ * @param count number of pixels
+ * @param pixel_size bytes per pixel
+ * @param dst destination, worst case `count * (pixel_size + 1)` bytes
+ * @return encoded size in bytes
+ */
+size_t asset_rle_encode_row(const uint8_t *src, uint16_t count,
+                            uint8_t pixel_size, uint8_t *dst);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*ASSET_H*/
@@ -0,0 +1,170 @@
+#include "asset_decoder.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct CacheEntry {
+  const asset_t *asset;
+  uint8_t *pixels;
+  uint32_t size;
+  uint32_t last_used;
+};
+
+static CacheEntry cache[ASSET_CACHE_ENTRIES];
+static uint32_t cache_used;
+static uint32_t use_counter;
+static uint32_t hits, misses;
+
+static CacheEntry *cache_find(const asset_t *asset) {
+  for (int i = 0; i < ASSET_CACHE_ENTRIES; i++) {
+    if (cache[i].asset == asset) {
+      cache[i].last_used = ++use_counter;
+      return &cache[i];
+    }
+  }
+  return NULL;
+}
+
+static void cache_drop(CacheEntry *e) {
+  free(e->pixels);
+  cache_used -= e->size;
+  e->asset = NULL;
+  e->pixels = NULL;
+  e->size = 0;
+}
+
+static CacheEntry *cache_lru() {
+  CacheEntry *lru = NULL;
+  for (int i = 0; i < ASSET_CACHE_ENTRIES; i++) {
+    if (cache[i].asset &&
+        (lru == NULL || cache[i].last_used < lru->last_used)) {
+      lru = &cache[i];
+    }
+  }
+  return lru;
+}
+
+static void cache_add(const asset_t *asset) {
+  uint32_t size = asset_decoded_size(asset);
+  if (size > ASSET_CACHE_ITEM_MAX) {
+    return;
+  }
+  while (cache_used + size > ASSET_CACHE_SIZE) {
+    cache_drop(cache_lru());
+  }
+  CacheEntry *slot = NULL;
+  for (int i = 0; i < ASSET_CACHE_ENTRIES && slot == NULL; i++) {
+    if (cache[i].asset == NULL) {
+      slot = &cache[i];
+    }
+  }
+  if (slot == NULL) {
+    slot = cache_lru();
+    cache_drop(slot);
+  }
+  slot->pixels = (uint8_t *)malloc(size);
+  if (slot->pixels == NULL) {
+    return;
+  }
+  asset_decode(asset, slot->pixels);
+  slot->asset = asset;
+  slot->size = size;
+  slot->last_used = ++use_counter;
+  cache_used += size;
+}
+
+static const asset_t *get_asset(const void *src) {
+  if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE) {
+    return NULL;
+  }
+  const lv_img_dsc_t *img = (const lv_img_dsc_t *)src;
+  if (img->header.cf != LV_IMG_CF_ASSET) {
+    return NULL;
+  }
+  return (const asset_t *)img->data;
+}
+
+static lv_img_cf_t color_format(const asset_t *asset) {
+  switch (asset->sheet->format) {
+  case ASSET_FORMAT_RGB565A8:
+    return LV_IMG_CF_TRUE_COLOR_ALPHA;
+  case ASSET_FORMAT_A8:
+    return LV_IMG_CF_ALPHA_8BIT;
+  default:
+    return LV_IMG_CF_TRUE_COLOR;
+  }
+}
+
+static lv_res_t info_cb(lv_img_decoder_t *decoder, const void *src,
+                        lv_img_header_t *header) {
+  const asset_t *asset = get_asset(src);
+  if (asset == NULL) {
+    return LV_RES_INV;
+  }
+  header->always_zero = 0;
+  header->w = asset->w;
+  header->h = asset->h;
+  header->cf = color_format(asset);
+  return LV_RES_OK;
+}
+
+static lv_res_t open_cb(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+  const asset_t *asset = get_asset(dsc->src);
+  if (asset == NULL) {
+    return LV_RES_INV;
+  }
+  dsc->header.cf = color_format(asset);
+  dsc->img_data = NULL; // always go through read_line_cb
+  dsc->user_data = (void *)asset;
+
+  if (cache_find(asset)) {
+    hits++;
+  } else {
+    misses++;
+    cache_add(asset);
+  }
+  return LV_RES_OK;
+}
+
+static lv_res_t read_line_cb(lv_img_decoder_t *decoder,
+                             lv_img_decoder_dsc_t *dsc, lv_coord_t x,
+                             lv_coord_t y, lv_coord_t len, uint8_t *buf) {
+  const asset_t *asset = (const asset_t *)dsc->user_data;
+  uint8_t size = asset_pixel_size(asset->sheet->format);
+
+  CacheEntry *e = cache_find(asset);
+  if (e) {
+    memcpy(buf, e->pixels + ((uint32_t)y * asset->w + x) * size,
+           (uint32_t)len * size);
+  } else {
+    asset_decode_line(asset, x, y, len, buf);
+  }
+  return LV_RES_OK;
+}
+
+static void close_cb(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+  dsc->user_data = NULL;
+}
+
+void asset_decoder_init() {
+  lv_img_decoder_t *dec = lv_img_decoder_create();
+  lv_img_decoder_set_info_cb(dec, info_cb);
+  lv_img_decoder_set_open_cb(dec, open_cb);
+  lv_img_decoder_set_read_line_cb(dec, read_line_cb);
+  lv_img_decoder_set_close_cb(dec, close_cb);
+}
+
+uint32_t asset_cache_release(uint32_t bytes) {
+  uint32_t released = 0;
+  while (cache_used && (bytes == 0 || released < bytes)) {
+    CacheEntry *e = cache_lru();
+    released += e->size;
+    cache_drop(e);
+  }
+  return released;
+}
+
+uint32_t asset_cache_used() { return cache_used; }
+
+uint32_t asset_cache_hits() { return hits; }
+
+uint32_t asset_cache_misses() { return misses; }
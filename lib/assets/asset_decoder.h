@@ -0,0 +1,43 @@
+#ifndef ASSET_DECODER_H
+#define ASSET_DECODER_H
+
+#include <lvgl.h>
+
+#include "asset.h"
+
+/**
+ * LVGL image decoder for packed assets.
+ * Images with `LV_IMG_CF_USER_ENCODED_0` whose `data` points to an
+ * `asset_t` (as generated by support/asset_packer.py) are decoded line by
+ * line straight into the draw buffer. Frames up to ASSET_CACHE_ITEM_MAX
+ * bytes are kept decoded in a small LRU cache of ASSET_CACHE_SIZE bytes.
+ */
+
+#ifndef ASSET_CACHE_SIZE
+#define ASSET_CACHE_SIZE (16U * 1024U)
+#endif
+
+#ifndef ASSET_CACHE_ITEM_MAX
+#define ASSET_CACHE_ITEM_MAX (ASSET_CACHE_SIZE / 2)
+#endif
+
+#ifndef ASSET_CACHE_ENTRIES
+#define ASSET_CACHE_ENTRIES 16
+#endif
+
+#define LV_IMG_CF_ASSET LV_IMG_CF_USER_ENCODED_0
+
+void asset_decoder_init();
+
+/**
+ * Drop cached frames
+ * @param bytes amount of memory wanted, 0 to drop everything
+ * @return bytes released
+ */
+uint32_t asset_cache_release(uint32_t bytes);
+
+uint32_t asset_cache_used();
+uint32_t asset_cache_hits();
+uint32_t asset_cache_misses();
+
+#endif /*ASSET_DECODER_H*/
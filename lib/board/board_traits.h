@@ -0,0 +1,238 @@
+#ifndef BOARD_TRAITS_H
+#define BOARD_TRAITS_H
+
+#include <stdint.h>
+
+/**
+ * Compile-time description of each supported board.
+ *
+ * `BoardTraits<BOARD_x>` holds the panel geometry, pins and limits as
+ * constexpr values, and the flush, touch and round-mask helpers below are
+ * templates on it, so each board gets straight-line code without runtime
+ * checks. `Board` (include/main.h) is the traits of the board the firmware
+ * is built for, the native tests instantiate all of them.
+ */
+
+enum BoardId { BOARD_ESP32, BOARD_ESPC3, BOARD_ESPS3_1_28, BOARD_ESPS3_1_69 };
+
+#if defined(ESPC3)
+#define BOARD_CURRENT BOARD_ESPC3
+#elif defined(ESPS3_1_28)
+#define BOARD_CURRENT BOARD_ESPS3_1_28
+#elif defined(ESPS3_1_69)
+#define BOARD_CURRENT BOARD_ESPS3_1_69
+#else
+#define BOARD_CURRENT BOARD_ESP32
+#endif
+
+// values of spi_host_device_t
+#define BOARD_SPI2_HOST 1
+#define BOARD_SPI3_HOST 2 // VSPI_HOST on the ESP32
+
+template <BoardId id> struct BoardTraits;
+
+template <> struct BoardTraits<BOARD_ESPC3> {
+  static constexpr const char *name = "ESPC3";
+  // screen configs
+  static constexpr int16_t width = 240;
+  static constexpr int16_t height = 240;
+  static constexpr int16_t offset_x = 0;
+  static constexpr int16_t offset_y = 0;
+  static constexpr bool rgb_order = false;
+  static constexpr bool round = true;
+  // touch
+  static constexpr int8_t i2c_sda = 4;
+  static constexpr int8_t i2c_scl = 5;
+  static constexpr int8_t tp_int = 0;
+  static constexpr int8_t tp_rst = 1;
+  static constexpr bool touch_swap_xy = false;
+  static constexpr bool touch_mirror_x = false;
+  static constexpr bool touch_mirror_y = false;
+  // display
+  static constexpr uint8_t spi_host = BOARD_SPI2_HOST;
+  static constexpr int8_t sclk = 6;
+  static constexpr int8_t mosi = 7;
+  static constexpr int8_t miso = -1;
+  static constexpr int8_t dc = 2;
+  static constexpr int8_t cs = 10;
+  static constexpr int8_t rst = -1;
+  static constexpr int8_t bl = 3;
+  // limits
+  static constexpr uint8_t max_file_open = 10;
+  static constexpr uint8_t draw_buf_lines = 10; // per buffer, two buffers
+};
+
+template <> struct BoardTraits<BOARD_ESPS3_1_28> {
+  static constexpr const char *name = "ESPS3_1_28";
+  static constexpr int16_t width = 240;
+  static constexpr int16_t height = 240;
+  static constexpr int16_t offset_x = 0;
+  static constexpr int16_t offset_y = 0;
+  static constexpr bool rgb_order = false;
+  static constexpr bool round = true;
+  static constexpr int8_t i2c_sda = 6;
+  static constexpr int8_t i2c_scl = 7;
+  static constexpr int8_t tp_int = 5;
+  static constexpr int8_t tp_rst = 13;
+  static constexpr bool touch_swap_xy = false;
+  static constexpr bool touch_mirror_x = false;
+  static constexpr bool touch_mirror_y = false;
+  static constexpr uint8_t spi_host = BOARD_SPI2_HOST;
+  static constexpr int8_t sclk = 10;
+  static constexpr int8_t mosi = 11;
+  static constexpr int8_t miso = 12;
+  static constexpr int8_t dc = 8;
+  static constexpr int8_t cs = 9;
+  static constexpr int8_t rst = 14;
+  static constexpr int8_t bl = 2;
+  static constexpr uint8_t max_file_open = 50;
+  static constexpr uint8_t draw_buf_lines = 10;
+};
+
+template <> struct BoardTraits<BOARD_ESPS3_1_69> {
+  static constexpr const char *name = "ESPS3_1_69";
+  static constexpr int16_t width = 240;
+  static constexpr int16_t height = 280;
+  static constexpr int16_t offset_x = 0;
+  static constexpr int16_t offset_y = 20;
+  static constexpr bool rgb_order = true;
+  static constexpr bool round = false;
+  static constexpr int8_t i2c_sda = 11;
+  static constexpr int8_t i2c_scl = 10;
+  static constexpr int8_t tp_int = 14;
+  static constexpr int8_t tp_rst = 13;
+  static constexpr bool touch_swap_xy = false;
+  static constexpr bool touch_mirror_x = false;
+  static constexpr bool touch_mirror_y = false;
+  static constexpr uint8_t spi_host = BOARD_SPI2_HOST;
+  static constexpr int8_t sclk = 6;
+  static constexpr int8_t mosi = 7;
+  static constexpr int8_t miso = -1;
+  static constexpr int8_t dc = 4;
+  static constexpr int8_t cs = 5;
+  static constexpr int8_t rst = 8;
+  static constexpr int8_t bl = 15;
+  static constexpr uint8_t max_file_open = 20;
+  static constexpr uint8_t draw_buf_lines = 10;
+};
+
+template <> struct BoardTraits<BOARD_ESP32> {
+  static constexpr const char *name = "ESP32";
+  static constexpr int16_t width = 240;
+  static constexpr int16_t height = 240;
+  static constexpr int16_t offset_x = 0;
+  static constexpr int16_t offset_y = 0;
+  static constexpr bool rgb_order = false;
+  static constexpr bool round = true;
+  static constexpr int8_t i2c_sda = 21;
+  static constexpr int8_t i2c_scl = 22;
+  static constexpr int8_t tp_int = 14;
+  static constexpr int8_t tp_rst = 5;
+  static constexpr bool touch_swap_xy = false;
+  static constexpr bool touch_mirror_x = false;
+  static constexpr bool touch_mirror_y = false;
+  static constexpr uint8_t spi_host = BOARD_SPI3_HOST;
+  static constexpr int8_t sclk = 18;
+  static constexpr int8_t mosi = 23;
+  static constexpr int8_t miso = -1;
+  static constexpr int8_t dc = 4;
+  static constexpr int8_t cs = 15;
+  static constexpr int8_t rst = 13;
+  static constexpr int8_t bl = 2;
+  static constexpr uint8_t max_file_open = 10;
+  static constexpr uint8_t draw_buf_lines = 10;
+};
+
+/**
+ * Pixels of one LVGL draw buffer
+ */
+template <class B> constexpr uint32_t board_draw_buf_pixels() {
+  return (uint32_t)B::width * B::draw_buf_lines;
+}
+
+/**
+ * Integer square root, rounded down
+ */
+inline uint32_t board_isqrt(uint32_t v) {
+  uint32_t r = 0;
+  for (uint32_t bit = 1UL << 30; bit; bit >>= 2) {
+    if (v >= r + bit) {
+      v -= r + bit;
+      r = (r >> 1) + bit;
+    } else {
+      r >>= 1;
+    }
+  }
+  return r;
+}
+
+/**
+ * Pixels hidden on each side of a row by the round bezel, 0 on square
+ * panels. A pixel is visible when its centre is inside the circle.
+ * @return inset, `B::width` if the row is outside the screen
+ */
+template <class B> inline int16_t board_round_inset(int16_t y) {
+  if (!B::round) {
+    return 0;
+  }
+  if (y < 0 || y >= B::height) {
+    return B::width;
+  }
+  // doubled coordinates keep the pixel centres integral
+  int32_t d = 2 * y + 1 - B::height;
+  uint32_t s = board_isqrt((uint32_t)(B::width * B::width - d * d));
+  return (int16_t)((B::width - (int32_t)s) / 2);
+}
+
+/**
+ * Trim the rows of a flush area that are completely hidden by the round
+ * bezel (the corners of the screen)
+ * @param y1 first row, moved down to the first visible one
+ * @param y2 last row, moved up to the last visible one
+ * @return false if nothing of the area is visible
+ */
+template <class B>
+inline bool board_visible_rows(int16_t x1, int16_t x2, int16_t &y1,
+                               int16_t &y2) {
+  if (!B::round) {
+    return y1 <= y2;
+  }
+  // the inset shrinks towards the middle, the first visible row from each
+  // end ends the search
+  while (y1 <= y2) {
+    int16_t inset = board_round_inset<B>(y1);
+    if (x2 >= inset && x1 <= B::width - 1 - inset) {
+      break;
+    }
+    y1++;
+  }
+  while (y2 > y1) {
+    int16_t inset = board_round_inset<B>(y2);
+    if (x2 >= inset && x1 <= B::width - 1 - inset) {
+      break;
+    }
+    y2--;
+  }
+  return y1 <= y2;
+}
+
+/**
+ * Raw touch controller coordinates to screen coordinates, clamped to the
+ * panel (the CST816S reports up to `width`/`height` inclusive)
+ */
+template <class B>
+inline void board_touch_point(uint16_t raw_x, uint16_t raw_y, int16_t &x,
+                              int16_t &y) {
+  int16_t tx = B::touch_swap_xy ? raw_y : raw_x;
+  int16_t ty = B::touch_swap_xy ? raw_x : raw_y;
+  if (tx >= B::width) {
+    tx = B::width - 1;
+  }
+  if (ty >= B::height) {
+    ty = B::height - 1;
+  }
+  x = B::touch_mirror_x ? B::width - 1 - tx : tx;
+  y = B::touch_mirror_y ? B::height - 1 - ty : ty;
+}
+
+#endif /*BOARD_TRAITS_H*/
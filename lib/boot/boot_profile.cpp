@@ -0,0 +1,96 @@
+#include "boot_profile.h"
+#include <stdio.h>
+
+static boot_clock_us_t clock_us;
+static uint32_t begin_us;
+static uint32_t last_us;
+static uint32_t first_frame_us;
+// boot_mark and boot_mark_deferred may run on different tasks, each one
+// only writes its own list
+static BootStage stages[BOOT_STAGES_MAX];
+static uint32_t count;
+static BootStage deferred[BOOT_DEFERRED_MAX];
+static volatile uint32_t deferred_count;
+
+void boot_profile_begin(boot_clock_us_t clock) {
+  clock_us = clock;
+  begin_us = clock_us();
+  last_us = begin_us;
+  first_frame_us = 0;
+  count = 0;
+  deferred_count = 0;
+}
+
+uint32_t boot_now_us() { return clock_us ? clock_us() - begin_us : 0; }
+
+static void set(BootStage &s, const char *stage, uint32_t start,
+                uint32_t end, bool is_deferred) {
+  s.name = stage;
+  s.start_us = start;
+  s.duration_us = end - start;
+  s.deferred = is_deferred;
+}
+
+void boot_mark(const char *stage) {
+  if (clock_us == NULL) {
+    return;
+  }
+  uint32_t now = clock_us();
+  if (count < BOOT_STAGES_MAX) {
+    set(stages[count], stage, last_us - begin_us, now - begin_us, false);
+    count++;
+  }
+  last_us = now;
+}
+
+void boot_mark_deferred(const char *stage, uint32_t start_us) {
+  if (clock_us == NULL) {
+    return;
+  }
+  uint32_t n = deferred_count;
+  if (n < BOOT_DEFERRED_MAX) {
+    set(deferred[n], stage, start_us, boot_now_us(), true);
+    deferred_count = n + 1; // published once the entry is complete
+  }
+}
+
+void boot_first_frame() {
+  if (first_frame_us == 0) {
+    first_frame_us = boot_now_us();
+  }
+}
+
+uint32_t boot_first_frame_us() { return first_frame_us; }
+
+uint32_t boot_stage_count() { return count + deferred_count; }
+
+const BootStage *boot_stage(uint32_t index) {
+  if (index < count) {
+    return &stages[index];
+  }
+  index -= count;
+  return index < deferred_count ? &deferred[index] : NULL;
+}
+
+void boot_report(boot_print_t print) {
+  char line[80];
+  uint32_t total = 0;
+
+  print("=== boot report ===\n");
+  uint32_t n = boot_stage_count();
+  for (uint32_t i = 0; i < n; i++) {
+    const BootStage &s = *boot_stage(i);
+    snprintf(line, sizeof(line), "%-20s %8lu us%s\n", s.name,
+             (unsigned long)s.duration_us, s.deferred ? " (deferred)" : "");
+    print(line);
+    if (!s.deferred) {
+      total += s.duration_us;
+    }
+  }
+  snprintf(line, sizeof(line), "%-20s %8lu us\n", "first frame",
+           (unsigned long)first_frame_us);
+  print(line);
+  snprintf(line, sizeof(line), "%-20s %8lu us\n", "boot total",
+           (unsigned long)total);
+  print(line);
+}
@@ -0,0 +1,69 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Boot time instrumentation.
+ * Each `boot_mark` closes the stage started by the previous mark, the
+ * report lists the duration of every stage and the total since
+ * `boot_profile_begin`.
+ */
+
+#ifndef BOOT_STAGES_MAX
+#define BOOT_STAGES_MAX 24
+#endif
+
+/* Stages of the background task, listed after the boot sequence */
+#ifndef BOOT_DEFERRED_MAX
+#define BOOT_DEFERRED_MAX 8
+#endif
+
+typedef uint32_t (*boot_clock_us_t)();
+typedef void (*boot_print_t)(const char *line);
+
+struct BootStage {
+  const char *name;
+  uint32_t start_us;
+  uint32_t duration_us;
+  bool deferred; // ran in background after the first frame
+};
+
+/**
+ * Start profiling
+ * @param clock microsecond clock, e.g. `micros` on the esp32
+ */
+void boot_profile_begin(boot_clock_us_t clock);
+
+/**
+ * End the current stage and start the next one
+ * @param stage name of the stage that just finished, must be a literal
+ */
+void boot_mark(const char *stage);
+
+/**
+ * Record a stage that ran outside the boot sequence (background task).
+ * Only one task may record deferred stages, the boot sequence can run on
+ * another one at the same time.
+ * @param stage name of the stage
+ * @param start_us start time from the profiler clock
+ */
+void boot_mark_deferred(const char *stage, uint32_t start_us);
+
+/**
+ * Mark the first frame sent to the panel
+ */
+void boot_first_frame();
+
+uint32_t boot_now_us();
+uint32_t boot_first_frame_us();
+uint32_t boot_stage_count();
+const BootStage *boot_stage(uint32_t index);
+
+/**
+ * Print the boot report one line at a time
+ */
+void boot_report(boot_print_t print);
+
+#endif /*BOOT_PROFILE_H*/
@@ -0,0 +1,203 @@
+#include "face_catalog.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define CATALOG_MAGIC 0x31544346 // "FCT1"
+#define CATALOG_FILE "faces.cat"
+#define PATH_MAX_LEN 96
+
+struct CatalogHeader {
+  uint32_t magic;
+  uint16_t entry_size;
+  uint16_t count;
+  uint32_t checksum;
+};
+
+static uint32_t checksum(const CatalogEntry *entries, uint16_t count) {
+  // FNV-1a, enough to catch a torn write
+  const uint8_t *p = (const uint8_t *)entries;
+  uint32_t h = 2166136261u;
+  for (uint32_t i = 0; i < (uint32_t)count * sizeof(CatalogEntry); i++) {
+    h = (h ^ p[i]) * 16777619u;
+  }
+  return h;
+}
+
+static bool has_ext(const char *name, const char *ext) {
+  size_t n = strlen(name), e = strlen(ext);
+  return n > e && strcmp(name + n - e, ext) == 0;
+}
+
+FaceCatalog::FaceCatalog(const char *dir, const char *ext, FaceParser parser)
+    : dir(dir), ext(ext), parser(parser), entries_count(0), stored(false) {}
+
+void FaceCatalog::path(char *out, uint32_t len, const char *file) const {
+  snprintf(out, len, "%s/%s", dir, file);
+}
+
+bool FaceCatalog::load() {
+  char p[PATH_MAX_LEN];
+  path(p, sizeof(p), CATALOG_FILE);
+  entries_count = 0;
+  stored = false;
+
+  FILE *f = fopen(p, "rb");
+  if (f == NULL) {
+    return false;
+  }
+  CatalogHeader h;
+  bool ok = fread(&h, sizeof(h), 1, f) == 1 && h.magic == CATALOG_MAGIC &&
+            h.entry_size == sizeof(CatalogEntry) && h.count <= CATALOG_MAX &&
+            fread(entries, sizeof(CatalogEntry), h.count, f) == h.count &&
+            checksum(entries, h.count) == h.checksum;
+  fclose(f);
+  if (ok) {
+    entries_count = h.count;
+    stored = true;
+  }
+  return ok;
+}
+
+bool FaceCatalog::save() {
+  char p[PATH_MAX_LEN], tmp[PATH_MAX_LEN];
+  path(p, sizeof(p), CATALOG_FILE);
+  path(tmp, sizeof(tmp), CATALOG_FILE ".tmp");
+
+  FILE *f = fopen(tmp, "wb");
+  if (f == NULL) {
+    return false;
+  }
+  CatalogHeader h = {CATALOG_MAGIC, sizeof(CatalogEntry), entries_count,
+                     checksum(entries, entries_count)};
+  bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+            fwrite(entries, sizeof(CatalogEntry), entries_count, f) ==
+                entries_count;
+  ok = fclose(f) == 0 && ok;
+  if (!ok) {
+    ::remove(tmp);
+    return false;
+  }
+  ::remove(p); // FAT rename does not replace
+  stored = rename(tmp, p) == 0;
+  return stored;
+}
+
+int FaceCatalog::find(const char *file) const {
+  for (uint16_t i = 0; i < entries_count; i++) {
+    if (strncmp(entries[i].file, file, CATALOG_NAME_MAX) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool FaceCatalog::parse(const char *file, CatalogEntry &entry) {
+  char p[PATH_MAX_LEN];
+  path(p, sizeof(p), file);
+  struct stat st;
+  if (strlen(file) >= CATALOG_NAME_MAX || stat(p, &st) != 0) {
+    return false;
+  }
+  memset(&entry, 0, sizeof(entry));
+  strcpy(entry.file, file);
+  entry.size = st.st_size;
+  entry.mtime = st.st_mtime;
+  return parser(p, entry);
+}
+
+CatalogSync FaceCatalog::sync() {
+  CatalogSync result;
+  memset(&result, 0, sizeof(result));
+  bool seen[CATALOG_MAX];
+  memset(seen, 0, sizeof(seen));
+  bool changed = !stored;
+
+  DIR *d = opendir(dir);
+  if (d == NULL) {
+    return result;
+  }
+  struct dirent *de;
+  while ((de = readdir(d)) != NULL) {
+    if (!has_ext(de->d_name, ext)) {
+      continue;
+    }
+    char p[PATH_MAX_LEN];
+    path(p, sizeof(p), de->d_name);
+    struct stat st;
+    if (stat(p, &st) != 0 || !S_ISREG(st.st_mode)) {
+      continue;
+    }
+
+    int i = find(de->d_name);
+    if (i >= 0 && entries[i].size == (uint32_t)st.st_size &&
+        entries[i].mtime == (uint32_t)st.st_mtime) {
+      seen[i] = true;
+      result.kept++;
+      continue;
+    }
+
+    // new or changed, the only files that are opened
+    CatalogEntry e;
+    if (!parse(de->d_name, e)) {
+      result.failed++;
+      continue; // an old entry is dropped below
+    }
+    if (i < 0) {
+      if (entries_count >= CATALOG_MAX) {
+        result.failed++;
+        continue;
+      }
+      i = entries_count++;
+    }
+    entries[i] = e;
+    seen[i] = true;
+    result.parsed++;
+    changed = true;
+  }
+  closedir(d);
+
+  uint16_t n = 0;
+  for (uint16_t i = 0; i < entries_count; i++) {
+    if (seen[i]) {
+      entries[n++] = entries[i];
+    } else {
+      result.removed++;
+      changed = true;
+    }
+  }
+  entries_count = n;
+
+  if (changed) {
+    result.saved = save();
+  }
+  return result;
+}
+
+bool FaceCatalog::add(const char *file) {
+  CatalogEntry e;
+  if (!has_ext(file, ext) || !parse(file, e)) {
+    return false;
+  }
+  int i = find(file);
+  if (i < 0) {
+    if (entries_count >= CATALOG_MAX) {
+      return false;
+    }
+    i = entries_count++;
+  }
+  entries[i] = e;
+  return save();
+}
+
+bool FaceCatalog::remove(const char *file) {
+  int i = find(file);
+  if (i < 0) {
+    return false;
+  }
+  memmove(&entries[i], &entries[i + 1],
+          (entries_count - i - 1) * sizeof(CatalogEntry));
+  entries_count--;
+  return save();
+}
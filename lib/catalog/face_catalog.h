@@ -0,0 +1,99 @@
+#ifndef FACE_CATALOG_H
+#define FACE_CATALOG_H
+
+#include <stdint.h>
+
+/**
+ * Catalog of the installed custom watchfaces.
+ *
+ * The picker needs the name, preview and a summary of every face. Instead
+ * of opening and parsing each face file, one catalog file (`faces.cat` in
+ * the face directory) holds an entry per face. `sync` only lists the
+ * directory: unchanged files (same size and mtime) keep their entry, new or
+ * changed ones are parsed and removed ones dropped, and the catalog is
+ * rewritten (temporary file + rename) only when something changed. The
+ * installer adds a face as soon as it is committed, `sync` catches up with
+ * files copied by other means.
+ */
+
+#ifndef CATALOG_MAX
+#define CATALOG_MAX 32
+#endif
+
+#define CATALOG_NAME_MAX 32
+
+struct CatalogEntry {
+  char file[CATALOG_NAME_MAX]; // file name in the face directory
+  char name[CATALOG_NAME_MAX]; // display name
+  uint32_t size;
+  uint32_t mtime;
+  char preview[CATALOG_NAME_MAX]; // preview image, "" if none
+  uint32_t preview_offset;        // pixels in `preview`, 0 if unread
+  // layout summary
+  uint16_t elements;
+  uint16_t assets;
+  uint8_t analog; // has hands drawn around a pivot
+  uint8_t reserved[3];
+};
+
+struct CatalogSync {
+  uint16_t kept;
+  uint16_t parsed;
+  uint16_t removed;
+  uint16_t failed;
+  bool saved;
+};
+
+/**
+ * Parse one face file and fill the entry (`file`, `size` and `mtime` are
+ * already set)
+ * @param path full path of the face file
+ * @return false if the file is not a valid face
+ */
+typedef bool (*FaceParser)(const char *path, CatalogEntry &entry);
+
+class FaceCatalog {
+public:
+  /**
+   * @param dir face directory, e.g. "/ffat"
+   * @param ext extension of the face files, e.g. ".wf"
+   * @param parser reads a face file
+   */
+  FaceCatalog(const char *dir, const char *ext, FaceParser parser);
+
+  /**
+   * Read the catalog file
+   * @return false if it is missing or damaged, `sync` rebuilds it
+   */
+  bool load();
+
+  /**
+   * Bring the catalog in line with the directory
+   */
+  CatalogSync sync();
+
+  /**
+   * Parse one face and add or replace its entry, e.g. after an install
+   * @return false if `file` is not a face or the catalog is full
+   */
+  bool add(const char *file);
+  bool remove(const char *file);
+
+  uint16_t count() const { return entries_count; }
+  const CatalogEntry &entry(uint16_t index) const { return entries[index]; }
+  int find(const char *file) const;
+
+private:
+  bool parse(const char *file, CatalogEntry &entry);
+  bool save();
+  void path(char *out, uint32_t len, const char *file) const;
+
+  const char *dir;
+  const char *ext;
+  FaceParser parser;
+  CatalogEntry entries[CATALOG_MAX];
+  uint16_t entries_count;
+  bool stored; // the catalog file matches `entries`
+};
+
+#endif /*FACE_CATALOG_H*/
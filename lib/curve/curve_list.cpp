@@ -0,0 +1,226 @@
+#include "curve_list.h"
+#include <string.h>
+
+struct CurveList {
+  CurveTable table;
+  uint16_t layout;   // original layout, restored on detach
+  uint16_t children; // child count at the last layout, hidden ones too
+  uint16_t count;    // laid out children
+  uint16_t capacity;
+  bool pending; // layout scheduled
+  // per laid out child, in content coordinates of the list
+  lv_obj_t **items;
+  int16_t *tops;
+  int16_t *bottoms;
+  int16_t *shift;
+  uint8_t *opa;
+};
+
+static CurveListStats counters;
+
+static void event_cb(lv_event_t *e);
+static void layout(lv_obj_t *list, CurveList *c);
+static void layout_async(void *list);
+
+static CurveList *state(lv_obj_t *list) {
+  return (CurveList *)lv_obj_get_event_user_data(list, event_cb);
+}
+
+static bool reserve(CurveList *c, uint16_t n) {
+  if (n <= c->capacity) {
+    return true;
+  }
+  size_t per_item = sizeof(lv_obj_t *) + 3 * sizeof(int16_t) + 1;
+  uint8_t *block = (uint8_t *)lv_mem_realloc(c->items, n * per_item);
+  if (block == NULL) {
+    return false;
+  }
+  c->capacity = n;
+  c->items = (lv_obj_t **)block;
+  c->tops = (int16_t *)(block + n * sizeof(lv_obj_t *));
+  c->bottoms = c->tops + n;
+  c->shift = c->bottoms + n;
+  c->opa = (uint8_t *)(c->shift + n);
+  return true;
+}
+
+/* Offsets of the children in view, the rest keep theirs until they scroll in */
+static void apply(lv_obj_t *list, CurveList *c) {
+  if (c->pending || lv_obj_get_child_cnt(list) != c->children) {
+    layout(list, c); // children created or deleted since the last layout
+    return;
+  }
+  counters.scrolls++;
+  lv_coord_t origin = lv_obj_get_style_pad_top(list, LV_PART_MAIN) +
+                      lv_obj_get_style_border_width(list, LV_PART_MAIN);
+  lv_coord_t h = lv_obj_get_height(list);
+  lv_coord_t view_top = lv_obj_get_scroll_y(list) - origin;
+  lv_coord_t center = view_top + h / 2;
+
+  uint16_t first, last;
+  if (!curve_visible_range(c->tops, c->bottoms, c->count, view_top,
+                           view_top + h - 1, &first, &last)) {
+    return;
+  }
+  for (uint16_t i = first; i <= last; i++) {
+    int32_t d = (c->tops[i] + c->bottoms[i]) / 2 - center;
+    int16_t shift = c->table.offset(d);
+    uint8_t opa = c->table.opacity(d);
+    counters.visited++;
+    if (shift == c->shift[i] && opa == c->opa[i]) {
+      continue;
+    }
+    // x is not a parent layout property, only this child is moved and
+    // its old and new box invalidated
+    if (shift != c->shift[i]) {
+      lv_obj_set_x(c->items[i], shift);
+      c->shift[i] = shift;
+    }
+    if (opa != c->opa[i]) {
+      lv_obj_set_style_opa(c->items[i], opa, LV_PART_MAIN);
+      c->opa[i] = opa;
+    }
+    counters.moved++;
+  }
+}
+
+static lv_align_t column_align(lv_obj_t *list) {
+  switch (lv_obj_get_style_flex_cross_place(list, LV_PART_MAIN)) {
+  case LV_FLEX_ALIGN_CENTER:
+    return LV_ALIGN_TOP_MID;
+  case LV_FLEX_ALIGN_END:
+    return LV_ALIGN_TOP_RIGHT;
+  default:
+    return LV_ALIGN_TOP_LEFT;
+  }
+}
+
+/* Column with the row gap of the list, replaces the flex layout */
+static void layout(lv_obj_t *list, CurveList *c) {
+  if (c->pending) {
+    lv_async_call_cancel(layout_async, list);
+    c->pending = false;
+  }
+  lv_obj_update_layout(list); // sizes of new children
+  uint32_t n = lv_obj_get_child_cnt(list);
+  c->children = n;
+  c->count = 0;
+  if (!reserve(c, n)) {
+    return;
+  }
+  lv_coord_t gap = lv_obj_get_style_pad_row(list, LV_PART_MAIN);
+  lv_align_t align = column_align(list);
+  lv_coord_t y = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    lv_obj_t *child = lv_obj_get_child(list, i);
+    if (lv_obj_has_flag_any(child, LV_OBJ_FLAG_HIDDEN |
+                                       LV_OBJ_FLAG_IGNORE_LAYOUT |
+                                       LV_OBJ_FLAG_FLOATING)) {
+      continue;
+    }
+    lv_coord_t h = lv_obj_get_height(child);
+    lv_obj_set_align(child, align);
+    lv_obj_set_y(child, y);
+    uint16_t k = c->count++;
+    c->items[k] = child;
+    c->tops[k] = y;
+    c->bottoms[k] = y + h - 1;
+    c->shift[k] = -1; // set on the first apply
+    c->opa[k] = 0;
+    y += h + gap;
+  }
+  counters.layouts++;
+  lv_obj_update_layout(list);
+  apply(list, c);
+}
+
+static void event_cb(lv_event_t *e) {
+  lv_obj_t *list = lv_event_get_current_target(e);
+  CurveList *c = (CurveList *)lv_event_get_user_data(e);
+  switch (lv_event_get_code(e)) {
+  case LV_EVENT_SCROLL:
+    apply(list, c);
+    break;
+  case LV_EVENT_CHILD_CREATED:
+  case LV_EVENT_CHILD_DELETED:
+  case LV_EVENT_SIZE_CHANGED:
+    // once the new children are set up, several changes make one layout
+    if (!c->pending) {
+      c->pending = true;
+      lv_async_call(layout_async, list);
+    }
+    break;
+  case LV_EVENT_DELETE:
+    if (c->pending) {
+      lv_async_call_cancel(layout_async, list);
+    }
+    lv_mem_free(c->items);
+    lv_mem_free(c);
+    break;
+  default:
+    break;
+  }
+}
+
+bool curve_list_attach(lv_obj_t *list, uint16_t radius) {
+  CurveList *c = state(list);
+  if (c) {
+    c->table.build(radius, true);
+    curve_list_refresh(list);
+    return true;
+  }
+  c = (CurveList *)lv_mem_alloc(sizeof(CurveList));
+  if (c == NULL) {
+    return false;
+  }
+  memset(c, 0, sizeof(CurveList));
+  c->table.build(radius, true);
+  c->layout = lv_obj_get_style_layout(list, LV_PART_MAIN);
+  lv_obj_set_style_layout(list, 0, LV_PART_MAIN);
+  lv_obj_add_event_cb(list, event_cb, LV_EVENT_ALL, c);
+  layout(list, c);
+  return true;
+}
+
+void curve_list_detach(lv_obj_t *list) {
+  CurveList *c = state(list);
+  if (c == NULL) {
+    return;
+  }
+  if (c->pending) {
+    lv_async_call_cancel(layout_async, list);
+  }
+  uint32_t n = lv_obj_get_child_cnt(list);
+  for (uint32_t i = 0; i < n; i++) {
+    lv_obj_t *child = lv_obj_get_child(list, i);
+    lv_obj_remove_local_style_prop(child, LV_STYLE_X, LV_PART_MAIN);
+    lv_obj_remove_local_style_prop(child, LV_STYLE_Y, LV_PART_MAIN);
+    lv_obj_remove_local_style_prop(child, LV_STYLE_ALIGN, LV_PART_MAIN);
+    lv_obj_remove_local_style_prop(child, LV_STYLE_OPA, LV_PART_MAIN);
+  }
+  lv_obj_set_style_layout(list, c->layout, LV_PART_MAIN);
+  lv_obj_remove_event_cb(list, event_cb);
+  lv_mem_free(c->items);
+  lv_mem_free(c);
+}
+
+bool curve_list_attached(lv_obj_t *list) { return state(list) != NULL; }
+
+static void layout_async(void *list) {
+  CurveList *c = state((lv_obj_t *)list);
+  if (c) {
+    c->pending = false; // this is the scheduled call, nothing to cancel
+    layout((lv_obj_t *)list, c);
+  }
+}
+
+void curve_list_refresh(lv_obj_t *list) {
+  CurveList *c = state(list);
+  if (c) {
+    layout(list, c);
+  }
+}
+
+const CurveListStats &curve_list_stats() { return counters; }
+
+void curve_list_stats_reset() { memset(&counters, 0, sizeof(counters)); }
@@ -0,0 +1,55 @@
+#ifndef CURVE_LIST_H
+#define CURVE_LIST_H
+
+#include <lvgl.h>
+
+#include "curve_table.h"
+
+/**
+ * Vertical list bent along a round display.
+ *
+ * The usual round scroll effect runs on every scroll event and, for every
+ * child, takes a square root and sets `translate_x` and `opa`. Translation
+ * is a layout property, so each event also re-runs the flex layout of the
+ * whole list. A curve list lays its children out in a column once (again
+ * when children are added, removed or the list is resized). On a scroll
+ * event only the children in view are looked up in a `CurveTable`, and only
+ * the ones whose offset or opacity changed are moved. LVGL then invalidates
+ * just their old and new boxes.
+ *
+ * Works on the existing flex column lists (ui_settingsList, ui_appList,
+ * ...), their row gap and cross alignment are kept. Detaching restores the
+ * flex layout.
+ */
+
+struct CurveListStats {
+  uint32_t scrolls; // scroll events handled
+  uint32_t visited; // children looked up, only the visible ones
+  uint32_t moved;   // children whose offset or opacity changed
+  uint32_t layouts; // column layouts
+};
+
+/**
+ * Bend a list, attaching twice only updates the radius
+ * @param list scrollable column, usually a flex column
+ * @param radius curve radius, e.g. half the screen width
+ * @return false if out of memory, the list stays unchanged
+ */
+bool curve_list_attach(lv_obj_t *list, uint16_t radius);
+
+/**
+ * Back to the original layout, offsets and opacity removed
+ */
+void curve_list_detach(lv_obj_t *list);
+
+bool curve_list_attached(lv_obj_t *list);
+
+/**
+ * Lay the children out again, e.g. after a child changed its height
+ */
+void curve_list_refresh(lv_obj_t *list);
+
+const CurveListStats &curve_list_stats();
+void curve_list_stats_reset();
+
+#endif /*CURVE_LIST_H*/
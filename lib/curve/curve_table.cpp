@@ -0,0 +1,70 @@
+#include "curve_table.h"
+#include <string.h>
+
+static uint32_t isqrt(uint32_t v) {
+  uint32_t root = 0, bit = 1UL << 30;
+  while (bit > v) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+CurveTable::CurveTable() : r(0) {
+  memset(shift, 0, sizeof(shift));
+  memset(opa, 0, sizeof(opa));
+  opa[0] = 255;
+}
+
+void CurveTable::build(uint16_t radius, bool fade) {
+  r = radius > CURVE_RADIUS_MAX ? CURVE_RADIUS_MAX : radius;
+  uint32_t r2 = (uint32_t)r * r;
+  for (uint16_t d = 0; d <= r; d++) {
+    // sqrt in Q4 (the argument in Q8), rounded to whole pixels
+    uint32_t root = isqrt((r2 - (uint32_t)d * d) << 8);
+    uint32_t x = ((uint32_t)r << 4) - root;
+    shift[d] = (uint8_t)((x + 8) >> 4);
+    opa[d] = fade && r ? (uint8_t)(255 - shift[d] * 255 / r) : 255;
+  }
+}
+
+bool curve_visible_range(const int16_t *tops, const int16_t *bottoms,
+                         uint16_t count, int16_t view_top,
+                         int16_t view_bottom, uint16_t *first,
+                         uint16_t *last) {
+  // first item ending at or below the top of the view
+  uint16_t lo = 0, hi = count;
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if (bottoms[mid] < view_top) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *first = lo;
+
+  // first item starting below the view, the one before is the last visible
+  hi = count;
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if (tops[mid] <= view_bottom) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == *first) {
+    return false;
+  }
+  *last = lo - 1;
+  return true;
+}
@@ -0,0 +1,70 @@
+#ifndef CURVE_TABLE_H
+#define CURVE_TABLE_H
+
+#include <stdint.h>
+
+/**
+ * Offsets of a list bent along a round display.
+ *
+ * An item whose centre is `d` pixels above or below the centre of the
+ * list is moved right by `r - sqrt(r^2 - d^2)` and faded as it nears the
+ * edge. The table holds both for every `d` up to the radius, computed once
+ * in fixed point, so a scroll step is a lookup per visible item instead of
+ * a square root per item.
+ */
+
+#ifndef CURVE_RADIUS_MAX
+#define CURVE_RADIUS_MAX 160
+#endif
+
+class CurveTable {
+public:
+  CurveTable();
+
+  /**
+   * @param radius curve radius in pixels, up to CURVE_RADIUS_MAX
+   * @param fade true to fade items towards the edge
+   */
+  void build(uint16_t radius, bool fade);
+
+  uint16_t radius() const { return r; }
+
+  /**
+   * Horizontal offset of an item `d` pixels from the centre (either side)
+   */
+  uint8_t offset(int32_t d) const {
+    d = d < 0 ? -d : d;
+    return shift[d < r ? d : r];
+  }
+
+  /**
+   * Opacity, 255 at the centre
+   */
+  uint8_t opacity(int32_t d) const {
+    d = d < 0 ? -d : d;
+    return opa[d < r ? d : r];
+  }
+
+private:
+  uint16_t r;
+  uint8_t shift[CURVE_RADIUS_MAX + 1];
+  uint8_t opa[CURVE_RADIUS_MAX + 1];
+};
+
+/**
+ * Items overlapping a viewport, by binary search
+ * @param tops top of each item, ascending
+ * @param bottoms bottom of each item
+ * @param count number of items
+ * @param view_top first visible line
+ * @param view_bottom last visible line
+ * @param first set to the first overlapping item
+ * @param last set to the last overlapping item
+ * @return false if none overlaps
+ */
+bool curve_visible_range(const int16_t *tops, const int16_t *bottoms,
+                         uint16_t count, int16_t view_top,
+                         int16_t view_bottom, uint16_t *first,
+                         uint16_t *last);
+
+#endif /*CURVE_TABLE_H*/
@@ -0,0 +1,321 @@
+#include "dir_pager.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+struct MetaSlot {
+  uint32_t hash; // of the full path
+  uint32_t size;
+  uint8_t type;
+  uint8_t state;
+};
+
+enum { SLOT_FREE, SLOT_USED, SLOT_FORGOTTEN };
+
+// open addressing, cleared when 7/8 full
+static MetaSlot meta[DIR_META_SLOTS];
+static uint32_t meta_count;
+
+static uint32_t fnv(uint32_t h, const char *s) {
+  while (*s) {
+    h = (h ^ (uint8_t)*s++) * 16777619u;
+  }
+  return h;
+}
+
+static bool has_slash(const char *dir) {
+  size_t n = strlen(dir);
+  return n && dir[n - 1] == '/';
+}
+
+static uint32_t path_hash(const char *dir, const char *name) {
+  uint32_t h = fnv(2166136261u, dir);
+  if (!has_slash(dir)) {
+    h = fnv(h, "/");
+  }
+  return fnv(h, name);
+}
+
+static MetaSlot *meta_find(uint32_t hash) {
+  for (uint32_t p = 0; p < DIR_META_SLOTS; p++) {
+    MetaSlot &s = meta[(hash + p) % DIR_META_SLOTS];
+    if (s.state == SLOT_FREE) {
+      return NULL;
+    }
+    if (s.state == SLOT_USED && s.hash == hash) {
+      return &s;
+    }
+  }
+  return NULL;
+}
+
+void dir_meta_clear() {
+  memset(meta, 0, sizeof(meta));
+  meta_count = 0;
+}
+
+static void meta_store(uint32_t hash, uint32_t size, uint8_t type) {
+  MetaSlot *slot = meta_find(hash);
+  if (slot == NULL) {
+    if (meta_count >= DIR_META_SLOTS / 8 * 7) {
+      dir_meta_clear();
+    }
+    // forgotten slots count as used until the next clear
+    for (uint32_t p = 0; slot == NULL; p++) {
+      MetaSlot &s = meta[(hash + p) % DIR_META_SLOTS];
+      if (s.state == SLOT_FREE) {
+        slot = &s;
+      }
+    }
+    meta_count++;
+  }
+  slot->hash = hash;
+  slot->size = size;
+  slot->type = type;
+  slot->state = SLOT_USED;
+}
+
+void dir_meta_forget(const char *path) {
+  MetaSlot *s = meta_find(fnv(2166136261u, path));
+  if (s) {
+    s->state = SLOT_FORGOTTEN;
+  }
+}
+
+static bool has_ext(const char *name, const char *ext) {
+  size_t n = strlen(name), e = strlen(ext);
+  return n > e && strcasecmp(name + n - e, ext) == 0;
+}
+
+DirEntryType dir_entry_type(const char *name) {
+  if (has_ext(name, ".bin") || has_ext(name, ".wf")) {
+    return DIR_TYPE_FACE;
+  }
+  if (has_ext(name, ".png") || has_ext(name, ".jpg") ||
+      has_ext(name, ".bmp")) {
+    return DIR_TYPE_IMAGE;
+  }
+  if (has_ext(name, ".txt") || has_ext(name, ".json") ||
+      has_ext(name, ".cat")) {
+    return DIR_TYPE_TEXT;
+  }
+  return DIR_TYPE_OTHER;
+}
+
+void dir_format_size(const DirEntry &entry, char *out, size_t len) {
+  if (entry.type == DIR_TYPE_DIR) {
+    snprintf(out, len, "%s", "");
+  } else if (!entry.sized) {
+    snprintf(out, len, "%s", "...");
+  } else if (entry.size < 1024) {
+    snprintf(out, len, "%u B", (unsigned)entry.size);
+  } else if (entry.size < 1024 * 1024) {
+    snprintf(out, len, "%u KB", (unsigned)((entry.size + 1023) / 1024));
+  } else {
+    uint32_t tenths = (entry.size / 1024) * 10 / 1024;
+    snprintf(out, len, "%u.%u MB", (unsigned)(tenths / 10),
+             (unsigned)(tenths % 10));
+  }
+}
+
+DirPager::DirPager()
+    : dir(NULL), items(NULL), order(NULL), names(NULL), items_count(0),
+      items_capacity(0), names_used(0), names_capacity(0), sized_count(0),
+      focus_pos(0), rev(0) {
+  dir_path[0] = '\0';
+  memset(&counters, 0, sizeof(counters));
+}
+
+DirPager::~DirPager() {
+  close();
+  free(items);
+  free(order);
+  free(names);
+}
+
+bool DirPager::open(const char *path) {
+  close();
+  snprintf(dir_path, sizeof(dir_path), "%s", path);
+  size_t n = strlen(dir_path);
+  while (n > 1 && dir_path[n - 1] == '/') {
+    dir_path[--n] = '\0';
+  }
+  memset(&counters, 0, sizeof(counters));
+  rev++;
+  dir = opendir(dir_path);
+  return dir != NULL;
+}
+
+void DirPager::close() {
+  if (dir) {
+    closedir((DIR *)dir);
+    dir = NULL;
+  }
+  // the buffers are kept for the next directory
+  items_count = 0;
+  names_used = 0;
+  sized_count = 0;
+  focus_pos = 0;
+  rev++;
+}
+
+bool DirPager::reserve(uint16_t n, uint32_t bytes) {
+  if (n > DIR_ENTRIES_MAX || bytes > 0xFFFF) {
+    return false; // offsets are 16 bit
+  }
+  if (n > items_capacity) {
+    uint32_t cap = items_capacity ? items_capacity * 2 : DIR_PAGE;
+    cap = cap > DIR_ENTRIES_MAX ? DIR_ENTRIES_MAX : cap;
+    Item *i = (Item *)realloc(items, cap * sizeof(Item));
+    if (i == NULL) {
+      return false;
+    }
+    items = i;
+    uint16_t *o = (uint16_t *)realloc(order, cap * sizeof(uint16_t));
+    if (o == NULL) {
+      return false;
+    }
+    order = o;
+    items_capacity = cap;
+  }
+  if (bytes > names_capacity) {
+    uint32_t cap = names_capacity ? names_capacity * 2 : 512;
+    while (cap < bytes) {
+      cap *= 2;
+    }
+    cap = cap > 0xFFFF ? 0xFFFF : cap;
+    char *p = (char *)realloc(names, cap);
+    if (p == NULL) {
+      return false;
+    }
+    names = p;
+    names_capacity = cap;
+  }
+  return true;
+}
+
+int DirPager::compare(uint16_t a, uint16_t b) const {
+  const Item &x = items[a], &y = items[b];
+  bool xd = x.type == DIR_TYPE_DIR, yd = y.type == DIR_TYPE_DIR;
+  if (xd != yd) {
+    return xd ? -1 : 1;
+  }
+  int c = strcasecmp(names + x.name, names + y.name);
+  return c ? c : strcmp(names + x.name, names + y.name);
+}
+
+void DirPager::insert(uint16_t index) {
+  // after the last entry not greater, so equal names keep listing order
+  uint16_t lo = 0, hi = items_count - 1;
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if (compare(order[mid], index) <= 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  memmove(order + lo + 1, order + lo,
+          (items_count - 1 - lo) * sizeof(uint16_t));
+  order[lo] = index;
+}
+
+bool DirPager::add(const char *name, bool is_dir, bool known) {
+  size_t len = strlen(name);
+  if (len >= DIR_NAME_MAX ||
+      !reserve(items_count + 1, names_used + len + 1)) {
+    counters.skipped++;
+    return false;
+  }
+  Item &item = items[items_count];
+  item.name = (uint16_t)names_used;
+  memcpy(names + names_used, name, len + 1);
+  names_used += len + 1;
+  item.size = 0;
+  item.type = is_dir ? DIR_TYPE_DIR : dir_entry_type(name);
+  item.sized = is_dir;
+
+  MetaSlot *m = meta_find(path_hash(dir_path, name));
+  if (m) {
+    item.size = m->size;
+    item.type = m->type;
+    item.sized = 1;
+    counters.hits++;
+  } else if (!known) {
+    size(item); // directory or file, needed to sort
+  }
+  items_count++;
+  sized_count += item.sized;
+  insert(items_count - 1);
+  counters.listed++;
+  rev++;
+  return true;
+}
+
+bool DirPager::size(Item &item) {
+  char full[DIR_PATH_MAX + DIR_NAME_MAX];
+  const char *name = names + item.name;
+  snprintf(full, sizeof(full), has_slash(dir_path) ? "%s%s" : "%s/%s",
+           dir_path, name);
+  struct stat st;
+  counters.stats++;
+  item.sized = 1; // also when it is gone, not tried again
+  if (stat(full, &st) != 0) {
+    return false;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    item.type = DIR_TYPE_DIR;
+    item.size = 0;
+  } else {
+    item.size = (uint32_t)st.st_size;
+  }
+  meta_store(path_hash(dir_path, name), item.size, item.type);
+  return true;
+}
+
+bool DirPager::step(uint16_t max) {
+  if (dir) {
+    for (uint16_t n = 0; n < max;) {
+      struct dirent *de = readdir((DIR *)dir);
+      if (de == NULL) {
+        closedir((DIR *)dir);
+        dir = NULL;
+        rev++;
+        break;
+      }
+      if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) {
+        continue;
+      }
+#ifdef DT_DIR
+      add(de->d_name, de->d_type == DT_DIR, de->d_type != DT_UNKNOWN);
+#else
+      add(de->d_name, false, false);
+#endif
+      n++;
+    }
+    return !done();
+  }
+
+  uint16_t n = 0;
+  uint16_t start = focus_pos < items_count ? focus_pos : 0;
+  for (uint16_t k = 0; k < items_count && n < max && !done(); k++) {
+    Item &item = items[order[(start + k) % items_count]];
+    if (!item.sized) {
+      size(item);
+      sized_count++;
+      n++;
+      rev++;
+    }
+  }
+  return !done();
+}
+
+DirEntry DirPager::entry(uint16_t pos) const {
+  const Item &item = items[order[pos]];
+  DirEntry e = {names + item.name, item.size, (DirEntryType)item.type,
+                item.sized != 0};
+  return e;
+}
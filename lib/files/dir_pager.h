@@ -0,0 +1,145 @@
+#ifndef DIR_PAGER_H
+#define DIR_PAGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Directory listing read a page at a time.
+ *
+ * On FFAT every `stat` looks the name up in the directory again, so
+ * listing a directory of a few hundred extracted face files with sizes
+ * takes seconds. `step` reads the names first (one `readdir` each) and
+ * inserts them into a sorted index as they come, directories first, so
+ * the first page can be shown right away. Once all names are read, later
+ * steps fill in the sizes, starting at the entry set with `focus` (the
+ * first visible row). Size and type are kept in a cache shared by all
+ * pagers, opening a directory again needs no `stat` at all.
+ *
+ * Not thread safe, a background task calls `step` and the UI reads the
+ * entries under the same lock.
+ */
+
+#ifndef DIR_ENTRIES_MAX
+#define DIR_ENTRIES_MAX 1024
+#endif
+
+#ifndef DIR_META_SLOTS
+#define DIR_META_SLOTS 512
+#endif
+
+#define DIR_PAGE 16
+#define DIR_NAME_MAX 64 // longer names are skipped
+#define DIR_PATH_MAX 128
+
+enum DirEntryType {
+  DIR_TYPE_DIR,
+  DIR_TYPE_FACE, // .bin, .wf
+  DIR_TYPE_IMAGE,
+  DIR_TYPE_TEXT,
+  DIR_TYPE_OTHER
+};
+
+struct DirEntry {
+  const char *name; // valid until the next step
+  uint32_t size;    // bytes, 0 for directories
+  DirEntryType type;
+  bool sized; // false while the size is not read yet
+};
+
+struct DirStats {
+  uint32_t listed;  // names read
+  uint32_t stats;   // stat calls
+  uint32_t hits;    // sizes found in the cache
+  uint32_t skipped; // names too long or over DIR_ENTRIES_MAX
+};
+
+class DirPager {
+public:
+  DirPager();
+  ~DirPager();
+
+  /**
+   * Start listing a directory, the previous listing is dropped
+   * @return false if the directory cannot be opened
+   */
+  bool open(const char *path);
+  void close();
+
+  /**
+   * Read up to `max` names, or once all are read, the sizes of up to `max`
+   * entries
+   * @return false once everything is read
+   */
+  bool step(uint16_t max);
+
+  /**
+   * Sizes are read from this position on first
+   */
+  void focus(uint16_t pos) { focus_pos = pos; }
+
+  bool listed() const { return dir == NULL; }
+  bool done() const { return listed() && sized_count == items_count; }
+
+  uint16_t count() const { return items_count; }
+
+  /**
+   * Entry at a position of the sorted listing
+   */
+  DirEntry entry(uint16_t pos) const;
+
+  /**
+   * Incremented whenever entries are added, moved or sized
+   */
+  uint32_t revision() const { return rev; }
+
+  const char *path() const { return dir_path; }
+  const DirStats &stats() const { return counters; }
+
+private:
+  struct Item {
+    uint32_t size;
+    uint16_t name; // offset in `names`
+    uint8_t type;
+    uint8_t sized;
+  };
+
+  bool add(const char *name, bool is_dir, bool known);
+  bool size(Item &item);
+  void insert(uint16_t index);
+  int compare(uint16_t a, uint16_t b) const;
+  bool reserve(uint16_t items, uint32_t bytes);
+
+  void *dir; // DIR * while names are read
+  char dir_path[DIR_PATH_MAX];
+  Item *items;
+  uint16_t *order; // sorted positions into `items`
+  char *names;
+  uint16_t items_count;
+  uint16_t items_capacity;
+  uint32_t names_used;
+  uint32_t names_capacity;
+  uint16_t sized_count;
+  uint16_t focus_pos;
+  uint32_t rev;
+  DirStats counters;
+};
+
+/**
+ * Type of a file from its extension
+ */
+DirEntryType dir_entry_type(const char *name);
+
+/**
+ * Size for a list row, e.g. "152 KB", "..." while unknown
+ */
+void dir_format_size(const DirEntry &entry, char *out, size_t len);
+
+/**
+ * Drop the cached size of a file, e.g. after writing it
+ * @param path full path of the file
+ */
+void dir_meta_forget(const char *path);
+void dir_meta_clear();
+
+#endif /*DIR_PAGER_H*/
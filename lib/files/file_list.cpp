@@ -0,0 +1,214 @@
+#include "file_list.h"
+#include <stdio.h>
+#include <string.h>
+
+struct FileRow {
+  lv_obj_t *obj;
+  lv_obj_t *name;
+  lv_obj_t *detail;
+  int32_t index; // shown entry, -1 if hidden
+  // label texts are static, the rows own them
+  char name_text[DIR_NAME_MAX + 8];
+  char detail_text[16];
+};
+
+struct FileList {
+  DirPager *pager;
+  file_list_lock_cb_t lock;
+  file_list_open_cb_t open_cb;
+  char root[DIR_PATH_MAX];
+  lv_obj_t *spacer;
+  lv_timer_t *timer;
+  uint32_t rev;    // pager revision shown
+  uint16_t total;  // rows including ".."
+  uint8_t up;      // 1 if row 0 is ".."
+  uint8_t row_count;
+  FileRow rows[FILE_LIST_ROWS_MAX];
+};
+
+static void lock(FileList *f, bool on) {
+  if (f->lock) {
+    f->lock(on);
+  }
+}
+
+static void fill(FileList *f, FileRow &row, int32_t index) {
+  if (index < f->up) {
+    snprintf(row.name_text, sizeof(row.name_text), "%s", LV_SYMBOL_UP " ..");
+    row.detail_text[0] = '\0';
+  } else {
+    DirEntry e = f->pager->entry(index - f->up);
+    snprintf(row.name_text, sizeof(row.name_text), "%s %s",
+             e.type == DIR_TYPE_DIR ? LV_SYMBOL_DIRECTORY : LV_SYMBOL_FILE,
+             e.name);
+    dir_format_size(e, row.detail_text, sizeof(row.detail_text));
+  }
+  row.index = index;
+}
+
+/* Rows for the entries in view, refilled if the pager changed */
+static void sync(lv_obj_t *list, FileList *f) {
+  lv_coord_t scroll = lv_obj_get_scroll_y(list);
+  int32_t first = (scroll > 0 ? scroll : 0) / FILE_LIST_ROW_H;
+  bool changed[FILE_LIST_ROWS_MAX];
+
+  lock(f, true);
+  uint32_t rev = f->pager->revision();
+  bool refill = rev != f->rev;
+  f->rev = rev;
+  f->total = f->pager->count() + f->up;
+  f->pager->focus(first > f->up ? first - f->up : 0);
+  // a row keeps its entry while it stays in view, scrolling by one row
+  // refills one row
+  for (uint8_t k = 0; k < f->row_count; k++) {
+    int32_t index = first + k;
+    uint8_t slot = index % f->row_count;
+    FileRow &row = f->rows[slot];
+    changed[slot] = refill || row.index != index;
+    if (!changed[slot]) {
+      continue;
+    }
+    if (index < f->total) {
+      fill(f, row, index);
+    } else {
+      row.index = -1;
+    }
+  }
+  lock(f, false);
+
+  lv_obj_set_height(f->spacer, f->total * FILE_LIST_ROW_H);
+  for (uint8_t k = 0; k < f->row_count; k++) {
+    FileRow &row = f->rows[k];
+    if (!changed[k]) {
+      continue;
+    }
+    if (row.index < 0) {
+      lv_obj_add_flag(row.obj, LV_OBJ_FLAG_HIDDEN);
+      continue;
+    }
+    lv_obj_set_y(row.obj, row.index * FILE_LIST_ROW_H);
+    lv_label_set_text_static(row.name, row.name_text);
+    lv_label_set_text_static(row.detail, row.detail_text);
+    lv_obj_clear_flag(row.obj, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+static void poll_cb(lv_timer_t *timer) {
+  lv_obj_t *list = (lv_obj_t *)timer->user_data;
+  FileList *f = (FileList *)lv_obj_get_user_data(list);
+  if (f->pager->revision() != f->rev) {
+    sync(list, f);
+  }
+}
+
+static bool open_dir(lv_obj_t *list, FileList *f, const char *path) {
+  lock(f, true);
+  bool ok = f->pager->open(path);
+  f->up = strcmp(f->pager->path(), f->root) != 0;
+  lock(f, false);
+  lv_obj_scroll_to_y(list, 0, LV_ANIM_OFF);
+  sync(list, f);
+  return ok;
+}
+
+static void row_cb(lv_event_t *e) {
+  lv_obj_t *list = lv_obj_get_parent(lv_event_get_current_target(e));
+  FileList *f = (FileList *)lv_obj_get_user_data(list);
+  FileRow *row = (FileRow *)lv_event_get_user_data(e);
+  if (row->index < 0) {
+    return;
+  }
+  char path[DIR_PATH_MAX + DIR_NAME_MAX];
+  lock(f, true);
+  snprintf(path, sizeof(path), "%s", f->pager->path());
+  DirEntry entry = {"", 0, DIR_TYPE_DIR, true};
+  bool up = row->index < f->up;
+  if (!up) {
+    entry = f->pager->entry(row->index - f->up);
+    size_t n = strlen(path);
+    snprintf(path + n, sizeof(path) - n, "%s%s", n > 1 ? "/" : "",
+             entry.name);
+  }
+  lock(f, false);
+
+  if (up) {
+    char *slash = strrchr(path, '/');
+    if (slash) {
+      *(slash == path ? slash + 1 : slash) = '\0';
+    }
+    open_dir(list, f, path);
+  } else if (entry.type == DIR_TYPE_DIR) {
+    open_dir(list, f, path);
+  } else if (f->open_cb) {
+    f->open_cb(path, entry);
+  }
+}
+
+static void list_cb(lv_event_t *e) {
+  lv_obj_t *list = lv_event_get_target(e);
+  FileList *f = (FileList *)lv_obj_get_user_data(list);
+  if (lv_event_get_code(e) == LV_EVENT_SCROLL) {
+    sync(list, f);
+  } else if (lv_event_get_code(e) == LV_EVENT_DELETE) {
+    lv_timer_del(f->timer);
+    lv_mem_free(f);
+  }
+}
+
+lv_obj_t *file_list_create(lv_obj_t *parent, DirPager *pager,
+                           const char *root, file_list_lock_cb_t lock,
+                           file_list_open_cb_t open_cb) {
+  FileList *f = (FileList *)lv_mem_alloc(sizeof(FileList));
+  if (f == NULL) {
+    return NULL;
+  }
+  memset(f, 0, sizeof(FileList));
+  f->pager = pager;
+  f->lock = lock;
+  f->open_cb = open_cb;
+  snprintf(f->root, sizeof(f->root), "%s", root);
+
+  lv_obj_t *list = lv_obj_create(parent);
+  lv_obj_set_user_data(list, f);
+  lv_obj_set_size(list, LV_PCT(100), LV_PCT(100));
+  lv_obj_set_style_pad_all(list, 0, LV_PART_MAIN);
+  lv_obj_set_style_border_width(list, 0, LV_PART_MAIN);
+  lv_obj_set_scroll_dir(list, LV_DIR_VER);
+
+  // gives the list the height of all entries
+  f->spacer = lv_obj_create(list);
+  lv_obj_remove_style_all(f->spacer);
+  lv_obj_set_size(f->spacer, 1, 0);
+  lv_obj_clear_flag(f->spacer, LV_OBJ_FLAG_CLICKABLE);
+
+  lv_obj_update_layout(list);
+  lv_coord_t rows = lv_obj_get_height(list) / FILE_LIST_ROW_H + 2;
+  f->row_count = rows > FILE_LIST_ROWS_MAX ? FILE_LIST_ROWS_MAX : rows;
+  for (uint8_t k = 0; k < f->row_count; k++) {
+    FileRow &row = f->rows[k];
+    row.index = -1;
+    row.obj = lv_obj_create(list);
+    lv_obj_set_size(row.obj, LV_PCT(100), FILE_LIST_ROW_H);
+    lv_obj_set_style_radius(row.obj, 0, LV_PART_MAIN);
+    lv_obj_set_style_border_side(row.obj, LV_BORDER_SIDE_BOTTOM, LV_PART_MAIN);
+    lv_obj_clear_flag(row.obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(row.obj, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_event_cb(row.obj, row_cb, LV_EVENT_CLICKED, &row);
+    row.name = lv_label_create(row.obj);
+    lv_label_set_long_mode(row.name, LV_LABEL_LONG_CLIP);
+    lv_obj_set_width(row.name, LV_PCT(70));
+    lv_obj_align(row.name, LV_ALIGN_LEFT_MID, 0, 0);
+    row.detail = lv_label_create(row.obj);
+    lv_obj_align(row.detail, LV_ALIGN_RIGHT_MID, 0, 0);
+  }
+
+  lv_obj_add_event_cb(list, list_cb, LV_EVENT_SCROLL, NULL);
+  lv_obj_add_event_cb(list, list_cb, LV_EVENT_DELETE, NULL);
+  f->timer = lv_timer_create(poll_cb, FILE_LIST_POLL_MS, list);
+  f->rev = pager->revision() - 1; // filled on the first poll
+  return list;
+}
+
+bool file_list_open(lv_obj_t *list, const char *path) {
+  return open_dir(list, (FileList *)lv_obj_get_user_data(list), path);
+}
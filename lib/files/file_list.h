@@ -0,0 +1,55 @@
+#ifndef FILE_LIST_H
+#define FILE_LIST_H
+
+#include <lvgl.h>
+
+#include "dir_pager.h"
+
+/**
+ * File browser list over a DirPager.
+ *
+ * Only enough rows to fill the list are created, a spacer gives the list
+ * the height of all entries and on scroll the rows are moved and filled
+ * with the entries that came into view. While the pager is still reading
+ * (from a background task or a timer), the list polls its revision and
+ * refills the visible rows, so the first page shows as soon as it is read.
+ * Clicking a directory opens it in the same list, ".." goes back up.
+ */
+
+#ifndef FILE_LIST_ROW_H
+#define FILE_LIST_ROW_H 40
+#endif
+
+#define FILE_LIST_ROWS_MAX 16
+#define FILE_LIST_POLL_MS 50
+
+/**
+ * Lock around every pager call, for a pager stepped by another task
+ * @param lock true to take the lock, false to release it
+ */
+typedef void (*file_list_lock_cb_t)(bool lock);
+
+/**
+ * A file was clicked
+ * @param path full path of the file
+ */
+typedef void (*file_list_open_cb_t)(const char *path, const DirEntry &entry);
+
+/**
+ * @param parent the list fills its content area
+ * @param pager pager to show, `file_list_open` starts it
+ * @param root directory the user cannot go above
+ * @param lock NULL if the pager is stepped on the LVGL thread
+ * @param open_cb called when a file is clicked, can be NULL
+ */
+lv_obj_t *file_list_create(lv_obj_t *parent, DirPager *pager,
+                           const char *root, file_list_lock_cb_t lock,
+                           file_list_open_cb_t open_cb);
+
+/**
+ * Show a directory, the pager starts reading it
+ * @return false if it cannot be opened
+ */
+bool file_list_open(lv_obj_t *list, const char *path);
+
+#endif /*FILE_LIST_H*/
@@ -0,0 +1,80 @@
+#include "blit.h"
+#include <string.h>
+
+/* Clip a rectangle to the framebuffer, returns false if nothing is left.
+ * sx/sy give the offset of the first visible pixel inside the source */
+static bool clip(const Framebuffer &fb, int16_t &x, int16_t &y, int16_t &w,
+                 int16_t &h, int16_t &sx, int16_t &sy) {
+  sx = 0;
+  sy = 0;
+  if (x < 0) {
+    sx = -x;
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    sy = -y;
+    h += y;
+    y = 0;
+  }
+  if (x + w > fb.width) {
+    w = fb.width - x;
+  }
+  if (y + h > fb.height) {
+    h = fb.height - y;
+  }
+  return w > 0 && h > 0;
+}
+
+void blit_fill(const Framebuffer &fb, int16_t x, int16_t y, int16_t w,
+               int16_t h, uint16_t color) {
+  int16_t sx, sy;
+  if (!clip(fb, x, y, w, h, sx, sy)) {
+    return;
+  }
+  uint16_t *row = fb.pixels + (int32_t)y * fb.width + x;
+  for (int16_t j = 0; j < h; j++) {
+    if (j == 0) {
+      for (int16_t i = 0; i < w; i++) {
+        row[i] = color;
+      }
+    } else {
+      memcpy(row, row - fb.width * j, w * sizeof(uint16_t));
+    }
+    row += fb.width;
+  }
+}
+
+void blit_sprite(const Framebuffer &fb, int16_t x, int16_t y,
+                 const uint16_t *sprite, int16_t w, int16_t h, uint16_t key) {
+  int16_t stride = w, sx, sy;
+  if (!clip(fb, x, y, w, h, sx, sy)) {
+    return;
+  }
+  const uint16_t *src = sprite + (int32_t)sy * stride + sx;
+  uint16_t *dst = fb.pixels + (int32_t)y * fb.width + x;
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++) {
+      if (src[i] != key) {
+        dst[i] = src[i];
+      }
+    }
+    src += stride;
+    dst += fb.width;
+  }
+}
+
+void blit_copy(const Framebuffer &fb, int16_t x, int16_t y,
+               const uint16_t *sprite, int16_t w, int16_t h) {
+  int16_t stride = w, sx, sy;
+  if (!clip(fb, x, y, w, h, sx, sy)) {
+    return;
+  }
+  const uint16_t *src = sprite + (int32_t)sy * stride + sx;
+  uint16_t *dst = fb.pixels + (int32_t)y * fb.width + x;
+  for (int16_t j = 0; j < h; j++) {
+    memcpy(dst, src, w * sizeof(uint16_t));
+    src += stride;
+    dst += fb.width;
+  }
+}
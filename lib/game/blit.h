@@ -0,0 +1,33 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+#include <stdint.h>
+
+/**
+ * RGB565 draw kernels for software rendered canvases.
+ * Colors are raw 16 bit values in the framebuffer byte order
+ * (`lv_color_t.full`). Every call clips to the framebuffer.
+ */
+
+struct Framebuffer {
+  uint16_t *pixels;
+  int16_t width;
+  int16_t height;
+};
+
+void blit_fill(const Framebuffer &fb, int16_t x, int16_t y, int16_t w,
+               int16_t h, uint16_t color);
+
+/**
+ * Copy a sprite, pixels equal to `key` are skipped
+ */
+void blit_sprite(const Framebuffer &fb, int16_t x, int16_t y,
+                 const uint16_t *sprite, int16_t w, int16_t h, uint16_t key);
+
+/**
+ * Copy a sprite without transparency
+ */
+void blit_copy(const Framebuffer &fb, int16_t x, int16_t y,
+               const uint16_t *sprite, int16_t w, int16_t h);
+
+#endif /*BLIT_H*/
@@ -0,0 +1,111 @@
+#include "game_loop.h"
+
+InputQueue::InputQueue() : head(0), tail(0) {}
+
+bool InputQueue::push(GameInput input) {
+  uint8_t next = (head + 1) % SIZE;
+  if (next == tail) {
+    return false; // full, drop
+  }
+  items[head] = input;
+  head = next;
+  return true;
+}
+
+bool InputQueue::pop(GameInput &input) {
+  if (tail == head) {
+    return false;
+  }
+  input = items[tail];
+  tail = (tail + 1) % SIZE;
+  return true;
+}
+
+void InputQueue::clear() { tail = head; }
+
+DirtyRects::DirtyRects() : num(0) {}
+
+static bool overlaps(const GameRect &a, const GameRect &b) {
+  return a.x1 <= b.x2 + 1 && b.x1 <= a.x2 + 1 && a.y1 <= b.y2 + 1 &&
+         b.y1 <= a.y2 + 1;
+}
+
+static void join(GameRect &a, const GameRect &b) {
+  if (b.x1 < a.x1)
+    a.x1 = b.x1;
+  if (b.y1 < a.y1)
+    a.y1 = b.y1;
+  if (b.x2 > a.x2)
+    a.x2 = b.x2;
+  if (b.y2 > a.y2)
+    a.y2 = b.y2;
+}
+
+void DirtyRects::add(const GameRect &rect) {
+  if (rect.x2 < rect.x1 || rect.y2 < rect.y1) {
+    return;
+  }
+  GameRect r = rect;
+  // absorb every rectangle touching the new one
+  for (uint8_t i = 0; i < num;) {
+    if (overlaps(rects[i], r)) {
+      join(r, rects[i]);
+      rects[i] = rects[--num];
+      i = 0;
+    } else {
+      i++;
+    }
+  }
+  if (num == MAX) {
+    for (uint8_t i = 1; i < num; i++) {
+      join(rects[0], rects[i]);
+    }
+    join(rects[0], r);
+    num = 1;
+    return;
+  }
+  rects[num++] = r;
+}
+
+uint32_t DirtyRects::area() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < num; i++) {
+    total += (uint32_t)(rects[i].x2 - rects[i].x1 + 1) *
+             (rects[i].y2 - rects[i].y1 + 1);
+  }
+  return total;
+}
+
+GameLoop::GameLoop(uint32_t step_ms)
+    : step_ms(step_ms), last(0), accumulator(0), last_frame(0), skipped(0) {
+  stats.reset();
+}
+
+void GameLoop::begin(uint32_t now) {
+  last = now;
+  last_frame = now;
+  accumulator = 0;
+  skipped = 0;
+  stats.reset();
+}
+
+uint32_t GameLoop::advance(uint32_t now) {
+  accumulator += now - last;
+  last = now;
+
+  uint32_t steps = accumulator / step_ms;
+  if (steps == 0) {
+    return 0;
+  }
+  if (steps > GAME_MAX_STEPS) {
+    skipped += steps - GAME_MAX_STEPS;
+    steps = GAME_MAX_STEPS;
+    accumulator = 0;
+  } else {
+    accumulator -= steps * step_ms;
+  }
+
+  stats.add(now - last_frame);
+  last_frame = now;
+  return steps;
+}
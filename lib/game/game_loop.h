@@ -0,0 +1,100 @@
+#ifndef GAME_LOOP_H
+#define GAME_LOOP_H
+
+#include <stdint.h>
+
+#include "frame_stats.h"
+
+/**
+ * Fixed timestep game loop shared by the esp32 and native HALs.
+ * `advance` is called from hal_loop with the current time and returns how
+ * many fixed steps to simulate, the game renders once when it is not 0.
+ * Catch up is capped so a slow frame never stalls the watch UI.
+ */
+
+#ifndef GAME_STEP_MS
+#define GAME_STEP_MS 20
+#endif
+
+#ifndef GAME_MAX_STEPS
+#define GAME_MAX_STEPS 4
+#endif
+
+enum GameInput : uint8_t {
+  GAME_INPUT_NONE,
+  GAME_INPUT_LEFT,
+  GAME_INPUT_RIGHT,
+  GAME_INPUT_PRESS,
+};
+
+/**
+ * Single producer (touch/event), single consumer (game update) ring buffer
+ */
+class InputQueue {
+public:
+  InputQueue();
+  bool push(GameInput input);
+  bool pop(GameInput &input);
+  void clear();
+
+private:
+  static const uint8_t SIZE = 16;
+  GameInput items[SIZE];
+  volatile uint8_t head;
+  volatile uint8_t tail;
+};
+
+struct GameRect {
+  int16_t x1, y1, x2, y2; // inclusive
+};
+
+/**
+ * Areas changed by the last render. Overlapping rectangles are merged,
+ * when the list is full everything collapses into one bounding box.
+ */
+class DirtyRects {
+public:
+  static const uint8_t MAX = 8;
+
+  DirtyRects();
+  void add(const GameRect &rect);
+  void clear() { num = 0; }
+  uint8_t count() const { return num; }
+  const GameRect &operator[](uint8_t i) const { return rects[i]; }
+  uint32_t area() const;
+
+private:
+  GameRect rects[MAX];
+  uint8_t num;
+};
+
+class GameLoop {
+public:
+  GameLoop(uint32_t step_ms = GAME_STEP_MS);
+
+  void begin(uint32_t now);
+
+  /**
+   * @param now current time in ms
+   * @return number of fixed steps to simulate before rendering
+   */
+  uint32_t advance(uint32_t now);
+
+  uint32_t step() const { return step_ms; }
+
+  /**
+   * Time between rendered frames
+   */
+  const FrameStats &frames() const { return stats; }
+  uint32_t dropped() const { return skipped; }
+
+private:
+  uint32_t step_ms;
+  uint32_t last;
+  uint32_t accumulator;
+  uint32_t last_frame;
+  uint32_t skipped;
+  FrameStats stats;
+};
+
+#endif /*GAME_LOOP_H*/
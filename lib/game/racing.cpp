@@ -0,0 +1,324 @@
+#include "racing.h"
+#include "blit.h"
+#include <stdlib.h>
+
+#define LANES 3
+#define LANE_W (RACING_WIDTH / LANES)
+#define CAR_W 24
+#define CAR_H 36
+#define MARKER_W 2
+#define MARKER_H 16
+#define MARKER_GAP 16
+#define MAX_CARS 4
+#define SPAWN_STEPS 40
+#define START_SPEED 3
+#define MAX_SPEED 8
+#define PLAYER_Y (RACING_HEIGHT - CAR_H - 8)
+
+struct Car {
+  int16_t x, y;   // position this frame
+  int16_t px, py; // position drawn last frame
+  uint16_t color;
+  bool active;
+  bool drawn;
+  bool repaint; // drawn again in place, e.g. in another color
+};
+
+static struct {
+  lv_obj_t *canvas;
+  uint16_t *pixels;
+  Framebuffer fb;
+  GameLoop loop;
+  InputQueue input;
+  DirtyRects dirty;
+  Car player;
+  Car cars[MAX_CARS];
+  uint8_t lane;
+  int16_t marker;
+  int16_t speed;
+  uint16_t spawn;
+  uint32_t score;
+  uint32_t seed;
+  bool crashed;
+  bool redraw;
+  uint16_t road, line, body, enemy, crash;
+} game;
+
+static uint32_t next_random() {
+  game.seed = game.seed * 1103515245 + 12345;
+  return game.seed >> 16;
+}
+
+static int16_t lane_x(uint8_t lane) {
+  return lane * LANE_W + (LANE_W - CAR_W) / 2;
+}
+
+static void reset() {
+  game.lane = LANES / 2;
+  game.player.x = lane_x(game.lane);
+  game.player.y = PLAYER_Y;
+  game.player.color = game.body;
+  game.player.active = true;
+  game.player.drawn = false;
+  for (int i = 0; i < MAX_CARS; i++) {
+    game.cars[i].active = false;
+    game.cars[i].drawn = false;
+  }
+  game.marker = 0;
+  game.speed = START_SPEED;
+  game.spawn = 0;
+  game.score = 0;
+  game.crashed = false;
+  game.redraw = true;
+  game.input.clear();
+}
+
+static bool collides(const Car &a, const Car &b) {
+  return a.x < b.x + CAR_W && b.x < a.x + CAR_W && a.y < b.y + CAR_H &&
+         b.y < a.y + CAR_H;
+}
+
+static void spawn_car() {
+  for (int i = 0; i < MAX_CARS; i++) {
+    Car &c = game.cars[i];
+    if (!c.active) {
+      c.x = lane_x(next_random() % LANES);
+      c.y = -CAR_H;
+      c.color = game.enemy;
+      c.active = true;
+      return;
+    }
+  }
+}
+
+static void step() {
+  GameInput in;
+  while (game.input.pop(in)) {
+    if (game.crashed) {
+      if (in == GAME_INPUT_PRESS) {
+        reset();
+      }
+    } else if (in == GAME_INPUT_LEFT && game.lane > 0) {
+      game.lane--;
+    } else if (in == GAME_INPUT_RIGHT && game.lane < LANES - 1) {
+      game.lane++;
+    }
+  }
+  if (game.crashed) {
+    return;
+  }
+
+  game.marker = (game.marker + game.speed) % (MARKER_H + MARKER_GAP);
+
+  int16_t target = lane_x(game.lane);
+  int16_t dx = target - game.player.x;
+  if (dx > 6)
+    dx = 6;
+  if (dx < -6)
+    dx = -6;
+  game.player.x += dx;
+
+  if (++game.spawn >= SPAWN_STEPS - game.speed * 2) {
+    game.spawn = 0;
+    spawn_car();
+  }
+
+  for (int i = 0; i < MAX_CARS; i++) {
+    Car &c = game.cars[i];
+    if (!c.active) {
+      continue;
+    }
+    c.y += game.speed;
+    if (c.y >= RACING_HEIGHT) {
+      c.active = false;
+      game.score++;
+      if (game.score % 10 == 0 && game.speed < MAX_SPEED) {
+        game.speed++;
+      }
+    } else if (collides(c, game.player)) {
+      game.crashed = true;
+      game.player.color = game.crash;
+      game.player.repaint = true; // crash color, the old frame is erased
+    }
+  }
+}
+
+static void draw_markers() {
+  for (int l = 1; l < LANES; l++) {
+    int16_t x = l * LANE_W - MARKER_W / 2;
+    blit_fill(game.fb, x, 0, MARKER_W, RACING_HEIGHT, game.road);
+    for (int16_t y = game.marker - MARKER_GAP; y < RACING_HEIGHT;
+         y += MARKER_H + MARKER_GAP) {
+      blit_fill(game.fb, x, y, MARKER_W, MARKER_H, game.line);
+    }
+    GameRect r = {x, 0, (int16_t)(x + MARKER_W - 1), RACING_HEIGHT - 1};
+    game.dirty.add(r);
+  }
+}
+
+static void draw_car(const Car &c) {
+  blit_fill(game.fb, c.x, c.y, CAR_W, CAR_H, c.color);
+  // windshield
+  blit_fill(game.fb, c.x + 4, c.y + 8, CAR_W - 8, 6, game.line);
+}
+
+static void mark(int16_t x, int16_t y) {
+  GameRect r = {x, y, (int16_t)(x + CAR_W - 1), (int16_t)(y + CAR_H - 1)};
+  if (r.y1 < 0)
+    r.y1 = 0;
+  if (r.y2 >= RACING_HEIGHT)
+    r.y2 = RACING_HEIGHT - 1;
+  game.dirty.add(r);
+}
+
+/* Erase a car where it was drawn if it moved or left the road */
+static void erase_car(Car &c) {
+  if (c.drawn && (!c.active || c.x != c.px || c.y != c.py)) {
+    blit_fill(game.fb, c.px, c.py, CAR_W, CAR_H, game.road);
+    mark(c.px, c.py);
+    c.drawn = false;
+  }
+}
+
+/* The markers are repainted every frame, a car across one is drawn again */
+static bool on_marker(const Car &c) {
+  for (int l = 1; l < LANES; l++) {
+    int16_t x = l * LANE_W - MARKER_W / 2;
+    if (c.x < x + MARKER_W && x < c.x + CAR_W) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void place_car(Car &c) {
+  if (c.active && (!c.drawn || c.repaint || on_marker(c))) {
+    c.repaint = false;
+    draw_car(c);
+    mark(c.x, c.y);
+    c.px = c.x;
+    c.py = c.y;
+    c.drawn = true;
+  }
+}
+
+static void render() {
+  game.dirty.clear();
+
+  if (game.redraw) {
+    blit_fill(game.fb, 0, 0, RACING_WIDTH, RACING_HEIGHT, game.road);
+    for (int i = 0; i < MAX_CARS; i++) {
+      game.cars[i].drawn = false;
+    }
+    game.player.drawn = false;
+    game.redraw = false;
+  }
+
+  // erase, then markers, then cars so the cars stay on top
+  for (int i = 0; i < MAX_CARS; i++) {
+    erase_car(game.cars[i]);
+  }
+  erase_car(game.player);
+  draw_markers();
+  for (int i = 0; i < MAX_CARS; i++) {
+    place_car(game.cars[i]);
+  }
+  place_car(game.player);
+
+  lv_area_t coords;
+  lv_obj_get_coords(game.canvas, &coords);
+  for (uint8_t i = 0; i < game.dirty.count(); i++) {
+    const GameRect &r = game.dirty[i];
+    lv_area_t a = {(lv_coord_t)(coords.x1 + r.x1), (lv_coord_t)(coords.y1 + r.y1),
+                   (lv_coord_t)(coords.x1 + r.x2), (lv_coord_t)(coords.y1 + r.y2)};
+    lv_obj_invalidate_area(game.canvas, &a);
+  }
+}
+
+static void touch_cb(lv_event_t *e) {
+  lv_point_t p;
+  lv_area_t coords;
+  lv_indev_get_point(lv_indev_get_act(), &p);
+  lv_obj_get_coords(game.canvas, &coords);
+
+  if (game.crashed) {
+    game.input.push(GAME_INPUT_PRESS);
+  } else if (p.x - coords.x1 < RACING_WIDTH / 2) {
+    game.input.push(GAME_INPUT_LEFT);
+  } else {
+    game.input.push(GAME_INPUT_RIGHT);
+  }
+}
+
+static void delete_cb(lv_event_t *e) {
+  game.canvas = NULL;
+  racing_close();
+}
+
+bool racing_open(lv_obj_t *parent) {
+  racing_close();
+
+  game.pixels =
+      (uint16_t *)malloc(RACING_WIDTH * RACING_HEIGHT * sizeof(lv_color_t));
+  if (game.pixels == NULL) {
+    LV_LOG_WARN("racing: no memory for the framebuffer");
+    return false;
+  }
+  game.fb.pixels = game.pixels;
+  game.fb.width = RACING_WIDTH;
+  game.fb.height = RACING_HEIGHT;
+
+  game.road = lv_color_hex(0x404040).full;
+  game.line = lv_color_hex(0xFFFFFF).full;
+  game.body = lv_color_hex(0xE53935).full;
+  game.enemy = lv_color_hex(0x1E88E5).full;
+  game.crash = lv_color_hex(0xFDD835).full;
+  game.seed = lv_tick_get();
+
+  game.canvas = lv_canvas_create(parent);
+  lv_canvas_set_buffer(game.canvas, game.pixels, RACING_WIDTH, RACING_HEIGHT,
+                       LV_IMG_CF_TRUE_COLOR);
+  lv_obj_center(game.canvas);
+  lv_obj_add_flag(game.canvas, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_add_event_cb(game.canvas, touch_cb, LV_EVENT_PRESSED, NULL);
+  lv_obj_add_event_cb(game.canvas, delete_cb, LV_EVENT_DELETE, NULL);
+
+  reset();
+  render();
+  game.loop.begin(lv_tick_get());
+  return true;
+}
+
+void racing_close() {
+  if (game.canvas) {
+    lv_obj_t *canvas = game.canvas;
+    game.canvas = NULL;
+    lv_obj_del(canvas); // delete_cb comes back here with canvas NULL
+  }
+  if (game.pixels) {
+    free(game.pixels);
+    game.pixels = NULL;
+  }
+}
+
+bool racing_running() { return game.canvas != NULL; }
+
+void racing_update(uint32_t now) {
+  if (!racing_running()) {
+    return;
+  }
+  uint32_t steps = game.loop.advance(now);
+  if (steps == 0) {
+    return;
+  }
+  while (steps--) {
+    step();
+  }
+  render();
+}
+
+bool racing_input(GameInput input) { return game.input.push(input); }
+
+const GameLoop &racing_loop() { return game.loop; }
+
+uint32_t racing_score() { return game.score; }
@@ -0,0 +1,37 @@
+#ifndef RACING_H
+#define RACING_H
+
+#include <lvgl.h>
+
+#include "game_loop.h"
+
+/**
+ * Racing game, software rendered into an lv_canvas.
+ * Only the areas that changed in a frame are invalidated, so LVGL flushes
+ * the moving cars and lane markers instead of the whole playfield.
+ */
+
+#define RACING_WIDTH 144
+#define RACING_HEIGHT 180
+
+/**
+ * Start the game on a screen
+ * @param parent object holding the canvas
+ * @return false if the framebuffer could not be allocated
+ */
+bool racing_open(lv_obj_t *parent);
+void racing_close();
+bool racing_running();
+
+/**
+ * Run the fixed steps due and render, call from hal_loop
+ * @param now current time in ms
+ */
+void racing_update(uint32_t now);
+
+bool racing_input(GameInput input);
+
+const GameLoop &racing_loop();
+uint32_t racing_score();
+
+#endif /*RACING_H*/
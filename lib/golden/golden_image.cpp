@@ -0,0 +1,151 @@
+#include "golden_image.h"
+#include <stdio.h>
+#include <string.h>
+
+#define GOLDEN_MAGIC 0x35363547 // "G565"
+
+struct GoldenHeader {
+  uint32_t magic;
+  uint16_t width;
+  uint16_t height;
+};
+
+static inline uint16_t native(uint16_t c, bool swapped) {
+  return swapped ? (uint16_t)((c >> 8) | (c << 8)) : c;
+}
+
+/**
+ * Expand RGB565 to 8 bit channels
+ */
+static inline void rgb888(uint16_t c, uint8_t rgb[3]) {
+  uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+  rgb[0] = (r << 3) | (r >> 2);
+  rgb[1] = (g << 2) | (g >> 4);
+  rgb[2] = (b << 3) | (b >> 2);
+}
+
+static uint8_t delta(uint16_t a, uint16_t b) {
+  uint8_t ca[3], cb[3];
+  rgb888(a, ca);
+  rgb888(b, cb);
+  uint8_t d = 0;
+  for (int i = 0; i < 3; i++) {
+    uint8_t c = ca[i] > cb[i] ? ca[i] - cb[i] : cb[i] - ca[i];
+    if (c > d) {
+      d = c;
+    }
+  }
+  return d;
+}
+
+GoldenResult golden_compare(const uint16_t *actual, const uint16_t *expected,
+                            uint16_t width, uint16_t height,
+                            const GoldenTolerance &tolerance, bool swapped) {
+  GoldenResult r;
+  memset(&r, 0, sizeof(r));
+  for (uint16_t y = 0; y < height; y++) {
+    const uint16_t *a = actual + (uint32_t)y * width;
+    const uint16_t *e = expected + (uint32_t)y * width;
+    if (memcmp(a, e, width * sizeof(uint16_t)) == 0) {
+      continue; // most rows are identical
+    }
+    for (uint16_t x = 0; x < width; x++) {
+      if (a[x] == e[x]) {
+        continue;
+      }
+      uint8_t d = delta(native(a[x], swapped), native(e[x], swapped));
+      if (d > r.max_delta) {
+        r.max_delta = d;
+      }
+      if (d <= tolerance.channel) {
+        continue;
+      }
+      r.differing++;
+      if (r.differing == 1) {
+        r.x1 = r.x2 = x;
+        r.y1 = r.y2 = y;
+      }
+      r.x1 = x < r.x1 ? x : r.x1;
+      r.x2 = x > r.x2 ? x : r.x2;
+      r.y2 = y; // rows are scanned in order
+    }
+  }
+  r.match = r.differing <= tolerance.max_pixels;
+  return r;
+}
+
+bool golden_save(const char *path, const uint16_t *pixels, uint16_t width,
+                 uint16_t height, bool swapped) {
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    return false;
+  }
+  GoldenHeader h = {GOLDEN_MAGIC, width, height};
+  bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+  uint16_t row[512];
+  for (uint16_t y = 0; ok && y < height; y++) {
+    for (uint16_t x = 0; x < width; x += 512) {
+      uint16_t n = width - x < 512 ? width - x : 512;
+      for (uint16_t i = 0; i < n; i++) {
+        row[i] = native(pixels[(uint32_t)y * width + x + i], swapped);
+      }
+      ok = ok && fwrite(row, sizeof(uint16_t), n, f) == n;
+    }
+  }
+  return fclose(f) == 0 && ok;
+}
+
+bool golden_load(const char *path, uint16_t *pixels, uint32_t max_pixels,
+                 uint16_t *width, uint16_t *height, bool swapped) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    return false;
+  }
+  GoldenHeader h;
+  uint32_t count = 0;
+  bool ok = fread(&h, sizeof(h), 1, f) == 1 && h.magic == GOLDEN_MAGIC;
+  if (ok) {
+    count = (uint32_t)h.width * h.height;
+    ok = count <= max_pixels &&
+         fread(pixels, sizeof(uint16_t), count, f) == count;
+  }
+  fclose(f);
+  if (!ok) {
+    return false;
+  }
+  for (uint32_t i = 0; swapped && i < count; i++) {
+    pixels[i] = native(pixels[i], true);
+  }
+  *width = h.width;
+  *height = h.height;
+  return true;
+}
+
+bool golden_save_diff(const char *path, const uint16_t *actual,
+                      const uint16_t *expected, uint16_t width,
+                      uint16_t height, const GoldenTolerance &tolerance,
+                      bool swapped) {
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    return false;
+  }
+  fprintf(f, "P6\n%u %u\n255\n", (unsigned)width, (unsigned)height);
+  uint32_t count = (uint32_t)width * height;
+  bool ok = true;
+  for (uint32_t i = 0; ok && i < count; i++) {
+    uint16_t a = native(actual[i], swapped), e = native(expected[i], swapped);
+    uint8_t rgb[3];
+    if (a != e && delta(a, e) > tolerance.channel) {
+      rgb[0] = 255;
+      rgb[1] = 0;
+      rgb[2] = 0;
+    } else {
+      rgb888(e, rgb);
+      for (int c = 0; c < 3; c++) {
+        rgb[c] /= 3;
+      }
+    }
+    ok = fwrite(rgb, 1, 3, f) == 3;
+  }
+  return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,60 @@
+#ifndef GOLDEN_IMAGE_H
+#define GOLDEN_IMAGE_H
+
+#include <stdint.h>
+
+/**
+ * Reference image comparison for rendering checks.
+ *
+ * Images are RGB565 framebuffers. References are stored as a small header
+ * and the pixels in plain RGB565 (little endian), `swapped` converts from
+ * and to the LV_COLOR_16_SWAP framebuffer order, so the same references
+ * work for both byte orders.
+ */
+
+struct GoldenTolerance {
+  uint8_t channel;     // allowed difference per channel, 0 - 255 scale
+  uint32_t max_pixels; // pixels allowed past `channel`
+};
+
+struct GoldenResult {
+  bool match;
+  uint32_t differing; // pixels past the channel tolerance
+  uint8_t max_delta;  // largest channel difference, 0 - 255 scale
+  // bounding box of the differing pixels, valid if `differing`
+  int16_t x1, y1, x2, y2;
+};
+
+/**
+ * @param actual rendered image
+ * @param expected reference
+ * @param swapped both buffers use the swapped byte order
+ */
+GoldenResult golden_compare(const uint16_t *actual, const uint16_t *expected,
+                            uint16_t width, uint16_t height,
+                            const GoldenTolerance &tolerance, bool swapped);
+
+/**
+ * Write a reference file
+ */
+bool golden_save(const char *path, const uint16_t *pixels, uint16_t width,
+                 uint16_t height, bool swapped);
+
+/**
+ * Read a reference file
+ * @param pixels destination of `max_pixels` entries
+ * @return false if missing, damaged or larger than `max_pixels`
+ */
+bool golden_load(const char *path, uint16_t *pixels, uint32_t max_pixels,
+                 uint16_t *width, uint16_t *height, bool swapped);
+
+/**
+ * Write a PPM showing the reference dimmed and the differing pixels red,
+ * to look at a failure with any image viewer
+ */
+bool golden_save_diff(const char *path, const uint16_t *actual,
+                      const uint16_t *expected, uint16_t width,
+                      uint16_t height, const GoldenTolerance &tolerance,
+                      bool swapped);
+
+#endif /*GOLDEN_IMAGE_H*/
@@ -0,0 +1,437 @@
+#include "analog_hands.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#endif
+
+/* sin(step * 3 deg), Q14, first quadrant */
+static const int16_t sin_table[HAND_STEPS / 4 + 1] = {
+    0,     857,   1713,  2563,  3406,  4240,  5063,  5872,
+    6664,  7438,  8192,  8923,  9630,  10311, 10963, 11585,
+    12176, 12733, 13255, 13741, 14189, 14598, 14968, 15296,
+    15582, 15826, 16026, 16182, 16294, 16362, 16384};
+
+struct RotatedFrame {
+  uint8_t *buf; // LV_IMG_CF_TRUE_COLOR_ALPHA
+  int16_t ox, oy; // top left corner relative to the centre
+  uint16_t w, h;
+  uint32_t used;
+};
+
+struct hand_t {
+  bool used;
+  HandMode mode;
+  HandConfig cfg;
+  lv_obj_t *obj;
+  uint16_t step;
+  bool placed;
+  lv_area_t area; // current box in parent coordinates
+  lv_point_t points[2];
+  RotatedFrame *table; // HAND_STEPS frames, table mode
+  lv_img_dsc_t dsc;    // displayed frame, table mode
+  uint32_t cache_used; // bytes of `table`, at most HANDS_CACHE_SIZE
+};
+
+static hand_t hands[HANDS_MAX];
+static HandStats stats;
+static uint32_t use_counter;
+
+int32_t hand_sin(uint16_t step) {
+  step %= HAND_STEPS;
+  const uint16_t q = HAND_STEPS / 4;
+  if (step <= q) {
+    return sin_table[step];
+  } else if (step <= 2 * q) {
+    return sin_table[2 * q - step];
+  } else if (step <= 3 * q) {
+    return -sin_table[step - 2 * q];
+  }
+  return -sin_table[HAND_STEPS - step];
+}
+
+int32_t hand_cos(uint16_t step) { return hand_sin(step + HAND_STEPS / 4); }
+
+static void *alloc_frame(uint32_t size) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (psramFound()) {
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+  }
+  return heap_caps_malloc(size, MALLOC_CAP_8BIT);
+#else
+  return malloc(size);
+#endif
+}
+
+static uint32_t area_size(const lv_area_t &a) {
+  return (uint32_t)(a.x2 - a.x1 + 1) * (a.y2 - a.y1 + 1);
+}
+
+/**
+ * Bounding box of the image rotated around its pivot, relative to the pivot
+ */
+static void rotated_box(const HandConfig &cfg, uint16_t step, lv_area_t *box) {
+  int32_t s = hand_sin(step), c = hand_cos(step);
+  int32_t xs[2] = {-cfg.pivot_x, cfg.img->header.w - cfg.pivot_x};
+  int32_t ys[2] = {-cfg.pivot_y, cfg.img->header.h - cfg.pivot_y};
+  int32_t x1 = INT32_MAX, y1 = INT32_MAX, x2 = INT32_MIN, y2 = INT32_MIN;
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      int32_t x = xs[i] * c - ys[j] * s;
+      int32_t y = xs[i] * s + ys[j] * c;
+      x1 = LV_MIN(x1, x);
+      y1 = LV_MIN(y1, y);
+      x2 = LV_MAX(x2, x);
+      y2 = LV_MAX(y2, y);
+    }
+  }
+  box->x1 = x1 >> 14;
+  box->y1 = y1 >> 14;
+  box->x2 = (x2 + 16383) >> 14;
+  box->y2 = (y2 + 16383) >> 14;
+}
+
+static uint32_t frame_size(const HandConfig &cfg, uint16_t step) {
+  lv_area_t box;
+  rotated_box(cfg, step, &box);
+  return (uint32_t)(box.x2 - box.x1) * (box.y2 - box.y1) *
+         LV_IMG_PX_SIZE_ALPHA_BYTE;
+}
+
+/**
+ * Cache a table hand needs at least: the displayed frame and the next one,
+ * at the angle with the largest box
+ */
+static uint32_t table_minimum(const HandConfig &cfg) {
+  uint32_t largest = 0;
+  for (uint16_t step = 0; step < HAND_STEPS; step++) {
+    largest = LV_MAX(largest, frame_size(cfg, step));
+  }
+  return 2 * largest;
+}
+
+static uint32_t release_frames(hand_t *only, uint32_t bytes);
+
+/**
+ * Rotate the hand image into a new frame, nearest neighbour.
+ * Source pixels are sampled at the centre of each destination pixel.
+ */
+static bool render_frame(hand_t *hand, uint16_t step, RotatedFrame *f) {
+  const lv_img_dsc_t *img = hand->cfg.img;
+  const uint8_t src_px = img->header.cf == LV_IMG_CF_TRUE_COLOR_ALPHA
+                             ? LV_IMG_PX_SIZE_ALPHA_BYTE
+                             : sizeof(lv_color_t);
+  lv_area_t box;
+  rotated_box(hand->cfg, step, &box);
+
+  f->ox = box.x1;
+  f->oy = box.y1;
+  f->w = box.x2 - box.x1;
+  f->h = box.y2 - box.y1;
+  uint32_t size = frame_size(hand->cfg, step);
+  if (size == 0) {
+    return false;
+  }
+
+  if (hand->cache_used + size > HANDS_CACHE_SIZE) {
+    release_frames(hand, hand->cache_used + size - HANDS_CACHE_SIZE);
+  }
+  f->buf = (uint8_t *)alloc_frame(size);
+  if (f->buf == NULL) {
+    return false;
+  }
+  hand->cache_used += size;
+  stats.cache_used += size;
+
+  int32_t s = hand_sin(step), c = hand_cos(step);
+  const int32_t sw = img->header.w, sh = img->header.h;
+  uint8_t *dst = f->buf;
+  for (int32_t y = 0; y < f->h; y++) {
+    int32_t dy = 2 * (f->oy + y) + 1;
+    for (int32_t x = 0; x < f->w; x++) {
+      int32_t dx = 2 * (f->ox + x) + 1;
+      // inverse rotation, Q14 after the halving
+      int32_t sx = ((dx * c + dy * s) >> 15) + hand->cfg.pivot_x;
+      int32_t sy = ((dy * c - dx * s) >> 15) + hand->cfg.pivot_y;
+      if (sx < 0 || sy < 0 || sx >= sw || sy >= sh) {
+        memset(dst, 0, LV_IMG_PX_SIZE_ALPHA_BYTE);
+      } else {
+        const uint8_t *p = img->data + (sy * sw + sx) * src_px;
+        memcpy(dst, p, sizeof(lv_color_t));
+        dst[LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = src_px == LV_IMG_PX_SIZE_ALPHA_BYTE
+                                                 ? p[src_px - 1]
+                                                 : (uint8_t)LV_OPA_COVER;
+      }
+      dst += LV_IMG_PX_SIZE_ALPHA_BYTE;
+    }
+  }
+  return true;
+}
+
+static void free_frame(hand_t *hand, RotatedFrame *f) {
+  uint32_t size = (uint32_t)f->w * f->h * LV_IMG_PX_SIZE_ALPHA_BYTE;
+  free(f->buf);
+  f->buf = NULL;
+  hand->cache_used -= size;
+  stats.cache_used -= size;
+}
+
+/**
+ * Drop least recently used frames that are not displayed, of `only` or of
+ * every hand
+ */
+static uint32_t release_frames(hand_t *only, uint32_t bytes) {
+  uint32_t released = 0;
+  while (bytes == 0 || released < bytes) {
+    hand_t *owner = NULL;
+    RotatedFrame *lru = NULL;
+    for (int i = 0; i < HANDS_MAX; i++) {
+      hand_t *h = &hands[i];
+      if (!h->used || h->table == NULL || (only && h != only)) {
+        continue;
+      }
+      for (uint16_t s = 0; s < HAND_STEPS; s++) {
+        RotatedFrame *f = &h->table[s];
+        if (f->buf == NULL || (h->placed && s == h->step)) {
+          continue; // displayed
+        }
+        if (lru == NULL || f->used < lru->used) {
+          lru = f;
+          owner = h;
+        }
+      }
+    }
+    if (lru == NULL) {
+      break;
+    }
+    released += (uint32_t)lru->w * lru->h * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    free_frame(owner, lru);
+  }
+  return released;
+}
+
+uint32_t hands_cache_release(uint32_t bytes) {
+  return release_frames(NULL, bytes);
+}
+
+static void place(hand_t *hand, const lv_area_t &area) {
+  stats.updates++;
+  stats.invalidated_px += area_size(area);
+  if (hand->placed) {
+    stats.invalidated_px += area_size(hand->area);
+  }
+  hand->area = area;
+  hand->placed = true;
+}
+
+static void set_line(hand_t *hand, uint16_t step) {
+  const HandConfig &cfg = hand->cfg;
+  int32_t s = hand_sin(step), c = hand_cos(step);
+  lv_coord_t x0 = cfg.cx + ((cfg.length * s) >> 14);
+  lv_coord_t y0 = cfg.cy - ((cfg.length * c) >> 14);
+  lv_coord_t x1 = cfg.cx - ((cfg.tail * s) >> 14);
+  lv_coord_t y1 = cfg.cy + ((cfg.tail * c) >> 14);
+
+  lv_area_t box;
+  box.x1 = LV_MIN(x0, x1);
+  box.y1 = LV_MIN(y0, y1);
+  box.x2 = LV_MAX(x0, x1);
+  box.y2 = LV_MAX(y0, y1);
+
+  // points relative to the box, so the object is no larger than the line
+  hand->points[0].x = x0 - box.x1;
+  hand->points[0].y = y0 - box.y1;
+  hand->points[1].x = x1 - box.x1;
+  hand->points[1].y = y1 - box.y1;
+  lv_obj_set_pos(hand->obj, box.x1, box.y1);
+  lv_line_set_points(hand->obj, hand->points, 2);
+
+  lv_area_increase(&box, cfg.width / 2 + 1, cfg.width / 2 + 1);
+  place(hand, box);
+}
+
+static void set_transform(hand_t *hand, uint16_t step) {
+  lv_img_set_angle(hand->obj, (int32_t)step * 3600 / HAND_STEPS);
+
+  lv_area_t box;
+  rotated_box(hand->cfg, step, &box);
+  lv_area_move(&box, hand->cfg.cx, hand->cfg.cy);
+  place(hand, box);
+}
+
+static bool set_table(hand_t *hand, uint16_t step) {
+  RotatedFrame *f = &hand->table[step];
+  if (f->buf) {
+    stats.cache_hits++;
+  } else {
+    stats.cache_misses++;
+    if (!render_frame(hand, step, f)) {
+      return false;
+    }
+  }
+  f->used = ++use_counter;
+
+  // the frame buffer changes, drop what the image cache knows about it
+  lv_img_cache_invalidate_src(&hand->dsc);
+  hand->dsc.header.w = f->w;
+  hand->dsc.header.h = f->h;
+  hand->dsc.data_size = (uint32_t)f->w * f->h * LV_IMG_PX_SIZE_ALPHA_BYTE;
+  hand->dsc.data = f->buf;
+  lv_img_set_src(hand->obj, &hand->dsc);
+  lv_obj_set_pos(hand->obj, hand->cfg.cx + f->ox, hand->cfg.cy + f->oy);
+
+  lv_area_t box = {(lv_coord_t)(hand->cfg.cx + f->ox),
+                   (lv_coord_t)(hand->cfg.cy + f->oy),
+                   (lv_coord_t)(hand->cfg.cx + f->ox + f->w - 1),
+                   (lv_coord_t)(hand->cfg.cy + f->oy + f->h - 1)};
+  place(hand, box);
+
+  // a miss may have gone over budget while the old frame was displayed,
+  // the new one is displayed now and the old one can go
+  hand->step = step;
+  if (hand->cache_used > HANDS_CACHE_SIZE) {
+    release_frames(hand, hand->cache_used - HANDS_CACHE_SIZE);
+  }
+  return true;
+}
+
+/* Give the slot and the cached frames back */
+static void release(hand_t *hand) {
+  if (hand->table) {
+    lv_img_cache_invalidate_src(&hand->dsc);
+    for (uint16_t s = 0; s < HAND_STEPS; s++) {
+      if (hand->table[s].buf) {
+        free_frame(hand, &hand->table[s]);
+      }
+    }
+    free(hand->table);
+  }
+  memset(hand, 0, sizeof(hand_t));
+}
+
+/* The object went with its screen, e.g. evicted by the screen registry */
+static void delete_cb(lv_event_t *e) {
+  hand_t *hand = (hand_t *)lv_event_get_user_data(e);
+  if (hand->used) {
+    release(hand);
+  }
+}
+
+hand_t *hand_create(lv_obj_t *parent, const HandConfig &config,
+                    HandMode mode) {
+  hand_t *hand = NULL;
+  for (int i = 0; i < HANDS_MAX; i++) {
+    if (!hands[i].used) {
+      hand = &hands[i];
+      break;
+    }
+  }
+  if (hand == NULL) {
+    LV_LOG_WARN("hands: HANDS_MAX reached");
+    return NULL;
+  }
+
+  if (config.img == NULL) {
+    mode = HAND_MODE_LINE;
+  } else if (mode == HAND_MODE_TABLE &&
+             config.img->header.cf != LV_IMG_CF_TRUE_COLOR &&
+             config.img->header.cf != LV_IMG_CF_TRUE_COLOR_ALPHA) {
+    mode = HAND_MODE_TRANSFORM; // encoded images can not be sampled
+  }
+  if (mode == HAND_MODE_TABLE && table_minimum(config) > HANDS_CACHE_SIZE) {
+    // it would evict its own frames and rotate again on every move
+    LV_LOG_WARN("hands: frames do not fit the cache, using transform");
+    mode = HAND_MODE_TRANSFORM;
+  }
+
+  memset(hand, 0, sizeof(hand_t));
+  hand->used = true;
+  hand->mode = mode;
+  hand->cfg = config;
+
+  if (mode == HAND_MODE_LINE) {
+    hand->obj = lv_line_create(parent);
+    lv_obj_set_style_line_width(hand->obj, config.width, 0);
+    lv_obj_set_style_line_color(hand->obj, config.color, 0);
+    lv_obj_set_style_line_rounded(hand->obj, true, 0);
+  } else {
+    hand->obj = lv_img_create(parent);
+    if (mode == HAND_MODE_TRANSFORM) {
+      lv_img_set_src(hand->obj, config.img);
+      lv_img_set_pivot(hand->obj, config.pivot_x, config.pivot_y);
+      lv_obj_set_pos(hand->obj, config.cx - config.pivot_x,
+                     config.cy - config.pivot_y);
+    } else {
+      hand->table = (RotatedFrame *)calloc(HAND_STEPS, sizeof(RotatedFrame));
+      hand->dsc.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+      if (hand->table == NULL) {
+        LV_LOG_WARN("hands: no memory for the table, using transform");
+        hand->mode = HAND_MODE_TRANSFORM;
+        lv_img_set_src(hand->obj, config.img);
+        lv_img_set_pivot(hand->obj, config.pivot_x, config.pivot_y);
+        lv_obj_set_pos(hand->obj, config.cx - config.pivot_x,
+                       config.cy - config.pivot_y);
+      }
+    }
+  }
+  lv_obj_clear_flag(hand->obj,
+                    LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_add_event_cb(hand->obj, delete_cb, LV_EVENT_DELETE, hand);
+  hand_set_step(hand, 0);
+  return hand;
+}
+
+void hand_delete(hand_t *hand, bool obj_deleted) {
+  if (hand == NULL || !hand->used) {
+    return; // already released by delete_cb
+  }
+  if (obj_deleted) {
+    release(hand);
+  } else {
+    lv_obj_del(hand->obj); // delete_cb releases the hand
+  }
+}
+
+void hand_set_step(hand_t *hand, uint16_t step) {
+  step %= HAND_STEPS;
+  if (hand == NULL || (hand->placed && step == hand->step)) {
+    return;
+  }
+
+  switch (hand->mode) {
+  case HAND_MODE_LINE:
+    set_line(hand, step);
+    break;
+  case HAND_MODE_TRANSFORM:
+    set_transform(hand, step);
+    break;
+  case HAND_MODE_TABLE:
+    if (!set_table(hand, step)) {
+      LV_LOG_WARN("hands: frame %u not rendered", step);
+      return;
+    }
+    break;
+  }
+  hand->step = step;
+}
+
+void hand_set(hand_t *hand, uint32_t value, uint32_t range) {
+  if (range == 0) {
+    return;
+  }
+  hand_set_step(hand, (uint16_t)((value % range) * HAND_STEPS / range));
+}
+
+HandMode hand_mode(const hand_t *hand) { return hand->mode; }
+
+lv_obj_t *hand_obj(const hand_t *hand) { return hand->obj; }
+
+const HandStats &hands_stats() { return stats; }
+
+void hands_stats_reset() {
+  uint32_t used = stats.cache_used;
+  memset(&stats, 0, sizeof(stats));
+  stats.cache_used = used;
+}
@@ -0,0 +1,113 @@
+#ifndef ANALOG_HANDS_H
+#define ANALOG_HANDS_H
+
+#include <lvgl.h>
+
+/**
+ * Analog watchface hands without per-frame image transforms.
+ *
+ * Angles are quantised to HAND_STEPS positions (3 degrees, so every second
+ * and every 12 minutes of the hour hand land on a step) and looked up in a
+ * fixed-point sine table. Each hand is an object sized to its own bounding
+ * box, so moving it invalidates only the old and new boxes.
+ *
+ * HAND_MODE_TRANSFORM  lv_img rotation (bilinear, redrawn on every refresh)
+ * HAND_MODE_LINE       antialiased lv_line, no image needed
+ * HAND_MODE_TABLE      the image rotated once per step and cached, the
+ *                      refresh is a plain blit of the cached bitmap. Best
+ *                      for the hour and minute hands, a seconds hand
+ *                      reaches a new step on every tick.
+ */
+
+#define HAND_STEPS 120
+
+#ifndef HANDS_MAX
+#define HANDS_MAX 6
+#endif
+
+/*
+ * Memory for the rotated bitmaps of each HAND_MODE_TABLE hand, so one hand
+ * does not evict the frames of another. A hand whose two largest frames do
+ * not fit is created in HAND_MODE_TRANSFORM.
+ */
+#ifndef HANDS_CACHE_SIZE
+#define HANDS_CACHE_SIZE (48U * 1024U)
+#endif
+
+enum HandMode {
+  HAND_MODE_TRANSFORM,
+  HAND_MODE_LINE,
+  HAND_MODE_TABLE,
+};
+
+struct HandConfig {
+  lv_coord_t cx, cy; // rotation centre in the parent
+
+  // image modes, `img` must be LV_IMG_CF_TRUE_COLOR(_ALPHA) for the table
+  const lv_img_dsc_t *img;
+  lv_coord_t pivot_x, pivot_y; // rotation centre in the image
+
+  // line mode, also used when `img` is NULL
+  lv_coord_t length; // from the centre to the tip
+  lv_coord_t tail;   // past the centre
+  lv_coord_t width;
+  lv_color_t color;
+};
+
+struct HandStats {
+  uint32_t updates;        // angle changes
+  uint64_t invalidated_px; // area of the old and new boxes
+  uint32_t cache_hits;
+  uint32_t cache_misses;
+  uint32_t cache_used; // bytes
+};
+
+typedef struct hand_t hand_t;
+
+/**
+ * Create a hand
+ * @param parent watchface screen or container
+ * @param config geometry and look, copied
+ * @param mode rendering mode, falls back to transform (table without a
+ * usable image or frames larger than HANDS_CACHE_SIZE) or line (no image)
+ * @return NULL when HANDS_MAX hands exist
+ */
+hand_t *hand_create(lv_obj_t *parent, const HandConfig &config, HandMode mode);
+
+/**
+ * Release the hand and its cached bitmaps, the object is deleted unless
+ * `obj_deleted`. Deleting the object (or its screen) releases the hand too,
+ * the handle is not valid afterwards.
+ */
+void hand_delete(hand_t *hand, bool obj_deleted = false);
+
+/**
+ * Point the hand at `value` out of `range` (e.g. 37 of 60 seconds)
+ */
+void hand_set(hand_t *hand, uint32_t value, uint32_t range);
+
+/**
+ * Point the hand at an angle step, 0 is 12 o'clock, clockwise
+ */
+void hand_set_step(hand_t *hand, uint16_t step);
+
+HandMode hand_mode(const hand_t *hand);
+lv_obj_t *hand_obj(const hand_t *hand);
+
+/**
+ * Drop cached bitmaps that are not displayed
+ * @param bytes amount of memory wanted, 0 to drop everything
+ * @return bytes released
+ */
+uint32_t hands_cache_release(uint32_t bytes);
+
+const HandStats &hands_stats();
+void hands_stats_reset();
+
+/**
+ * sin of an angle step, Q14 (16384 = 1.0)
+ */
+int32_t hand_sin(uint16_t step);
+int32_t hand_cos(uint16_t step);
+
+#endif /*ANALOG_HANDS_H*/
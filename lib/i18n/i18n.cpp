@@ -0,0 +1,42 @@
+#include "i18n.h"
+#include <string.h>
+
+I18nLanguage i18n_language_from(int32_t index) {
+  return index >= 0 && index < LANG_COUNT ? (I18nLanguage)index : LANG_EN;
+}
+
+const char *i18n_text(I18nLanguage lang, I18nString id) {
+  if (id < 0 || id >= STR_COUNT) {
+    return "";
+  }
+  return i18n_languages[i18n_language_from(lang)].strings[id];
+}
+
+int i18n_lookup(I18nLanguage lang, const char *text) {
+  if (text == NULL) {
+    return -1;
+  }
+  const char *const *strings = i18n_languages[i18n_language_from(lang)].strings;
+  for (int i = 0; i < STR_COUNT; i++) {
+    if (strcmp(strings[i], text) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+uint16_t i18n_missing_glyphs(I18nLanguage lang, i18n_glyph_cb_t has_glyph,
+                             void *ctx, uint32_t *first_missing) {
+  const I18nLanguageDesc &l = i18n_languages[i18n_language_from(lang)];
+  uint16_t missing = 0;
+  for (uint16_t i = 0; i < l.glyph_count; i++) {
+    if (l.glyphs[i] < 0x20 || has_glyph(l.glyphs[i], ctx)) {
+      continue;
+    }
+    if (missing == 0 && first_missing) {
+      *first_missing = l.glyphs[i];
+    }
+    missing++;
+  }
+  return missing;
+}
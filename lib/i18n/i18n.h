@@ -0,0 +1,58 @@
+#ifndef I18N_H
+#define I18N_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "i18n_strings.h"
+
+/**
+ * UI strings in every language, as constant tables.
+ *
+ * The tables and the I18nString / I18nLanguage enums are generated from
+ * support/i18n/strings.csv by support/i18n_gen.py, so they live in flash
+ * and a lookup is an index. Each language also lists the code points its
+ * strings use, to check them against the enabled fonts.
+ */
+
+struct I18nLanguageDesc {
+  const char *code;            // ISO 639-1
+  const char *name;            // in the language itself
+  const char *const *strings;  // STR_COUNT entries
+  const uint32_t *glyphs;      // code points used, ascending
+  uint16_t glyph_count;
+};
+
+extern const I18nLanguageDesc i18n_languages[LANG_COUNT];
+
+/**
+ * Language of a settings value, English if out of range
+ */
+I18nLanguage i18n_language_from(int32_t index);
+
+/**
+ * Text of a string, English if the language is out of range
+ */
+const char *i18n_text(I18nLanguage lang, I18nString id);
+
+/**
+ * Find the string with this text
+ * @return the string id or -1
+ */
+int i18n_lookup(I18nLanguage lang, const char *text);
+
+/**
+ * @return true if the font has a glyph for the code point
+ */
+typedef bool (*i18n_glyph_cb_t)(uint32_t cp, void *ctx);
+
+/**
+ * Count the code points of a language the font has no glyph for
+ * @param has_glyph glyph lookup of the font
+ * @param first_missing set to the first missing code point, can be NULL
+ * @return number of missing glyphs, 0 if the font covers the language
+ */
+uint16_t i18n_missing_glyphs(I18nLanguage lang, i18n_glyph_cb_t has_glyph,
+                             void *ctx, uint32_t *first_missing);
+
+#endif /*I18N_H*/
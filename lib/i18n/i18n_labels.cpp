@@ -0,0 +1,151 @@
+#include "i18n_labels.h"
+
+struct I18nBinding {
+  lv_obj_t *label;
+  const lv_font_t *font; // font of the label when bound
+  I18nString id;
+};
+
+static I18nBinding bindings[I18N_BINDINGS_MAX];
+static const I18nLabel *labels;
+static uint16_t label_count;
+static I18nStats counters;
+static I18nLanguage current = LANG_EN;
+static const lv_font_t *fonts[LANG_COUNT];
+static uint16_t missing[LANG_COUNT];
+
+static bool font_has_glyph(uint32_t cp, void *font) {
+  lv_font_glyph_dsc_t dsc;
+  return lv_font_get_glyph_dsc((const lv_font_t *)font, &dsc, cp, 0);
+}
+
+static uint16_t check(I18nLanguage lang, const lv_font_t *font,
+                      uint32_t *first) {
+  return i18n_missing_glyphs(lang, font_has_glyph, (void *)font, first);
+}
+
+void i18n_begin(I18nLanguage lang, const lv_font_t *wide_font) {
+  for (int i = 0; i < LANG_COUNT; i++) {
+    I18nLanguage l = (I18nLanguage)i;
+    uint32_t first = 0;
+    fonts[i] = NULL;
+    missing[i] = check(l, LV_FONT_DEFAULT, &first);
+    if (missing[i] && wide_font) {
+      uint32_t wide_first = 0;
+      uint16_t wide_missing = check(l, wide_font, &wide_first);
+      if (wide_missing < missing[i]) {
+        fonts[i] = wide_font;
+        missing[i] = wide_missing;
+        first = wide_first;
+      }
+    }
+    if (missing[i]) {
+      LV_LOG_WARN("language %s: %u glyphs missing, first U+%04lX",
+                  i18n_languages[i].code, (unsigned)missing[i],
+                  (unsigned long)first);
+    }
+  }
+  current = i18n_language_from(lang);
+}
+
+static void apply(const I18nBinding &b) {
+  // the local font exists from the bind, setting it again is in place
+  lv_obj_set_style_text_font(b.label, fonts[current] ? fonts[current] : b.font,
+                             LV_PART_MAIN);
+  lv_label_set_text_static(b.label, i18n_text(current, b.id));
+}
+
+static I18nBinding *find(lv_obj_t *label) {
+  for (uint16_t i = 0; i < counters.bound; i++) {
+    if (bindings[i].label == label) {
+      return &bindings[i];
+    }
+  }
+  return NULL;
+}
+
+static void forget(lv_obj_t *label) {
+  I18nBinding *b = find(label);
+  if (b) {
+    *b = bindings[--counters.bound];
+  }
+}
+
+static void delete_cb(lv_event_t *e) { forget(lv_event_get_target(e)); }
+
+bool i18n_bind(lv_obj_t *label, I18nString id) {
+  I18nBinding *b = find(label);
+  if (b == NULL) {
+    if (counters.bound >= I18N_BINDINGS_MAX) {
+      LV_LOG_WARN("i18n: more than %d labels", I18N_BINDINGS_MAX);
+      return false;
+    }
+    b = &bindings[counters.bound++];
+    b->label = label;
+    b->font = lv_obj_get_style_text_font(label, LV_PART_MAIN);
+    lv_obj_add_event_cb(label, delete_cb, LV_EVENT_DELETE, NULL);
+  }
+  b->id = id;
+  apply(*b);
+  return true;
+}
+
+void i18n_unbind(lv_obj_t *label) {
+  if (find(label)) {
+    lv_obj_remove_event_cb(label, delete_cb);
+    forget(label);
+  }
+}
+
+void i18n_set_labels(const I18nLabel *table, uint16_t count) {
+  labels = table;
+  label_count = count;
+}
+
+uint16_t i18n_bind_screen(lv_obj_t *screen) {
+  uint16_t n = 0;
+  for (uint16_t i = 0; screen && i < label_count; i++) {
+    // only the globals of this screen are fresh, others may be deleted
+    const I18nLabel &l = labels[i];
+    if (*l.screen == screen && *l.label && i18n_bind(*l.label, l.id)) {
+      n++;
+    }
+  }
+  return n;
+}
+
+uint16_t i18n_bind_screens(lv_disp_t *disp) {
+  if (disp == NULL) {
+    disp = lv_disp_get_default();
+  }
+  uint16_t n = 0;
+  for (uint32_t i = 0; disp && i < disp->screen_cnt; i++) {
+    n += i18n_bind_screen(disp->screens[i]);
+  }
+  return n;
+}
+
+void i18n_set_language(I18nLanguage lang) {
+  lang = i18n_language_from(lang);
+  if (lang == current) {
+    return;
+  }
+  current = lang;
+  for (uint16_t i = 0; i < counters.bound; i++) {
+    apply(bindings[i]);
+  }
+  counters.switches++;
+  counters.rebinds += counters.bound;
+}
+
+I18nLanguage i18n_language() { return current; }
+
+const lv_font_t *i18n_font(I18nLanguage lang) {
+  return fonts[i18n_language_from(lang)];
+}
+
+uint16_t i18n_missing(I18nLanguage lang) {
+  return missing[i18n_language_from(lang)];
+}
+
+const I18nStats &i18n_stats() { return counters; }
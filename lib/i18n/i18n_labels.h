@@ -0,0 +1,97 @@
+#ifndef I18N_LABELS_H
+#define I18N_LABELS_H
+
+#include <lvgl.h>
+
+#include "i18n.h"
+
+/**
+ * Labels following the UI language.
+ *
+ * Bound labels point at the constant string tables with
+ * `lv_label_set_text_static` and get the font of the language as a local
+ * style, both set once when binding. Switching the language then rewrites
+ * the text pointer and the font of every bound label in one pass, nothing
+ * is recreated and the LVGL heap is not touched (except for the dot buffer
+ * of LV_LABEL_LONG_DOT labels, which LVGL reallocates on any text change).
+ *
+ * Labels are bound explicitly, never by their text: one `i18n_bind` call
+ * per label, or a table of label globals and string ids bound each time
+ * their screen is built.
+ */
+
+#ifndef I18N_BINDINGS_MAX
+#define I18N_BINDINGS_MAX 128
+#endif
+
+struct I18nLabel {
+  lv_obj_t **screen; // ui global of the screen holding the label
+  lv_obj_t **label;  // ui global of the label, set when the screen is built
+  I18nString id;
+};
+
+struct I18nStats {
+  uint16_t bound;    // labels bound now
+  uint32_t switches; // language changes
+  uint32_t rebinds;  // labels updated by them
+};
+
+/**
+ * Pick the fonts of every language and check their glyphs, languages not
+ * covered by the default font use `wide_font` (e.g. lv_font_simsun_16_cjk)
+ * @param lang initial language
+ * @param wide_font font for the other languages, can be NULL
+ */
+void i18n_begin(I18nLanguage lang, const lv_font_t *wide_font);
+
+/**
+ * Bind a label to a string, binding it again changes the string
+ * @return false if I18N_BINDINGS_MAX labels are bound
+ */
+bool i18n_bind(lv_obj_t *label, I18nString id);
+
+/**
+ * Stop following the language, the label keeps its current text
+ */
+void i18n_unbind(lv_obj_t *label);
+
+/**
+ * Set the labels bound by `i18n_bind_screen`
+ * @param labels table, kept by reference
+ * @param count entries in `labels`
+ */
+void i18n_set_labels(const I18nLabel *labels, uint16_t count);
+
+/**
+ * Bind the labels of the table that are on `screen`, e.g. from the screen
+ * registry's built callback
+ * @return number of labels bound
+ */
+uint16_t i18n_bind_screen(lv_obj_t *screen);
+
+/**
+ * i18n_bind_screen on every screen of a display, e.g. after ui_init
+ * @param disp display, NULL for the default one
+ */
+uint16_t i18n_bind_screens(lv_disp_t *disp);
+
+/**
+ * Set the language of all bound labels
+ */
+void i18n_set_language(I18nLanguage lang);
+
+I18nLanguage i18n_language();
+
+/**
+ * Font of a language, NULL if labels keep their own font
+ */
+const lv_font_t *i18n_font(I18nLanguage lang);
+
+/**
+ * Glyphs of a language missing from its font, see i18n_begin
+ */
+uint16_t i18n_missing(I18nLanguage lang);
+
+const I18nStats &i18n_stats();
+
+#endif /*I18N_LABELS_H*/
@@ -0,0 +1,121 @@
+// Generated by support/i18n_gen.py from support/i18n/strings.csv, do not edit
+#include "i18n.h"
+
+static const char *const strings_en[STR_COUNT] = {
+    "Settings",
+    "Brightness",
+    "Screen timeout",
+    "Language",
+    "Watchface",
+    "Circular scroll",
+    "Alerts",
+    "Always on",
+    "Notifications",
+    "No notifications",
+    "Clear all",
+    "Weather",
+    "Apps",
+    "Games",
+    "Battery",
+    "Connected",
+    "Disconnected",
+    "Find phone",
+    "Camera",
+    "Music",
+    "Steps",
+    "Heart rate",
+    "Timer",
+    "Calendar",
+    "About",
+};
+
+static const uint32_t glyphs_en[] = {
+    0x0020, 0x0041, 0x0042, 0x0043, 0x0044, 0x0046, 0x0047, 0x0048,
+    0x004c, 0x004d, 0x004e, 0x0053, 0x0054, 0x0057, 0x0061, 0x0062,
+    0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006c,
+    0x006d, 0x006e, 0x006f, 0x0070, 0x0072, 0x0073, 0x0074, 0x0075,
+    0x0077, 0x0079,
+};
+
+static const char *const strings_zh[STR_COUNT] = {
+    "设置",
+    "亮度",
+    "屏幕超时",
+    "语言",
+    "表盘",
+    "圆形列表",
+    "提醒",
+    "常亮",
+    "通知",
+    "没有通知",
+    "全部清除",
+    "天气",
+    "应用",
+    "游戏",
+    "电池",
+    "已连接",
+    "未连接",
+    "查找手机",
+    "相机",
+    "音乐",
+    "步数",
+    "心率",
+    "计时器",
+    "日历",
+    "关于",
+};
+
+static const uint32_t glyphs_zh[] = {
+    0x4e50, 0x4e8e, 0x4eae, 0x5168, 0x5173, 0x5217, 0x5386, 0x5668,
+    0x5706, 0x5929, 0x5c4f, 0x5df2, 0x5e38, 0x5e55, 0x5e94, 0x5ea6,
+    0x5f62, 0x5fc3, 0x620f, 0x624b, 0x627e, 0x63a5, 0x63d0, 0x6570,
+    0x65e5, 0x65f6, 0x6709, 0x672a, 0x673a, 0x67e5, 0x6b65, 0x6c14,
+    0x6c60, 0x6ca1, 0x6e05, 0x6e38, 0x7387, 0x7528, 0x7535, 0x76d8,
+    0x76f8, 0x77e5, 0x7f6e, 0x8868, 0x8a00, 0x8ba1, 0x8bbe, 0x8bed,
+    0x8d85, 0x8fde, 0x901a, 0x90e8, 0x9192, 0x9664, 0x97f3,
+};
+
+static const char *const strings_id[STR_COUNT] = {
+    "Pengaturan",
+    "Kecerahan",
+    "Batas waktu layar",
+    "Bahasa",
+    "Tampilan jam",
+    "Gulir melingkar",
+    "Peringatan",
+    "Selalu aktif",
+    "Notifikasi",
+    "Tidak ada notifikasi",
+    "Hapus semua",
+    "Cuaca",
+    "Aplikasi",
+    "Permainan",
+    "Baterai",
+    "Terhubung",
+    "Terputus",
+    "Cari ponsel",
+    "Kamera",
+    "Musik",
+    "Langkah",
+    "Detak jantung",
+    "Pengatur waktu",
+    "Kalender",
+    "Tentang",
+};
+
+static const uint32_t glyphs_id[] = {
+    0x0020, 0x0041, 0x0042, 0x0043, 0x0044, 0x0047, 0x0048, 0x004b,
+    0x004c, 0x004d, 0x004e, 0x0050, 0x0053, 0x0054, 0x0061, 0x0062,
+    0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a,
+    0x006b, 0x006c, 0x006d, 0x006e, 0x006f, 0x0070, 0x0072, 0x0073,
+    0x0074, 0x0075, 0x0077, 0x0079,
+};
+
+const I18nLanguageDesc i18n_languages[LANG_COUNT] = {
+    {"en", "English", strings_en, glyphs_en,
+     sizeof(glyphs_en) / sizeof(glyphs_en[0])},
+    {"zh", "简体中文", strings_zh, glyphs_zh,
+     sizeof(glyphs_zh) / sizeof(glyphs_zh[0])},
+    {"id", "Bahasa Indonesia", strings_id, glyphs_id,
+     sizeof(glyphs_id) / sizeof(glyphs_id[0])},
+};
@@ -0,0 +1,46 @@
+// Generated by support/i18n_gen.py from support/i18n/strings.csv, do not edit
+#ifndef I18N_STRINGS_H
+#define I18N_STRINGS_H
+
+enum I18nLanguage {
+  LANG_EN, // English
+  LANG_ZH, // 简体中文
+  LANG_ID, // Bahasa Indonesia
+  LANG_COUNT
+};
+
+enum I18nString {
+  STR_SETTINGS, // Settings
+  STR_BRIGHTNESS, // Brightness
+  STR_TIMEOUT, // Screen timeout
+  STR_LANGUAGE, // Language
+  STR_WATCHFACE, // Watchface
+  STR_CIRCULAR, // Circular scroll
+  STR_ALERTS, // Alerts
+  STR_ALWAYS_ON, // Always on
+  STR_NOTIFICATIONS, // Notifications
+  STR_NO_NOTIFICATIONS, // No notifications
+  STR_CLEAR_ALL, // Clear all
+  STR_WEATHER, // Weather
+  STR_APPS, // Apps
+  STR_GAMES, // Games
+  STR_BATTERY, // Battery
+  STR_CONNECTED, // Connected
+  STR_DISCONNECTED, // Disconnected
+  STR_FIND_PHONE, // Find phone
+  STR_CAMERA, // Camera
+  STR_MUSIC, // Music
+  STR_STEPS, // Steps
+  STR_HEART_RATE, // Heart rate
+  STR_TIMER, // Timer
+  STR_CALENDAR, // Calendar
+  STR_ABOUT, // About
+  STR_COUNT
+};
+
+/**
+ * Options of the language dropdown, in I18nLanguage order
+ */
+#define I18N_LANGUAGE_OPTIONS "English\n简体中文\nBahasa Indonesia"
+
+#endif /*I18N_STRINGS_H*/
@@ -0,0 +1,102 @@
+#include "chronos_payloads.h"
+#include <string.h>
+
+static bool weatherDay(JsonVariantConst e, uint16_t index, void *out) {
+  WeatherPayload &p = *(WeatherPayload *)out;
+  if (index >= WEATHER_DAYS) {
+    return true; // longer forecasts are read and dropped
+  }
+  WeatherDay &d = p.days[index];
+  d.icon = e["icon"] | 0;
+  d.day = e["day"] | 0;
+  d.temp = e["temp"] | 0;
+  d.high = e["high"] | 0;
+  d.low = e["low"] | 0;
+  p.count = index + 1;
+  return true;
+}
+
+static const IngestField weatherFields[] = {
+    INGEST_STRING_FIELD(WeatherPayload, "city", city),
+    INGEST_INT_FIELD(WeatherPayload, "hour", hour),
+    INGEST_INT_FIELD(WeatherPayload, "minute", minute),
+    INGEST_ARRAY_FIELD(
+        "days", "{\"icon\":true,\"day\":true,\"temp\":true,\"high\":true,"
+                "\"low\":true}",
+        weatherDay),
+};
+
+#define WEATHER_FOUND_DAYS (1 << 3)
+
+bool ingest_weather(JsonIngest &ingest, IngestSource &src,
+                    WeatherPayload &out) {
+  memset(&out, 0, sizeof(out));
+  uint32_t found;
+  return ingest.parse(src, weatherFields,
+                      sizeof(weatherFields) / sizeof(weatherFields[0]), &out,
+                      &found) &&
+         (found & WEATHER_FOUND_DAYS);
+}
+
+void weather_apply(const WeatherPayload &payload, WeatherModel &model) {
+  model.update(payload.days, payload.count);
+  if (payload.city[0]) {
+    model.setCity(payload.city);
+  }
+  model.setUpdated(payload.hour, payload.minute);
+}
+
+static const IngestField notificationFields[] = {
+    INGEST_INT_FIELD(NotificationRecord, "id", id),
+    INGEST_INT_FIELD(NotificationRecord, "icon", icon),
+    INGEST_STRING_FIELD(NotificationRecord, "app", app),
+    INGEST_STRING_FIELD(NotificationRecord, "time", time),
+    INGEST_STRING_FIELD(NotificationRecord, "message", message),
+};
+
+#define NOTIFICATION_FOUND_MESSAGE (1 << 4)
+
+bool ingest_notification(JsonIngest &ingest, IngestSource &src,
+                         NotificationRecord &out) {
+  memset(&out, 0, sizeof(out));
+  uint32_t found;
+  return ingest.parse(src, notificationFields,
+                      sizeof(notificationFields) /
+                          sizeof(notificationFields[0]),
+                      &out, &found) &&
+         (found & NOTIFICATION_FOUND_MESSAGE);
+}
+
+static bool link(JsonVariantConst e, uint16_t index, void *out) {
+  LinksPayload &p = *(LinksPayload *)out;
+  const char *url = e.as<const char *>();
+  if (url && p.count < LINKS_MAX) {
+    utf8_copy(p.link[p.count++], url, LINK_MAX);
+  }
+  return true;
+}
+
+static const IngestField linkFields[] = {
+    INGEST_ARRAY_FIELD("links", "true", link),
+};
+
+bool ingest_links(JsonIngest &ingest, IngestSource &src, LinksPayload &out) {
+  memset(&out, 0, sizeof(out));
+  return ingest.parse(src, linkFields, 1, &out);
+}
+
+bool ingest_settings(JsonIngest &ingest, IngestSource &src,
+                     SettingsPayload &out) {
+  static IngestField fields[SETTING_COUNT];
+  if (fields[0].key == NULL) {
+    // one field per stored setting, same keys as in NVS
+    for (uint8_t i = 0; i < SETTING_COUNT; i++) {
+      fields[i].key = settingDescs[i].key;
+      fields[i].type = INGEST_INT;
+      fields[i].offset = offsetof(SettingsPayload, values) + i * 4;
+      fields[i].size = 4;
+    }
+  }
+  memset(&out, 0, sizeof(out));
+  return ingest.parse(src, fields, SETTING_COUNT, &out, &out.present);
+}
@@ -0,0 +1,65 @@
+#ifndef CHRONOS_PAYLOADS_H
+#define CHRONOS_PAYLOADS_H
+
+#include "json_ingest.h"
+#include "notification_store.h"
+#include "settings_store.h"
+#include "weather_model.h"
+
+/**
+ * JSON payloads from the companion app, decoded with `JsonIngest` into
+ * fixed structs.
+ *
+ *  weather       {"city":"Nairobi","hour":14,"minute":5,
+ *                 "days":[{"icon":2,"day":1,"temp":21,"high":25,"low":13}]}
+ *  notification  {"id":7,"icon":3,"app":"Skype","time":"14:05",
+ *                 "message":"..."}
+ *  links         {"links":["https://...", ...]}
+ *  settings      {"brightness":120,"timeout":2,...} with the keys of
+ *                `settingDescs`
+ *
+ * Members not listed are skipped, days past WEATHER_DAYS and links past
+ * LINKS_MAX are read and dropped.
+ */
+
+struct WeatherPayload {
+  WeatherDay days[WEATHER_DAYS];
+  uint8_t count;
+  char city[WEATHER_CITY_MAX];
+  uint8_t hour; // time of the update
+  uint8_t minute;
+};
+
+#define LINKS_MAX 4
+#define LINK_MAX 214 // 213 bytes fit a version 10 QR code (QR_MAX_VERSION)
+
+struct LinksPayload {
+  char link[LINKS_MAX][LINK_MAX];
+  uint8_t count;
+};
+
+struct SettingsPayload {
+  int32_t values[SETTING_COUNT];
+  uint32_t present; // bit n set for SettingKey n
+};
+
+bool ingest_weather(JsonIngest &ingest, IngestSource &src,
+                    WeatherPayload &out);
+
+/**
+ * Store the payload in the model, only the changed days are marked
+ */
+void weather_apply(const WeatherPayload &payload, WeatherModel &model);
+
+/**
+ * @return false if the payload is invalid or has no message
+ */
+bool ingest_notification(JsonIngest &ingest, IngestSource &src,
+                         NotificationRecord &out);
+
+bool ingest_links(JsonIngest &ingest, IngestSource &src, LinksPayload &out);
+
+bool ingest_settings(JsonIngest &ingest, IngestSource &src,
+                     SettingsPayload &out);
+
+#endif /*CHRONOS_PAYLOADS_H*/
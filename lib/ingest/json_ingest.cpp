@@ -0,0 +1,578 @@
+#include "json_ingest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// keeps the blocks aligned for the 64 bit values of the documents
+union BlockHeader {
+  size_t size;
+  uint64_t align;
+  void *ptr;
+};
+
+BoundedAllocator::BoundedAllocator(size_t limit)
+    : max(limit), in_use(0), high(0), failed(0) {}
+
+void *BoundedAllocator::allocate(size_t size) {
+  size_t total = sizeof(BlockHeader) + size;
+  if (total > max - in_use) {
+    failed++;
+    return NULL;
+  }
+  BlockHeader *block = (BlockHeader *)malloc(total);
+  if (block == NULL) {
+    failed++;
+    return NULL;
+  }
+  block->size = total;
+  in_use += total;
+  if (in_use > high) {
+    high = in_use;
+  }
+  return block + 1;
+}
+
+void BoundedAllocator::deallocate(void *ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  BlockHeader *block = (BlockHeader *)ptr - 1;
+  in_use -= block->size;
+  free(block);
+}
+
+void *BoundedAllocator::reallocate(void *ptr, size_t new_size) {
+  if (ptr == NULL) {
+    return allocate(new_size);
+  }
+  BlockHeader *block = (BlockHeader *)ptr - 1;
+  size_t old = block->size;
+  size_t total = sizeof(BlockHeader) + new_size;
+  if (total > old && total - old > max - in_use) {
+    failed++;
+    return NULL;
+  }
+  BlockHeader *moved = (BlockHeader *)realloc(block, total);
+  if (moved == NULL) {
+    failed++;
+    return NULL;
+  }
+  moved->size = total;
+  in_use = in_use - old + total;
+  if (in_use > high) {
+    high = in_use;
+  }
+  return moved + 1;
+}
+
+/**
+ * Counts the bytes and gives one byte back, the ArduinoJson reader interface
+ */
+class IngestReader {
+public:
+  explicit IngestReader(IngestSource &src) : src(src), pushed(-1), bytes(0) {}
+
+  int read() {
+    if (pushed >= 0) {
+      int c = pushed;
+      pushed = -1;
+      return c;
+    }
+    int c = src.read();
+    if (c >= 0) {
+      bytes++;
+    }
+    return c;
+  }
+
+  size_t readBytes(char *buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+      int c = read();
+      if (c < 0) {
+        break;
+      }
+      buffer[n++] = (char)c;
+    }
+    return n;
+  }
+
+  void unread(int c) { pushed = c; }
+
+  /**
+   * Next byte that is not white space
+   */
+  int next() {
+    int c;
+    do {
+      c = read();
+    } while (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+    return c;
+  }
+
+  uint32_t count() const { return bytes; }
+
+private:
+  IngestSource &src;
+  int pushed;
+  uint32_t bytes;
+};
+
+/**
+ * Characters of numbers and of true, false and null
+ */
+static bool isTokenChar(int c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' ||
+         c == '+' || c == '.' || c == 'E';
+}
+
+static uint8_t utf8Encode(uint32_t cp, char *out) {
+  if (cp < 0x80) {
+    out[0] = cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = 0xC0 | (cp >> 6);
+    out[1] = 0x80 | (cp & 0x3F);
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = 0xE0 | (cp >> 12);
+    out[1] = 0x80 | ((cp >> 6) & 0x3F);
+    out[2] = 0x80 | (cp & 0x3F);
+    return 3;
+  }
+  out[0] = 0xF0 | (cp >> 18);
+  out[1] = 0x80 | ((cp >> 12) & 0x3F);
+  out[2] = 0x80 | ((cp >> 6) & 0x3F);
+  out[3] = 0x80 | (cp & 0x3F);
+  return 4;
+}
+
+/**
+ * One payload, walks the top-level object
+ */
+class IngestParser {
+public:
+  IngestParser(IngestReader &in, ArduinoJson::Allocator *allocator,
+               const IngestField *fields, uint8_t count, void *out)
+      : found(0), err(DeserializationError::Ok), in(in), doc(allocator),
+        filter(allocator), fields(fields), count(count), out((uint8_t *)out) {}
+
+  bool parse();
+
+  uint32_t found;
+  DeserializationError err;
+
+private:
+  bool fail(DeserializationError::Code code) {
+    err = code;
+    return false;
+  }
+  bool expected(int c) {
+    return fail(c < 0 ? DeserializationError::IncompleteInput
+                      : DeserializationError::InvalidInput);
+  }
+  bool readHex(uint32_t &value);
+  bool readString(char *dst, size_t size, bool &truncated);
+  bool readToken(char *dst, size_t size);
+  bool readValue(const JsonVariantConst *allow);
+  bool skip();
+  bool readInt(const IngestField &field, bool &matched);
+  bool readText(const IngestField &field, bool &matched);
+  bool readArray(const IngestField &field, bool &matched);
+
+  IngestReader &in;
+  JsonDocument doc;
+  JsonDocument filter;
+  const IngestField *fields;
+  uint8_t count;
+  uint8_t *out;
+};
+
+bool IngestParser::readHex(uint32_t &value) {
+  value = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    int c = in.read();
+    uint8_t digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      return expected(c);
+    }
+    value = value << 4 | digit;
+  }
+  return true;
+}
+
+/**
+ * Decode a string after its opening quote, a character that does not fit
+ * ends the copy so no sequence is split
+ */
+bool IngestParser::readString(char *dst, size_t size, bool &truncated) {
+  size_t n = 0;
+  truncated = false;
+  while (true) {
+    int c = in.read();
+    if (c < 0) {
+      return expected(c);
+    }
+    if (c == '"') {
+      break;
+    }
+    char seq[4];
+    uint8_t len = 1;
+    seq[0] = c;
+    if (c == '\\') {
+      c = in.read();
+      switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        seq[0] = c;
+        break;
+      case 'b':
+        seq[0] = '\b';
+        break;
+      case 'f':
+        seq[0] = '\f';
+        break;
+      case 'n':
+        seq[0] = '\n';
+        break;
+      case 'r':
+        seq[0] = '\r';
+        break;
+      case 't':
+        seq[0] = '\t';
+        break;
+      case 'u': {
+        uint32_t cp;
+        if (!readHex(cp)) {
+          return false;
+        }
+        if (cp >= 0xD800 && cp < 0xDC00) {
+          // high surrogate, the low one follows as another escape
+          uint32_t low;
+          if (in.read() != '\\' || in.read() != 'u' || !readHex(low)) {
+            return fail(DeserializationError::InvalidInput);
+          }
+          cp = (low >= 0xDC00 && low < 0xE000)
+                   ? 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00)
+                   : 0xFFFD;
+        } else if (cp >= 0xDC00 && cp < 0xE000) {
+          cp = 0xFFFD;
+        }
+        len = utf8Encode(cp, seq);
+        break;
+      }
+      default:
+        return expected(c);
+      }
+    } else if (c >= 0xC0) {
+      // raw UTF-8, the lead byte gives the length
+      len = c >= 0xF0 ? 4 : (c >= 0xE0 ? 3 : 2);
+      for (uint8_t i = 1; i < len; i++) {
+        int next = in.read();
+        if (next < 0 || (next & 0xC0) != 0x80) {
+          return expected(next);
+        }
+        seq[i] = next;
+      }
+    }
+    if (!truncated && n + len < size) {
+      memcpy(dst + n, seq, len);
+      n += len;
+    } else {
+      truncated = true;
+    }
+  }
+  if (size) {
+    dst[n] = 0;
+  }
+  return true;
+}
+
+/**
+ * Read a number or literal, the character after it is given back
+ */
+bool IngestParser::readToken(char *dst, size_t size) {
+  size_t n = 0;
+  while (true) {
+    int c = in.read();
+    if (!isTokenChar(c)) {
+      in.unread(c);
+      break;
+    }
+    if (n + 1 >= size) {
+      return fail(DeserializationError::InvalidInput);
+    }
+    dst[n++] = c;
+  }
+  dst[n] = 0;
+  return n ? true : expected(in.read());
+}
+
+/**
+ * Read one value into `doc`
+ * @param allow filter, what it does not keep is skipped without being
+ * stored, NULL keeps everything
+ */
+bool IngestParser::readValue(const JsonVariantConst *allow) {
+  int c = in.next();
+  if (c < 0) {
+    return expected(c);
+  }
+  in.unread(c);
+  DeserializationError e;
+  if (c == '{' || c == '[' || c == '"') {
+    // ArduinoJson stops right after the closing character
+    if (allow) {
+      e = deserializeJson(doc, in, DeserializationOption::Filter(*allow),
+                          DeserializationOption::NestingLimit(INGEST_NESTING));
+    } else {
+      e = deserializeJson(doc, in,
+                          DeserializationOption::NestingLimit(INGEST_NESTING));
+    }
+  } else {
+    // a number only ends at the next character, which ArduinoJson would
+    // take as trailing input: read it here and parse the token alone
+    char token[INGEST_TOKEN_MAX];
+    if (!readToken(token, sizeof(token))) {
+      return false;
+    }
+    if (allow) {
+      e = deserializeJson(doc, (const char *)token, strlen(token),
+                          DeserializationOption::Filter(*allow));
+    } else {
+      e = deserializeJson(doc, (const char *)token, strlen(token));
+    }
+  }
+  if (e) {
+    err = e;
+    return false;
+  }
+  return true;
+}
+
+bool IngestParser::skip() {
+  JsonVariantConst none;
+  return readValue(&none);
+}
+
+bool IngestParser::readInt(const IngestField &field, bool &matched) {
+  int c = in.next();
+  in.unread(c);
+  if (c == '"' || c == '{' || c == '[') {
+    return skip();
+  }
+  if (!readValue(NULL)) {
+    return false;
+  }
+  JsonVariantConst value = doc.as<JsonVariantConst>();
+  if (value.isNull()) {
+    return true;
+  }
+  // ids above INT32_MAX keep their bits, floats are truncated
+  int32_t v = value.is<uint32_t>() && !value.is<int32_t>()
+                  ? (int32_t)value.as<uint32_t>()
+                  : value.as<int32_t>();
+  uint8_t *dst = out + field.offset;
+  switch (field.size) {
+  case 1: {
+    uint8_t b = (uint8_t)v;
+    memcpy(dst, &b, 1);
+    break;
+  }
+  case 2: {
+    uint16_t h = (uint16_t)v;
+    memcpy(dst, &h, 2);
+    break;
+  }
+  default:
+    memcpy(dst, &v, 4);
+    break;
+  }
+  matched = true;
+  return true;
+}
+
+bool IngestParser::readText(const IngestField &field, bool &matched) {
+  int c = in.next();
+  if (c != '"') {
+    in.unread(c);
+    return skip();
+  }
+  bool truncated;
+  if (!readString((char *)out + field.offset, field.size, truncated)) {
+    return false;
+  }
+  matched = true;
+  return true;
+}
+
+bool IngestParser::readArray(const IngestField &field, bool &matched) {
+  int c = in.next();
+  if (c != '[') {
+    in.unread(c);
+    return skip();
+  }
+  JsonVariantConst allow; // null skips the elements
+  filter.clear();
+  if (field.filter) {
+    DeserializationError e = deserializeJson(filter, field.filter);
+    if (e) {
+      err = e;
+      return false;
+    }
+    allow = filter.as<JsonVariantConst>();
+  }
+  c = in.next();
+  if (c != ']') {
+    in.unread(c);
+    for (uint16_t index = 0;; index++) {
+      // the previous element is released when the document is reused
+      if (!readValue(&allow)) {
+        return false;
+      }
+      if (field.element &&
+          !field.element(doc.as<JsonVariantConst>(), index, out)) {
+        return fail(DeserializationError::InvalidInput);
+      }
+      c = in.next();
+      if (c == ']') {
+        break;
+      }
+      if (c != ',') {
+        return expected(c);
+      }
+    }
+  }
+  doc.clear();
+  filter.clear();
+  matched = true;
+  return true;
+}
+
+bool IngestParser::parse() {
+  int c = in.next();
+  if (c < 0) {
+    return fail(DeserializationError::EmptyInput);
+  }
+  if (c != '{') {
+    return fail(DeserializationError::InvalidInput);
+  }
+  c = in.next();
+  if (c == '}') {
+    return true;
+  }
+  while (true) {
+    if (c != '"') {
+      return expected(c);
+    }
+    char key[INGEST_KEY_MAX];
+    bool truncated;
+    if (!readString(key, sizeof(key), truncated)) {
+      return false;
+    }
+    c = in.next();
+    if (c != ':') {
+      return expected(c);
+    }
+
+    int index = -1;
+    for (uint8_t i = 0; i < count && !truncated; i++) {
+      if (strcmp(fields[i].key, key) == 0) {
+        index = i;
+        break;
+      }
+    }
+    bool matched = false;
+    bool ok;
+    if (index < 0) {
+      ok = skip();
+    } else if (fields[index].type == INGEST_INT) {
+      ok = readInt(fields[index], matched);
+    } else if (fields[index].type == INGEST_STRING) {
+      ok = readText(fields[index], matched);
+    } else {
+      ok = readArray(fields[index], matched);
+    }
+    if (!ok) {
+      return false;
+    }
+    if (matched) {
+      found |= 1UL << index;
+    }
+
+    c = in.next();
+    if (c == '}') {
+      return true;
+    }
+    if (c != ',') {
+      return expected(c);
+    }
+    c = in.next();
+  }
+}
+
+JsonIngest::JsonIngest(size_t limit, uint32_t (*clock)())
+    : allocator(limit), clock(clock), err(DeserializationError::Ok) {
+  memset(&counters, 0, sizeof(counters));
+}
+
+bool JsonIngest::parse(IngestSource &src, const IngestField *fields,
+                       uint8_t count, void *out, uint32_t *found) {
+  uint32_t start = clock ? clock() : 0;
+  allocator.resetPeak();
+  size_t base = allocator.used();
+
+  IngestReader in(src);
+  bool ok;
+  uint32_t hits;
+  {
+    // the documents only live for this payload
+    IngestParser parser(in, &allocator, fields,
+                        count < INGEST_FIELDS_MAX ? count : INGEST_FIELDS_MAX,
+                        out);
+    ok = parser.parse();
+    hits = parser.found;
+    err = parser.err;
+  }
+  if (found) {
+    *found = hits;
+  }
+
+  counters.payloads++;
+  if (!ok) {
+    counters.failures++;
+  }
+  counters.last_bytes = in.count();
+  counters.total_bytes += in.count();
+  counters.last_us = clock ? clock() - start : 0;
+  counters.total_us += counters.last_us;
+  counters.last_peak = allocator.peak() - base;
+  if (counters.last_peak > counters.peak) {
+    counters.peak = counters.last_peak;
+  }
+  return ok;
+}
+
+uint32_t JsonIngest::bytesPerSecond() const {
+  if (counters.total_us == 0) {
+    return 0;
+  }
+  return (uint32_t)(counters.total_bytes * 1000000ULL / counters.total_us);
+}
+
+int JsonIngest::format(char *out, size_t len) const {
+  return snprintf(out, len,
+                  "json: %u payloads, %u failed, %u B/s, peak %u of %u B\n",
+                  (unsigned)counters.payloads, (unsigned)counters.failures,
+                  (unsigned)bytesPerSecond(), (unsigned)counters.peak,
+                  (unsigned)allocator.limit());
+}
@@ -0,0 +1,160 @@
+#ifndef JSON_INGEST_H
+#define JSON_INGEST_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Streaming, filtered JSON ingestion into fixed structs.
+ *
+ * A payload is one top-level object whose members are matched against a
+ * table of fields. Numbers and strings are decoded straight into the
+ * output struct (strings are cut on a UTF-8 boundary). Arrays are read one
+ * element at a time into a small document through
+ * `DeserializationOption::Filter`, handed to the field's callback and
+ * dropped. Other members are skipped without being stored. The memory used
+ * depends on the largest filtered element, not on the payload size, and
+ * every allocation goes through a `BoundedAllocator` that fails instead of
+ * growing past its limit.
+ */
+
+#ifndef INGEST_HEAP_LIMIT
+#define INGEST_HEAP_LIMIT (12 * 1024)
+#endif
+
+#define INGEST_FIELDS_MAX 32
+#define INGEST_KEY_MAX 24   // longer keys never match
+#define INGEST_TOKEN_MAX 32 // longest number or literal
+#define INGEST_NESTING 8
+
+/**
+ * Bytes of a payload, e.g. a BLE buffer or a file
+ */
+class IngestSource {
+public:
+  virtual ~IngestSource() {}
+  /**
+   * @return next byte, -1 at the end
+   */
+  virtual int read() = 0;
+};
+
+class IngestBuffer : public IngestSource {
+public:
+  IngestBuffer(const char *data, size_t len) : data(data), len(len), pos(0) {}
+  int read() { return pos < len ? (uint8_t)data[pos++] : -1; }
+
+private:
+  const char *data;
+  size_t len;
+  size_t pos;
+};
+
+/**
+ * ArduinoJson allocator with a ceiling, tracks the current and peak use
+ */
+class BoundedAllocator : public ArduinoJson::Allocator {
+public:
+  explicit BoundedAllocator(size_t limit);
+
+  void *allocate(size_t size);
+  void deallocate(void *ptr);
+  void *reallocate(void *ptr, size_t new_size);
+
+  size_t used() const { return in_use; } // including the block headers
+  size_t peak() const { return high; }
+  size_t limit() const { return max; }
+  uint32_t failures() const { return failed; }
+  void resetPeak() { high = in_use; }
+
+private:
+  size_t max;
+  size_t in_use;
+  size_t high;
+  uint32_t failed;
+};
+
+enum IngestType {
+  INGEST_INT,    // int8/16/32 or uint8/16/32 member
+  INGEST_STRING, // char array member
+  INGEST_ARRAY   // elements passed to a callback
+};
+
+/**
+ * Decode one array element
+ * @param element the element after the filter, null if the field has none
+ * @param index position in the array
+ * @param out output struct
+ * @return false to reject the payload
+ */
+typedef bool (*IngestElement)(JsonVariantConst element, uint16_t index,
+                              void *out);
+
+struct IngestField {
+  const char *key;
+  IngestType type;
+  uint16_t offset;       // of the member in the output struct
+  uint16_t size;         // of the member, 1, 2 or 4 for INGEST_INT
+  const char *filter;    // arrays: filter of one element as JSON
+  IngestElement element; // arrays
+};
+
+#define INGEST_INT_FIELD(type, key, member)                                    \
+  { key, INGEST_INT, offsetof(type, member), sizeof(((type *)0)->member),      \
+    NULL, NULL }
+#define INGEST_STRING_FIELD(type, key, member)                                 \
+  { key, INGEST_STRING, offsetof(type, member), sizeof(((type *)0)->member),   \
+    NULL, NULL }
+#define INGEST_ARRAY_FIELD(key, filter, element)                               \
+  { key, INGEST_ARRAY, 0, 0, filter, element }
+
+struct IngestStats {
+  uint32_t payloads;
+  uint32_t failures;
+  uint32_t last_bytes;
+  uint32_t last_us;
+  uint64_t total_bytes;
+  uint64_t total_us;
+  uint32_t last_peak; // allocator peak of the last payload
+  uint32_t peak;      // highest allocator peak
+};
+
+class JsonIngest {
+public:
+  /**
+   * @param limit bytes the documents may allocate
+   * @param clock microsecond clock for the throughput, e.g. micros
+   */
+  JsonIngest(size_t limit = INGEST_HEAP_LIMIT, uint32_t (*clock)() = NULL);
+
+  /**
+   * Decode a payload into `out`
+   * @param src payload
+   * @param fields members to decode, at most INGEST_FIELDS_MAX
+   * @param count number of fields
+   * @param out struct the field offsets refer to
+   * @param found bit n is set if fields[n] was present with the right type
+   * @return false if the payload is invalid, see `error`
+   */
+  bool parse(IngestSource &src, const IngestField *fields, uint8_t count,
+             void *out, uint32_t *found = NULL);
+
+  DeserializationError error() const { return err; }
+  const IngestStats &stats() const { return counters; }
+
+  /**
+   * Average over every payload so far, 0 without a clock
+   */
+  uint32_t bytesPerSecond() const;
+
+  int format(char *out, size_t len) const;
+
+private:
+  BoundedAllocator allocator;
+  uint32_t (*clock)();
+  IngestStats counters;
+  DeserializationError err;
+};
+
+#endif /*JSON_INGEST_H*/
@@ -0,0 +1,239 @@
+#include "face_install.h"
+#include <string.h>
+
+#define JOURNAL_MAGIC 0x4A4E4C31 // "JNL1"
+
+uint32_t install_crc32(uint32_t crc, const uint8_t *data, size_t len) {
+  static const uint32_t table[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+      0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+      0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+FaceInstaller::FaceInstaller(InstallStorage &storage, uint32_t commit_bytes)
+    : storage(storage), commit_bytes(commit_bytes), validator(NULL),
+      extension(NULL), received(0), crc(0), running(false) {
+  memset(&journal, 0, sizeof(journal));
+  memset(&summary, 0, sizeof(summary));
+  memset(&counters, 0, sizeof(counters));
+}
+
+void FaceInstaller::setValidator(FaceValidator v) { validator = v; }
+
+void FaceInstaller::setExtension(const char *ext) { extension = ext; }
+
+/* The name comes from the link, it must stay a file of the storage root */
+static bool valid_name(const char *name, const char *ext) {
+  size_t len = strlen(name);
+  if (len == 0 || strchr(name, '/') != NULL || strstr(name, "..") != NULL) {
+    return false;
+  }
+  if (ext == NULL) {
+    return true;
+  }
+  size_t ext_len = strlen(ext);
+  return len > ext_len && strcmp(name + len - ext_len, ext) == 0;
+}
+
+InstallStatus FaceInstaller::begin(const char *name, uint32_t total,
+                                   uint32_t file_crc) {
+  if (!valid_name(name, extension)) {
+    return INSTALL_INVALID; // a transfer in progress is left alone
+  }
+  if (running) {
+    storage.closeTemp();
+    running = false;
+  }
+
+  InstallJournal saved;
+  bool resume = storage.loadJournal(saved) && saved.magic == JOURNAL_MAGIC &&
+                strncmp(saved.name, name, INSTALL_NAME_MAX) == 0 &&
+                saved.total == total && saved.file_crc == file_crc &&
+                saved.committed <= total &&
+                storage.tempSize(name) >= saved.committed;
+
+  if (resume) {
+    journal = saved;
+    counters.resumes++;
+    counters.resumed_bytes += saved.committed;
+  } else {
+    if (storage.loadJournal(saved) && saved.magic == JOURNAL_MAGIC) {
+      storage.discard(saved.name); // another face was interrupted
+    }
+    memset(&journal, 0, sizeof(journal));
+    journal.magic = JOURNAL_MAGIC;
+    strncpy(journal.name, name, INSTALL_NAME_MAX - 1);
+    journal.total = total;
+    journal.file_crc = file_crc;
+  }
+
+  received = journal.committed;
+  crc = journal.crc;
+
+  if (!storage.openTemp(journal.name, received) ||
+      (!resume && !storage.saveJournal(journal))) {
+    storage.closeTemp();
+    return INSTALL_IO_ERROR;
+  }
+  running = true;
+
+  if (received == total) {
+    return finish(); // everything was committed before the link dropped
+  }
+  return INSTALL_OK;
+}
+
+InstallStatus FaceInstaller::write(uint32_t offset, const uint8_t *data,
+                                   uint32_t len, uint32_t chunk_crc) {
+  if (!running) {
+    return INSTALL_IDLE;
+  }
+  counters.chunks++;
+
+  if (install_crc32(0, data, len) != chunk_crc) {
+    counters.resends++;
+    return INSTALL_RESEND;
+  }
+  if (offset + len <= received) {
+    counters.duplicates++;
+    return INSTALL_DUPLICATE;
+  }
+  if (offset > received || offset + len > journal.total) {
+    counters.resends++;
+    return INSTALL_RESEND;
+  }
+
+  // a resent chunk may overlap what is already stored
+  uint32_t skip = received - offset;
+  data += skip;
+  len -= skip;
+
+  if (!storage.append(data, len)) {
+    return INSTALL_IO_ERROR;
+  }
+  crc = install_crc32(crc, data, len);
+  received += len;
+
+  if (received == journal.total) {
+    return finish();
+  }
+  if (received - journal.committed >= commit_bytes && !checkpoint()) {
+    return INSTALL_IO_ERROR;
+  }
+  return INSTALL_OK;
+}
+
+bool FaceInstaller::checkpoint() {
+  if (!storage.sync()) {
+    return false;
+  }
+  journal.committed = received;
+  journal.crc = crc;
+  counters.commits++;
+  return storage.saveJournal(journal);
+}
+
+InstallStatus FaceInstaller::finish() {
+  bool synced = storage.sync();
+  storage.closeTemp();
+  running = false;
+  if (!synced) {
+    return INSTALL_IO_ERROR;
+  }
+
+  if (journal.file_crc && crc != journal.file_crc) {
+    storage.discard(journal.name);
+    storage.clearJournal();
+    return INSTALL_FILE_CRC;
+  }
+
+  memset(&summary, 0, sizeof(summary));
+  strncpy(summary.name, journal.name, INSTALL_NAME_MAX - 1);
+  summary.size = journal.total;
+  summary.crc = crc;
+
+  if (validator && !validator(storage, journal.name, journal.total, summary)) {
+    storage.discard(journal.name);
+    storage.clearJournal();
+    return INSTALL_INVALID;
+  }
+
+  if (!storage.commit(journal.name)) {
+    return INSTALL_IO_ERROR;
+  }
+  storage.clearJournal();
+  return INSTALL_DONE;
+}
+
+void FaceInstaller::suspend() {
+  if (!running) {
+    return;
+  }
+  // the chunks since the last commit passed their CRC, keep them too
+  checkpoint();
+  storage.closeTemp();
+  running = false;
+}
+
+void FaceInstaller::cancel() {
+  if (running) {
+    storage.closeTemp();
+    running = false;
+  }
+  InstallJournal saved;
+  if (storage.loadJournal(saved) && saved.magic == JOURNAL_MAGIC) {
+    storage.discard(saved.name);
+  }
+  storage.clearJournal();
+  received = 0;
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+  return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+         (uint32_t)p[3] << 24;
+}
+
+bool FaceInstaller::isPacket(const uint8_t *data, size_t len) {
+  return len > 0 && (data[0] == INSTALL_PACKET_BEGIN ||
+                     data[0] == INSTALL_PACKET_CHUNK ||
+                     data[0] == INSTALL_PACKET_CANCEL);
+}
+
+InstallStatus FaceInstaller::packet(const uint8_t *data, size_t len,
+                                    uint8_t *reply) {
+  InstallStatus status = INSTALL_RESEND;
+  if (len > 9 && data[0] == INSTALL_PACKET_BEGIN) {
+    char name[INSTALL_NAME_MAX];
+    size_t n = len - 9 < INSTALL_NAME_MAX - 1 ? len - 9 : INSTALL_NAME_MAX - 1;
+    memcpy(name, data + 9, n);
+    name[n] = '\0';
+    status = begin(name, read_u32(data + 1), read_u32(data + 5));
+  } else if (len > 9 && data[0] == INSTALL_PACKET_CHUNK) {
+    status = write(read_u32(data + 1), data + 9, len - 9, read_u32(data + 5));
+  } else if (len >= 1 && data[0] == INSTALL_PACKET_CANCEL) {
+    cancel();
+    status = INSTALL_IDLE;
+  }
+  reply[0] = INSTALL_PACKET_REPLY;
+  reply[1] = status;
+  for (int i = 0; i < 4; i++) {
+    reply[2 + i] = received >> (8 * i);
+  }
+  return status;
+}
+
+const char *FaceInstaller::pending() {
+  static InstallJournal saved;
+  if (running || !storage.loadJournal(saved) ||
+      saved.magic != JOURNAL_MAGIC) {
+    return NULL;
+  }
+  return saved.name;
+}
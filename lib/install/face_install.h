@@ -0,0 +1,226 @@
+#ifndef FACE_INSTALL_H
+#define FACE_INSTALL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class FaceCatalog;
+
+/**
+ * Resumable watchface install.
+ *
+ * Chunks are checked with a CRC32 and appended in order to a temporary
+ * file. Every INSTALL_COMMIT_BYTES the file is synced and the received
+ * offset is written to a small journal, so after a dropped link the sender
+ * only resends from the last committed offset. When the whole file is
+ * there its CRC is checked, the face is validated, the temporary file is
+ * renamed to its final name and an index entry is written.
+ */
+
+#ifndef INSTALL_COMMIT_BYTES
+#define INSTALL_COMMIT_BYTES (8U * 1024U)
+#endif
+
+#define INSTALL_NAME_MAX 32
+
+/*
+ * Packets of the transfer, integers are little endian
+ *   BEGIN  total u32, file CRC u32, name
+ *   CHUNK  offset u32, chunk CRC u32, data
+ *   CANCEL
+ * and the reply sent for each of them
+ *   REPLY  status u8, offset u32 the sender continues from
+ */
+#define INSTALL_PACKET_BEGIN 0xF0
+#define INSTALL_PACKET_CHUNK 0xF1
+#define INSTALL_PACKET_CANCEL 0xF2
+#define INSTALL_PACKET_REPLY 0xF3
+#define INSTALL_REPLY_SIZE 6
+
+enum InstallStatus {
+  INSTALL_OK,        // chunk stored
+  INSTALL_DONE,      // file complete, validated and renamed
+  INSTALL_DUPLICATE, // chunk already stored, ignore
+  INSTALL_RESEND,    // CRC error or gap, resend from `offset()`
+  INSTALL_IDLE,      // no install in progress
+  INSTALL_IO_ERROR,
+  INSTALL_FILE_CRC, // whole file CRC mismatch, install discarded
+  INSTALL_INVALID,  // validation failed, install discarded
+};
+
+struct FaceSummary {
+  char name[INSTALL_NAME_MAX];
+  uint32_t size;
+  uint32_t crc;
+};
+
+struct InstallJournal {
+  uint32_t magic;
+  char name[INSTALL_NAME_MAX];
+  uint32_t total;
+  uint32_t file_crc;  // expected CRC of the whole file, 0 if unknown
+  uint32_t committed; // bytes synced to the temporary file
+  uint32_t crc;       // running CRC of the committed bytes
+};
+
+struct InstallStats {
+  uint32_t chunks;
+  uint32_t resends;    // CRC errors and gaps
+  uint32_t duplicates;
+  uint32_t resumes;
+  uint32_t resumed_bytes; // bytes that did not have to be sent again
+  uint32_t commits;
+};
+
+uint32_t install_crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+/**
+ * Where the install is written. A file system implementation is provided,
+ * tests can wrap it to inject failures.
+ */
+class InstallStorage {
+public:
+  virtual ~InstallStorage() {}
+  /**
+   * Open the temporary file of `name` for writing at `offset`, bytes past
+   * it are overwritten as the transfer continues
+   */
+  virtual bool openTemp(const char *name, uint32_t offset) = 0;
+  virtual uint32_t tempSize(const char *name) = 0;
+  virtual bool append(const uint8_t *data, uint32_t len) = 0;
+  virtual bool sync() = 0;
+  virtual void closeTemp() = 0;
+  virtual bool readTemp(const char *name, uint32_t offset, uint8_t *data,
+                        uint32_t len) = 0;
+  /**
+   * Replace `name` with its temporary file
+   */
+  virtual bool commit(const char *name) = 0;
+  virtual void discard(const char *name) = 0;
+
+  virtual bool loadJournal(InstallJournal &journal) = 0;
+  virtual bool saveJournal(const InstallJournal &journal) = 0;
+  virtual void clearJournal() = 0;
+};
+
+/**
+ * Files under `root` (e.g. "/ffat"), the temporary file is `<name>.part`
+ * and the journal `install.jnl`. An installed face is added to `catalog`,
+ * the face index of `root`.
+ */
+class FileInstallStorage : public InstallStorage {
+public:
+  FileInstallStorage(const char *root, FaceCatalog *catalog = NULL);
+  bool openTemp(const char *name, uint32_t offset);
+  uint32_t tempSize(const char *name);
+  bool append(const uint8_t *data, uint32_t len);
+  bool sync();
+  void closeTemp();
+  bool readTemp(const char *name, uint32_t offset, uint8_t *data,
+                uint32_t len);
+  bool commit(const char *name);
+  void discard(const char *name);
+  bool loadJournal(InstallJournal &journal);
+  bool saveJournal(const InstallJournal &journal);
+  void clearJournal();
+
+private:
+  void path(char *out, size_t len, const char *name, const char *ext);
+
+  const char *root;
+  FaceCatalog *catalog;
+  void *temp; // FILE *
+};
+
+/**
+ * Check a complete file before it is installed and fill the summary
+ * @return false to reject the face
+ */
+typedef bool (*FaceValidator)(InstallStorage &storage, const char *name,
+                              uint32_t size, FaceSummary &summary);
+
+class FaceInstaller {
+public:
+  FaceInstaller(InstallStorage &storage,
+                uint32_t commit_bytes = INSTALL_COMMIT_BYTES);
+
+  void setValidator(FaceValidator validator);
+
+  /**
+   * Only accept names ending in `ext`, e.g. ".wf" for the catalog
+   */
+  void setExtension(const char *ext);
+
+  /**
+   * Start or resume an install
+   * @param name file name, e.g. "kenya.bin", without directories
+   * @param total file size
+   * @param file_crc CRC32 of the whole file, 0 if the sender has none
+   * @return INSTALL_OK, `offset()` is where the sender starts, or
+   * INSTALL_INVALID for a name that could leave the face directory
+   */
+  InstallStatus begin(const char *name, uint32_t total, uint32_t file_crc);
+
+  /**
+   * Store a chunk
+   * @param offset position of the chunk in the file
+   * @param data chunk data
+   * @param len chunk size
+   * @param crc CRC32 of the chunk
+   */
+  InstallStatus write(uint32_t offset, const uint8_t *data, uint32_t len,
+                      uint32_t crc);
+
+  /**
+   * @return true if `data` is a BEGIN, CHUNK or CANCEL packet
+   */
+  static bool isPacket(const uint8_t *data, size_t len);
+
+  /**
+   * Run a packet received from the link
+   * @param reply INSTALL_REPLY_SIZE bytes to send back
+   * @return status of the packet, INSTALL_RESEND if it is malformed
+   */
+  InstallStatus packet(const uint8_t *data, size_t len, uint8_t *reply);
+
+  /**
+   * Link dropped, keep what was committed for a later `begin`
+   */
+  void suspend();
+
+  /**
+   * Drop the install and its temporary file
+   */
+  void cancel();
+
+  bool active() const { return running; }
+  /**
+   * Offset the sender should continue from
+   */
+  uint32_t offset() const { return received; }
+  uint32_t total() const { return journal.total; }
+  const FaceSummary &installed() const { return summary; }
+  const InstallStats &stats() const { return counters; }
+
+  /**
+   * Name of an interrupted install found in the journal, NULL if none
+   */
+  const char *pending();
+
+private:
+  bool checkpoint();
+  InstallStatus finish();
+
+  InstallStorage &storage;
+  uint32_t commit_bytes;
+  FaceValidator validator;
+  const char *extension;
+  InstallJournal journal;
+  FaceSummary summary;
+  InstallStats counters;
+  uint32_t received;
+  uint32_t crc;
+  bool running;
+};
+
+#endif /*FACE_INSTALL_H*/
@@ -0,0 +1,136 @@
+#include "face_install.h"
+#include "face_catalog.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PATH_MAX_LEN 96
+
+FileInstallStorage::FileInstallStorage(const char *root, FaceCatalog *catalog)
+    : root(root), catalog(catalog), temp(NULL) {}
+
+void FileInstallStorage::path(char *out, size_t len, const char *name,
+                              const char *ext) {
+  while (*name == '/') {
+    name++;
+  }
+  snprintf(out, len, "%s/%s%s", root, name, ext);
+}
+
+bool FileInstallStorage::openTemp(const char *name, uint32_t offset) {
+  char p[PATH_MAX_LEN];
+  path(p, sizeof(p), name, ".part");
+  closeTemp();
+
+  FILE *f = fopen(p, offset ? "r+b" : "wb");
+  if (f == NULL) {
+    return false;
+  }
+  if (offset && fseek(f, offset, SEEK_SET) != 0) {
+    fclose(f);
+    return false;
+  }
+  temp = f;
+  return true;
+}
+
+uint32_t FileInstallStorage::tempSize(const char *name) {
+  char p[PATH_MAX_LEN];
+  path(p, sizeof(p), name, ".part");
+  struct stat st;
+  return stat(p, &st) == 0 ? (uint32_t)st.st_size : 0;
+}
+
+bool FileInstallStorage::append(const uint8_t *data, uint32_t len) {
+  return temp && fwrite(data, 1, len, (FILE *)temp) == len;
+}
+
+bool FileInstallStorage::sync() {
+  if (temp == NULL || fflush((FILE *)temp) != 0) {
+    return false;
+  }
+  return fsync(fileno((FILE *)temp)) == 0;
+}
+
+void FileInstallStorage::closeTemp() {
+  if (temp) {
+    fclose((FILE *)temp);
+    temp = NULL;
+  }
+}
+
+bool FileInstallStorage::readTemp(const char *name, uint32_t offset,
+                                  uint8_t *data, uint32_t len) {
+  char p[PATH_MAX_LEN];
+  path(p, sizeof(p), name, ".part");
+  FILE *f = fopen(p, "rb");
+  if (f == NULL) {
+    return false;
+  }
+  bool ok = fseek(f, offset, SEEK_SET) == 0 && fread(data, 1, len, f) == len;
+  fclose(f);
+  return ok;
+}
+
+bool FileInstallStorage::commit(const char *name) {
+  char from[PATH_MAX_LEN], to[PATH_MAX_LEN];
+  path(from, sizeof(from), name, ".part");
+  path(to, sizeof(to), name, "");
+  remove(to); // FAT rename does not replace
+  if (rename(from, to) != 0) {
+    return false;
+  }
+  if (catalog) {
+    // the face is installed either way, a failed entry is redone by sync
+    while (*name == '/') {
+      name++;
+    }
+    catalog->add(name);
+  }
+  return true;
+}
+
+void FileInstallStorage::discard(const char *name) {
+  char p[PATH_MAX_LEN];
+  path(p, sizeof(p), name, ".part");
+  remove(p);
+}
+
+bool FileInstallStorage::loadJournal(InstallJournal &journal) {
+  char p[PATH_MAX_LEN];
+  path(p, sizeof(p), "install.jnl", "");
+  FILE *f = fopen(p, "rb");
+  if (f == NULL) {
+    return false;
+  }
+  uint32_t check = 0;
+  bool ok = fread(&journal, sizeof(journal), 1, f) == 1 &&
+            fread(&check, sizeof(check), 1, f) == 1;
+  fclose(f);
+  // a journal torn by a power loss is ignored
+  return ok && check == install_crc32(0, (const uint8_t *)&journal,
+                                      sizeof(journal));
+}
+
+bool FileInstallStorage::saveJournal(const InstallJournal &journal) {
+  char p[PATH_MAX_LEN];
+  path(p, sizeof(p), "install.jnl", "");
+  FILE *f = fopen(p, "wb");
+  if (f == NULL) {
+    return false;
+  }
+  uint32_t check =
+      install_crc32(0, (const uint8_t *)&journal, sizeof(journal));
+  bool ok = fwrite(&journal, sizeof(journal), 1, f) == 1 &&
+            fwrite(&check, sizeof(check), 1, f) == 1 && fflush(f) == 0 &&
+            fsync(fileno(f)) == 0;
+  fclose(f);
+  return ok;
+}
+
+void FileInstallStorage::clearJournal() {
+  char p[PATH_MAX_LEN];
+  path(p, sizeof(p), "install.jnl", "");
+  remove(p);
+}
@@ -0,0 +1,299 @@
+#include "mem_governor.h"
+#include <lvgl.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#endif
+
+struct MemAction {
+  MemLevel level;
+  const char *name;
+  mem_shed_cb_t cb;
+  mem_restore_cb_t restore;
+};
+
+static MemBudget budget;
+static void (*print_cb)(const char *);
+static MemAction actions[MEM_ACTIONS_MAX];
+static uint8_t action_count;
+static bool ran[MEM_ACTIONS_MAX]; // in this episode
+static MemLevel level = MEM_OK;
+static MemUsage lows;
+static mem_usage_cb_t usage_cb;
+
+static MemDecision decisions[MEM_DECISIONS];
+static uint8_t decision_head;
+static uint8_t decision_count;
+
+static const char *level_names[MEM_LEVELS] = {"ok", "shed caches",
+                                              "unload screens", "degrade"};
+
+MemBudget mem_budget_for_board() {
+  MemBudget b;
+#if defined(ESPC3)
+  // 400K SRAM shared with BLE and the 120K LVGL pool, no PSRAM
+  b.lvgl_min_free = 12 * 1024;
+  b.lvgl_min_block = 6 * 1024;
+  b.sys_min_free = 24 * 1024;
+  b.sys_min_block = 12 * 1024;
+#elif defined(ESPS3_1_28) || defined(ESPS3_1_69)
+  b.lvgl_min_free = 12 * 1024;
+  b.lvgl_min_block = 6 * 1024;
+  b.sys_min_free = 48 * 1024;
+  b.sys_min_block = 24 * 1024;
+#else
+  b.lvgl_min_free = 12 * 1024;
+  b.lvgl_min_block = 6 * 1024;
+  b.sys_min_free = 32 * 1024;
+  b.sys_min_block = 16 * 1024;
+#endif
+  return b;
+}
+
+static void report_line(const char *fmt, ...) {
+  if (print_cb == NULL) {
+    return;
+  }
+  char line[128];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  print_cb(line);
+}
+
+MemUsage mem_governor_usage() {
+  if (usage_cb) {
+    return usage_cb();
+  }
+  MemUsage u;
+#if LV_MEM_CUSTOM == 0
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  u.lvgl_free = mon.free_size;
+  u.lvgl_block = mon.free_biggest_size;
+#else
+  u.lvgl_free = UINT32_MAX; // system malloc, counted below
+  u.lvgl_block = UINT32_MAX;
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  u.sys_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  u.sys_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+#else
+  u.sys_free = UINT32_MAX; // not tracked on the host
+  u.sys_block = UINT32_MAX;
+#endif
+  return u;
+}
+
+static uint32_t shortfall(uint32_t have, uint32_t need) {
+  return have < need ? need - have : 0;
+}
+
+/**
+ * Bytes missing to keep budget `b` after allocating the given amounts
+ */
+static uint32_t deficit(const MemUsage &u, const MemBudget &b,
+                        uint32_t lvgl_bytes, uint32_t sys_bytes) {
+  uint32_t d = 0;
+  if (lvgl_bytes || u.lvgl_free != UINT32_MAX) {
+    d = LV_MAX(d, shortfall(u.lvgl_free, b.lvgl_min_free + lvgl_bytes));
+    d = LV_MAX(d,
+               shortfall(u.lvgl_block, LV_MAX(lvgl_bytes, b.lvgl_min_block)));
+  }
+  if (sys_bytes || u.sys_free != UINT32_MAX) {
+    d = LV_MAX(d, shortfall(u.sys_free, b.sys_min_free + sys_bytes));
+    d = LV_MAX(d,
+               shortfall(u.sys_block, LV_MAX(sys_bytes, b.sys_min_block)));
+  }
+  return d;
+}
+
+/* High-water mark that ends an episode */
+static bool recovered(const MemUsage &u) {
+  MemBudget high;
+  high.lvgl_min_free = budget.lvgl_min_free * MEM_RECOVER_PCT / 100;
+  high.lvgl_min_block = budget.lvgl_min_block * MEM_RECOVER_PCT / 100;
+  high.sys_min_free = budget.sys_min_free * MEM_RECOVER_PCT / 100;
+  high.sys_min_block = budget.sys_min_block * MEM_RECOVER_PCT / 100;
+  return deficit(u, high, 0, 0) == 0;
+}
+
+static void track_lows(const MemUsage &u) {
+  lows.lvgl_free = LV_MIN(lows.lvgl_free, u.lvgl_free);
+  lows.lvgl_block = LV_MIN(lows.lvgl_block, u.lvgl_block);
+  lows.sys_free = LV_MIN(lows.sys_free, u.sys_free);
+  lows.sys_block = LV_MIN(lows.sys_block, u.sys_block);
+}
+
+static void record(MemLevel lvl, const char *name, const MemUsage &before,
+                   const MemUsage &after) {
+  MemDecision &d = decisions[decision_head];
+  decision_head = (decision_head + 1) % MEM_DECISIONS;
+  if (decision_count < MEM_DECISIONS) {
+    decision_count++;
+  }
+  d.time = lv_tick_get();
+  d.level = lvl;
+  d.action = name;
+  d.lvgl_gain = before.lvgl_free == UINT32_MAX
+                    ? 0
+                    : (int32_t)(after.lvgl_free - before.lvgl_free);
+  d.sys_gain = before.sys_free == UINT32_MAX
+                   ? 0
+                   : (int32_t)(after.sys_free - before.sys_free);
+  report_line("mem: %s: %s, lvgl %+ld (free %lu), sys %+ld\n",
+              level_names[lvl], name, (long)d.lvgl_gain,
+              (unsigned long)after.lvgl_free, (long)d.sys_gain);
+}
+
+/**
+ * Run shed actions level by level until `lvgl_bytes` and `sys_bytes` fit
+ * @param once skip the actions that already ran in this episode
+ * @param last highest level allowed to run
+ * @param used highest level run by this call
+ */
+static bool shed(uint32_t lvgl_bytes, uint32_t sys_bytes, bool once,
+                 MemLevel last, MemLevel *used) {
+  MemUsage u = mem_governor_usage();
+  track_lows(u);
+  uint32_t missing = deficit(u, budget, lvgl_bytes, sys_bytes);
+  if (missing == 0) {
+    return true;
+  }
+
+  bool acted = false;
+  for (int lvl = MEM_SHED_CACHES; lvl <= last; lvl++) {
+    for (uint8_t i = 0; i < action_count; i++) {
+      if (actions[i].level != lvl || (once && ran[i])) {
+        continue;
+      }
+      actions[i].cb(missing);
+      ran[i] = true;
+      acted = true;
+      MemUsage after = mem_governor_usage();
+      record((MemLevel)lvl, actions[i].name, u, after);
+      u = after;
+      level = LV_MAX(level, (MemLevel)lvl);
+      *used = LV_MAX(*used, (MemLevel)lvl);
+      missing = deficit(u, budget, lvgl_bytes, sys_bytes);
+      if (missing == 0) {
+        return true;
+      }
+    }
+  }
+  if (acted && last == MEM_DEGRADE) {
+    report_line("mem: still %lu bytes short after every action\n",
+                (unsigned long)missing);
+  }
+  return false;
+}
+
+void mem_governor_begin(const MemBudget &b, void (*print)(const char *)) {
+  budget = b;
+  print_cb = print;
+  level = MEM_OK;
+  memset(ran, 0, sizeof(ran));
+  lows = mem_governor_usage();
+}
+
+bool mem_governor_add(MemLevel lvl, const char *name, mem_shed_cb_t cb,
+                      mem_restore_cb_t restore) {
+  if (action_count >= MEM_ACTIONS_MAX || lvl == MEM_OK) {
+    return false;
+  }
+  actions[action_count].level = lvl;
+  actions[action_count].name = name;
+  actions[action_count].cb = cb;
+  actions[action_count].restore = restore;
+  action_count++;
+  return true;
+}
+
+/**
+ * Undo the actions of the episode, last first, while the heaps stay above
+ * the high-water mark. The others are undone by a later check.
+ * @return true if nothing is left to undo
+ */
+static bool restore_actions() {
+  for (int i = action_count - 1; i >= 0; i--) {
+    if (!ran[i] || actions[i].restore == NULL) {
+      continue;
+    }
+    if (!recovered(mem_governor_usage())) {
+      return false;
+    }
+    actions[i].restore();
+    ran[i] = false;
+    report_line("mem: restored %s\n", actions[i].name);
+  }
+  return true;
+}
+
+MemLevel mem_governor_check() {
+  if (level != MEM_OK && recovered(mem_governor_usage()) &&
+      restore_actions()) {
+    report_line("mem: recovered from %s\n", level_names[level]);
+    level = MEM_OK;
+    memset(ran, 0, sizeof(ran));
+  }
+  MemLevel used = MEM_OK;
+  shed(0, 0, true, MEM_DEGRADE, &used);
+  return used;
+}
+
+bool mem_governor_reserve(uint32_t lvgl_bytes, uint32_t sys_bytes) {
+  MemLevel used = MEM_OK;
+  // degraded modes change state the caller may be in the middle of using,
+  // e.g. the draw buffers during a refresh, only the loop check runs them
+  return shed(lvgl_bytes, sys_bytes, false, MEM_UNLOAD_SCREENS, &used);
+}
+
+void mem_governor_set_usage(mem_usage_cb_t cb) { usage_cb = cb; }
+
+MemLevel mem_governor_level() { return level; }
+
+const MemBudget &mem_governor_budget() { return budget; }
+
+uint8_t mem_governor_decision_count() { return decision_count; }
+
+const MemDecision *mem_governor_decision(uint8_t index) {
+  if (index >= decision_count) {
+    return NULL;
+  }
+  uint8_t first = (decision_head + MEM_DECISIONS - decision_count) %
+                  MEM_DECISIONS;
+  return &decisions[(first + index) % MEM_DECISIONS];
+}
+
+void mem_governor_report() {
+  MemUsage u = mem_governor_usage();
+  track_lows(u);
+  report_line("mem: level %s, lvgl free %lu (low %lu) block %lu, sys free %lu "
+              "(low %lu) block %lu\n",
+              level_names[level], (unsigned long)u.lvgl_free,
+              (unsigned long)lows.lvgl_free, (unsigned long)u.lvgl_block,
+              (unsigned long)u.sys_free, (unsigned long)lows.sys_free,
+              (unsigned long)u.sys_block);
+  for (uint8_t i = 0; i < decision_count; i++) {
+    const MemDecision *d = mem_governor_decision(i);
+    report_line("mem:   %lums %s: %s lvgl %+ld sys %+ld\n",
+                (unsigned long)d->time, level_names[d->level], d->action,
+                (long)d->lvgl_gain, (long)d->sys_gain);
+  }
+}
+
+extern "C" void mem_governor_fault(void) {
+  report_line("mem: LVGL assert, out of memory?\n");
+  mem_governor_report();
+#ifdef ARDUINO_ARCH_ESP32
+  esp_restart();
+#else
+  abort();
+#endif
+}
@@ -0,0 +1,153 @@
+#ifndef MEM_GOVERNOR_H
+#define MEM_GOVERNOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Keeps the LVGL heap and the system heap inside a per-board budget.
+ *
+ * The HAL registers shed actions by level: optional caches first, then
+ * off-screen screens, then degraded modes (e.g. legacy transitions, a
+ * single draw buffer). `mem_governor_check` runs them in order until the
+ * heaps are back inside the budget, `mem_governor_reserve` does the same
+ * with the caches and screens before a large allocation. Every decision is
+ * printed.
+ *
+ * The periodic check runs each action once per episode: from the first
+ * deficit until the heaps are back above MEM_RECOVER_PCT percent of the
+ * budget. A heap that stays low does not clear the caches on every check.
+ * When the episode ends the degraded modes are undone, last first, by
+ * their restore callbacks.
+ */
+
+enum MemLevel {
+  MEM_OK,
+  MEM_SHED_CACHES,
+  MEM_UNLOAD_SCREENS,
+  MEM_DEGRADE,
+  MEM_LEVELS
+};
+
+struct MemBudget {
+  uint32_t lvgl_min_free;  // free bytes in the LVGL heap
+  uint32_t lvgl_min_block; // largest free LVGL block
+  uint32_t sys_min_free;   // free internal RAM
+  uint32_t sys_min_block;  // largest free internal block
+};
+
+struct MemUsage {
+  uint32_t lvgl_free;
+  uint32_t lvgl_block;
+  uint32_t sys_free;
+  uint32_t sys_block;
+};
+
+struct MemDecision {
+  uint32_t time;
+  MemLevel level;
+  const char *action;
+  int32_t lvgl_gain; // bytes, measured after the action
+  int32_t sys_gain;
+};
+
+/**
+ * Release memory
+ * @param deficit bytes still missing (a hint, the gain is measured)
+ */
+typedef void (*mem_shed_cb_t)(uint32_t deficit);
+
+/**
+ * Undo a shed action once memory recovered, e.g. allocate a buffer again
+ */
+typedef void (*mem_restore_cb_t)();
+
+#ifndef MEM_ACTIONS_MAX
+#define MEM_ACTIONS_MAX 12
+#endif
+
+#define MEM_DECISIONS 8
+
+#ifndef MEM_RECOVER_PCT
+#define MEM_RECOVER_PCT 150 // of the budget, ends a shed episode
+#endif
+
+/**
+ * Source of the heap figures, for tests
+ */
+typedef MemUsage (*mem_usage_cb_t)();
+
+/**
+ * Budget of the board the firmware is built for (ESPC3, ESPS3_1_28, ...)
+ */
+MemBudget mem_budget_for_board();
+
+/**
+ * @param budget limits to keep
+ * @param print output for the decisions and reports, e.g. Serial.print
+ */
+void mem_governor_begin(const MemBudget &budget, void (*print)(const char *));
+
+/**
+ * Register a shed action, actions of a level run in registration order
+ * @param restore optional, run by `mem_governor_check` after the heaps
+ * recovered
+ */
+bool mem_governor_add(MemLevel level, const char *name, mem_shed_cb_t cb,
+                      mem_restore_cb_t restore = NULL);
+
+/**
+ * Shed until the heaps are inside the budget, call from the loop outside
+ * `lv_timer_handler`.
+ * Actions that already ran in this episode are skipped.
+ * @return highest level used by this call, MEM_OK if nothing ran
+ */
+MemLevel mem_governor_check();
+
+/**
+ * Make room before an allocation, may be called from inside
+ * `lv_timer_handler`. Cache and screen actions can run again in the same
+ * episode, degraded modes are left to `mem_governor_check`.
+ * @param lvgl_bytes bytes about to be allocated from the LVGL heap
+ * @param sys_bytes bytes about to be allocated from the system heap
+ * @return false if the budget can not be kept after the allocation
+ */
+bool mem_governor_reserve(uint32_t lvgl_bytes, uint32_t sys_bytes);
+
+MemUsage mem_governor_usage();
+
+/**
+ * Replace the heap figures, NULL to measure the heaps again
+ */
+void mem_governor_set_usage(mem_usage_cb_t cb);
+
+/**
+ * @return highest level used since the heaps last recovered
+ */
+MemLevel mem_governor_level();
+const MemBudget &mem_governor_budget();
+
+/**
+ * Recent decisions, index 0 is the oldest kept
+ */
+uint8_t mem_governor_decision_count();
+const MemDecision *mem_governor_decision(uint8_t index);
+
+/**
+ * Print usage, lows and the recent decisions
+ */
+void mem_governor_report();
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+ * LV_ASSERT_HANDLER: print what led to the failure, then restart (esp32)
+ * or abort (native) instead of halting silently
+ */
+void mem_governor_fault(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*MEM_GOVERNOR_H*/
@@ -0,0 +1,60 @@
+#include "notification_store.h"
+#include <string.h>
+
+uint32_t utf8_copy(char *dst, const char *src, uint32_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  uint32_t len = strlen(src);
+  if (len >= size) {
+    len = size - 1;
+    // back up over continuation bytes to the lead byte of the cut character
+    uint32_t lead = len;
+    while (lead > 0 && ((uint8_t)src[lead] & 0xC0) == 0x80) {
+      lead--;
+    }
+    len = lead;
+  }
+  memcpy(dst, src, len);
+  dst[len] = '\0';
+  return len;
+}
+
+NotificationStore::NotificationStore() : head(0), used(0), next_id(1) {
+  memset(records, 0, sizeof(records));
+}
+
+const NotificationRecord &NotificationStore::add(uint8_t icon,
+                                                 const char *app,
+                                                 const char *time,
+                                                 const char *message) {
+  head = (head + NOTIFICATION_MAX - 1) % NOTIFICATION_MAX;
+  if (used < NOTIFICATION_MAX) {
+    used++;
+  }
+  NotificationRecord &r = records[head];
+  r.id = next_id++;
+  r.icon = icon;
+  utf8_copy(r.app, app, sizeof(r.app));
+  utf8_copy(r.time, time, sizeof(r.time));
+  utf8_copy(r.message, message, sizeof(r.message));
+  return r;
+}
+
+const NotificationRecord &NotificationStore::get(uint8_t index) const {
+  return records[(head + index) % NOTIFICATION_MAX];
+}
+
+int NotificationStore::find(uint32_t id) const {
+  for (uint8_t i = 0; i < used; i++) {
+    if (get(i).id == id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void NotificationStore::clear() {
+  used = 0;
+  next_id++;
+}
@@ -0,0 +1,73 @@
+#ifndef NOTIFICATION_STORE_H
+#define NOTIFICATION_STORE_H
+
+#include <stdint.h>
+
+/**
+ * The last NOTIFICATION_MAX notifications in fixed storage, newest first.
+ * Text is copied and cut at a UTF-8 character boundary, so nothing is
+ * allocated when a notification arrives.
+ */
+
+#ifndef NOTIFICATION_MAX
+#define NOTIFICATION_MAX 10
+#endif
+
+#ifndef NOTIFICATION_TEXT_MAX
+#define NOTIFICATION_TEXT_MAX 256
+#endif
+
+#define NOTIFICATION_APP_MAX 20
+#define NOTIFICATION_TIME_MAX 8
+
+struct NotificationRecord {
+  uint32_t id; // increases with every notification
+  uint8_t icon;
+  char app[NOTIFICATION_APP_MAX];
+  char time[NOTIFICATION_TIME_MAX];
+  char message[NOTIFICATION_TEXT_MAX];
+};
+
+/**
+ * Copy `src` into `dst` without splitting a UTF-8 sequence
+ * @return bytes copied, excluding the terminator
+ */
+uint32_t utf8_copy(char *dst, const char *src, uint32_t size);
+
+class NotificationStore {
+public:
+  NotificationStore();
+
+  /**
+   * Add a notification, the oldest one is dropped when full
+   * @return the stored record
+   */
+  const NotificationRecord &add(uint8_t icon, const char *app,
+                                const char *time, const char *message);
+
+  /**
+   * @param index 0 is the newest
+   */
+  const NotificationRecord &get(uint8_t index) const;
+
+  /**
+   * Index of the notification with `id`, -1 if it was dropped
+   */
+  int find(uint32_t id) const;
+
+  uint8_t count() const { return used; }
+  void clear();
+
+  /**
+   * Changes on every add or clear, the list is rebuilt only when it differs
+   */
+  uint32_t revision() const { return next_id; }
+
+private:
+  NotificationRecord records[NOTIFICATION_MAX];
+  uint8_t head; // slot of the newest
+  uint8_t used;
+  uint32_t next_id;
+};
+
+#endif /*NOTIFICATION_STORE_H*/
@@ -0,0 +1,80 @@
+#include "time_format.h"
+#include <stdio.h>
+
+static const char *weekdays[7] = {"Sunday",   "Monday", "Tuesday",
+                                  "Wednesday", "Thursday", "Friday",
+                                  "Saturday"};
+static const char *months[12] = {"January", "February", "March",
+                                 "April",   "May",      "June",
+                                 "July",    "August",   "September",
+                                 "October", "November", "December"};
+
+/**
+ * snprintf length clamped to what was written
+ */
+static size_t written(int n, size_t len) {
+  if (n < 0 || len == 0) {
+    return 0;
+  }
+  return (size_t)n < len ? (size_t)n : len - 1;
+}
+
+ClockTime clock_time(const struct tm &tm) {
+  ClockTime t;
+  t.year = 1900 + tm.tm_year;
+  t.month = 1 + tm.tm_mon;
+  t.day = tm.tm_mday;
+  t.weekday = tm.tm_wday;
+  t.hour = tm.tm_hour;
+  t.minute = tm.tm_min;
+  t.second = tm.tm_sec;
+  return t;
+}
+
+const char *clock_weekday_name(uint8_t weekday) {
+  return weekday < 7 ? weekdays[weekday] : "";
+}
+
+const char *clock_month_name(uint8_t month) {
+  return month >= 1 && month <= 12 ? months[month - 1] : "";
+}
+
+uint8_t clock_display_hour(uint8_t hour, bool h24) {
+  if (h24) {
+    return hour;
+  }
+  hour %= 12;
+  return hour == 0 ? 12 : hour;
+}
+
+size_t clock_format_time(char *out, size_t len, const ClockTime &t, bool h24) {
+  int n;
+  if (h24) {
+    n = snprintf(out, len, "%02u:%02u", (unsigned)t.hour, (unsigned)t.minute);
+  } else {
+    n = snprintf(out, len, "%u:%02u %s",
+                 (unsigned)clock_display_hour(t.hour, false),
+                 (unsigned)t.minute, t.hour < 12 ? "AM" : "PM");
+  }
+  return written(n, len);
+}
+
+size_t clock_format_date(char *out, size_t len, const ClockTime &t) {
+  int n = snprintf(out, len, "%02u\n%s", (unsigned)t.day,
+                   clock_month_name(t.month));
+  return written(n, len);
+}
+
+size_t clock_format_age(char *out, size_t len, uint32_t seconds) {
+  int n;
+  if (seconds < 60) {
+    n = snprintf(out, len, "now");
+  } else if (seconds < 3600) {
+    n = snprintf(out, len, "%u min", (unsigned)(seconds / 60));
+  } else if (seconds < 86400) {
+    n = snprintf(out, len, "%u h", (unsigned)(seconds / 3600));
+  } else {
+    n = snprintf(out, len, "%u d", (unsigned)(seconds / 86400));
+  }
+  return written(n, len);
+}
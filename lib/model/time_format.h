@@ -0,0 +1,49 @@
+#ifndef TIME_FORMAT_H
+#define TIME_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * Clock fields and the text the watchfaces show for them.
+ * Plain C++, shared by the HALs and the native tests.
+ */
+
+struct ClockTime {
+  uint16_t year;
+  uint8_t month;   // 1 - 12
+  uint8_t day;     // 1 - 31
+  uint8_t weekday; // 0 = Sunday
+  uint8_t hour;    // 0 - 23
+  uint8_t minute;
+  uint8_t second;
+};
+
+ClockTime clock_time(const struct tm &tm);
+
+const char *clock_weekday_name(uint8_t weekday);
+const char *clock_month_name(uint8_t month);
+
+/**
+ * Hour as shown on the face, 1 - 12 in 12 hour mode
+ */
+uint8_t clock_display_hour(uint8_t hour, bool h24);
+
+/**
+ * "09:30" in 24 hour mode, "9:30 PM" in 12 hour mode
+ * @return length written, excluding the terminator
+ */
+size_t clock_format_time(char *out, size_t len, const ClockTime &t, bool h24);
+
+/**
+ * "11\nMay", the two line date of the default face
+ */
+size_t clock_format_date(char *out, size_t len, const ClockTime &t);
+
+/**
+ * Age of a notification: "now", "5 min", "3 h", "2 d"
+ */
+size_t clock_format_age(char *out, size_t len, uint32_t seconds);
+
+#endif /*TIME_FORMAT_H*/
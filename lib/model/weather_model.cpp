@@ -0,0 +1,82 @@
+#include "weather_model.h"
+#include "notification_store.h"
+#include <string.h>
+
+static bool same(const WeatherDay &a, const WeatherDay &b) {
+  return a.icon == b.icon && a.day == b.day && a.temp == b.temp &&
+         a.high == b.high && a.low == b.low;
+}
+
+WeatherModel::WeatherModel() : days_count(0), updated_at(0), changes(0) {
+  memset(days, 0, sizeof(days));
+  city_name[0] = '\0';
+}
+
+bool WeatherModel::set(uint8_t index, const WeatherDay &d) {
+  if (index >= WEATHER_DAYS) {
+    return false;
+  }
+  bool known = index < days_count;
+  if (known && same(days[index], d)) {
+    return false;
+  }
+  days[index] = d;
+  if (!known) {
+    // days in between stay as they were, they are filled by later updates
+    days_count = index + 1;
+  }
+  changes |= 1 << index;
+  return true;
+}
+
+void WeatherModel::update(const WeatherDay *list, uint8_t count) {
+  if (count > WEATHER_DAYS) {
+    count = WEATHER_DAYS;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    set(i, list[i]);
+  }
+  for (uint8_t i = count; i < days_count; i++) {
+    changes |= 1 << i;
+  }
+  days_count = count;
+}
+
+void WeatherModel::setCity(const char *city) {
+  if (strncmp(city_name, city, sizeof(city_name) - 1) != 0) {
+    utf8_copy(city_name, city, sizeof(city_name));
+    changes |= WEATHER_CHANGED_INFO;
+  }
+}
+
+void WeatherModel::setUpdated(uint8_t hour, uint8_t minute) {
+  uint16_t at = hour * 60 + minute;
+  if (at != updated_at) {
+    updated_at = at;
+    changes |= WEATHER_CHANGED_INFO;
+  }
+}
+
+void WeatherModel::advance(uint8_t weekday) {
+  uint8_t shift = 0;
+  while (shift < days_count && days[shift].day != weekday) {
+    shift++;
+  }
+  if (shift == 0) {
+    return;
+  }
+  uint8_t remaining = days_count - shift;
+  for (uint8_t i = 0; i < remaining; i++) {
+    days[i] = days[i + shift];
+  }
+  for (uint8_t i = 0; i < days_count; i++) {
+    changes |= 1 << i;
+  }
+  days_count = remaining;
+}
+
+uint8_t WeatherModel::takeChanges() {
+  uint8_t c = changes;
+  changes = 0;
+  return c;
+}
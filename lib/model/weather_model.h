@@ -0,0 +1,69 @@
+#ifndef WEATHER_MODEL_H
+#define WEATHER_MODEL_H
+
+#include <stdint.h>
+
+/**
+ * Current weather and the week forecast.
+ * Updates only mark the days that actually changed, so the weather screen
+ * rebinds those rows instead of rebuilding the forecast list.
+ */
+
+#define WEATHER_DAYS 7
+#define WEATHER_CITY_MAX 32
+
+struct WeatherDay {
+  uint8_t icon;
+  uint8_t day; // weekday, 0 = Sunday
+  int16_t temp;
+  int16_t high;
+  int16_t low;
+};
+
+class WeatherModel {
+public:
+  WeatherModel();
+
+  /**
+   * Set one forecast day, index 0 is today
+   * @return true if it differs from the stored day
+   */
+  bool set(uint8_t index, const WeatherDay &day);
+
+  /**
+   * Set the forecast from `count` days, the days past `count` are dropped
+   */
+  void update(const WeatherDay *days, uint8_t count);
+
+  void setCity(const char *city);
+  void setUpdated(uint8_t hour, uint8_t minute);
+
+  /**
+   * Move to a new day: the forecast shifts so index 0 is `weekday`, the
+   * days that are no longer known are dropped
+   */
+  void advance(uint8_t weekday);
+
+  uint8_t count() const { return days_count; }
+  const WeatherDay &day(uint8_t index) const { return days[index]; }
+  const WeatherDay &today() const { return days[0]; }
+  const char *city() const { return city_name; }
+  uint16_t updated() const { return updated_at; } // hour * 60 + minute
+
+  /**
+   * Bit n set when day n changed, bit 7 for the city or update time.
+   * Reading clears it.
+   */
+  uint8_t takeChanges();
+
+private:
+  WeatherDay days[WEATHER_DAYS];
+  uint8_t days_count;
+  char city_name[WEATHER_CITY_MAX];
+  uint16_t updated_at;
+  uint8_t changes;
+};
+
+#define WEATHER_CHANGED_INFO 0x80
+
+#endif /*WEATHER_MODEL_H*/
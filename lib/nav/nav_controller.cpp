@@ -0,0 +1,200 @@
+#include "nav_controller.h"
+#include "screen_registry.h"
+
+/* An image cache entry is keyed on the source, recolor and frame */
+struct NavImage {
+  const void *src;
+  lv_color_t recolor;
+  int32_t frame_id;
+};
+
+struct NavState {
+  NavGraph graph;
+  NavGesture gesture;
+  lv_obj_t **handles[NAV_SCREENS_MAX];
+  NavImage images[NAV_PREFETCH_IMAGES];
+  uint8_t image_count;
+  int8_t current;
+  bool started;
+  bool enabled;
+  NavStats stats;
+};
+
+static NavState nav = {};
+
+static lv_obj_tree_walk_res_t collect_image(lv_obj_t *obj, void *user_data) {
+  if (nav.image_count >= NAV_PREFETCH_IMAGES) {
+    return LV_OBJ_TREE_WALK_END;
+  }
+  if (lv_obj_check_type(obj, &lv_img_class)) {
+    const void *src = lv_img_get_src(obj);
+    lv_img_src_t type = lv_img_src_get_type(src);
+    if (type == LV_IMG_SRC_VARIABLE || type == LV_IMG_SRC_FILE) {
+      // the key the image will be drawn with
+      lv_draw_img_dsc_t dsc;
+      lv_draw_img_dsc_init(&dsc);
+      lv_obj_init_draw_img_dsc(obj, LV_PART_MAIN, &dsc);
+      NavImage &image = nav.images[nav.image_count++];
+      image.src = src;
+      image.recolor = dsc.recolor;
+      image.frame_id = dsc.frame_id;
+    }
+  }
+  return LV_OBJ_TREE_WALK_NEXT;
+}
+
+/* Build, lay out, then open one image per step */
+static bool prepare_step(uint8_t target, uint16_t step, void *ctx) {
+  lv_obj_t **handle = nav.handles[target];
+  if (step == 0) {
+    return screen_registry_get(handle) != NULL;
+  }
+  lv_obj_t *scr = *handle;
+  if (scr == NULL) {
+    return false; // evicted while preparing
+  }
+  if (step == 1) {
+    lv_obj_update_layout(scr);
+    return true;
+  }
+  if (step == 2) {
+    nav.image_count = 0;
+    lv_obj_tree_walk(scr, collect_image, NULL);
+    return nav.image_count > 0;
+  }
+  uint16_t image = step - 3;
+  if (image < nav.image_count) {
+    // decoded into the image cache, the first frame finds it open
+    const NavImage &img = nav.images[image];
+    _lv_img_cache_open(img.src, img.recolor, img.frame_id);
+  }
+  return image + 1 < nav.image_count;
+}
+
+static NavPrefetch *prefetch;
+
+static void prefetch_cb(lv_timer_t *timer) {
+  uint32_t before = prefetch->busy_us();
+  prefetch->run(NAV_PREFETCH_BUDGET_US);
+  nav.stats.prefetch_us += prefetch->busy_us() - before;
+}
+
+static void prepare(int8_t target) {
+  if (!nav.enabled || target < 0 || target == prefetch->target()) {
+    return;
+  }
+  if (prefetch->active() && prefetch->steps() > 0) {
+    nav.stats.wasted++;
+  }
+  prefetch->start(target);
+}
+
+static void cancel() {
+  if (prefetch->active() && prefetch->steps() > 0) {
+    nav.stats.wasted++;
+  }
+  prefetch->cancel();
+}
+
+static lv_scr_load_anim_t anim_for(NavDir dir) {
+  switch (dir) {
+  case NAV_LEFT:
+    return LV_SCR_LOAD_ANIM_MOVE_LEFT;
+  case NAV_RIGHT:
+    return LV_SCR_LOAD_ANIM_MOVE_RIGHT;
+  case NAV_UP:
+    return LV_SCR_LOAD_ANIM_MOVE_TOP;
+  default:
+    return LV_SCR_LOAD_ANIM_MOVE_BOTTOM;
+  }
+}
+
+int8_t nav_add(const char *name, lv_obj_t **handle) {
+  int8_t id = nav.graph.add(name);
+  if (id >= 0) {
+    nav.handles[id] = handle;
+  }
+  return id;
+}
+
+void nav_link(uint8_t from, NavDir dir, uint8_t to) {
+  nav.graph.link(from, dir, to);
+}
+
+void nav_begin(uint8_t start, NavClockFn clock) {
+  static NavPrefetch p(prepare_step, NULL, clock);
+  prefetch = &p;
+  nav.current = start;
+  nav.enabled = true;
+  if (nav.started) {
+    return;
+  }
+  nav.started = true;
+  lv_disp_t *disp = lv_disp_get_default();
+  uint32_t period = disp && disp->refr_timer ? disp->refr_timer->period
+                                             : LV_DISP_DEF_REFR_PERIOD;
+  lv_timer_create(prefetch_cb, period, NULL);
+}
+
+void nav_go(uint8_t to, NavDir dir) {
+  if (!nav.started || to >= nav.graph.count() || nav.handles[to] == NULL) {
+    return;
+  }
+  nav.stats.swipes++;
+  if (*nav.handles[to] == NULL) {
+    nav.stats.cold++;
+  } else if (prefetch->target() == (int8_t)to && prefetch->ready()) {
+    nav.stats.ready++;
+  } else {
+    nav.stats.partial++;
+  }
+  if (prefetch->target() == (int8_t)to) {
+    prefetch->cancel();
+  } else {
+    cancel();
+  }
+  nav.graph.visited(nav.current, to);
+  nav.current = to;
+  screen_registry_load(nav.handles[to], anim_for(dir), NAV_TRANSITION_MS, 0);
+}
+
+void nav_input(lv_coord_t x, lv_coord_t y, bool pressed) {
+  if (!nav.started) {
+    return;
+  }
+  switch (nav.gesture.feed(x, y, pressed)) {
+  case NAV_GESTURE_PRESS:
+    prepare(nav.graph.likely(nav.current));
+    break;
+  case NAV_GESTURE_START:
+    prepare(nav.graph.neighbour(nav.current, nav.gesture.dir()));
+    break;
+  case NAV_GESTURE_SWIPE: {
+    int8_t to = nav.graph.neighbour(nav.current, nav.gesture.dir());
+    if (to >= 0) {
+      nav_go(to, nav.gesture.dir());
+    } else {
+      cancel();
+    }
+    break;
+  }
+  case NAV_GESTURE_CANCEL:
+    cancel();
+    break;
+  default:
+    break;
+  }
+}
+
+int8_t nav_current() { return nav.started ? nav.current : -1; }
+
+void nav_set_prefetch(bool enabled) {
+  nav.enabled = enabled;
+  if (!enabled && prefetch) {
+    prefetch->cancel();
+  }
+}
+
+const NavStats &nav_stats() { return nav.stats; }
+
+void nav_stats_reset() { nav.stats = NavStats(); }
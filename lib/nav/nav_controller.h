@@ -0,0 +1,86 @@
+#ifndef NAV_CONTROLLER_H
+#define NAV_CONTROLLER_H
+
+#include <lvgl.h>
+
+#include "nav_graph.h"
+
+/**
+ * Swipe navigation between registered screens with predictive prefetch.
+ *
+ * Screens are linked in a graph (home in the middle, a neighbour on each
+ * side). When the finger goes down the neighbour most often visited from
+ * the current screen is prepared, as soon as the swipe direction is known
+ * the neighbour on that side is prepared instead. Preparing builds the
+ * screen through the screen registry, lays it out and opens its images in
+ * the image cache, a few steps per display refresh within
+ * NAV_PREFETCH_BUDGET_US, so the screen shown under the finger keeps its
+ * frame rate. On release the transition starts from a screen that is
+ * already built instead of building it in the same frame.
+ */
+
+#ifndef NAV_PREFETCH_BUDGET_US
+#define NAV_PREFETCH_BUDGET_US 4000 // per display refresh
+#endif
+
+#ifndef NAV_PREFETCH_IMAGES
+#define NAV_PREFETCH_IMAGES 16 // images opened per screen
+#endif
+
+#ifndef NAV_TRANSITION_MS
+#define NAV_TRANSITION_MS 300
+#endif
+
+struct NavStats {
+  uint32_t swipes;      // navigations
+  uint32_t ready;       // target fully prepared on release
+  uint32_t partial;     // target built, but not all of it prepared
+  uint32_t cold;        // target built on release
+  uint32_t wasted;      // prepared screens that were not navigated to
+  uint32_t prefetch_us; // time spent preparing
+};
+
+/**
+ * Add a screen, it must be registered with `screen_registry_add`
+ * @param handle address of the ui global holding the screen
+ * @return screen id, -1 if NAV_SCREENS_MAX are added
+ */
+int8_t nav_add(const char *name, lv_obj_t **handle);
+
+/**
+ * Swiping `dir` on `from` loads `to`
+ */
+void nav_link(uint8_t from, NavDir dir, uint8_t to);
+
+/**
+ * Start taking input, `start` is the screen shown. Calling it again
+ * only sets the screen shown.
+ * @param clock monotonic microseconds, for the prefetch budget
+ */
+void nav_begin(uint8_t start, NavClockFn clock);
+
+/**
+ * Feed a touch sample, from the input device read callback.
+ * Does nothing before `nav_begin`.
+ */
+void nav_input(lv_coord_t x, lv_coord_t y, bool pressed);
+
+/**
+ * Load a screen as a swipe `dir` would
+ */
+void nav_go(uint8_t to, NavDir dir);
+
+/**
+ * @return screen shown, -1 before `nav_begin`
+ */
+int8_t nav_current();
+
+/**
+ * Turn the prefetch off to compare, screens are then built on release
+ */
+void nav_set_prefetch(bool enabled);
+
+const NavStats &nav_stats();
+void nav_stats_reset();
+
+#endif /*NAV_CONTROLLER_H*/
@@ -0,0 +1,123 @@
+#include "nav_graph.h"
+#include <string.h>
+
+NavGraph::NavGraph() : screens(0) {
+  memset(links, -1, sizeof(links));
+  memset(visits, 0, sizeof(visits));
+}
+
+int8_t NavGraph::add(const char *name) {
+  if (screens >= NAV_SCREENS_MAX) {
+    return -1;
+  }
+  names[screens] = name;
+  return screens++;
+}
+
+void NavGraph::link(uint8_t from, NavDir dir, uint8_t to) {
+  if (from < screens && to < screens && dir < NAV_DIRS) {
+    links[from][dir] = to;
+  }
+}
+
+int8_t NavGraph::neighbour(uint8_t from, NavDir dir) const {
+  return from < screens && dir < NAV_DIRS ? links[from][dir] : -1;
+}
+
+void NavGraph::visited(uint8_t from, uint8_t to) {
+  if (from >= screens) {
+    return;
+  }
+  for (int d = 0; d < NAV_DIRS; d++) {
+    if (links[from][d] == to && visits[from][d] < UINT16_MAX) {
+      visits[from][d]++;
+      return;
+    }
+  }
+}
+
+int8_t NavGraph::likely(uint8_t from) const {
+  if (from >= screens) {
+    return -1;
+  }
+  int best = -1;
+  for (int d = 0; d < NAV_DIRS; d++) {
+    if (links[from][d] >= 0 &&
+        (best < 0 || visits[from][d] > visits[from][best])) {
+      best = d;
+    }
+  }
+  return best < 0 ? -1 : links[from][best];
+}
+
+NavGesture::NavGesture()
+    : down(false), started(false), x0(0), y0(0), dx(0), dy(0),
+      direction(NAV_LEFT) {}
+
+static int16_t magnitude(int16_t v) { return v < 0 ? -v : v; }
+
+NavGestureEvent NavGesture::feed(int16_t x, int16_t y, bool pressed) {
+  if (pressed && !down) {
+    down = true;
+    started = false;
+    x0 = x;
+    y0 = y;
+    dx = dy = 0;
+    return NAV_GESTURE_PRESS;
+  }
+  if (!down) {
+    return NAV_GESTURE_NONE;
+  }
+  if (pressed) {
+    dx = x - x0;
+    dy = y - y0;
+  }
+  int16_t ax = magnitude(dx), ay = magnitude(dy);
+  if (!pressed) {
+    down = false;
+    int16_t along = direction == NAV_LEFT || direction == NAV_RIGHT ? ax : ay;
+    bool swipe = started && along >= NAV_SWIPE_COMMIT_PX;
+    started = false;
+    return swipe ? NAV_GESTURE_SWIPE : NAV_GESTURE_CANCEL;
+  }
+  // the dominant axis can still change until the finger is released
+  NavDir d = ax >= ay ? (dx < 0 ? NAV_LEFT : NAV_RIGHT)
+                      : (dy < 0 ? NAV_UP : NAV_DOWN);
+  if ((ax >= NAV_SWIPE_START_PX || ay >= NAV_SWIPE_START_PX) &&
+      (!started || d != direction)) {
+    started = true;
+    direction = d;
+    return NAV_GESTURE_START;
+  }
+  return NAV_GESTURE_NONE;
+}
+
+NavPrefetch::NavPrefetch(NavStepFn step, void *ctx, NavClockFn clock)
+    : step_fn(step), ctx(ctx), clock(clock), target_id(-1), next(0),
+      finished(false), spent(0) {}
+
+void NavPrefetch::start(uint8_t target) {
+  if (target_id == (int8_t)target) {
+    return;
+  }
+  target_id = target;
+  next = 0;
+  finished = false;
+  spent = 0;
+}
+
+void NavPrefetch::cancel() { target_id = -1; }
+
+bool NavPrefetch::run(uint32_t budget_us) {
+  if (!active() || finished) {
+    return false;
+  }
+  uint32_t start = clock();
+  uint32_t used = 0;
+  while (!finished && used < budget_us) {
+    finished = !step_fn(target_id, next++, ctx);
+    used = clock() - start;
+  }
+  spent += used;
+  return !finished;
+}
@@ -0,0 +1,146 @@
+#ifndef NAV_GRAPH_H
+#define NAV_GRAPH_H
+
+#include <stdint.h>
+
+/**
+ * Screen graph, swipe tracking and budgeted prefetch for the navigation
+ * controller (nav_controller.h). Kept free of LVGL so it runs in the
+ * native tests.
+ */
+
+#ifndef NAV_SCREENS_MAX
+#define NAV_SCREENS_MAX 8
+#endif
+
+#ifndef NAV_SWIPE_START_PX
+#define NAV_SWIPE_START_PX 10 // movement that starts a swipe
+#endif
+
+#ifndef NAV_SWIPE_COMMIT_PX
+#define NAV_SWIPE_COMMIT_PX 50 // movement that navigates on release
+#endif
+
+/* Direction the finger moves, the next screen comes from the other side */
+enum NavDir { NAV_LEFT, NAV_RIGHT, NAV_UP, NAV_DOWN, NAV_DIRS };
+
+class NavGraph {
+public:
+  NavGraph();
+
+  /**
+   * @return id of the screen, -1 if NAV_SCREENS_MAX are added
+   */
+  int8_t add(const char *name);
+
+  /**
+   * Swiping `dir` on `from` shows `to`
+   */
+  void link(uint8_t from, NavDir dir, uint8_t to);
+
+  /**
+   * @return the screen a swipe leads to, -1 if none
+   */
+  int8_t neighbour(uint8_t from, NavDir dir) const;
+
+  /**
+   * Count a navigation, for `likely`
+   */
+  void visited(uint8_t from, uint8_t to);
+
+  /**
+   * Neighbour most often navigated to from `from`, the first linked one
+   * if none was visited yet
+   * @return screen id, -1 if `from` has no neighbour
+   */
+  int8_t likely(uint8_t from) const;
+
+  uint8_t count() const { return screens; }
+  const char *name(uint8_t id) const { return names[id]; }
+
+private:
+  const char *names[NAV_SCREENS_MAX];
+  int8_t links[NAV_SCREENS_MAX][NAV_DIRS];
+  uint16_t visits[NAV_SCREENS_MAX][NAV_DIRS];
+  uint8_t screens;
+};
+
+enum NavGestureEvent {
+  NAV_GESTURE_NONE,
+  NAV_GESTURE_PRESS,   // finger down, direction unknown yet
+  NAV_GESTURE_START,   // moved past NAV_SWIPE_START_PX, `dir` is known
+  NAV_GESTURE_SWIPE,   // released past NAV_SWIPE_COMMIT_PX along `dir`
+  NAV_GESTURE_CANCEL   // released without a swipe
+};
+
+/**
+ * Turns touch samples into swipe events
+ */
+class NavGesture {
+public:
+  NavGesture();
+
+  NavGestureEvent feed(int16_t x, int16_t y, bool pressed);
+
+  NavDir dir() const { return direction; }
+  bool swiping() const { return started; }
+
+private:
+  bool down;
+  bool started;
+  int16_t x0, y0;
+  int16_t dx, dy;
+  NavDir direction;
+};
+
+/**
+ * One preparation step of a screen
+ * @param target screen being prepared
+ * @param step 0 for the first call, then incremented
+ * @return false once the screen is ready
+ */
+typedef bool (*NavStepFn)(uint8_t target, uint16_t step, void *ctx);
+
+/**
+ * @return a monotonic time in microseconds
+ */
+typedef uint32_t (*NavClockFn)();
+
+/**
+ * Prepares one screen a few steps per frame. `run` returns once the
+ * budget is used, so a step longer than the budget still runs alone
+ * but the frame is never held by more than one of them.
+ */
+class NavPrefetch {
+public:
+  NavPrefetch(NavStepFn step, void *ctx, NavClockFn clock);
+
+  /**
+   * Prepare `target`, restarts unless it is already the target
+   */
+  void start(uint8_t target);
+  void cancel();
+
+  /**
+   * Run steps for up to `budget_us`
+   * @return true while steps are left
+   */
+  bool run(uint32_t budget_us);
+
+  bool active() const { return target_id >= 0; }
+  bool ready() const { return active() && finished; }
+  int8_t target() const { return target_id; }
+  uint16_t steps() const { return next; }
+  uint32_t busy_us() const { return spent; }
+
+private:
+  NavStepFn step_fn;
+  void *ctx;
+  NavClockFn clock;
+  int8_t target_id;
+  uint16_t next;
+  bool finished;
+  uint32_t spent; // time in steps since `start`
+};
+
+#endif /*NAV_GRAPH_H*/
@@ -0,0 +1,63 @@
+#include "frame_stats.h"
+#include <math.h>
+#include <stdio.h>
+
+void FrameStats::reset() {
+  frames = 0;
+  total_ms = 0;
+  min_ms = UINT32_MAX;
+  max_ms = 0;
+  sq_sum = 0;
+  pixels = 0;
+}
+
+void FrameStats::add(uint32_t ms, uint32_t px) {
+  frames++;
+  total_ms += ms;
+  sq_sum += (uint64_t)ms * ms;
+  pixels += px;
+  if (ms < min_ms) {
+    min_ms = ms;
+  }
+  if (ms > max_ms) {
+    max_ms = ms;
+  }
+}
+
+void FrameStats::merge(const FrameStats &other) {
+  if (other.frames == 0) {
+    return;
+  }
+  frames += other.frames;
+  total_ms += other.total_ms;
+  sq_sum += other.sq_sum;
+  pixels += other.pixels;
+  if (other.min_ms < min_ms) {
+    min_ms = other.min_ms;
+  }
+  if (other.max_ms > max_ms) {
+    max_ms = other.max_ms;
+  }
+}
+
+float FrameStats::avg() const {
+  return frames ? (float)total_ms / frames : 0.0f;
+}
+
+float FrameStats::jitter() const {
+  if (frames < 2) {
+    return 0.0f;
+  }
+  float mean = avg();
+  float var = (float)sq_sum / frames - mean * mean;
+  return var > 0.0f ? sqrtf(var) : 0.0f;
+}
+
+int FrameStats::format(char *out, size_t len, const char *label) const {
+  return snprintf(out, len,
+                  "%s: frames=%lu avg=%.2fms min=%lums max=%lums "
+                  "jitter=%.2fms px=%lu\n",
+                  label, (unsigned long)frames, avg(),
+                  (unsigned long)(frames ? min_ms : 0),
+                  (unsigned long)max_ms, jitter(), (unsigned long)pixels);
+}
@@ -0,0 +1,38 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Running frame-time statistics.
+ * Fed with one sample per refreshed frame (e.g. from `monitor_cb` of the
+ * display driver), keeps count, min, max, average and jitter (standard
+ * deviation) without storing the individual samples.
+ */
+struct FrameStats {
+  uint32_t frames;
+  uint32_t total_ms;
+  uint32_t min_ms;
+  uint32_t max_ms;
+  uint64_t sq_sum;
+  uint32_t pixels;
+
+  void reset();
+  void add(uint32_t ms, uint32_t px = 0);
+  void merge(const FrameStats &other);
+
+  float avg() const;
+  float jitter() const;
+
+  /**
+   * Write a one line summary into `out`
+   * @param out destination buffer
+   * @param len size of the destination buffer
+   * @param label prefix of the line
+   * @return number of characters written (as snprintf)
+   */
+  int format(char *out, size_t len, const char *label) const;
+};
+
+#endif /*FRAME_STATS_H*/
@@ -0,0 +1,101 @@
+#include "power_governor.h"
+#include <stdio.h>
+
+PowerGovernor::PowerGovernor(const PowerConfig &config)
+    : config(config), current(POWER_ACTIVE), level(200), timeout(0),
+      lastActivity(0), lastAnimation(0), lastUpdate(0) {
+  for (int i = 0; i < POWER_STATES; i++) {
+    stateMs[i] = 0;
+  }
+}
+
+void PowerGovernor::begin(uint32_t now) {
+  current = POWER_ACTIVE;
+  lastActivity = now;
+  lastAnimation = now;
+  lastUpdate = now;
+  for (int i = 0; i < POWER_STATES; i++) {
+    stateMs[i] = 0;
+  }
+}
+
+void PowerGovernor::setBrightness(uint8_t brightness) { level = brightness; }
+
+void PowerGovernor::setTimeout(uint32_t ms) { timeout = ms; }
+
+void PowerGovernor::activity(uint32_t now) {
+  lastActivity = now;
+  lastAnimation = now;
+}
+
+void PowerGovernor::animating(uint32_t now) { lastAnimation = now; }
+
+bool PowerGovernor::update(uint32_t now) {
+  stateMs[current] += now - lastUpdate;
+  lastUpdate = now;
+
+  uint32_t idle = now - lastActivity;
+  PowerState next;
+  if (timeout && idle >= timeout) {
+    next = POWER_OFF;
+  } else if (timeout > config.dim_before_ms &&
+             idle >= timeout - config.dim_before_ms) {
+    next = POWER_DIM;
+  } else if (now - lastAnimation < config.idle_after_ms) {
+    next = POWER_ACTIVE;
+  } else {
+    next = POWER_IDLE;
+  }
+
+  if (next == current) {
+    return false;
+  }
+  current = next;
+  return true;
+}
+
+uint32_t PowerGovernor::refreshPeriod() const {
+  switch (current) {
+  case POWER_ACTIVE:
+    return config.active_refr_ms;
+  case POWER_OFF:
+    return config.off_refr_ms;
+  default:
+    return config.idle_refr_ms;
+  }
+}
+
+uint32_t PowerGovernor::loopDelay() const {
+  switch (current) {
+  case POWER_ACTIVE:
+    return config.active_loop_ms;
+  case POWER_OFF:
+    return config.off_loop_ms;
+  default:
+    return config.idle_loop_ms;
+  }
+}
+
+uint8_t PowerGovernor::brightness() const {
+  switch (current) {
+  case POWER_DIM:
+    return level < config.dim_brightness ? level : config.dim_brightness;
+  case POWER_OFF:
+    return 0;
+  default:
+    return level;
+  }
+}
+
+const char *PowerGovernor::name(PowerState state) {
+  static const char *names[POWER_STATES] = {"active", "idle", "dim", "off"};
+  return state < POWER_STATES ? names[state] : "?";
+}
+
+int PowerGovernor::format(char *out, size_t len) const {
+  return snprintf(out, len, "power: active=%lums idle=%lums dim=%lums off=%lums\n",
+                  (unsigned long)stateMs[POWER_ACTIVE],
+                  (unsigned long)stateMs[POWER_IDLE],
+                  (unsigned long)stateMs[POWER_DIM],
+                  (unsigned long)stateMs[POWER_OFF]);
+}
@@ -0,0 +1,95 @@
+#ifndef POWER_GOVERNOR_H
+#define POWER_GOVERNOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Backlight and refresh rate governor.
+ * Driven by the caller's clock (`now` in ms), so the same logic runs on the
+ * device (millis), in the emulator (lv_tick_get) and against a simulated
+ * clock.
+ *
+ *  ACTIVE  input or animations in the last `idle_after_ms`, fast refresh
+ *  IDLE    static screen, slow refresh and fewer loop wake-ups
+ *  DIM     the screen timeout is about to expire, backlight dimmed
+ *  OFF     screen timeout expired, backlight off
+ */
+
+enum PowerState { POWER_ACTIVE, POWER_IDLE, POWER_DIM, POWER_OFF, POWER_STATES };
+
+struct PowerConfig {
+  uint32_t active_refr_ms; // LVGL refresh period while active
+  uint32_t idle_refr_ms;   // LVGL refresh period on a static screen
+  uint32_t off_refr_ms;    // LVGL refresh period with the backlight off
+  uint32_t active_loop_ms; // hal_loop delay while active
+  uint32_t idle_loop_ms;   // hal_loop delay on a static screen
+  uint32_t off_loop_ms;    // hal_loop delay with the backlight off
+  uint32_t idle_after_ms;  // no input/animation for this long -> IDLE
+  uint32_t dim_before_ms;  // dim this long before the timeout
+  uint8_t dim_brightness;
+
+  PowerConfig()
+      : active_refr_ms(20), idle_refr_ms(100), off_refr_ms(1000),
+        active_loop_ms(15), idle_loop_ms(50), off_loop_ms(200),
+        idle_after_ms(1000), dim_before_ms(5000), dim_brightness(20) {}
+};
+
+class PowerGovernor {
+public:
+  PowerGovernor(const PowerConfig &config = PowerConfig());
+
+  void begin(uint32_t now);
+
+  void setBrightness(uint8_t brightness);
+
+  /**
+   * Set the screen timeout
+   * @param ms timeout, 0 to keep the screen on
+   */
+  void setTimeout(uint32_t ms);
+
+  /**
+   * User input, wakes the screen and restarts the timeout
+   */
+  void activity(uint32_t now);
+
+  /**
+   * Animation or scroll running, keeps the fast refresh rate without
+   * restarting the timeout
+   */
+  void animating(uint32_t now);
+
+  /**
+   * Update the state
+   * @param now current time in ms
+   * @return true if the state changed (apply the new outputs)
+   */
+  bool update(uint32_t now);
+
+  PowerState state() const { return current; }
+  uint32_t refreshPeriod() const;
+  uint32_t loopDelay() const;
+  uint8_t brightness() const;
+
+  /**
+   * Time spent in a state since `begin`, in ms
+   */
+  uint32_t timeIn(PowerState state) const { return stateMs[state]; }
+
+  int format(char *out, size_t len) const;
+
+  static const char *name(PowerState state);
+
+private:
+  PowerConfig config;
+  PowerState current;
+  uint8_t level;
+  uint32_t timeout;
+  uint32_t lastActivity;
+  uint32_t lastAnimation;
+  uint32_t lastUpdate;
+  uint32_t stateMs[POWER_STATES];
+};
+
+#endif /*POWER_GOVERNOR_H*/
@@ -0,0 +1,261 @@
+#include "qr_cache.h"
+#include <string.h>
+
+#if LV_USE_QRCODE == 0
+#error "qr_cache requires LV_USE_QRCODE 1 in lv_conf.h"
+#endif
+
+#include "src/extra/libs/qrcode/qrcodegen.h"
+
+static QrBitmap cache[QR_CACHE_ENTRIES];
+static char texts[QR_CACHE_ENTRIES][QR_MAX_TEXT + 1]; // checked on a hit
+static uint32_t last_used[QR_CACHE_ENTRIES];
+static uint32_t use_counter;
+static QrCacheStats stats;
+
+/* 2 entry palette, then 1 bit per pixel rows, MSB first */
+#define QR_PALETTE_SIZE (2 * sizeof(lv_color32_t))
+
+struct QrView {
+  QrBitmap bitmap;
+  lv_color_t dark;
+  lv_color_t light;
+  lv_img_dsc_t img; // the bitmap expanded at `img_scale`
+  uint8_t img_scale; // 0 when `img` has to be rebuilt
+};
+
+uint32_t qr_hash(const char *text, uint16_t *length) {
+  uint32_t h = 2166136261u;
+  uint16_t n = 0;
+  while (text[n]) {
+    h = (h ^ (uint8_t)text[n]) * 16777619u;
+    n++;
+  }
+  if (length) {
+    *length = n;
+  }
+  return h ? h : 1; // 0 marks an empty entry
+}
+
+static bool encode(const char *text, QrBitmap *bm) {
+  static uint8_t temp[qrcodegen_BUFFER_LEN_FOR_VERSION(QR_MAX_VERSION)];
+  static uint8_t code[qrcodegen_BUFFER_LEN_FOR_VERSION(QR_MAX_VERSION)];
+
+  if (!qrcodegen_encodeText(text, temp, code, qrcodegen_Ecc_MEDIUM,
+                            qrcodegen_VERSION_MIN, QR_MAX_VERSION,
+                            qrcodegen_Mask_AUTO, true)) {
+    return false;
+  }
+
+  bm->size = qrcodegen_getSize(code);
+  memset(bm->bits, 0, sizeof(bm->bits));
+  for (int y = 0; y < bm->size; y++) {
+    uint8_t *row = &bm->bits[y * QR_ROW_BYTES];
+    for (int x = 0; x < bm->size; x++) {
+      if (qrcodegen_getModule(code, x, y)) {
+        row[x >> 3] |= 0x80 >> (x & 7);
+      }
+    }
+  }
+  return true;
+}
+
+const QrBitmap *qr_cache_get(const char *text) {
+  uint16_t length;
+  uint32_t hash = qr_hash(text, &length);
+  if (length > QR_MAX_TEXT) {
+    stats.failures++;
+    LV_LOG_WARN("qr: %u bytes, more than QR_MAX_TEXT", length);
+    return NULL;
+  }
+
+  int slot = 0;
+  for (int i = 0; i < QR_CACHE_ENTRIES; i++) {
+    if (cache[i].hash == hash && cache[i].length == length &&
+        memcmp(texts[i], text, length) == 0) {
+      stats.hits++;
+      last_used[i] = ++use_counter;
+      return &cache[i];
+    }
+    if (last_used[i] < last_used[slot]) {
+      slot = i; // least recently used, empty entries are 0
+    }
+  }
+
+  // encode aside so a failure does not evict anything
+  static QrBitmap encoded;
+  if (!encode(text, &encoded)) {
+    stats.failures++;
+    LV_LOG_WARN("qr: %u bytes do not fit version %d", length, QR_MAX_VERSION);
+    return NULL;
+  }
+  stats.encodes++;
+
+  QrBitmap *bm = &cache[slot];
+  memcpy(bm, &encoded, sizeof(QrBitmap));
+  bm->hash = hash;
+  bm->length = length;
+  memcpy(texts[slot], text, length + 1);
+  last_used[slot] = ++use_counter;
+  return bm;
+}
+
+void qr_cache_clear() {
+  memset(cache, 0, sizeof(cache));
+  memset(last_used, 0, sizeof(last_used));
+}
+
+const QrCacheStats &qr_cache_stats() { return stats; }
+
+static void set_palette(QrView *view) {
+  lv_color32_t *palette = (lv_color32_t *)view->img.data;
+  palette[0].full = lv_color_to32(view->light);
+  palette[1].full = lv_color_to32(view->dark);
+}
+
+static void release_image(QrView *view) {
+  if (view->img.data) {
+    lv_img_cache_invalidate_src(&view->img);
+    lv_mem_free((void *)view->img.data);
+    view->img.data = NULL;
+    view->img.data_size = 0;
+  }
+  view->img_scale = 0;
+}
+
+/* Expand the modules and the quiet zone into a 1 bit indexed image */
+static bool render(QrView *view, uint8_t scale) {
+  const QrBitmap *bm = &view->bitmap;
+  lv_coord_t px = (bm->size + 2 * QR_BORDER) * scale;
+  uint32_t stride = (px + 7) / 8;
+  uint32_t size = QR_PALETTE_SIZE + stride * px;
+
+  if (view->img.data_size != size) {
+    release_image(view);
+    view->img.data = (const uint8_t *)lv_mem_alloc(size);
+    if (view->img.data == NULL) {
+      return false;
+    }
+    view->img.data_size = size;
+  } else {
+    lv_img_cache_invalidate_src(&view->img); // decoded with the old bits
+  }
+  view->img.header.cf = LV_IMG_CF_INDEXED_1BIT;
+  view->img.header.always_zero = 0;
+  view->img.header.w = px;
+  view->img.header.h = px;
+  set_palette(view);
+
+  uint8_t *rows = (uint8_t *)view->img.data + QR_PALETTE_SIZE;
+  memset(rows, 0, stride * px);
+  uint8_t *prev = NULL;
+  int32_t prev_my = INT32_MIN;
+  for (lv_coord_t y = 0; y < px; y++) {
+    uint8_t *row = rows + y * stride;
+    int32_t my = y / scale - QR_BORDER;
+    if (my == prev_my) {
+      // same module row as the line above
+      memcpy(row, prev, stride);
+      continue;
+    }
+    prev = row;
+    prev_my = my;
+    if (my < 0 || my >= bm->size) {
+      continue; // quiet zone, light
+    }
+    for (lv_coord_t x = QR_BORDER * scale; x < px - QR_BORDER * scale; x++) {
+      if (qr_module(bm, x / scale - QR_BORDER, my)) {
+        row[x >> 3] |= 0x80 >> (x & 7);
+      }
+    }
+  }
+  view->img_scale = scale;
+  return true;
+}
+
+static void view_event_cb(lv_event_t *e) {
+  lv_obj_t *obj = lv_event_get_target(e);
+  QrView *view = (QrView *)lv_obj_get_user_data(obj);
+
+  if (lv_event_get_code(e) == LV_EVENT_DELETE) {
+    release_image(view);
+    lv_mem_free(view);
+    lv_obj_set_user_data(obj, NULL);
+    return;
+  }
+
+  if (view == NULL || view->bitmap.size == 0) {
+    return;
+  }
+
+  lv_area_t coords;
+  lv_obj_get_coords(obj, &coords);
+  lv_coord_t side = LV_MIN(lv_area_get_width(&coords),
+                           lv_area_get_height(&coords));
+  uint8_t cells = view->bitmap.size + 2 * QR_BORDER;
+  uint8_t scale = LV_MAX(1, side / cells);
+  lv_coord_t px = cells * scale;
+  if (view->img_scale != scale && !render(view, scale)) {
+    return;
+  }
+
+  // the code, centred in the object
+  lv_area_t code;
+  code.x1 = coords.x1 + (lv_area_get_width(&coords) - px) / 2;
+  code.y1 = coords.y1 + (lv_area_get_height(&coords) - px) / 2;
+  code.x2 = code.x1 + px - 1;
+  code.y2 = code.y1 + px - 1;
+
+  lv_draw_img_dsc_t dsc;
+  lv_draw_img_dsc_init(&dsc);
+  lv_draw_img(lv_event_get_draw_ctx(e), &dsc, &code, &view->img);
+}
+
+lv_obj_t *qr_view_create(lv_obj_t *parent, lv_coord_t size) {
+  QrView *view = (QrView *)lv_mem_alloc(sizeof(QrView));
+  if (view == NULL) {
+    return NULL;
+  }
+  memset(view, 0, sizeof(QrView));
+  view->dark = lv_color_black();
+  view->light = lv_color_white();
+
+  lv_obj_t *obj = lv_obj_create(parent);
+  lv_obj_remove_style_all(obj);
+  lv_obj_set_size(obj, size, size);
+  lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_user_data(obj, view);
+  lv_obj_add_event_cb(obj, view_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+  lv_obj_add_event_cb(obj, view_event_cb, LV_EVENT_DELETE, NULL);
+  return obj;
+}
+
+bool qr_view_set_text(lv_obj_t *obj, const char *text) {
+  QrView *view = (QrView *)lv_obj_get_user_data(obj);
+  const QrBitmap *bm = qr_cache_get(text);
+  if (bm == NULL) {
+    view->bitmap.hash = 0;
+    view->bitmap.size = 0;
+    release_image(view);
+    lv_obj_invalidate(obj);
+    return false;
+  }
+  if (bm->size != view->bitmap.size ||
+      memcmp(bm->bits, view->bitmap.bits, bm->size * QR_ROW_BYTES) != 0) {
+    memcpy(&view->bitmap, bm, sizeof(QrBitmap));
+    view->img_scale = 0;
+    lv_obj_invalidate(obj);
+  }
+  return true;
+}
+
+void qr_view_set_colors(lv_obj_t *obj, lv_color_t dark, lv_color_t light) {
+  QrView *view = (QrView *)lv_obj_get_user_data(obj);
+  view->dark = dark;
+  view->light = light;
+  if (view->img.data) {
+    set_palette(view);
+    lv_img_cache_invalidate_src(&view->img); // the decoder copied the palette
+  }
+  lv_obj_invalidate(obj);
+}
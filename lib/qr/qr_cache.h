@@ -0,0 +1,86 @@
+#ifndef QR_CACHE_H
+#define QR_CACHE_H
+
+#include <lvgl.h>
+
+/**
+ * QR codes encoded once per link and kept as 1 bit per module bitmaps.
+ *
+ * `lv_qrcode` encodes the text and redraws the canvas every time it is
+ * updated. Here a link is encoded the first time it is seen and the bitmap
+ * is cached by content. A QR view expands it once to its pixel size as a
+ * 1 bit indexed image and draws that with `lv_draw_img`.
+ */
+
+/* Largest version encoded, 10 is 57x57 modules, up to 213 bytes of text */
+#ifndef QR_MAX_VERSION
+#define QR_MAX_VERSION 10
+#endif
+
+/* Longest text accepted, what fits version 10 at medium error correction */
+#ifndef QR_MAX_TEXT
+#define QR_MAX_TEXT 213
+#endif
+
+#ifndef QR_CACHE_ENTRIES
+#define QR_CACHE_ENTRIES 8
+#endif
+
+/* Quiet zone around the code, in modules */
+#ifndef QR_BORDER
+#define QR_BORDER 2
+#endif
+
+#define QR_MAX_MODULES (QR_MAX_VERSION * 4 + 17)
+#define QR_ROW_BYTES ((QR_MAX_MODULES + 7) / 8)
+
+struct QrBitmap {
+  uint32_t hash; // FNV-1a of the text, 0 when the entry is empty
+  uint16_t length;
+  uint8_t size; // modules per side
+  uint8_t bits[QR_MAX_MODULES * QR_ROW_BYTES]; // MSB first, dark is 1
+};
+
+struct QrCacheStats {
+  uint32_t hits;
+  uint32_t encodes;
+  uint32_t failures;
+};
+
+/**
+ * Bitmap of a text, encoded on the first request
+ * @param text link or text to encode
+ * @return NULL if the text does not fit QR_MAX_VERSION or QR_MAX_TEXT
+ */
+const QrBitmap *qr_cache_get(const char *text);
+
+/**
+ * Forget all the bitmaps, e.g. when the phone sends a new link list
+ */
+void qr_cache_clear();
+
+const QrCacheStats &qr_cache_stats();
+
+uint32_t qr_hash(const char *text, uint16_t *length);
+
+static inline bool qr_module(const QrBitmap *bm, uint8_t x, uint8_t y) {
+  return bm->bits[y * QR_ROW_BYTES + (x >> 3)] & (0x80 >> (x & 7));
+}
+
+/**
+ * QR code widget drawn from a copy of the cached bitmap, scaled to a whole
+ * number of pixels per module and centred, with a QR_BORDER quiet zone
+ * @param parent parent object
+ * @param size maximum side in pixels
+ */
+lv_obj_t *qr_view_create(lv_obj_t *parent, lv_coord_t size);
+
+/**
+ * Show a text, cheap when it was shown before
+ * @return false if it could not be encoded
+ */
+bool qr_view_set_text(lv_obj_t *view, const char *text);
+
+void qr_view_set_colors(lv_obj_t *view, lv_color_t dark, lv_color_t light);
+
+#endif /*QR_CACHE_H*/
@@ -0,0 +1,193 @@
+#include "screen_registry.h"
+#include "transition.h"
+
+static screen_entry_t entries[SCREEN_REGISTRY_MAX];
+static uint32_t count;
+static uint32_t use_counter;
+static screen_reserve_cb_t reserve_cb;
+static screen_built_cb_t any_built_cb;
+
+static screen_entry_t *find(lv_obj_t **handle) {
+  for (uint32_t i = 0; i < count; i++) {
+    if (entries[i].handle == handle) {
+      return &entries[i];
+    }
+  }
+  return NULL;
+}
+
+static uint32_t heap_used() {
+#if LV_MEM_CUSTOM == 0
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  return mon.total_size - mon.free_size;
+#else
+  return 0;
+#endif
+}
+
+static uint32_t heap_biggest_free() {
+#if LV_MEM_CUSTOM == 0
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  return mon.free_biggest_size;
+#else
+  return UINT32_MAX;
+#endif
+}
+
+static bool in_use(lv_obj_t *scr) {
+  lv_disp_t *d = lv_obj_get_disp(scr);
+  return scr == d->act_scr || scr == d->prev_scr || scr == d->scr_to_load;
+}
+
+static void build(screen_entry_t *e) {
+  if (reserve_cb &&
+      !reserve_cb(e->heap_size ? e->heap_size : SCREEN_RESERVE_DEFAULT)) {
+    LV_LOG_WARN("screen %s: building with less memory than it needs",
+                e->name);
+  }
+
+  uint32_t heap = heap_used();
+  uint32_t start = lv_tick_get();
+
+  e->init();
+
+  e->build_ms = lv_tick_elaps(start);
+  e->heap_size = heap_used() - heap;
+  e->builds++;
+
+  LV_LOG_USER("screen %s built in %lu ms, %lu bytes (build #%lu)", e->name,
+              (unsigned long)e->build_ms, (unsigned long)e->heap_size,
+              (unsigned long)e->builds);
+
+  if (any_built_cb && *e->handle) {
+    any_built_cb(*e->handle);
+  }
+  if (e->built && *e->handle) {
+    e->built(*e->handle);
+  }
+}
+
+static void destroy(screen_entry_t *e) {
+  lv_obj_del(*e->handle);
+  *e->handle = NULL;
+  if (e->destroy) {
+    e->destroy();
+  }
+  LV_LOG_USER("screen %s evicted", e->name);
+}
+
+screen_entry_t *screen_registry_add(const char *name, lv_obj_t **handle,
+                                    screen_init_cb_t init,
+                                    screen_destroy_cb_t destroy, bool pinned) {
+  screen_entry_t *e = find(handle);
+  if (e == NULL) {
+    if (count >= SCREEN_REGISTRY_MAX) {
+      LV_LOG_WARN("screen registry full, %s not added", name);
+      return NULL;
+    }
+    e = &entries[count++];
+  }
+  e->name = name;
+  e->handle = handle;
+  e->init = init;
+  e->destroy = destroy;
+  e->built = NULL;
+  e->pinned = pinned;
+  e->last_used = 0;
+  e->builds = 0;
+  e->build_ms = 0;
+  e->heap_size = 0;
+  return e;
+}
+
+void screen_registry_on_built(lv_obj_t **handle, screen_built_cb_t cb) {
+  screen_entry_t *e = find(handle);
+  if (e) {
+    e->built = cb;
+  }
+}
+
+void screen_registry_set_built_cb(screen_built_cb_t cb) { any_built_cb = cb; }
+
+void screen_registry_set_reserve_cb(screen_reserve_cb_t cb) {
+  reserve_cb = cb;
+}
+
+lv_obj_t *screen_registry_get(lv_obj_t **handle) {
+  screen_entry_t *e = find(handle);
+  if (e == NULL) {
+    return *handle;
+  }
+  e->last_used = ++use_counter;
+  if (*handle == NULL) {
+    build(e);
+  }
+  return *handle;
+}
+
+void screen_registry_load(lv_obj_t **handle, lv_scr_load_anim_t anim,
+                          uint32_t time, uint32_t delay) {
+  lv_obj_t *scr = screen_registry_get(handle);
+  if (scr) {
+    transition_load(scr, anim, time, delay);
+  }
+}
+
+bool screen_registry_evict(lv_obj_t **handle) {
+  screen_entry_t *e = find(handle);
+  if (e == NULL || e->pinned || *handle == NULL || in_use(*handle) ||
+      transition_active()) {
+    return false;
+  }
+  destroy(e);
+  return true;
+}
+
+uint32_t screen_registry_trim(uint32_t min_free) {
+  uint32_t evicted = 0;
+  if (transition_active()) {
+    return 0;
+  }
+  while (heap_biggest_free() < min_free) {
+    screen_entry_t *lru = NULL;
+    for (uint32_t i = 0; i < count; i++) {
+      screen_entry_t *e = &entries[i];
+      if (e->pinned || *e->handle == NULL || in_use(*e->handle)) {
+        continue;
+      }
+      if (lru == NULL || e->last_used < lru->last_used) {
+        lru = e;
+      }
+    }
+    if (lru == NULL) {
+      break;
+    }
+    destroy(lru);
+    evicted++;
+  }
+  return evicted;
+}
+
+uint32_t screen_registry_count(void) { return count; }
+
+const screen_entry_t *screen_registry_entry(uint32_t index) {
+  return index < count ? &entries[index] : NULL;
+}
+
+void screen_registry_report(void) {
+  uint32_t resident = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const screen_entry_t *e = &entries[i];
+    if (*e->handle) {
+      resident++;
+    }
+    LV_LOG_USER("screen %-16s %s%s builds=%lu last=%lums heap=%lu", e->name,
+                *e->handle ? "resident" : "-", e->pinned ? " pinned" : "",
+                (unsigned long)e->builds, (unsigned long)e->build_ms,
+                (unsigned long)e->heap_size);
+  }
+  LV_LOG_USER("screens resident %lu/%lu", (unsigned long)resident,
+              (unsigned long)count);
+}
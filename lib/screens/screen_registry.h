@@ -0,0 +1,115 @@
+#ifndef SCREEN_REGISTRY_H
+#define SCREEN_REGISTRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <lvgl.h>
+#include <stdbool.h>
+
+/**
+ * Lazy screen construction.
+ * Screens are registered with their `ui_<name>_screen_init` function and
+ * global handle, and are only built the first time they are needed.
+ * Screens that are not pinned can be deleted again (least recently used
+ * first) when the LVGL heap runs low, they are rebuilt on the next use.
+ */
+
+#ifndef SCREEN_RESERVE_DEFAULT
+#define SCREEN_RESERVE_DEFAULT (8U * 1024U)
+#endif
+
+#ifndef SCREEN_REGISTRY_MAX
+#define SCREEN_REGISTRY_MAX 24
+#endif
+
+typedef void (*screen_init_cb_t)(void);
+typedef void (*screen_destroy_cb_t)(void);
+typedef void (*screen_built_cb_t)(lv_obj_t *screen);
+
+typedef struct {
+  const char *name;
+  lv_obj_t **handle;           // ui global, e.g. &ui_weatherScreen
+  screen_init_cb_t init;       // creates the screen and sets *handle
+  screen_destroy_cb_t destroy; // optional, resets child handles
+  screen_built_cb_t built;     // optional, fills the screen with data
+  bool pinned;                 // never evicted
+  uint32_t last_used;
+  uint32_t builds;
+  uint32_t build_ms;  // cost of the last build
+  uint32_t heap_size; // LVGL heap used by the last build
+} screen_entry_t;
+
+/**
+ * Register a screen
+ * @param name name used in logs
+ * @param handle address of the ui global holding the screen
+ * @param init function creating the screen
+ * @param destroy optional function clearing child handles after deletion
+ * @param pinned true to keep the screen resident once built
+ * @return the entry or NULL if the registry is full
+ */
+screen_entry_t *screen_registry_add(const char *name, lv_obj_t **handle,
+                                    screen_init_cb_t init,
+                                    screen_destroy_cb_t destroy, bool pinned);
+
+/**
+ * Set a callback run each time the screen is (re)built
+ */
+void screen_registry_on_built(lv_obj_t **handle, screen_built_cb_t cb);
+
+/**
+ * Set a callback run each time any screen is (re)built, before its own
+ */
+void screen_registry_set_built_cb(screen_built_cb_t cb);
+
+/**
+ * Called before a screen is built with the heap it needs (its last build
+ * size, or SCREEN_RESERVE_DEFAULT the first time), e.g. to free memory
+ * @return false if the memory is not available, the screen is still built
+ */
+typedef bool (*screen_reserve_cb_t)(uint32_t bytes);
+
+void screen_registry_set_reserve_cb(screen_reserve_cb_t cb);
+
+/**
+ * Get a screen, building it if needed
+ * @param handle address of the ui global holding the screen
+ * @return the screen or NULL if it is not registered
+ */
+lv_obj_t *screen_registry_get(lv_obj_t **handle);
+
+/**
+ * Build (if needed) and load a screen, same arguments as `lv_scr_load_anim`
+ */
+void screen_registry_load(lv_obj_t **handle, lv_scr_load_anim_t anim,
+                          uint32_t time, uint32_t delay);
+
+/**
+ * Delete least recently used screens until `min_free` bytes of LVGL heap
+ * are available. Pinned and displayed screens are kept.
+ * @param min_free wanted size of the biggest free block
+ * @return number of screens deleted
+ */
+uint32_t screen_registry_trim(uint32_t min_free);
+
+/**
+ * Delete one screen if it is not pinned or displayed
+ * @return true if the screen was deleted
+ */
+bool screen_registry_evict(lv_obj_t **handle);
+
+uint32_t screen_registry_count(void);
+const screen_entry_t *screen_registry_entry(uint32_t index);
+
+/**
+ * Log the build cost of every registered screen
+ */
+void screen_registry_report(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*SCREEN_REGISTRY_H*/
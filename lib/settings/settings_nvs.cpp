@@ -0,0 +1,47 @@
+#ifdef ARDUINO_ARCH_ESP32
+
+#include "settings_store.h"
+#include <nvs.h>
+#include <nvs_flash.h>
+
+NvsSettingsBackend::NvsSettingsBackend(const char *ns) : ns(ns), handle(0) {}
+
+bool NvsSettingsBackend::begin() {
+  nvs_handle_t h;
+  if (nvs_open(ns, NVS_READWRITE, &h) != ESP_OK) {
+    return false;
+  }
+  handle = h;
+  return true;
+}
+
+bool NvsSettingsBackend::read(const SettingDesc &desc, int32_t &value) {
+  if (!handle) {
+    return false;
+  }
+  if (desc.type == SETTING_TYPE_INT) {
+    return nvs_get_i32(handle, desc.key, &value) == ESP_OK;
+  }
+  uint8_t v;
+  if (nvs_get_u8(handle, desc.key, &v) != ESP_OK) {
+    return false;
+  }
+  value = v;
+  return true;
+}
+
+bool NvsSettingsBackend::write(const SettingDesc &desc, int32_t value) {
+  if (!handle) {
+    return false;
+  }
+  if (desc.type == SETTING_TYPE_INT) {
+    return nvs_set_i32(handle, desc.key, value) == ESP_OK;
+  }
+  return nvs_set_u8(handle, desc.key, (uint8_t)value) == ESP_OK;
+}
+
+bool NvsSettingsBackend::commit() {
+  return handle && nvs_commit(handle) == ESP_OK;
+}
+
+#endif
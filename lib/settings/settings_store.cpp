@@ -0,0 +1,129 @@
+#include "settings_store.h"
+
+const SettingDesc settingDescs[SETTING_COUNT] = {
+    {"brightness", SETTING_TYPE_U8, 200}, // SETTING_BRIGHTNESS
+    {"timeout", SETTING_TYPE_INT, 0},     // SETTING_TIMEOUT
+    {"watchface", SETTING_TYPE_INT, 0},   // SETTING_WATCHFACE
+    {"language", SETTING_TYPE_INT, 0},    // SETTING_LANGUAGE
+    {"circular", SETTING_TYPE_BOOL, 1},   // SETTING_CIRCULAR
+    {"alerts", SETTING_TYPE_BOOL, 1},     // SETTING_ALERTS
+    {"aod", SETTING_TYPE_BOOL, 0},        // SETTING_AOD
+};
+
+// screen timeout dropdown options
+static const uint32_t timeouts[] = {0, 5000, 10000, 20000, 30000, 60000};
+
+uint32_t settingTimeoutMs(int32_t index) {
+  if (index < 0 || index >= (int32_t)(sizeof(timeouts) / sizeof(timeouts[0]))) {
+    return 0;
+  }
+  return timeouts[index];
+}
+
+static int32_t clamp(const SettingDesc &desc, int32_t value) {
+  switch (desc.type) {
+  case SETTING_TYPE_U8:
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+  case SETTING_TYPE_BOOL:
+    return value != 0;
+  default:
+    return value;
+  }
+}
+
+MemorySettingsBackend::MemorySettingsBackend() : writes(0), commits(0) {
+  for (int i = 0; i < SETTING_COUNT; i++) {
+    stored[i] = false;
+  }
+}
+
+bool MemorySettingsBackend::begin() { return true; }
+
+bool MemorySettingsBackend::read(const SettingDesc &desc, int32_t &value) {
+  int i = &desc - settingDescs;
+  if (!stored[i]) {
+    return false;
+  }
+  value = values[i];
+  return true;
+}
+
+bool MemorySettingsBackend::write(const SettingDesc &desc, int32_t value) {
+  int i = &desc - settingDescs;
+  values[i] = value;
+  stored[i] = true;
+  writes++;
+  return true;
+}
+
+bool MemorySettingsBackend::commit() {
+  commits++;
+  return true;
+}
+
+SettingsStore::SettingsStore(SettingsBackend &backend, uint32_t settle_ms,
+                             uint32_t max_delay_ms)
+    : backend(backend), settle_ms(settle_ms), max_delay_ms(max_delay_ms),
+      dirty(0), first_change(0), last_change(0) {
+  for (int i = 0; i < SETTING_COUNT; i++) {
+    values[i] = settingDescs[i].def;
+  }
+}
+
+void SettingsStore::begin() {
+  backend.begin();
+  for (int i = 0; i < SETTING_COUNT; i++) {
+    int32_t value;
+    if (backend.read(settingDescs[i], value)) {
+      values[i] = clamp(settingDescs[i], value);
+    }
+  }
+  dirty = 0;
+}
+
+void SettingsStore::set(SettingKey key, int32_t value, uint32_t now) {
+  value = clamp(settingDescs[key], value);
+  if (values[key] == value) {
+    return;
+  }
+  values[key] = value;
+  if (dirty == 0) {
+    first_change = now;
+  }
+  dirty |= 1UL << key;
+  last_change = now;
+}
+
+bool SettingsStore::loop(uint32_t now) {
+  if (dirty == 0) {
+    return false;
+  }
+  if (now - last_change < settle_ms && now - first_change < max_delay_ms) {
+    return false;
+  }
+  if (flush()) {
+    return true;
+  }
+  // retry once the changes settle again, not on every loop
+  first_change = now;
+  last_change = now;
+  return false;
+}
+
+bool SettingsStore::flush() {
+  if (dirty == 0) {
+    return false;
+  }
+  uint32_t written = 0;
+  for (int i = 0; i < SETTING_COUNT; i++) {
+    if ((dirty & (1UL << i)) && backend.write(settingDescs[i], values[i])) {
+      written |= 1UL << i;
+    }
+  }
+  // nothing is stored until the commit, keep every key dirty if it fails
+  if (!backend.commit()) {
+    return false;
+  }
+  dirty &= ~written;
+  return dirty == 0;
+}
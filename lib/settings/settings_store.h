@@ -0,0 +1,138 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <stdint.h>
+
+/**
+ * Persistent settings with an in-RAM shadow copy.
+ * Reads come from the shadow copy. Writes mark the key dirty and are
+ * written back together, in one commit, once no change happened for
+ * `settle_ms` (or `max_delay_ms` after the first pending change).
+ */
+
+enum SettingKey {
+  SETTING_BRIGHTNESS,
+  SETTING_TIMEOUT,
+  SETTING_WATCHFACE,
+  SETTING_LANGUAGE,
+  SETTING_CIRCULAR,
+  SETTING_ALERTS,
+  SETTING_AOD,
+  SETTING_COUNT
+};
+
+enum SettingType { SETTING_TYPE_U8, SETTING_TYPE_INT, SETTING_TYPE_BOOL };
+
+struct SettingDesc {
+  const char *key; // NVS key, max 15 characters
+  SettingType type;
+  int32_t def;
+};
+
+extern const SettingDesc settingDescs[SETTING_COUNT];
+
+/**
+ * Screen timeout for a SETTING_TIMEOUT option index
+ * @return timeout in ms, 0 = always on
+ */
+uint32_t settingTimeoutMs(int32_t index);
+
+class SettingsBackend {
+public:
+  virtual ~SettingsBackend() {}
+  virtual bool begin() = 0;
+  /**
+   * Read a stored value
+   * @return false if the key is not stored
+   */
+  virtual bool read(const SettingDesc &desc, int32_t &value) = 0;
+  virtual bool write(const SettingDesc &desc, int32_t value) = 0;
+  virtual bool commit() = 0;
+};
+
+/**
+ * RAM backend for the native builds, counts writes and commits
+ */
+class MemorySettingsBackend : public SettingsBackend {
+public:
+  MemorySettingsBackend();
+  bool begin();
+  bool read(const SettingDesc &desc, int32_t &value);
+  bool write(const SettingDesc &desc, int32_t value);
+  bool commit();
+
+  uint32_t writes;
+  uint32_t commits;
+
+private:
+  int32_t values[SETTING_COUNT];
+  bool stored[SETTING_COUNT];
+};
+
+#ifdef ARDUINO_ARCH_ESP32
+/**
+ * NVS backend, same namespace, keys and types as `Preferences`
+ * (putUChar/putInt/putBool) so existing values are kept
+ */
+class NvsSettingsBackend : public SettingsBackend {
+public:
+  NvsSettingsBackend(const char *ns);
+  bool begin();
+  bool read(const SettingDesc &desc, int32_t &value);
+  bool write(const SettingDesc &desc, int32_t value);
+  bool commit();
+
+private:
+  const char *ns;
+  uint32_t handle;
+};
+#endif
+
+class SettingsStore {
+public:
+  SettingsStore(SettingsBackend &backend, uint32_t settle_ms = 2000,
+                uint32_t max_delay_ms = 10000);
+
+  /**
+   * Load every setting into the shadow copy
+   */
+  void begin();
+
+  int32_t get(SettingKey key) const { return values[key]; }
+  bool getBool(SettingKey key) const { return values[key] != 0; }
+
+  /**
+   * Change a setting, written back later by `loop`
+   * @param key setting
+   * @param value new value
+   * @param now current time in ms
+   */
+  void set(SettingKey key, int32_t value, uint32_t now);
+
+  /**
+   * Write back pending changes once they settled
+   * @param now current time in ms
+   * @return true if the pending changes were stored, after a failure
+   *         the next attempt waits `settle_ms`
+   */
+  bool loop(uint32_t now);
+
+  /**
+   * Write back pending changes now (e.g. before sleep)
+   * @return true if every change was stored, failed keys stay pending
+   */
+  bool flush();
+
+  bool pending() const { return dirty != 0; }
+
+private:
+  SettingsBackend &backend;
+  uint32_t settle_ms;
+  uint32_t max_delay_ms;
+  int32_t values[SETTING_COUNT];
+  uint32_t dirty;
+  uint32_t first_change;
+  uint32_t last_change;
+};
+
+#endif /*SETTINGS_STORE_H*/
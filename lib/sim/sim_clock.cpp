@@ -0,0 +1,72 @@
+#include "sim_clock.h"
+
+SimClock::SimClock(time_t start, SimTick tick)
+    : start(start), tick(tick), elapsed(0), event_count(0), events_fired(0) {}
+
+void SimClock::begin(time_t start, SimTick tick) {
+  this->start = start;
+  this->tick = tick;
+  elapsed = 0;
+  event_count = 0;
+  events_fired = 0;
+}
+
+bool SimClock::every(uint32_t period_ms, SimEvent event) {
+  if (event_count == SIM_EVENTS_MAX || period_ms == 0) {
+    return false;
+  }
+  Scheduled &s = events[event_count++];
+  s.event = event;
+  s.period = period_ms;
+  s.due = elapsed + period_ms;
+  s.count = 0;
+  return true;
+}
+
+// tick in uint32_t steps, a long advance does not overflow the callback
+void SimClock::step(uint64_t to) {
+  while (elapsed < to) {
+    uint64_t left = to - elapsed;
+    uint32_t ms = left > UINT32_MAX ? UINT32_MAX : (uint32_t)left;
+    elapsed += ms;
+    if (tick) {
+      tick(ms);
+    }
+  }
+}
+
+void SimClock::advance(uint32_t ms) {
+  uint64_t target = elapsed + ms;
+  while (true) {
+    // earliest due event within the step, the first registered on a tie
+    Scheduled *next = 0;
+    for (uint8_t i = 0; i < event_count; i++) {
+      if (events[i].due <= target && (!next || events[i].due < next->due)) {
+        next = &events[i];
+      }
+    }
+    if (!next) {
+      break;
+    }
+    step(next->due);
+    next->due += next->period;
+    next->count++;
+    events_fired++;
+    next->event(next->count);
+  }
+  step(target);
+}
+
+uint32_t SimClock::untilNext() const {
+  uint64_t next = UINT64_MAX;
+  for (uint8_t i = 0; i < event_count; i++) {
+    if (events[i].due < next) {
+      next = events[i].due;
+    }
+  }
+  if (next == UINT64_MAX) {
+    return UINT32_MAX;
+  }
+  uint64_t left = next - elapsed;
+  return left > UINT32_MAX ? UINT32_MAX : (uint32_t)left;
+}
@@ -0,0 +1,71 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * Simulated clock for virtual-time runs of the emulator.
+ *
+ * Time only moves when `advance` is called, so a loop that advances by its
+ * own delay instead of sleeping runs as fast as the host allows. Elapsed
+ * milliseconds are forwarded to the tick callback (`lv_tick_inc`) and the
+ * wall clock is `start` plus the elapsed time. Periodic events (incoming
+ * notifications, touches) fire at their exact simulated time, in order,
+ * even when one `advance` crosses several of them.
+ */
+
+#ifndef SIM_EVENTS_MAX
+#define SIM_EVENTS_MAX 8
+#endif
+
+typedef void (*SimTick)(uint32_t ms);
+typedef void (*SimEvent)(uint32_t count);
+
+class SimClock {
+public:
+  SimClock(time_t start = 0, SimTick tick = 0);
+
+  void begin(time_t start, SimTick tick);
+
+  /**
+   * Call `event` every `period_ms`, first after one period
+   * @param event called with the number of times it fired, from 1
+   * @return false if SIM_EVENTS_MAX events are registered
+   */
+  bool every(uint32_t period_ms, SimEvent event);
+
+  /**
+   * Move the time forward, ticking up to each due event before firing it
+   */
+  void advance(uint32_t ms);
+
+  /**
+   * Time to the next event, UINT32_MAX without events
+   */
+  uint32_t untilNext() const;
+
+  uint64_t millis() const { return elapsed; }
+  time_t time() const { return start + (time_t)(elapsed / 1000); }
+  uint32_t millisOfSecond() const { return elapsed % 1000; }
+  uint32_t fired() const { return events_fired; }
+
+private:
+  struct Scheduled {
+    SimEvent event;
+    uint32_t period;
+    uint64_t due;
+    uint32_t count;
+  };
+
+  void step(uint64_t to);
+
+  time_t start;
+  SimTick tick;
+  uint64_t elapsed;
+  Scheduled events[SIM_EVENTS_MAX];
+  uint8_t event_count;
+  uint32_t events_fired;
+};
+
+#endif /*SIM_CLOCK_H*/
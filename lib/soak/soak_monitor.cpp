@@ -0,0 +1,122 @@
+#include "soak_monitor.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *metric_names[SOAK_METRICS] = {"heap used", "free block",
+                                                 "objects"};
+static const char *trend_names[] = {"stable", "GROWING", "GROWING (noisy)"};
+
+SoakMonitor::SoakMonitor(const SoakLimits &limits)
+    : limits(limits), samples(0) {
+  memset(history, 0, sizeof(history));
+}
+
+bool SoakMonitor::add(const SoakSample &sample) {
+  if (samples == SOAK_CHECKPOINTS_MAX) {
+    return false;
+  }
+  history[samples++] = sample;
+  return true;
+}
+
+int64_t SoakMonitor::value(uint16_t index, SoakMetric metric) const {
+  const SoakSample &s = history[index];
+  switch (metric) {
+  case SOAK_USED:
+    return s.used;
+  case SOAK_FREE_BLOCK:
+    return -(int64_t)s.biggest_free; // shrinking is bad
+  default:
+    return s.objects;
+  }
+}
+
+uint32_t SoakMonitor::drift(SoakMetric metric) const {
+  if (samples <= limits.warmup) {
+    return 0;
+  }
+  int64_t d = value(samples - 1, metric) - value(limits.warmup, metric);
+  return d > 0 ? (uint32_t)d : 0;
+}
+
+SoakTrend SoakMonitor::trend(SoakMetric metric) const {
+  uint16_t first = limits.warmup;
+  if (samples < first + 3) {
+    return SOAK_STABLE; // too short to tell
+  }
+  uint32_t slack = limits.slack[metric];
+
+  bool monotonic = true;
+  for (uint16_t i = first + 1; i < samples && monotonic; i++) {
+    monotonic = value(i, metric) >= value(i - 1, metric);
+  }
+  if (monotonic && drift(metric) > slack) {
+    return SOAK_MONOTONIC;
+  }
+
+  // noisy: compare the worst of the first third with the best of the last
+  uint16_t third = (samples - first) / 3;
+  int64_t early = value(first, metric);
+  for (uint16_t i = first; i < first + third; i++) {
+    if (value(i, metric) > early) {
+      early = value(i, metric);
+    }
+  }
+  int64_t late = value(samples - 1, metric);
+  for (uint16_t i = samples - third; i < samples; i++) {
+    if (value(i, metric) < late) {
+      late = value(i, metric);
+    }
+  }
+  if (late - early > (int64_t)slack) {
+    return SOAK_SUSTAINED;
+  }
+  return SOAK_STABLE;
+}
+
+bool SoakMonitor::passed() const {
+  for (uint8_t m = 0; m < SOAK_METRICS; m++) {
+    if (trend((SoakMetric)m) != SOAK_STABLE) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int SoakMonitor::format(char *out, size_t len) const {
+  size_t used = 0;
+  out[0] = '\0';
+  for (uint8_t m = 0; m < SOAK_METRICS && samples > limits.warmup; m++) {
+    SoakMetric metric = (SoakMetric)m;
+    int64_t lo = value(limits.warmup, metric), hi = lo;
+    for (uint16_t i = limits.warmup; i < samples; i++) {
+      int64_t v = value(i, metric);
+      lo = v < lo ? v : lo;
+      hi = v > hi ? v : hi;
+    }
+    int64_t first = value(limits.warmup, metric);
+    int64_t last = value(samples - 1, metric);
+    if (metric == SOAK_FREE_BLOCK) { // print the real values
+      first = -first;
+      last = -last;
+      int64_t t = lo;
+      lo = -hi;
+      hi = -t;
+    }
+    int n = snprintf(out + used, len - used,
+                     "soak: %-10s first %ld last %ld min %ld max %ld %s\n",
+                     metric_names[m], (long)first, (long)last, (long)lo,
+                     (long)hi, trend_names[trend(metric)]);
+    if (n < 0 || (size_t)n >= len - used) {
+      return (int)len - 1;
+    }
+    used += n;
+  }
+  return (int)used;
+}
+
+const char *SoakMonitor::name(SoakMetric metric) {
+  return metric < SOAK_METRICS ? metric_names[metric] : "";
+}
+
+const char *SoakMonitor::name(SoakTrend trend) { return trend_names[trend]; }
@@ -0,0 +1,87 @@
+#ifndef SOAK_MONITOR_H
+#define SOAK_MONITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Leak and fragmentation check for long runs.
+ *
+ * The caller repeats the same actions between checkpoints and adds one
+ * sample per checkpoint. After the warm-up (first screen builds, caches
+ * filling) a metric fails when it keeps moving the wrong way by more than
+ * its limit: LVGL heap use and object count growing, the largest free
+ * block shrinking. Either every step goes that way (a clean leak), or the
+ * last third of the run never comes back to the range of the first third
+ * (a leak hidden in noise).
+ */
+
+#ifndef SOAK_CHECKPOINTS_MAX
+#define SOAK_CHECKPOINTS_MAX 256
+#endif
+
+enum SoakMetric { SOAK_USED, SOAK_FREE_BLOCK, SOAK_OBJECTS, SOAK_METRICS };
+
+enum SoakTrend {
+  SOAK_STABLE,
+  SOAK_MONOTONIC, // moved the wrong way at every checkpoint
+  SOAK_SUSTAINED, // last third entirely past the first third
+};
+
+struct SoakSample {
+  uint32_t used;         // LVGL heap in use
+  uint32_t biggest_free; // largest free block
+  uint32_t objects;      // LVGL objects on all screens and layers
+};
+
+struct SoakLimits {
+  uint16_t warmup;              // checkpoints ignored at the start
+  uint32_t slack[SOAK_METRICS]; // allowed drift per metric over the run
+
+  SoakLimits() : warmup(2) {
+    slack[SOAK_USED] = 1024;
+    slack[SOAK_FREE_BLOCK] = 2048;
+    slack[SOAK_OBJECTS] = 0;
+  }
+};
+
+class SoakMonitor {
+public:
+  SoakMonitor(const SoakLimits &limits = SoakLimits());
+
+  /**
+   * @return false once SOAK_CHECKPOINTS_MAX samples are stored
+   */
+  bool add(const SoakSample &sample);
+
+  uint16_t count() const { return samples; }
+  const SoakSample &sample(uint16_t index) const { return history[index]; }
+
+  SoakTrend trend(SoakMetric metric) const;
+
+  /**
+   * Drift in the failing direction from the first sample after the
+   * warm-up to the last one, 0 if it moved the other way
+   */
+  uint32_t drift(SoakMetric metric) const;
+
+  bool passed() const;
+
+  /**
+   * One line per metric: first, last, min, max and the verdict
+   */
+  int format(char *out, size_t len) const;
+
+  static const char *name(SoakMetric metric);
+  static const char *name(SoakTrend trend);
+
+private:
+  // value oriented so that growing is bad
+  int64_t value(uint16_t index, SoakMetric metric) const;
+
+  SoakLimits limits;
+  SoakSample history[SOAK_CHECKPOINTS_MAX];
+  uint16_t samples;
+};
+
+#endif /*SOAK_MONITOR_H*/
@@ -0,0 +1,115 @@
+#include "label_layout.h"
+
+// same breaking and widths as lv_draw_label
+static uint32_t lvgl_break(const char *text, const void *font, int16_t width,
+                           int16_t letter_space, uint8_t flags,
+                           int16_t *line_width) {
+  const lv_font_t *f = (const lv_font_t *)font;
+  uint32_t n = _lv_txt_get_next_line(text, f, letter_space, width, NULL,
+                                     (lv_text_flag_t)flags);
+  *line_width = lv_txt_get_width(text, n, f, letter_space,
+                                 (lv_text_flag_t)flags);
+  return n;
+}
+
+static TextLayoutCache cache(lvgl_break);
+
+static void draw_line(lv_draw_ctx_t *draw_ctx, const lv_draw_label_dsc_t *dsc,
+                      const char *text, const TextLine &line, lv_point_t pos) {
+  uint32_t i = line.start;
+  uint32_t end = line.start + line.length;
+  while (i < end && pos.x <= draw_ctx->clip_area->x2) {
+    uint32_t letter, next;
+    _lv_txt_encoded_letter_next_2(text, &letter, &next, &i);
+    if (letter == '\n' || letter == '\r') {
+      continue;
+    }
+    lv_draw_letter(draw_ctx, dsc, &pos, letter);
+    pos.x += lv_font_get_glyph_width(dsc->font, letter, next) +
+             dsc->letter_space;
+  }
+}
+
+static void draw_main(lv_event_t *e) {
+  lv_obj_t *obj = lv_event_get_target(e);
+  if (lv_label_get_long_mode(obj) != LV_LABEL_LONG_WRAP ||
+      lv_label_get_recolor(obj) ||
+      lv_obj_get_style_width(obj, LV_PART_MAIN) == LV_SIZE_CONTENT) {
+    return;
+  }
+#if LV_LABEL_TEXT_SELECTION
+  if (lv_label_get_text_selection_start(obj) != LV_DRAW_LABEL_NO_TXT_SEL) {
+    return;
+  }
+#endif
+  lv_draw_label_dsc_t dsc;
+  lv_draw_label_dsc_init(&dsc);
+  lv_obj_init_draw_label_dsc(obj, LV_PART_MAIN, &dsc);
+  if (dsc.decor != LV_TEXT_DECOR_NONE) {
+    return;
+  }
+
+  lv_area_t coords;
+  lv_obj_get_content_coords(obj, &coords);
+  const char *text = lv_label_get_text(obj);
+  lv_coord_t w = lv_area_get_width(&coords);
+  const TextLayout *layout =
+      cache.get(text, dsc.font, w, dsc.letter_space, LV_TEXT_FLAG_NONE);
+  if (layout == NULL) {
+    return;
+  }
+
+  // the base object draws background and border, the label class is skipped
+  lv_obj_event_base(&lv_label_class, e);
+  lv_event_stop_processing(e);
+
+  lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+  lv_area_t clip;
+  if (!_lv_area_intersect(&clip, &coords, draw_ctx->clip_area)) {
+    return;
+  }
+  const lv_area_t *prev_clip = draw_ctx->clip_area;
+  draw_ctx->clip_area = &clip;
+
+  lv_coord_t top = coords.y1 - lv_obj_get_scroll_top(obj);
+  lv_coord_t font_h = lv_font_get_line_height(dsc.font);
+  lv_coord_t line_h = font_h + dsc.line_space;
+  // jump to the first visible line, nothing above it is measured
+  int32_t first = line_h > 0 ? (clip.y1 - top - font_h) / line_h : 0;
+  for (int32_t i = first < 0 ? 0 : first; i < layout->count; i++) {
+    lv_point_t pos;
+    pos.y = top + i * line_h;
+    if (pos.y > clip.y2) {
+      break;
+    }
+    if (pos.y + font_h <= clip.y1) {
+      continue;
+    }
+    const TextLine &line = layout->lines[i];
+    pos.x = coords.x1;
+    if (dsc.align == LV_TEXT_ALIGN_CENTER) {
+      pos.x += (w - line.width) / 2;
+    } else if (dsc.align == LV_TEXT_ALIGN_RIGHT) {
+      pos.x += w - line.width;
+    }
+    draw_line(draw_ctx, &dsc, text, line, pos);
+  }
+  draw_ctx->clip_area = prev_clip;
+}
+
+void label_layout_attach(lv_obj_t *label) {
+  lv_obj_remove_event_cb(label, draw_main);
+  lv_obj_add_event_cb(
+      label, draw_main,
+      (lv_event_code_t)(LV_EVENT_DRAW_MAIN | LV_EVENT_PREPROCESS), NULL);
+}
+
+void label_layout_detach(lv_obj_t *label) {
+  lv_obj_remove_event_cb(label, draw_main);
+}
+
+void label_layout_invalidate(const lv_font_t *font) {
+  cache.invalidate(font);
+}
+
+const TextLayoutStats &label_layout_stats() { return cache.stats(); }
@@ -0,0 +1,33 @@
+#ifndef LABEL_LAYOUT_H
+#define LABEL_LAYOUT_H
+
+#include <lvgl.h>
+
+#include "text_layout.h"
+
+/**
+ * Wrapped labels drawn from the `TextLayoutCache`.
+ *
+ * An attached label breaks its text once per text, font and width instead
+ * of once per draw band, and only the lines inside the clip area are
+ * drawn, so scrolling a long notification redraws a few lines from the
+ * cached offsets. Labels the cache does not cover (other long modes,
+ * recolor, selection, decorations, more than TEXT_LAYOUT_LINES lines) are
+ * drawn by LVGL as before.
+ */
+
+/**
+ * Draw a label from the cache, attaching twice is harmless
+ */
+void label_layout_attach(lv_obj_t *label);
+
+void label_layout_detach(lv_obj_t *label);
+
+/**
+ * Drop the layouts of a font before it is unloaded, NULL for all
+ */
+void label_layout_invalidate(const lv_font_t *font);
+
+const TextLayoutStats &label_layout_stats();
+
+#endif /*LABEL_LAYOUT_H*/
@@ -0,0 +1,110 @@
+#include "text_layout.h"
+#include <stdlib.h>
+#include <string.h>
+
+TextLayoutCache::TextLayoutCache(TextBreak breaker)
+    : breaker(breaker), uses(0) {
+  memset(entries, 0, sizeof(entries));
+  memset(&counters, 0, sizeof(counters));
+}
+
+TextLayoutCache::~TextLayoutCache() {
+  for (uint8_t i = 0; i < TEXT_LAYOUT_ENTRIES; i++) {
+    free(entries[i].text);
+  }
+}
+
+uint32_t TextLayoutCache::hash(const char *text, uint32_t *length) {
+  uint32_t h = 2166136261u;
+  const char *p = text;
+  while (*p) {
+    h = (h ^ (uint8_t)*p++) * 16777619u;
+  }
+  *length = p - text;
+  return h;
+}
+
+static bool same_key(const TextLayoutKey &a, const TextLayoutKey &b) {
+  return a.hash == b.hash && a.length == b.length && a.font == b.font &&
+         a.width == b.width && a.letter_space == b.letter_space &&
+         a.flags == b.flags;
+}
+
+const TextLayout *TextLayoutCache::get(const char *text, const void *font,
+                                       int16_t width, int16_t letter_space,
+                                       uint8_t flags) {
+  TextLayoutKey key;
+  memset(&key, 0, sizeof(key));
+  key.hash = hash(text, &key.length);
+  key.font = font;
+  key.width = width;
+  key.letter_space = letter_space;
+  key.flags = flags;
+
+  TextLayout *oldest = &entries[0];
+  for (uint8_t i = 0; i < TEXT_LAYOUT_ENTRIES; i++) {
+    TextLayout &e = entries[i];
+    if (e.key.font && same_key(e.key, key) &&
+        memcmp(e.text, text, key.length) == 0) {
+      e.last_used = ++uses;
+      counters.hits++;
+      return &e;
+    }
+    if (e.last_used < oldest->last_used) {
+      oldest = &e;
+    }
+  }
+  if (key.length > UINT16_MAX) {
+    counters.too_long++;
+    return NULL;
+  }
+
+  // break into the least recently used entry
+  TextLayout &e = *oldest;
+  e.key.font = NULL;
+  if (e.text_size <= key.length) {
+    char *copy = (char *)realloc(e.text, key.length + 1);
+    if (copy == NULL) {
+      return NULL;
+    }
+    e.text = copy;
+    e.text_size = key.length + 1;
+  }
+  e.count = 0;
+  e.max_width = 0;
+  uint32_t pos = 0;
+  while (pos < key.length) {
+    int16_t w = 0;
+    uint32_t n = breaker(text + pos, font, width, letter_space, flags, &w);
+    if (n == 0) {
+      break;
+    }
+    if (e.count == TEXT_LAYOUT_LINES) {
+      e.last_used = 0;
+      counters.too_long++;
+      return NULL;
+    }
+    TextLine &line = e.lines[e.count++];
+    line.start = pos;
+    line.length = n;
+    line.width = w;
+    if (w > e.max_width) {
+      e.max_width = w;
+    }
+    pos += n;
+  }
+  memcpy(e.text, text, key.length + 1);
+  e.key = key;
+  e.last_used = ++uses;
+  counters.misses++;
+  return &e;
+}
+
+void TextLayoutCache::invalidate(const void *font) {
+  for (uint8_t i = 0; i < TEXT_LAYOUT_ENTRIES; i++) {
+    if (font == NULL || entries[i].key.font == font) {
+      entries[i].key.font = NULL;
+      entries[i].last_used = 0;
+    }
+  }
+}
@@ -0,0 +1,102 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <stdint.h>
+
+/**
+ * Line-break cache for wrapped text.
+ *
+ * Breaking a long message into lines measures every glyph, and a label
+ * does it again for each band of the draw buffer, on every scroll step.
+ * The cache keeps the line offsets and widths of the last
+ * TEXT_LAYOUT_ENTRIES layouts, keyed by the text content and everything
+ * the breaking depends on (font, width, letter spacing, flags), so an
+ * unchanged label reuses them across redraws and a message opened again
+ * finds its layout. A different text or style is a different key, nothing
+ * has to be invalidated by hand. Each entry keeps a copy of its text, a
+ * hash match is only a hit if the text matches too.
+ *
+ * The breaking itself is done by `TextBreak`, LVGL's in the firmware.
+ */
+
+#ifndef TEXT_LAYOUT_ENTRIES
+#define TEXT_LAYOUT_ENTRIES 4
+#endif
+
+#ifndef TEXT_LAYOUT_LINES
+#define TEXT_LAYOUT_LINES 48 // texts with more lines are not cached
+#endif
+
+/**
+ * Length of the first line of `text`
+ * @param line_width set to the width of that line in pixels
+ * @return bytes in the line including the break, 0 at the end
+ */
+typedef uint32_t (*TextBreak)(const char *text, const void *font,
+                              int16_t width, int16_t letter_space,
+                              uint8_t flags, int16_t *line_width);
+
+struct TextLayoutKey {
+  uint32_t hash; // FNV-1a of the text
+  uint32_t length;
+  const void *font;
+  int16_t width;
+  int16_t letter_space;
+  uint8_t flags;
+};
+
+struct TextLine {
+  uint16_t start; // byte offset in the text
+  uint16_t length;
+  int16_t width;
+};
+
+struct TextLayout {
+  TextLayoutKey key;
+  char *text; // copy of the text, compared on a hit
+  uint32_t text_size;
+  uint16_t count;
+  int16_t max_width;
+  uint32_t last_used;
+  TextLine lines[TEXT_LAYOUT_LINES];
+};
+
+struct TextLayoutStats {
+  uint32_t hits;
+  uint32_t misses;   // layouts computed
+  uint32_t too_long; // more than TEXT_LAYOUT_LINES lines, not cached
+};
+
+class TextLayoutCache {
+public:
+  explicit TextLayoutCache(TextBreak breaker);
+  ~TextLayoutCache();
+
+  /**
+   * Layout of a text, computed on a miss
+   * @return NULL if the text has more than TEXT_LAYOUT_LINES lines or
+   *         could not be copied, valid until the next call
+   */
+  const TextLayout *get(const char *text, const void *font, int16_t width,
+                        int16_t letter_space, uint8_t flags);
+
+  /**
+   * Drop the layouts of a font, e.g. before it is unloaded, NULL for all
+   */
+  void invalidate(const void *font = 0);
+
+  const TextLayoutStats &stats() const { return counters; }
+
+  static uint32_t hash(const char *text, uint32_t *length);
+
+private:
+  TextLayoutCache(const TextLayoutCache &);
+  TextLayoutCache &operator=(const TextLayoutCache &);
+
+  TextBreak breaker;
+  TextLayout entries[TEXT_LAYOUT_ENTRIES];
+  uint32_t uses;
+  TextLayoutStats counters;
+};
+
+#endif /*TEXT_LAYOUT_H*/
@@ -0,0 +1,342 @@
+#include "transition.h"
+#include <stdlib.h>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#endif
+
+#if LV_USE_SNAPSHOT == 0
+#error "transition requires LV_USE_SNAPSHOT 1 in lv_conf.h"
+#endif
+
+/* Heap that must stay free after both snapshot buffers are allocated */
+#ifndef TRANSITION_HEAP_RESERVE
+#define TRANSITION_HEAP_RESERVE (48U * 1024U)
+#endif
+
+#define PROGRESS_MAX 1024
+
+static TransitionMode mode = TRANSITION_AUTO;
+static TransitionStats stats;
+
+enum SnapshotStart {
+  SNAPSHOT_STARTED,     // the stage is animating
+  SNAPSHOT_UNAVAILABLE, // nothing sent yet, use lv_scr_load_anim
+  SNAPSHOT_LOADED       // capture failed, the screen was loaded without anim
+};
+
+static struct {
+  bool active;
+  bool snapshot;
+  uint32_t start;
+  uint32_t duration;
+  lv_scr_load_anim_t anim;
+  lv_obj_t *from;
+  lv_obj_t *to;
+  lv_obj_t *stage;
+  lv_obj_t *img_from;
+  lv_obj_t *img_to;
+  lv_img_dsc_t dsc_from;
+  lv_img_dsc_t dsc_to;
+  void *buf_from;
+  void *buf_to;
+} tr;
+
+static void *alloc_buffer(uint32_t size) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (psramFound()) {
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+  }
+  if (heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) < size ||
+      heap_caps_get_free_size(MALLOC_CAP_8BIT) <
+          size + TRANSITION_HEAP_RESERVE) {
+    return NULL;
+  }
+  return heap_caps_malloc(size, MALLOC_CAP_8BIT);
+#else
+  return malloc(size);
+#endif
+}
+
+static void free_buffers() {
+  if (tr.buf_from) {
+    lv_img_cache_invalidate_src(&tr.dsc_from);
+    free(tr.buf_from);
+    tr.buf_from = NULL;
+  }
+  if (tr.buf_to) {
+    lv_img_cache_invalidate_src(&tr.dsc_to);
+    free(tr.buf_to);
+    tr.buf_to = NULL;
+  }
+}
+
+static bool anim_supported(lv_scr_load_anim_t anim) {
+  switch (anim) {
+  case LV_SCR_LOAD_ANIM_FADE_IN:
+  case LV_SCR_LOAD_ANIM_FADE_OUT:
+  case LV_SCR_LOAD_ANIM_OVER_LEFT:
+  case LV_SCR_LOAD_ANIM_OVER_RIGHT:
+  case LV_SCR_LOAD_ANIM_OVER_TOP:
+  case LV_SCR_LOAD_ANIM_OVER_BOTTOM:
+  case LV_SCR_LOAD_ANIM_MOVE_LEFT:
+  case LV_SCR_LOAD_ANIM_MOVE_RIGHT:
+  case LV_SCR_LOAD_ANIM_MOVE_TOP:
+  case LV_SCR_LOAD_ANIM_MOVE_BOTTOM:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/* Buffers for both snapshots, nothing is sent to the screens yet so a failure
+ * here can still fall back to lv_scr_load_anim. Returns the size of each */
+static uint32_t alloc_snapshots(lv_obj_t *from, lv_obj_t *to) {
+  lv_obj_update_layout(from);
+  lv_obj_update_layout(to);
+
+  uint32_t size = lv_snapshot_buf_size_needed(from, LV_IMG_CF_TRUE_COLOR);
+  if (size == 0 ||
+      size != lv_snapshot_buf_size_needed(to, LV_IMG_CF_TRUE_COLOR)) {
+    return 0;
+  }
+
+  tr.buf_from = alloc_buffer(size);
+  tr.buf_to = tr.buf_from ? alloc_buffer(size) : NULL;
+  if (tr.buf_to == NULL) {
+    free_buffers();
+    return 0;
+  }
+  return size;
+}
+
+static bool take_snapshots(lv_obj_t *from, lv_obj_t *to, uint32_t size) {
+  uint32_t start = lv_tick_get();
+
+  /* the load start handlers may have changed the content */
+  lv_obj_update_layout(from);
+  lv_obj_update_layout(to);
+
+  if (lv_snapshot_take_to_buf(from, LV_IMG_CF_TRUE_COLOR, &tr.dsc_from,
+                              tr.buf_from, size) != LV_RES_OK ||
+      lv_snapshot_take_to_buf(to, LV_IMG_CF_TRUE_COLOR, &tr.dsc_to,
+                              tr.buf_to, size) != LV_RES_OK) {
+    free_buffers();
+    return false;
+  }
+
+  stats.snapshot_ms = lv_tick_elaps(start);
+  stats.buffer_size = size * 2;
+  return true;
+}
+
+static void step_cb(void *var, int32_t v) {
+  (void)var;
+  lv_coord_t w = lv_obj_get_width(tr.stage);
+  lv_coord_t h = lv_obj_get_height(tr.stage);
+  /* remaining distance of the incoming screen */
+  lv_coord_t dx = w - (lv_coord_t)((int32_t)w * v / PROGRESS_MAX);
+  lv_coord_t dy = h - (lv_coord_t)((int32_t)h * v / PROGRESS_MAX);
+
+  switch (tr.anim) {
+  case LV_SCR_LOAD_ANIM_FADE_IN:
+    lv_obj_set_style_img_opa(tr.img_to, v * LV_OPA_COVER / PROGRESS_MAX, 0);
+    break;
+  case LV_SCR_LOAD_ANIM_FADE_OUT:
+    lv_obj_set_style_img_opa(tr.img_from,
+                             LV_OPA_COVER - v * LV_OPA_COVER / PROGRESS_MAX,
+                             0);
+    break;
+  case LV_SCR_LOAD_ANIM_OVER_LEFT:
+    lv_obj_set_x(tr.img_to, dx);
+    break;
+  case LV_SCR_LOAD_ANIM_OVER_RIGHT:
+    lv_obj_set_x(tr.img_to, -dx);
+    break;
+  case LV_SCR_LOAD_ANIM_OVER_TOP:
+    lv_obj_set_y(tr.img_to, dy);
+    break;
+  case LV_SCR_LOAD_ANIM_OVER_BOTTOM:
+    lv_obj_set_y(tr.img_to, -dy);
+    break;
+  case LV_SCR_LOAD_ANIM_MOVE_LEFT:
+    lv_obj_set_x(tr.img_to, dx);
+    lv_obj_set_x(tr.img_from, dx - w);
+    break;
+  case LV_SCR_LOAD_ANIM_MOVE_RIGHT:
+    lv_obj_set_x(tr.img_to, -dx);
+    lv_obj_set_x(tr.img_from, w - dx);
+    break;
+  case LV_SCR_LOAD_ANIM_MOVE_TOP:
+    lv_obj_set_y(tr.img_to, dy);
+    lv_obj_set_y(tr.img_from, dy - h);
+    break;
+  case LV_SCR_LOAD_ANIM_MOVE_BOTTOM:
+    lv_obj_set_y(tr.img_to, -dy);
+    lv_obj_set_y(tr.img_from, h - dy);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Make `to` the active screen and send the events that end a load */
+static void show_loaded(lv_obj_t *from, lv_obj_t *to) {
+  lv_disp_t *d = lv_obj_get_disp(to);
+  d->act_scr = to;
+  d->prev_scr = NULL;
+  lv_obj_invalidate(to);
+
+  lv_event_send(to, LV_EVENT_SCREEN_LOADED, NULL);
+  lv_event_send(from, LV_EVENT_SCREEN_UNLOADED, NULL);
+}
+
+static void finish() {
+  if (!tr.active) {
+    return;
+  }
+  tr.active = false;
+
+  if (tr.snapshot) {
+    lv_anim_del(&tr, step_cb);
+
+    /* A screen loaded while the stage was shown replaced this load */
+    lv_disp_t *d = lv_obj_get_disp(tr.stage);
+    bool shown = d->act_scr == tr.stage;
+    if (d->prev_scr == tr.stage) {
+      d->prev_scr = NULL; // lv_scr_load_anim started from the stage
+    }
+    lv_obj_del(tr.stage);
+    tr.stage = NULL;
+    free_buffers();
+
+    /* Swap the stage for the real screen. The load start events were sent
+     * before the snapshots were taken, same order as lv_scr_load_anim */
+    if (shown) {
+      show_loaded(tr.from, tr.to);
+    }
+  }
+}
+
+static void ready_cb(lv_anim_t *a) {
+  (void)a;
+  finish();
+}
+
+static lv_obj_t *stage_img(const lv_img_dsc_t *dsc) {
+  lv_obj_t *img = lv_img_create(tr.stage);
+  lv_img_set_src(img, dsc);
+  lv_obj_set_pos(img, 0, 0);
+  return img;
+}
+
+static SnapshotStart start_snapshot(lv_obj_t *from, lv_obj_t *to,
+                                    uint32_t time, uint32_t delay) {
+  lv_disp_t *d = lv_obj_get_disp(to);
+  if (d->scr_to_load != NULL || d->prev_scr != NULL) {
+    return SNAPSHOT_UNAVAILABLE; /* lv_scr_load_anim in progress */
+  }
+
+  uint32_t size = alloc_snapshots(from, to);
+  if (size == 0) {
+    return SNAPSHOT_UNAVAILABLE;
+  }
+
+  /* Let the screens update their content before they are captured */
+  lv_event_send(to, LV_EVENT_SCREEN_LOAD_START, NULL);
+  lv_event_send(from, LV_EVENT_SCREEN_UNLOAD_START, NULL);
+
+  if (!take_snapshots(from, to, size)) {
+    /* lv_scr_load_anim would send the load start events again */
+    show_loaded(from, to);
+    return SNAPSHOT_LOADED;
+  }
+
+  tr.stage = lv_obj_create(NULL);
+  lv_obj_remove_style_all(tr.stage);
+  lv_obj_set_size(tr.stage, lv_disp_get_hor_res(d), lv_disp_get_ver_res(d));
+  lv_obj_clear_flag(tr.stage, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+
+  if (tr.anim == LV_SCR_LOAD_ANIM_FADE_OUT) {
+    /* the old screen fades out on top of the new one */
+    tr.img_to = stage_img(&tr.dsc_to);
+    tr.img_from = stage_img(&tr.dsc_from);
+  } else {
+    tr.img_from = stage_img(&tr.dsc_from);
+    tr.img_to = stage_img(&tr.dsc_to);
+  }
+  step_cb(&tr, 0);
+
+  d->act_scr = tr.stage;
+  lv_obj_invalidate(tr.stage);
+
+  lv_anim_t a;
+  lv_anim_init(&a);
+  lv_anim_set_var(&a, &tr);
+  lv_anim_set_exec_cb(&a, step_cb);
+  lv_anim_set_values(&a, 0, PROGRESS_MAX);
+  lv_anim_set_time(&a, time);
+  lv_anim_set_delay(&a, delay);
+  lv_anim_set_ready_cb(&a, ready_cb);
+  lv_anim_start(&a);
+  return SNAPSHOT_STARTED;
+}
+
+void transition_load(lv_obj_t *scr, lv_scr_load_anim_t anim, uint32_t time,
+                     uint32_t delay) {
+  finish();
+
+  lv_obj_t *act = lv_scr_act();
+
+  tr.from = act;
+  tr.to = scr;
+  tr.anim = anim;
+  tr.start = lv_tick_get();
+  tr.duration = time + delay;
+  tr.snapshot = false;
+
+  stats.snapshot = false;
+  stats.snapshot_ms = 0;
+  stats.buffer_size = 0;
+  stats.frames.reset();
+
+  SnapshotStart start = SNAPSHOT_UNAVAILABLE;
+  if (mode != TRANSITION_LEGACY && scr != act && time > 0 &&
+      anim_supported(anim)) {
+    start = start_snapshot(act, scr, time, delay);
+    if (start == SNAPSHOT_UNAVAILABLE && mode == TRANSITION_SNAPSHOT) {
+      LV_LOG_WARN("transition: snapshot unavailable, using lv_scr_load_anim");
+    }
+  }
+  if (start == SNAPSHOT_LOADED) {
+    LV_LOG_WARN("transition: snapshot failed, loaded without animation");
+    return;
+  }
+
+  tr.snapshot = start == SNAPSHOT_STARTED;
+  stats.snapshot = tr.snapshot;
+  tr.active = true;
+
+  if (!tr.snapshot) {
+    lv_scr_load_anim(scr, anim, time, delay, false);
+  }
+}
+
+void transition_set_mode(TransitionMode m) { mode = m; }
+
+bool transition_active() {
+  if (tr.active && !tr.snapshot && lv_tick_elaps(tr.start) > tr.duration) {
+    tr.active = false;
+  }
+  return tr.active;
+}
+
+const TransitionStats &transition_stats() { return stats; }
+
+void transition_monitor_cb(lv_disp_drv_t *drv, uint32_t time, uint32_t px) {
+  (void)drv;
+  if (transition_active()) {
+    stats.frames.add(time, px);
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef TRANSITION_H
+#define TRANSITION_H
+
+#include <lvgl.h>
+
+#include "frame_stats.h"
+
+/**
+ * Screen transitions rendered from snapshots.
+ *
+ * `lv_scr_load_anim` redraws both widget trees on every frame of the
+ * animation. When there is enough RAM for two full screen RGB565 buffers the
+ * outgoing and incoming screens are rendered once with `lv_snapshot` and the
+ * animation only blends or moves the two bitmaps. Otherwise the call falls
+ * back to `lv_scr_load_anim`.
+ */
+
+enum TransitionMode {
+  TRANSITION_AUTO,     // snapshot if the buffers fit, legacy otherwise
+  TRANSITION_SNAPSHOT, // same as auto, but log when falling back
+  TRANSITION_LEGACY    // always use lv_scr_load_anim
+};
+
+struct TransitionStats {
+  bool snapshot;        // last transition used snapshots
+  uint32_t snapshot_ms; // time spent rendering both snapshots
+  uint32_t buffer_size; // bytes allocated for the snapshots
+  FrameStats frames;    // frames refreshed while the transition ran
+};
+
+/**
+ * Load a screen with an animation, drop-in replacement for
+ * `lv_scr_load_anim(scr, anim, time, delay, false)`
+ * @param scr screen to load
+ * @param anim animation type
+ * @param time duration of the animation in ms
+ * @param delay delay before the animation starts in ms
+ */
+void transition_load(lv_obj_t *scr, lv_scr_load_anim_t anim, uint32_t time,
+                     uint32_t delay);
+
+void transition_set_mode(TransitionMode mode);
+bool transition_active();
+
+const TransitionStats &transition_stats();
+
+/**
+ * Display driver monitor callback, records the frame times of transitions
+ * Assign to `disp_drv.monitor_cb`
+ */
+void transition_monitor_cb(lv_disp_drv_t *drv, uint32_t time, uint32_t px);
+
+#endif /*TRANSITION_H*/
@@ -1,15 +1,17 @@
 #include "ui.h"
-#include <Arduino.h>
+#include "screen_registry.h"
 #include <lvgl.h>
 
+lv_obj_t *ui_demoScreen;
+
 static void btn_event_cb(lv_event_t *e) {
   const char *msg = (const char *)lv_event_get_user_data(e);
   // Serial.println(msg);
 }
 
-void ui_init(void) {
-  lv_disp_t *dispp = lv_disp_get_default();
-  lv_obj_t *container = lv_obj_create(lv_scr_act());
+void ui_demoScreen_screen_init(void) {
+  ui_demoScreen = lv_obj_create(NULL);
+  lv_obj_t *container = lv_obj_create(ui_demoScreen);
   lv_obj_set_size(container, 300, 200);
   lv_obj_align(container, LV_ALIGN_CENTER, 0, 0);
   lv_obj_set_layout(container, LV_LAYOUT_FLEX);
@@ -36,3 +38,15 @@ void ui_init(void) {
   lv_obj_add_event_cb(btn3, btn_event_cb, LV_EVENT_CLICKED,
                       (void *)"Button 3 pressed");
 }
+
+void ui_init(void) {
+  lv_disp_t *dispp = lv_disp_get_default();
+
+  // Screens are only registered here, each one is built on first use
+  // (screen_registry_get / screen_registry_load). The first screen is
+  // pinned so it is never evicted.
+  screen_registry_add("demo", &ui_demoScreen, ui_demoScreen_screen_init, NULL,
+                      true);
+
+  lv_disp_load_scr(screen_registry_get(&ui_demoScreen));
+}
@@ -4,6 +4,10 @@ extern "C" {
 
 #include "lvgl.h"
 
+extern lv_obj_t *ui_demoScreen;
+
+void ui_demoScreen_screen_init(void);
+
 void ui_init(void);
 
 #ifdef __cplusplus
@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""
+Pack watchface and game images into compressed asset sheets.
+
+Images are converted to RGB565 (or RGB565 + A8 when they have transparency),
+optionally packed into one atlas, RLE compressed row by row and written as a
+C source/header pair decoded at runtime by lib/assets (asset_decoder.h).
+
+    python support/asset_packer.py -o src/faces/kenya_assets --atlas \\
+        kenya_bg.png kenya_hour.png kenya_minute.png
+
+Requires Pillow (pip install pillow).
+"""
+
+import argparse
+import os
+import re
+import sys
+
+from PIL import Image
+
+FORMAT_RGB565 = 0
+FORMAT_RGB565A8 = 1
+FORMAT_A8 = 2
+
+CODEC_RAW = 0
+CODEC_RLE = 1
+
+PIXEL_SIZE = {FORMAT_RGB565: 2, FORMAT_RGB565A8: 3, FORMAT_A8: 1}
+FORMAT_NAME = {FORMAT_RGB565: "ASSET_FORMAT_RGB565", FORMAT_RGB565A8: "ASSET_FORMAT_RGB565A8", FORMAT_A8: "ASSET_FORMAT_A8"}
+CODEC_NAME = {CODEC_RAW: "ASSET_CODEC_RAW", CODEC_RLE: "ASSET_CODEC_RLE"}
+
+
+def symbol(name):
+    return re.sub(r"[^0-9a-zA-Z_]", "_", name).lower()
+
+
+def has_alpha(img):
+    if img.mode not in ("RGBA", "LA") and "transparency" not in img.info:
+        return False
+    return img.convert("RGBA").getextrema()[3][0] < 255
+
+
+def pixel_bytes(rgba, fmt, swap):
+    r, g, b, a = rgba
+    if fmt == FORMAT_A8:
+        return bytes([a])
+    c = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+    px = bytes([c >> 8, c & 0xFF]) if swap else bytes([c & 0xFF, c >> 8])
+    if fmt == FORMAT_RGB565A8:
+        px += bytes([a])
+    return px
+
+
+def rle_row(pixels, size):
+    """Same encoding as asset_rle_encode_row in lib/assets/asset.cpp"""
+    out = bytearray()
+    count = len(pixels) // size
+    px = [pixels[i * size:(i + 1) * size] for i in range(count)]
+    i = 0
+    while i < count:
+        run = 1
+        while i + run < count and run < 128 and px[i + run] == px[i]:
+            run += 1
+        if run >= 2:
+            out.append(0x80 | (run - 1))
+            out += px[i]
+            i += run
+            continue
+        lit = 1
+        while i + lit < count and lit < 128 and not (i + lit + 1 < count and px[i + lit] == px[i + lit + 1]):
+            lit += 1
+        out.append(lit - 1)
+        for p in px[i:i + lit]:
+            out += p
+        i += lit
+    return bytes(out)
+
+
+def pack_shelves(images, max_width):
+    """Shelf packing, tallest first. Returns sheet size and frame positions."""
+    order = sorted(range(len(images)), key=lambda i: -images[i].size[1])
+    frames = [None] * len(images)
+    x = y = shelf = width = 0
+    for i in order:
+        w, h = images[i].size
+        if x + w > max_width:
+            x = 0
+            y += shelf
+            shelf = 0
+        frames[i] = (x, y)
+        x += w
+        shelf = max(shelf, h)
+        width = max(width, x)
+    return width, y + shelf, frames
+
+
+class Sheet:
+    def __init__(self, name, images, fmt, codec, swap, max_width):
+        self.name = name
+        self.fmt = fmt
+        if len(images) == 1:
+            self.width, self.height = images[0].size
+            self.frames = [(0, 0)]
+        else:
+            self.width, self.height, self.frames = pack_shelves(images, max_width)
+
+        canvas = Image.new("RGBA", (self.width, self.height), (0, 0, 0, 0))
+        for img, pos in zip(images, self.frames):
+            canvas.paste(img, pos)
+
+        size = PIXEL_SIZE[fmt]
+        data = canvas.load()
+        raw_rows = []
+        for y in range(self.height):
+            raw_rows.append(b"".join(pixel_bytes(data[x, y], fmt, swap) for x in range(self.width)))
+
+        self.raw_size = self.width * self.height * size
+        rle_rows = [rle_row(r, size) for r in raw_rows]
+        rle_size = sum(len(r) for r in rle_rows)
+
+        if codec is None:
+            codec = CODEC_RLE if rle_size < self.raw_size else CODEC_RAW
+        self.codec = codec
+        rows = rle_rows if codec == CODEC_RLE else raw_rows
+
+        self.offsets = []
+        self.data = bytearray()
+        for r in rows:
+            self.offsets.append(len(self.data))
+            self.data += r
+
+    @property
+    def packed_size(self):
+        return len(self.data) + 4 * len(self.offsets)
+
+
+def c_array(data, per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def write_sources(out, sheets, entries):
+    base = os.path.basename(out)
+    guard = symbol(base).upper() + "_H"
+
+    with open(out + ".h", "w") as h:
+        h.write("// Generated by support/asset_packer.py, do not edit\n")
+        h.write("#ifndef %s\n#define %s\n\n" % (guard, guard))
+        h.write("#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n#include <lvgl.h>\n\n")
+        for name, _, _, _ in entries:
+            h.write("extern const lv_img_dsc_t %s;\n" % name)
+        h.write("\n#ifdef __cplusplus\n} /*extern \"C\"*/\n#endif\n\n#endif /*%s*/\n" % guard)
+
+    with open(out + ".c", "w") as c:
+        c.write("// Generated by support/asset_packer.py, do not edit\n")
+        c.write("#include \"%s.h\"\n#include \"asset.h\"\n\n" % base)
+        for s in sheets:
+            c.write("static const uint8_t %s_data[] = {\n%s\n};\n\n" % (s.name, c_array(s.data)))
+            c.write("static const uint32_t %s_rows[] = {\n" % s.name)
+            for i in range(0, len(s.offsets), 8):
+                c.write("    " + ", ".join(str(o) for o in s.offsets[i:i + 8]) + ",\n")
+            c.write("};\n\n")
+            c.write("static const asset_sheet_t %s = {%d, %d, %s, %s, %s_rows, %s_data, sizeof(%s_data)};\n\n" % (
+                s.name, s.width, s.height, FORMAT_NAME[s.fmt], CODEC_NAME[s.codec], s.name, s.name, s.name))
+
+        for name, sheet, (x, y), (w, h) in entries:
+            c.write("static const asset_t %s_asset = {&%s, %d, %d, %d, %d};\n" % (name, sheet.name, x, y, w, h))
+            c.write("const lv_img_dsc_t %s = {\n" % name)
+            c.write("    .header.cf = LV_IMG_CF_USER_ENCODED_0,\n")
+            c.write("    .header.always_zero = 0,\n")
+            c.write("    .header.reserved = 0,\n")
+            c.write("    .header.w = %d,\n    .header.h = %d,\n" % (w, h))
+            c.write("    .data_size = sizeof(asset_t),\n")
+            c.write("    .data = (const uint8_t *)&%s_asset,\n};\n\n" % name)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack images into compressed asset sheets")
+    parser.add_argument("images", nargs="+", help="PNG images, the file name is used as symbol")
+    parser.add_argument("-o", "--output", required=True, help="output path without extension (.c/.h are written)")
+    parser.add_argument("--prefix", default="", help="symbol prefix")
+    parser.add_argument("--atlas", action="store_true", help="pack images with the same format into one sheet")
+    parser.add_argument("--atlas-width", type=int, default=256, help="maximum atlas width")
+    parser.add_argument("--codec", choices=["auto", "rle", "raw"], default="auto")
+    parser.add_argument("--no-swap", action="store_true", help="do not swap RGB565 bytes (LV_COLOR_16_SWAP 0)")
+    args = parser.parse_args()
+
+    codec = {"auto": None, "rle": CODEC_RLE, "raw": CODEC_RAW}[args.codec]
+    prefix = symbol(args.prefix or os.path.basename(args.output))
+
+    images = []
+    for path in args.images:
+        img = Image.open(path)
+        fmt = FORMAT_RGB565A8 if has_alpha(img) else FORMAT_RGB565
+        name = symbol(args.prefix + os.path.splitext(os.path.basename(path))[0])
+        images.append((name, img.convert("RGBA"), fmt))
+
+    groups = {}
+    if args.atlas:
+        for item in images:
+            groups.setdefault(item[2], []).append(item)
+    else:
+        for item in images:
+            groups[item[0]] = [item]
+
+    sheets = []
+    entries = []
+    for key, items in groups.items():
+        fmt = items[0][2]
+        sheet_name = "%s_sheet%d" % (prefix, len(sheets)) if args.atlas else items[0][0] + "_sheet"
+        sheet = Sheet(sheet_name, [i[1] for i in items], fmt, codec, not args.no_swap, args.atlas_width)
+        sheets.append(sheet)
+        for (name, img, _), pos in zip(items, sheet.frames):
+            entries.append((name, sheet, pos, img.size))
+
+    write_sources(args.output, sheets, entries)
+
+    raw = sum(img.size[0] * img.size[1] * PIXEL_SIZE[fmt] for _, img, fmt in images)
+    packed = sum(s.packed_size for s in sheets)
+    for s in sheets:
+        print("%-32s %4dx%-4d %-8s %7d -> %7d bytes (%.1f%%)" % (
+            s.name, s.width, s.height, "rle" if s.codec == CODEC_RLE else "raw",
+            s.raw_size, s.packed_size, 100.0 * s.packed_size / max(s.raw_size, 1)))
+    print("total %d -> %d bytes (%.1f%%)" % (raw, packed, 100.0 * packed / max(raw, 1)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""
+Compare two native benchmark runs (test/test_bench, Google Benchmark JSON).
+
+    BENCH_JSON=v3.6.json pio test -e native -f test_bench
+    python support/bench_compare.py v3.5.json v3.6.json --threshold 10
+
+Prints the change of every benchmark and exits with 1 when one of them got
+slower by more than the threshold (percent of real time).
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return {b["name"]: b for b in data["benchmarks"] if b.get("run_type", "iteration") == "iteration"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="JSON of the previous release")
+    parser.add_argument("current", help="JSON of the new build")
+    parser.add_argument("--threshold", type=float, default=10.0, help="allowed slowdown in percent (default 10)")
+    args = parser.parse_args()
+
+    base = load(args.baseline)
+    cur = load(args.current)
+
+    regressions = 0
+    print("%-36s %14s %14s %9s" % ("Benchmark", "Baseline (ns)", "Current (ns)", "Change"))
+    for name in sorted(set(base) | set(cur)):
+        if name not in base or name not in cur:
+            print("%-36s %s" % (name, "only in " + ("current" if name in cur else "baseline")))
+            continue
+        before = base[name]["real_time"]
+        after = cur[name]["real_time"]
+        change = (after - before) * 100.0 / before if before else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        print("%-36s %14.1f %14.1f %+8.1f%%%s" % (name, before, after, change, mark))
+
+    if regressions:
+        print("%d benchmark(s) slower than %.0f%%" % (regressions, args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
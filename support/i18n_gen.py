@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Generate the UI string tables used by lib/i18n.
+
+The strings are kept in a CSV file, one row per string and one column per
+language (ISO 639-1 code in the header). The `_name` row holds the name of
+each language in the language itself. Empty cells fall back to English.
+
+For every language the generator writes a constant table of STR_COUNT
+pointers and the sorted list of code points its strings use, which the
+firmware checks against the fonts at startup (i18n_missing_glyphs).
+
+    python support/i18n_gen.py support/i18n/strings.csv -o lib/i18n/i18n_strings
+"""
+
+import argparse
+import csv
+import os
+import re
+import sys
+
+
+def symbol(name):
+    return re.sub(r"[^0-9a-zA-Z_]", "_", name).upper()
+
+
+def c_string(text):
+    return '"%s"' % text.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n")
+
+
+def load(path):
+    with open(path, newline="", encoding="utf-8") as f:
+        rows = list(csv.reader(f))
+    header = rows[0]
+    if header[0] != "key" or len(header) < 2 or header[1] != "en":
+        sys.exit("%s: the header must be key,en,..." % path)
+    langs = header[1:]
+    names = None
+    keys, table = [], {lang: [] for lang in langs}
+    for line, row in enumerate(rows[1:], 2):
+        if not row or not row[0]:
+            continue
+        row += [""] * (len(header) - len(row))
+        if row[0] == "_name":
+            names = row[1:]
+            continue
+        if row[0] in keys:
+            sys.exit("%s:%d: duplicate key %s" % (path, line, row[0]))
+        if not row[1]:
+            sys.exit("%s:%d: %s has no English text" % (path, line, row[0]))
+        keys.append(row[0])
+        for lang, text in zip(langs, row[1:]):
+            if not text:
+                print("warning: %s has no %s text, using English" % (row[0], lang))
+                text = row[1]
+            table[lang].append(text)
+    if names is None:
+        sys.exit("%s: missing _name row" % path)
+    return langs, names, keys, table
+
+
+def glyphs(strings):
+    return sorted(set(ord(c) for text in strings for c in text))
+
+
+def write_sources(out, source, langs, names, keys, table):
+    base = os.path.basename(out)
+    guard = symbol(base) + "_H"
+    note = "// Generated by support/i18n_gen.py from %s, do not edit\n" % source
+    with open(out + ".h", "w", encoding="utf-8") as h:
+        h.write(note)
+        h.write("#ifndef %s\n#define %s\n\n" % (guard, guard))
+        h.write("enum I18nLanguage {\n")
+        for lang, name in zip(langs, names):
+            h.write("  LANG_%s, // %s\n" % (symbol(lang), name))
+        h.write("  LANG_COUNT\n};\n\n")
+        h.write("enum I18nString {\n")
+        for key, text in zip(keys, table["en"]):
+            h.write("  STR_%s, // %s\n" % (symbol(key), text))
+        h.write("  STR_COUNT\n};\n\n")
+        h.write("/**\n * Options of the language dropdown, in I18nLanguage order\n */\n")
+        h.write("#define I18N_LANGUAGE_OPTIONS %s\n\n" % c_string("\n".join(names)))
+        h.write("#endif /*%s*/\n" % guard)
+
+    with open(out + ".cpp", "w", encoding="utf-8") as c:
+        c.write(note)
+        c.write("#include \"i18n.h\"\n\n")
+        for lang in langs:
+            c.write("static const char *const strings_%s[STR_COUNT] = {\n" % lang)
+            for text in table[lang]:
+                c.write("    %s,\n" % c_string(text))
+            c.write("};\n\n")
+            cps = glyphs(table[lang])
+            c.write("static const uint32_t glyphs_%s[] = {\n" % lang)
+            for i in range(0, len(cps), 8):
+                c.write("    " + ", ".join("0x%04x" % cp for cp in cps[i:i + 8]) + ",\n")
+            c.write("};\n\n")
+        c.write("const I18nLanguageDesc i18n_languages[LANG_COUNT] = {\n")
+        for lang, name in zip(langs, names):
+            c.write("    {\"%s\", %s, strings_%s, glyphs_%s,\n     sizeof(glyphs_%s) / sizeof(glyphs_%s[0])},\n" % (
+                lang, c_string(name), lang, lang, lang, lang))
+        c.write("};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the UI string tables")
+    parser.add_argument("csv", help="strings, one column per language")
+    parser.add_argument("-o", "--output", default="lib/i18n/i18n_strings",
+                        help="output path without extension (.cpp/.h are written)")
+    args = parser.parse_args()
+
+    langs, names, keys, table = load(args.csv)
+    write_sources(args.output, args.csv.replace(os.sep, "/"), langs, names, keys, table)
+    for lang, name in zip(langs, names):
+        size = sum(len(t.encode("utf-8")) + 1 for t in table[lang])
+        cps = glyphs(table[lang])
+        print("%-4s %-20s %3d strings %5d bytes %4d glyphs (%d non-ASCII)" % (
+            lang, name, len(table[lang]), size, len(cps), len([cp for cp in cps if cp > 0x7f])))
+
+
+if __name__ == "__main__":
+    main()
@@ -1,11 +1,41 @@
 Import("env", "projenv")
 
+import shutil
+import subprocess
+import sys
+
+IS_WINDOWS = sys.platform.startswith("win")
+
+
+def has_define(e, name):
+    for d in e.get("CPPDEFINES", []):
+        if (d[0] if isinstance(d, (tuple, list)) else d) == name:
+            return True
+    return False
+
+
+# Without SDL_INCLUDE_PATH in the env (the Linux/macOS envs), take the SDL
+# flags from pkg-config
+use_pkg_config = not has_define(projenv, "SDL_INCLUDE_PATH")
+if use_pkg_config:
+    if shutil.which("pkg-config") is None or subprocess.call(
+            ["pkg-config", "--exists", "sdl2"]) != 0:
+        sys.stderr.write("Error: SDL2 not found by pkg-config, install libsdl2-dev (apt) or sdl2 (brew)\n")
+        env.Exit(1)
+
 for e in [ env, projenv ]:
     # If compiler uses `-m32`, propagate it to linker.
     # Add via script, because `-Wl,-m32` does not work.
     if "-m32" in e['CCFLAGS']:
         e.Append(LINKFLAGS = ["-m32"])
-    e.Append(LINKFLAGS = ["-mwindows"])
+    # Sanitizers need the runtime at link time too
+    e.Append(LINKFLAGS = [f for f in e['CCFLAGS'] if str(f).startswith("-fsanitize")])
+    if use_pkg_config:
+        e.ParseConfig("pkg-config --cflags --libs sdl2")
+        e.Append(CPPDEFINES = [("SDL_INCLUDE_PATH", e.StringifyMacro("SDL.h"))])
+    if IS_WINDOWS:
+        # no console window
+        e.Append(LINKFLAGS = ["-mwindows"])
 
 exec_name = "${BUILD_DIR}/${PROGNAME}${PROGSUFFIX}"
 
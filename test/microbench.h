@@ -0,0 +1,174 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <chrono>
+#include <ctime>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Minimal Google Benchmark style runner for the native test suites.
+ *
+ *   static void BM_fill(BenchState &state) {
+ *     while (state.keepRunning()) { ... }
+ *     state.setBytesProcessed(state.iterations() * bytes);
+ *   }
+ *   bench_register("BM_fill", BM_fill);
+ *   bench_run_all("bench_native.json");
+ *
+ * Each benchmark is rerun with more iterations until it takes at least
+ * BENCH_MIN_TIME_MS. The JSON file uses the Google Benchmark layout, so
+ * `support/bench_compare.py` (or Google's compare.py) can diff two runs.
+ */
+
+#ifndef BENCH_MIN_TIME_MS
+#define BENCH_MIN_TIME_MS 200
+#endif
+
+#define BENCH_MAX 32
+
+/**
+ * Keep the compiler from dropping a result
+ */
+template <class T> inline void bench_keep(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class BenchState {
+public:
+  explicit BenchState(uint64_t max) : max(max), count(0), bytes(0) {}
+
+  bool keepRunning() { return count++ < max; }
+  uint64_t iterations() const { return max; }
+  void setBytesProcessed(uint64_t b) { bytes = b; }
+  uint64_t bytesProcessed() const { return bytes; }
+
+private:
+  uint64_t max;
+  uint64_t count;
+  uint64_t bytes;
+};
+
+typedef void (*bench_fn_t)(BenchState &state);
+
+struct BenchResult {
+  const char *name;
+  bench_fn_t fn;
+  uint64_t iterations;
+  double real_ns; // per iteration
+  double cpu_ns;
+  double bytes_per_second;
+};
+
+static BenchResult bench_list[BENCH_MAX];
+static int bench_count;
+
+inline void bench_register(const char *name, bench_fn_t fn) {
+  if (bench_count < BENCH_MAX) {
+    bench_list[bench_count].name = name;
+    bench_list[bench_count].fn = fn;
+    bench_count++;
+  }
+}
+
+inline void bench_measure(BenchResult &r) {
+  using namespace std::chrono;
+  uint64_t n = 1;
+  while (true) {
+    BenchState state(n);
+    clock_t cpu_start = clock();
+    steady_clock::time_point start = steady_clock::now();
+    r.fn(state);
+    double real =
+        duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    double cpu = (double)(clock() - cpu_start) * 1e9 / CLOCKS_PER_SEC;
+
+    if (real >= BENCH_MIN_TIME_MS * 1e6 || n >= (1ULL << 40)) {
+      r.iterations = n;
+      r.real_ns = real / n;
+      r.cpu_ns = cpu / n;
+      r.bytes_per_second =
+          state.bytesProcessed() ? state.bytesProcessed() * 1e9 / real : 0;
+      return;
+    }
+    // aim a little past the minimum time, like Google Benchmark
+    double scale = real > 0 ? BENCH_MIN_TIME_MS * 1.4e6 / real : 10;
+    if (scale > 10) {
+      scale = 10;
+    }
+    uint64_t next = (uint64_t)(n * scale);
+    n = next > n ? next : n + 1;
+  }
+}
+
+inline bool bench_write_json(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (f == NULL) {
+    return false;
+  }
+  char host[64] = "";
+  gethostname(host, sizeof(host) - 1);
+  time_t now = time(NULL);
+  char date[32];
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+  fprintf(f, "{\n  \"context\": {\n");
+  fprintf(f, "    \"date\": \"%s\",\n", date);
+  fprintf(f, "    \"host_name\": \"%s\",\n", host);
+  fprintf(f, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+  fprintf(f, "    \"library_build_type\": \"%s\"\n",
+#ifdef NDEBUG
+          "release"
+#else
+          "debug"
+#endif
+  );
+  fprintf(f, "  },\n  \"benchmarks\": [\n");
+  for (int i = 0; i < bench_count; i++) {
+    const BenchResult &r = bench_list[i];
+    fprintf(f,
+            "    {\n      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n"
+            "      \"run_type\": \"iteration\",\n"
+            "      \"iterations\": %llu,\n      \"real_time\": %.3f,\n"
+            "      \"cpu_time\": %.3f,\n      \"time_unit\": \"ns\"",
+            r.name, r.name, (unsigned long long)r.iterations, r.real_ns,
+            r.cpu_ns);
+    if (r.bytes_per_second > 0) {
+      fprintf(f, ",\n      \"bytes_per_second\": %.1f", r.bytes_per_second);
+    }
+    fprintf(f, "\n    }%s\n", i + 1 < bench_count ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  return fclose(f) == 0;
+}
+
+/**
+ * Run every registered benchmark, print a table and write the JSON file
+ * @param path output file, overridden by the BENCH_JSON environment variable
+ * @return number of benchmarks run
+ */
+inline int bench_run_all(const char *path) {
+  const char *env = getenv("BENCH_JSON");
+  if (env && *env) {
+    path = env;
+  }
+  printf("%-36s %14s %14s %12s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)",
+         "Iterations", "MB/s");
+  for (int i = 0; i < bench_count; i++) {
+    BenchResult &r = bench_list[i];
+    bench_measure(r);
+    printf("%-36s %14.1f %14.1f %12llu %12.1f\n", r.name, r.real_ns, r.cpu_ns,
+           (unsigned long long)r.iterations, r.bytes_per_second / 1e6);
+  }
+  if (!bench_write_json(path)) {
+    printf("could not write %s\n", path);
+  } else {
+    printf("results written to %s\n", path);
+  }
+  return bench_count;
+}
+
+#endif /*MICROBENCH_H*/
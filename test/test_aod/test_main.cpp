@@ -0,0 +1,195 @@
+#include <string.h>
+#include <unity.h>
+
+#include "always_on.h"
+
+#define W 240
+#define H 240
+
+static uint16_t screen[W * H];
+
+static uint32_t at(uint32_t hour, uint32_t minute, uint32_t second = 0) {
+  return hour * 3600 + minute * 60 + second;
+}
+
+/* Write an update to the simulated panel in AOD_BUF_LINES bands */
+static void flush(AlwaysOnFace &face, const AodRect &r) {
+  static uint16_t band[W * AOD_BUF_LINES];
+  for (int16_t y = 0; y < r.h; y += AOD_BUF_LINES) {
+    int16_t lines = r.h - y < AOD_BUF_LINES ? r.h - y : AOD_BUF_LINES;
+    face.render(y, lines, band);
+    for (int16_t j = 0; j < lines; j++) {
+      memcpy(&screen[(r.y + y + j) * W + r.x], &band[j * r.w],
+             r.w * sizeof(uint16_t));
+    }
+  }
+}
+
+static AodConfig config() {
+  AodConfig c;
+  c.color = 0xFFFF;
+  c.background = 0x0000;
+  return c;
+}
+
+void setUp(void) { memset(screen, 0, sizeof(screen)); }
+void tearDown(void) {}
+
+void test_sleep_until_next_minute(void) {
+  TEST_ASSERT_EQUAL(60000, AlwaysOnFace::sleepMs(at(10, 8, 0), 0));
+  TEST_ASSERT_EQUAL(23500, AlwaysOnFace::sleepMs(at(10, 8, 36), 500));
+  TEST_ASSERT_EQUAL(1, AlwaysOnFace::sleepMs(at(10, 8, 59), 999));
+}
+
+void test_first_update_draws_text(void) {
+  AlwaysOnFace face(config());
+  face.enter();
+  TEST_ASSERT_TRUE(face.active());
+  AodRect r = face.update(at(10, 8));
+  AodRect text = face.textArea();
+  TEST_ASSERT_EQUAL(text.x, r.x);
+  TEST_ASSERT_EQUAL(text.y, r.y);
+  TEST_ASSERT_EQUAL(text.w, r.w);
+  TEST_ASSERT_EQUAL(text.h, r.h);
+  TEST_ASSERT_LESS_THAN(W, r.w);
+  TEST_ASSERT_EQUAL(1, face.stats().updates);
+}
+
+void test_same_minute_skipped(void) {
+  AlwaysOnFace face(config());
+  face.enter();
+  face.update(at(10, 8, 5));
+  AodRect r = face.update(at(10, 8, 40));
+  TEST_ASSERT_EQUAL(0, r.w);
+  TEST_ASSERT_EQUAL(1, face.stats().skipped);
+}
+
+void test_only_changed_digits(void) {
+  AodConfig c = config();
+  AlwaysOnFace face(c);
+  face.enter();
+  AodRect text = face.update(at(10, 8));
+  AodRect r = face.update(at(10, 9));
+  // the last digit only
+  TEST_ASSERT_EQUAL(c.digit_w, r.w);
+  TEST_ASSERT_EQUAL(text.x + text.w - c.digit_w, r.x);
+  TEST_ASSERT_EQUAL(c.digit_h, r.h);
+  r = face.update(at(10, 10));
+  // both minute digits
+  TEST_ASSERT_EQUAL(2 * c.digit_w + c.gap, r.w);
+}
+
+void test_hour_change_moves_face(void) {
+  AodConfig c = config();
+  AlwaysOnFace face(c);
+  face.enter();
+  AodRect before = face.update(at(10, 59));
+  AodRect r = face.update(at(11, 0));
+  AodRect after = face.textArea();
+  TEST_ASSERT_TRUE(after.x != before.x || after.y != before.y);
+  // covers the old and the new position
+  TEST_ASSERT_LESS_OR_EQUAL(before.x, r.x);
+  TEST_ASSERT_LESS_OR_EQUAL(after.x, r.x);
+  TEST_ASSERT_GREATER_OR_EQUAL(before.x + before.w, r.x + r.w);
+  TEST_ASSERT_GREATER_OR_EQUAL(after.x + after.w, r.x + r.w);
+  TEST_ASSERT_LESS_OR_EQUAL(c.shift * 2 + before.w, r.w);
+}
+
+void test_render_segments(void) {
+  AodConfig c = config();
+  AlwaysOnFace face(c);
+  face.enter();
+  flush(face, face.update(at(18, 8)));
+  AodRect text = face.textArea();
+  // the last digit is an 8: middle segment lit, inside of the loops dark
+  int16_t x = text.x + text.w - c.digit_w;
+  int16_t mid = text.y + (c.digit_h - c.thickness) / 2 + c.thickness / 2;
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, screen[mid * W + x + c.digit_w / 2]);
+  TEST_ASSERT_EQUAL_HEX16(0, screen[(text.y + c.digit_h / 4) * W + x +
+                                    c.digit_w / 2]);
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, screen[(text.y + c.digit_h / 4) * W + x]);
+}
+
+void test_partial_matches_full_redraw(void) {
+  static uint16_t partial[W * H];
+  AodConfig c = config();
+  AlwaysOnFace face(c);
+  face.enter();
+  flush(face, face.update(at(10, 58)));
+  flush(face, face.update(at(10, 59)));
+  memcpy(partial, screen, sizeof(screen));
+
+  memset(screen, 0, sizeof(screen));
+  AlwaysOnFace fresh(c);
+  fresh.enter();
+  flush(fresh, fresh.update(at(10, 59)));
+  TEST_ASSERT_EQUAL_MEMORY(screen, partial, sizeof(screen));
+}
+
+void test_moved_face_leaves_no_trace(void) {
+  static uint16_t moved[W * H];
+  AodConfig c = config();
+  AlwaysOnFace face(c);
+  face.enter();
+  flush(face, face.update(at(10, 59)));
+  flush(face, face.update(at(11, 0)));
+  memcpy(moved, screen, sizeof(screen));
+
+  memset(screen, 0, sizeof(screen));
+  AlwaysOnFace fresh(c);
+  fresh.enter();
+  flush(fresh, fresh.update(at(11, 0)));
+  TEST_ASSERT_EQUAL_MEMORY(screen, moved, sizeof(screen));
+}
+
+void test_simulated_day(void) {
+  AlwaysOnFace face(config());
+  face.enter();
+  uint64_t clock_ms = at(0, 0, 17) * 1000ULL + 250;
+  uint32_t wakeups = 0;
+  while (clock_ms < 24 * 3600 * 1000ULL) {
+    uint32_t seconds = clock_ms / 1000;
+    AodRect r = face.update(seconds);
+    if (r.w) {
+      flush(face, r);
+    }
+    clock_ms += AlwaysOnFace::sleepMs(seconds, clock_ms % 1000);
+    wakeups++;
+  }
+  TEST_ASSERT_EQUAL(1440, wakeups);
+  TEST_ASSERT_EQUAL(1440, face.stats().updates);
+  // on average well under a fifth of the text box per minute
+  AodRect text = face.textArea();
+  TEST_ASSERT_LESS_THAN((uint64_t)1440 * text.w * text.h / 3,
+                        face.stats().pixels);
+}
+
+void test_12_hour_blank_digit(void) {
+  AodConfig c = config();
+  c.h24 = false;
+  AlwaysOnFace face(c);
+  face.enter();
+  flush(face, face.update(at(13, 5)));
+  AodRect text = face.textArea();
+  // "1:05" with the first digit blank
+  for (int16_t y = text.y; y < text.y + text.h; y++) {
+    for (int16_t x = text.x; x < text.x + c.digit_w; x++) {
+      TEST_ASSERT_EQUAL_HEX16(0, screen[y * W + x]);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sleep_until_next_minute);
+  RUN_TEST(test_first_update_draws_text);
+  RUN_TEST(test_same_minute_skipped);
+  RUN_TEST(test_only_changed_digits);
+  RUN_TEST(test_hour_change_moves_face);
+  RUN_TEST(test_render_segments);
+  RUN_TEST(test_partial_matches_full_redraw);
+  RUN_TEST(test_moved_face_leaves_no_trace);
+  RUN_TEST(test_simulated_day);
+  RUN_TEST(test_12_hour_blank_digit);
+  return UNITY_END();
+}
@@ -0,0 +1,276 @@
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unity.h>
+
+#include "../microbench.h"
+#include "asset.h"
+#include "blit.h"
+#include "chronos_payloads.h"
+#include "face_install.h"
+#include "notification_store.h"
+#include "time_format.h"
+#include "weather_model.h"
+
+/* Microbenchmarks of the pure C++ parts, results go to bench_native.json
+ * (or $BENCH_JSON). Compare two runs with support/bench_compare.py */
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void BM_clock_format_time(BenchState &state) {
+  struct tm tm;
+  memset(&tm, 0, sizeof(tm));
+  char out[16];
+  uint32_t minute = 0;
+  while (state.keepRunning()) {
+    tm.tm_hour = (minute / 60) % 24;
+    tm.tm_min = minute % 60;
+    ClockTime t = clock_time(tm);
+    bench_keep(clock_format_time(out, sizeof(out), t, minute & 1));
+    minute++;
+  }
+}
+
+static void BM_notification_add(BenchState &state) {
+  static NotificationStore store;
+  static const char *message =
+      "Hey there! Just reminding you about our meeting at 10:00 AM. Please "
+      "make sure to prepare the presentation slides and gather all necessary "
+      "documents beforehand. Looking forward to a productive discussion!";
+  uint32_t len = strlen(message);
+  while (state.keepRunning()) {
+    bench_keep(store.add(0x08, "Skype", "09:30", message).id);
+  }
+  state.setBytesProcessed(state.iterations() * len);
+}
+
+static void BM_weather_update(BenchState &state) {
+  static WeatherModel model;
+  WeatherDay week[WEATHER_DAYS];
+  for (uint8_t i = 0; i < WEATHER_DAYS; i++) {
+    WeatherDay d = {i, i, 20, 25, 15};
+    week[i] = d;
+  }
+  uint32_t n = 0;
+  while (state.keepRunning()) {
+    week[n % WEATHER_DAYS].temp = 20 + n % 5; // about one day in five changes
+    model.update(week, WEATHER_DAYS);
+    bench_keep(model.takeChanges());
+    n++;
+  }
+}
+
+/* Storage that only keeps the data in RAM, measures the installer itself */
+class RamStorage : public InstallStorage {
+public:
+  RamStorage() : size(0), journal_ok(false) {}
+  bool openTemp(const char *name, uint32_t offset) {
+    size = offset;
+    return true;
+  }
+  uint32_t tempSize(const char *name) { return size; }
+  bool append(const uint8_t *data, uint32_t len) {
+    if (size + len > sizeof(buffer)) {
+      return false;
+    }
+    memcpy(buffer + size, data, len);
+    size += len;
+    return true;
+  }
+  bool sync() { return true; }
+  void closeTemp() {}
+  bool readTemp(const char *name, uint32_t offset, uint8_t *data,
+                uint32_t len) {
+    memcpy(data, buffer + offset, len);
+    return true;
+  }
+  bool commit(const char *name) { return true; }
+  void discard(const char *name) { size = 0; }
+  bool loadJournal(InstallJournal &j) {
+    j = journal;
+    return journal_ok;
+  }
+  bool saveJournal(const InstallJournal &j) {
+    journal = j;
+    journal_ok = true;
+    return true;
+  }
+  void clearJournal() { journal_ok = false; }
+
+  uint8_t buffer[64 * 1024];
+  uint32_t size;
+  InstallJournal journal;
+  bool journal_ok;
+};
+
+static void BM_install_reassembly(BenchState &state) {
+  static RamStorage storage;
+  static uint8_t file[32 * 1024];
+  static uint32_t crcs[sizeof(file) / 244 + 1];
+  const uint32_t chunk = 244; // BLE payload of the Chronos transfer
+  for (uint32_t i = 0; i < sizeof(file); i++) {
+    file[i] = i * 7;
+  }
+  for (uint32_t off = 0, i = 0; off < sizeof(file); off += chunk, i++) {
+    uint32_t len = off + chunk > sizeof(file) ? sizeof(file) - off : chunk;
+    crcs[i] = install_crc32(0, file + off, len);
+  }
+  while (state.keepRunning()) {
+    FaceInstaller installer(storage);
+    storage.clearJournal();
+    installer.begin("face.bin", sizeof(file), 0);
+    for (uint32_t off = 0, i = 0; off < sizeof(file); off += chunk, i++) {
+      uint32_t len = off + chunk > sizeof(file) ? sizeof(file) - off : chunk;
+      installer.write(off, file + off, len, crcs[i]);
+    }
+  }
+  state.setBytesProcessed(state.iterations() * sizeof(file));
+}
+
+static uint16_t framebuffer[240 * 240];
+
+static void BM_blit_fill(BenchState &state) {
+  Framebuffer fb = {framebuffer, 240, 240};
+  while (state.keepRunning()) {
+    blit_fill(fb, 0, 0, 240, 240, 0x1234);
+    bench_keep(framebuffer[0]);
+  }
+  state.setBytesProcessed(state.iterations() * sizeof(framebuffer));
+}
+
+static void BM_blit_sprite(BenchState &state) {
+  Framebuffer fb = {framebuffer, 240, 240};
+  static uint16_t sprite[32 * 48];
+  for (int i = 0; i < 32 * 48; i++) {
+    sprite[i] = (i % 5) ? (uint16_t)i : 0xF81F;
+  }
+  uint32_t n = 0;
+  while (state.keepRunning()) {
+    // sweeps across the screen, including clipped positions
+    int16_t x = (int16_t)(n * 7 % 260) - 10;
+    blit_sprite(fb, x, 100, sprite, 32, 48, 0xF81F);
+    n++;
+  }
+  state.setBytesProcessed(state.iterations() * sizeof(sprite));
+}
+
+static void BM_asset_rle_decode_line(BenchState &state) {
+  static uint16_t image[240];
+  static uint8_t packed[240 * 3];
+  for (int x = 0; x < 240; x++) {
+    image[x] = x < 120 ? 0 : (uint16_t)(x / 8); // flat half, short runs
+  }
+  uint32_t rows[1] = {0};
+  uint32_t size = asset_rle_encode_row((const uint8_t *)image, 240, 2, packed);
+  asset_sheet_t sheet = {240,  1,      ASSET_FORMAT_RGB565, ASSET_CODEC_RLE,
+                         rows, packed, (uint32_t)size};
+  asset_t frame = {&sheet, 0, 0, 240, 1};
+  uint16_t line[240];
+  while (state.keepRunning()) {
+    asset_decode_line(&frame, 0, 0, 240, (uint8_t *)line);
+    bench_keep(line[239]);
+  }
+  state.setBytesProcessed(state.iterations() * sizeof(line));
+}
+
+/* Weather sync with `days` entries, more members per day than are used */
+static std::string forecast_json(int days) {
+  std::string json =
+      "{\"city\":\"Nairobi\",\"hour\":14,\"minute\":5,\"days\":[";
+  char item[224];
+  for (int i = 0; i < days; i++) {
+    snprintf(item, sizeof(item),
+             "%s{\"icon\":%d,\"day\":%d,\"temp\":%d,\"high\":%d,\"low\":%d,"
+             "\"humidity\":%d,\"wind\":{\"speed\":12.5,\"dir\":\"NE\"},"
+             "\"summary\":\"Partly cloudy with a chance of rain later\"}",
+             i ? "," : "", i % 8, i % 7, 20 + i % 5, 25 + i % 3, 12 + i % 4,
+             40 + i % 50);
+    json += item;
+  }
+  return json + "]}";
+}
+
+static std::string week_json = forecast_json(WEATHER_DAYS);
+static std::string month_json = forecast_json(240); // hourly, 10 days
+static JsonIngest weekIngest, monthIngest, noteIngest;
+static BoundedAllocator documentAllocator(1 << 26);
+
+static void BM_ingest_weather(BenchState &state, JsonIngest &ingest,
+                              const std::string &json) {
+  WeatherPayload w;
+  while (state.keepRunning()) {
+    IngestBuffer src(json.data(), json.size());
+    bench_keep(ingest_weather(ingest, src, w));
+  }
+  state.setBytesProcessed(state.iterations() * json.size());
+}
+
+static void BM_ingest_weather_week(BenchState &state) {
+  BM_ingest_weather(state, weekIngest, week_json);
+}
+
+static void BM_ingest_weather_hourly(BenchState &state) {
+  BM_ingest_weather(state, monthIngest, month_json);
+}
+
+/* The same payload as one document, what a plain deserializeJson costs */
+static void BM_json_document_hourly(BenchState &state) {
+  WeatherPayload w;
+  while (state.keepRunning()) {
+    JsonDocument doc(&documentAllocator);
+    deserializeJson(doc, month_json.data(), month_json.size());
+    JsonVariantConst days = doc["days"];
+    for (w.count = 0; w.count < WEATHER_DAYS && w.count < days.size();
+         w.count++) {
+      w.days[w.count].temp = days[w.count]["temp"] | 0;
+    }
+    bench_keep(w.count);
+  }
+  state.setBytesProcessed(state.iterations() * month_json.size());
+}
+
+static void BM_ingest_notification(BenchState &state) {
+  static const char *json =
+      "{\"id\":42,\"icon\":8,\"app\":\"Skype\",\"time\":\"09:30\","
+      "\"message\":\"Hey there! Just reminding you about our meeting at "
+      "10:00 AM. Please make sure to prepare the presentation slides and "
+      "gather all necessary documents beforehand.\"}";
+  size_t len = strlen(json);
+  NotificationRecord n;
+  while (state.keepRunning()) {
+    IngestBuffer src(json, len);
+    bench_keep(ingest_notification(noteIngest, src, n));
+  }
+  state.setBytesProcessed(state.iterations() * len);
+}
+
+void test_benchmarks(void) {
+  bench_register("BM_clock_format_time", BM_clock_format_time);
+  bench_register("BM_notification_add", BM_notification_add);
+  bench_register("BM_weather_update", BM_weather_update);
+  bench_register("BM_install_reassembly/244", BM_install_reassembly);
+  bench_register("BM_blit_fill/240x240", BM_blit_fill);
+  bench_register("BM_blit_sprite/32x48", BM_blit_sprite);
+  bench_register("BM_asset_rle_decode_line/240", BM_asset_rle_decode_line);
+  bench_register("BM_ingest_weather/7", BM_ingest_weather_week);
+  bench_register("BM_ingest_weather/240", BM_ingest_weather_hourly);
+  bench_register("BM_json_document/240", BM_json_document_hourly);
+  bench_register("BM_ingest_notification", BM_ingest_notification);
+  TEST_ASSERT_EQUAL(11, bench_run_all("bench_native.json"));
+  for (int i = 0; i < bench_count; i++) {
+    TEST_ASSERT_TRUE(bench_list[i].real_ns > 0);
+  }
+
+  printf("peak JSON memory: weather/7 %u B, weather/240 %u B, "
+         "document/240 %u B, notification %u B\n",
+         (unsigned)weekIngest.stats().peak, (unsigned)monthIngest.stats().peak,
+         (unsigned)documentAllocator.peak(), (unsigned)noteIngest.stats().peak);
+  TEST_ASSERT_TRUE(monthIngest.stats().peak <= weekIngest.stats().peak);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_benchmarks);
+  return UNITY_END();
+}
@@ -0,0 +1,144 @@
+#include <unity.h>
+
+#include "board_traits.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+typedef BoardTraits<BOARD_ESP32> Esp32;
+typedef BoardTraits<BOARD_ESPC3> EspC3;
+typedef BoardTraits<BOARD_ESPS3_1_28> EspS3_128;
+typedef BoardTraits<BOARD_ESPS3_1_69> EspS3_169;
+
+// the values the boards shipped with in include/main.h
+static_assert(EspC3::width == 240 && EspC3::height == 240, "ESPC3 panel");
+static_assert(EspC3::dc == 2 && EspC3::cs == 10 && EspC3::bl == 3,
+              "ESPC3 pins");
+static_assert(EspS3_128::miso == 12 && EspS3_128::rst == 14,
+              "ESPS3_1_28 pins");
+static_assert(EspS3_128::max_file_open == 50, "ESPS3_1_28 files");
+static_assert(EspS3_169::height == 280 && EspS3_169::offset_y == 20,
+              "ESPS3_1_69 panel");
+static_assert(EspS3_169::rgb_order && !EspS3_169::round, "ESPS3_1_69 order");
+static_assert(Esp32::spi_host == BOARD_SPI3_HOST && Esp32::sclk == 18,
+              "ESP32 bus");
+static_assert(board_draw_buf_pixels<EspS3_169>() == 2400, "buffer size");
+
+/**
+ * Visible according to the pixel centre, the reference for the inset
+ */
+template <class B> static bool inside(int16_t x, int16_t y) {
+  int32_t dx = 2 * x + 1 - B::width;
+  int32_t dy = 2 * y + 1 - B::height;
+  return dx * dx + dy * dy <= (int32_t)B::width * B::width;
+}
+
+template <class B> static void check_inset() {
+  for (int16_t y = 0; y < B::height; y++) {
+    int16_t inset = board_round_inset<B>(y);
+    TEST_ASSERT_EQUAL(inset, board_round_inset<B>(B::height - 1 - y));
+    if (!B::round) {
+      TEST_ASSERT_EQUAL(0, inset);
+      continue;
+    }
+    TEST_ASSERT_TRUE(inside<B>(inset, y));
+    if (inset > 0) {
+      TEST_ASSERT_FALSE(inside<B>(inset - 1, y));
+    }
+  }
+  TEST_ASSERT_EQUAL(B::round ? B::width : 0, board_round_inset<B>(-1));
+}
+
+template <class B> static void check_rows(int16_t x1, int16_t y1, int16_t x2,
+                                          int16_t y2) {
+  int16_t first = -1, last = -1;
+  for (int16_t y = y1; y <= y2; y++) {
+    for (int16_t x = x1; x <= x2; x++) {
+      if (!B::round || inside<B>(x, y)) {
+        if (first < 0) {
+          first = y;
+        }
+        last = y;
+        break;
+      }
+    }
+  }
+  int16_t a = y1, b = y2;
+  bool visible = board_visible_rows<B>(x1, x2, a, b);
+  TEST_ASSERT_EQUAL(first >= 0, visible);
+  if (visible) {
+    TEST_ASSERT_EQUAL(first, a);
+    TEST_ASSERT_EQUAL(last, b);
+  }
+}
+
+template <class B> static void check_flush_areas() {
+  // the corners, full width bands and a few stripes of 10 lines
+  check_rows<B>(0, 0, 29, 29);
+  check_rows<B>(B::width - 30, B::height - 30, B::width - 1, B::height - 1);
+  check_rows<B>(0, 0, 9, 9);
+  for (int16_t y = 0; y < B::height; y += 10) {
+    check_rows<B>(0, y, B::width - 1, y + 9);
+    check_rows<B>(0, y, 39, y + 9);
+    check_rows<B>(B::width / 2 - 5, y, B::width / 2 + 4, y + 9);
+  }
+}
+
+template <class B> static void check_touch() {
+  int16_t x, y;
+  board_touch_point<B>(10, 20, x, y);
+  TEST_ASSERT_EQUAL(10, x);
+  TEST_ASSERT_EQUAL(20, y);
+  board_touch_point<B>(B::width, B::height, x, y);
+  TEST_ASSERT_EQUAL(B::width - 1, x);
+  TEST_ASSERT_EQUAL(B::height - 1, y);
+}
+
+void test_round_inset(void) {
+  check_inset<Esp32>();
+  check_inset<EspC3>();
+  check_inset<EspS3_128>();
+  check_inset<EspS3_169>();
+  // 240 round panel: the top row shows the middle 22 pixels
+  TEST_ASSERT_EQUAL(109, board_round_inset<EspC3>(0));
+  TEST_ASSERT_EQUAL(0, board_round_inset<EspC3>(120));
+}
+
+void test_visible_rows(void) {
+  check_flush_areas<Esp32>();
+  check_flush_areas<EspC3>();
+  check_flush_areas<EspS3_128>();
+  check_flush_areas<EspS3_169>();
+
+  // a corner stripe of a round panel is dropped entirely
+  int16_t y1 = 0, y2 = 9;
+  TEST_ASSERT_FALSE(board_visible_rows<EspC3>(0, 39, y1, y2));
+  y1 = 0, y2 = 9;
+  TEST_ASSERT_TRUE(board_visible_rows<EspS3_169>(0, 39, y1, y2));
+  TEST_ASSERT_EQUAL(0, y1);
+  TEST_ASSERT_EQUAL(9, y2);
+}
+
+void test_touch_point(void) {
+  check_touch<Esp32>();
+  check_touch<EspC3>();
+  check_touch<EspS3_128>();
+  check_touch<EspS3_169>();
+}
+
+void test_isqrt(void) {
+  for (uint32_t v = 0; v < 70000; v++) {
+    uint32_t r = board_isqrt(v);
+    TEST_ASSERT_TRUE(r * r <= v && (r + 1) * (r + 1) > v);
+  }
+  TEST_ASSERT_EQUAL_UINT32(65535, board_isqrt(0xFFFFFFFFUL));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_inset);
+  RUN_TEST(test_visible_rows);
+  RUN_TEST(test_touch_point);
+  RUN_TEST(test_isqrt);
+  return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include "face_catalog.h"
+
+static char root[64];
+static int parses;
+
+/* A face is a file starting with "face", the rest is its display name */
+static bool parse_face(const char *path, CatalogEntry &entry) {
+  parses++;
+  char buf[CATALOG_NAME_MAX + 4] = {0};
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    return false;
+  }
+  size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+  fclose(f);
+  if (n < 4 || memcmp(buf, "face", 4) != 0) {
+    return false;
+  }
+  strncpy(entry.name, buf + 4, CATALOG_NAME_MAX - 1);
+  entry.elements = n;
+  return true;
+}
+
+static void write_face(const char *file, const char *text) {
+  char p[96];
+  snprintf(p, sizeof(p), "%s/%s", root, file);
+  FILE *f = fopen(p, "wb");
+  fputs(text, f);
+  fclose(f);
+}
+
+static void remove_file(const char *file) {
+  char p[96];
+  snprintf(p, sizeof(p), "%s/%s", root, file);
+  remove(p);
+}
+
+static void remove_all() {
+  const char *names[] = {"a.wf", "b.wf", "c.wf", "bad.wf", "notes.txt",
+                         "faces.cat"};
+  for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    remove_file(names[i]);
+  }
+}
+
+void setUp(void) {
+  remove_all();
+  parses = 0;
+}
+
+void tearDown(void) { remove_all(); }
+
+void test_build_and_reload(void) {
+  write_face("a.wf", "faceAlpha");
+  write_face("b.wf", "faceBeta");
+  write_face("bad.wf", "nope");
+  write_face("notes.txt", "faceNotes");
+
+  FaceCatalog catalog(root, ".wf", parse_face);
+  TEST_ASSERT_FALSE(catalog.load());
+  CatalogSync sync = catalog.sync();
+  TEST_ASSERT_EQUAL(2, sync.parsed);
+  TEST_ASSERT_EQUAL(1, sync.failed);
+  TEST_ASSERT_TRUE(sync.saved);
+  TEST_ASSERT_EQUAL(2, catalog.count());
+  int b = catalog.find("b.wf");
+  TEST_ASSERT_TRUE(b >= 0);
+  TEST_ASSERT_EQUAL_STRING("Beta", catalog.entry(b).name);
+  TEST_ASSERT_EQUAL(8, catalog.entry(b).size);
+
+  // unchanged files are not opened again
+  FaceCatalog reloaded(root, ".wf", parse_face);
+  TEST_ASSERT_TRUE(reloaded.load());
+  TEST_ASSERT_EQUAL(2, reloaded.count());
+  parses = 0;
+  sync = reloaded.sync();
+  TEST_ASSERT_EQUAL(2, sync.kept);
+  TEST_ASSERT_EQUAL(1, parses); // the invalid file has no entry to keep
+  TEST_ASSERT_FALSE(sync.saved);
+}
+
+void test_rescan_changes(void) {
+  write_face("a.wf", "faceAlpha");
+  write_face("b.wf", "faceBeta");
+  FaceCatalog catalog(root, ".wf", parse_face);
+  catalog.sync();
+
+  write_face("b.wf", "faceBeta two"); // other size
+  write_face("c.wf", "faceGamma");
+  remove_file("a.wf");
+  parses = 0;
+  CatalogSync sync = catalog.sync();
+  TEST_ASSERT_EQUAL(0, sync.kept);
+  TEST_ASSERT_EQUAL(2, sync.parsed);
+  TEST_ASSERT_EQUAL(1, sync.removed);
+  TEST_ASSERT_EQUAL(2, parses);
+  TEST_ASSERT_TRUE(sync.saved);
+  TEST_ASSERT_EQUAL(2, catalog.count());
+  TEST_ASSERT_EQUAL(-1, catalog.find("a.wf"));
+  TEST_ASSERT_EQUAL_STRING("Beta two",
+                           catalog.entry(catalog.find("b.wf")).name);
+
+  FaceCatalog reloaded(root, ".wf", parse_face);
+  TEST_ASSERT_TRUE(reloaded.load());
+  TEST_ASSERT_EQUAL(2, reloaded.count());
+  TEST_ASSERT_TRUE(reloaded.find("c.wf") >= 0);
+}
+
+void test_add_and_remove(void) {
+  write_face("a.wf", "faceAlpha");
+  FaceCatalog catalog(root, ".wf", parse_face);
+  catalog.sync();
+
+  write_face("b.wf", "faceBeta");
+  TEST_ASSERT_TRUE(catalog.add("b.wf"));
+  TEST_ASSERT_EQUAL(2, catalog.count());
+  write_face("b.wf", "faceBeta two");
+  TEST_ASSERT_TRUE(catalog.add("b.wf")); // replaced, not added twice
+  TEST_ASSERT_EQUAL(2, catalog.count());
+  write_face("bad.wf", "nope");
+  TEST_ASSERT_FALSE(catalog.add("bad.wf"));
+  TEST_ASSERT_FALSE(catalog.add("notes.txt"));
+
+  TEST_ASSERT_TRUE(catalog.remove("a.wf"));
+  TEST_ASSERT_FALSE(catalog.remove("a.wf"));
+  TEST_ASSERT_EQUAL(1, catalog.count());
+
+  // stored as it goes, a reload sees the same entries
+  FaceCatalog reloaded(root, ".wf", parse_face);
+  TEST_ASSERT_TRUE(reloaded.load());
+  TEST_ASSERT_EQUAL(1, reloaded.count());
+  TEST_ASSERT_EQUAL_STRING("Beta two", reloaded.entry(0).name);
+}
+
+void test_damaged_catalog_rebuilds(void) {
+  write_face("a.wf", "faceAlpha");
+  FaceCatalog catalog(root, ".wf", parse_face);
+  catalog.sync();
+
+  char p[96];
+  snprintf(p, sizeof(p), "%s/faces.cat", root);
+  FILE *f = fopen(p, "r+b");
+  fseek(f, 20, SEEK_SET);
+  fputc('#', f);
+  fclose(f);
+
+  FaceCatalog reloaded(root, ".wf", parse_face);
+  TEST_ASSERT_FALSE(reloaded.load());
+  CatalogSync sync = reloaded.sync();
+  TEST_ASSERT_EQUAL(1, sync.parsed);
+  TEST_ASSERT_TRUE(sync.saved);
+  TEST_ASSERT_TRUE(reloaded.load());
+}
+
+int main(int argc, char **argv) {
+  strcpy(root, "/tmp/face_catalogXXXXXX");
+  if (mkdtemp(root) == NULL) {
+    return 1;
+  }
+  UNITY_BEGIN();
+  RUN_TEST(test_build_and_reload);
+  RUN_TEST(test_rescan_changes);
+  RUN_TEST(test_add_and_remove);
+  RUN_TEST(test_damaged_catalog_rebuilds);
+  int failures = UNITY_END();
+  rmdir(root);
+  return failures;
+}
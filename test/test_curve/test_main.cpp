@@ -0,0 +1,103 @@
+#include <math.h>
+#include <unity.h>
+
+#include "curve_table.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_matches_circle(void) {
+  CurveTable t;
+  t.build(120, false);
+  for (int d = 0; d <= 120; d++) {
+    double x = 120 - sqrt(120.0 * 120 - d * d);
+    TEST_ASSERT_INT_WITHIN(1, (int)lround(x), t.offset(d));
+    TEST_ASSERT_EQUAL(t.offset(d), t.offset(-d));
+  }
+  TEST_ASSERT_EQUAL(0, t.offset(0));
+  TEST_ASSERT_EQUAL(120, t.offset(120));
+  TEST_ASSERT_EQUAL(120, t.offset(500)); // past the radius
+}
+
+void test_monotonic(void) {
+  CurveTable t;
+  t.build(140, true);
+  for (int d = 1; d <= 140; d++) {
+    TEST_ASSERT_TRUE(t.offset(d) >= t.offset(d - 1));
+    TEST_ASSERT_TRUE(t.opacity(d) <= t.opacity(d - 1));
+  }
+}
+
+void test_fade(void) {
+  CurveTable t;
+  t.build(120, true);
+  TEST_ASSERT_EQUAL(255, t.opacity(0));
+  TEST_ASSERT_EQUAL(0, t.opacity(120));
+  TEST_ASSERT_EQUAL(0, t.opacity(-300));
+  t.build(120, false);
+  TEST_ASSERT_EQUAL(255, t.opacity(119));
+}
+
+void test_radius_clamped(void) {
+  CurveTable t;
+  t.build(CURVE_RADIUS_MAX + 50, false);
+  TEST_ASSERT_EQUAL(CURVE_RADIUS_MAX, t.radius());
+  TEST_ASSERT_EQUAL(CURVE_RADIUS_MAX, t.offset(CURVE_RADIUS_MAX));
+}
+
+void test_empty_table(void) {
+  CurveTable t;
+  TEST_ASSERT_EQUAL(0, t.offset(10));
+  t.build(0, true);
+  TEST_ASSERT_EQUAL(0, t.offset(0));
+  TEST_ASSERT_EQUAL(255, t.opacity(0));
+}
+
+/* 20 items of 50 px with a 10 px gap */
+static int16_t tops[20], bottoms[20];
+
+static void column(void) {
+  for (int i = 0; i < 20; i++) {
+    tops[i] = i * 60;
+    bottoms[i] = i * 60 + 49;
+  }
+}
+
+void test_visible_range(void) {
+  column();
+  uint16_t first, last;
+  TEST_ASSERT_TRUE(curve_visible_range(tops, bottoms, 20, 0, 239, &first, &last));
+  TEST_ASSERT_EQUAL(0, first);
+  TEST_ASSERT_EQUAL(3, last); // 180 - 229
+  // scrolled into the gap after item 4 and partly over item 8
+  TEST_ASSERT_TRUE(curve_visible_range(tops, bottoms, 20, 290, 489, &first, &last));
+  TEST_ASSERT_EQUAL(5, first);
+  TEST_ASSERT_EQUAL(8, last);
+  TEST_ASSERT_TRUE(curve_visible_range(tops, bottoms, 20, 1100, 1339, &first, &last));
+  TEST_ASSERT_EQUAL(18, first);
+  TEST_ASSERT_EQUAL(19, last);
+}
+
+void test_visible_range_edges(void) {
+  column();
+  uint16_t first, last;
+  TEST_ASSERT_FALSE(curve_visible_range(tops, bottoms, 20, 1300, 1500, &first, &last));
+  TEST_ASSERT_FALSE(curve_visible_range(tops, bottoms, 20, -300, -1, &first, &last));
+  TEST_ASSERT_FALSE(curve_visible_range(tops, bottoms, 20, 50, 59, &first, &last)); // in a gap
+  TEST_ASSERT_FALSE(curve_visible_range(tops, bottoms, 0, 0, 239, &first, &last));
+  TEST_ASSERT_TRUE(curve_visible_range(tops, bottoms, 20, 49, 60, &first, &last));
+  TEST_ASSERT_EQUAL(0, first);
+  TEST_ASSERT_EQUAL(1, last);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_circle);
+  RUN_TEST(test_monotonic);
+  RUN_TEST(test_fade);
+  RUN_TEST(test_radius_clamped);
+  RUN_TEST(test_empty_table);
+  RUN_TEST(test_visible_range);
+  RUN_TEST(test_visible_range_edges);
+  return UNITY_END();
+}
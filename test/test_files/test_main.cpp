@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include "dir_pager.h"
+
+#define FACE_FILES 300
+
+static char root[64];
+
+static void write_file(const char *dir, const char *name, uint32_t size) {
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  FILE *f = fopen(path, "wb");
+  for (uint32_t i = 0; i < size; i++) {
+    fputc('x', f);
+  }
+  fclose(f);
+}
+
+static void path_of(char *out, size_t len, const char *sub) {
+  snprintf(out, len, "%s/%s", root, sub);
+}
+
+/* root: 3 directories and 4 files, extracted/ holds FACE_FILES faces */
+static void make_tree(void) {
+  snprintf(root, sizeof(root), "/tmp/dir_pager_XXXXXX");
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  char p[160];
+  const char *dirs[] = {"watchface", "extracted", "Bluetooth"};
+  for (int i = 0; i < 3; i++) {
+    path_of(p, sizeof(p), dirs[i]);
+    mkdir(p, 0755);
+  }
+  write_file(root, "kenya.bin", 1530);
+  write_file(root, "Kenya.wf", 453);
+  write_file(root, "list.txt", 2453);
+  write_file(root, "preview.png", 10);
+  path_of(p, sizeof(p), "extracted");
+  for (int i = 0; i < FACE_FILES; i++) {
+    char name[32];
+    snprintf(name, sizeof(name), "face_%03d.bin", (i * 7919) % FACE_FILES);
+    write_file(p, name, i % 50);
+  }
+}
+
+static void remove_tree(void) {
+  char cmd[96];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s", root);
+  TEST_ASSERT_EQUAL(0, system(cmd));
+}
+
+void setUp(void) {
+  dir_meta_clear();
+  make_tree();
+}
+
+void tearDown(void) { remove_tree(); }
+
+static void assert_sorted(const DirPager &pager) {
+  for (uint16_t i = 1; i < pager.count(); i++) {
+    DirEntry a = pager.entry(i - 1), b = pager.entry(i);
+    bool ad = a.type == DIR_TYPE_DIR, bd = b.type == DIR_TYPE_DIR;
+    TEST_ASSERT_TRUE(ad >= bd); // directories first
+    if (ad == bd) {
+      TEST_ASSERT_TRUE(strcasecmp(a.name, b.name) <= 0);
+    }
+  }
+}
+
+void test_root_listing(void) {
+  DirPager pager;
+  TEST_ASSERT_TRUE(pager.open(root));
+  while (pager.step(DIR_PAGE)) {
+  }
+  TEST_ASSERT_TRUE(pager.done());
+  TEST_ASSERT_EQUAL(7, pager.count());
+  const char *expect[] = {"Bluetooth", "extracted", "watchface", "kenya.bin",
+                          "Kenya.wf",  "list.txt",  "preview.png"};
+  for (int i = 0; i < 7; i++) {
+    TEST_ASSERT_EQUAL_STRING(expect[i], pager.entry(i).name);
+  }
+  TEST_ASSERT_EQUAL(DIR_TYPE_DIR, pager.entry(0).type);
+  TEST_ASSERT_EQUAL(DIR_TYPE_FACE, pager.entry(3).type);
+  TEST_ASSERT_EQUAL(DIR_TYPE_FACE, pager.entry(4).type);
+  TEST_ASSERT_EQUAL(DIR_TYPE_TEXT, pager.entry(5).type);
+  TEST_ASSERT_EQUAL(DIR_TYPE_IMAGE, pager.entry(6).type);
+  TEST_ASSERT_EQUAL(1530, pager.entry(3).size);
+  TEST_ASSERT_EQUAL(453, pager.entry(4).size);
+}
+
+void test_first_page_before_sizes(void) {
+  char p[160];
+  path_of(p, sizeof(p), "extracted");
+  DirPager pager;
+  TEST_ASSERT_TRUE(pager.open(p));
+  TEST_ASSERT_TRUE(pager.step(DIR_PAGE));
+  // one page of names, no stat yet
+  TEST_ASSERT_EQUAL(DIR_PAGE, pager.count());
+  TEST_ASSERT_FALSE(pager.listed());
+  TEST_ASSERT_EQUAL(0, pager.stats().stats);
+  TEST_ASSERT_FALSE(pager.entry(0).sized);
+  assert_sorted(pager);
+
+  // sorted after every page while the names come in
+  uint32_t rev = pager.revision();
+  while (!pager.listed()) {
+    pager.step(DIR_PAGE);
+    assert_sorted(pager);
+  }
+  TEST_ASSERT_TRUE(pager.revision() > rev);
+  TEST_ASSERT_EQUAL(FACE_FILES, pager.count());
+  TEST_ASSERT_EQUAL(0, pager.stats().stats);
+  for (int i = 0; i < FACE_FILES; i++) {
+    char name[32];
+    snprintf(name, sizeof(name), "face_%03d.bin", i);
+    TEST_ASSERT_EQUAL_STRING(name, pager.entry(i).name);
+  }
+}
+
+void test_sizes_from_focus(void) {
+  char p[160];
+  path_of(p, sizeof(p), "extracted");
+  DirPager pager;
+  pager.open(p);
+  while (!pager.listed()) {
+    pager.step(DIR_PAGE);
+  }
+  pager.focus(200);
+  pager.step(4);
+  TEST_ASSERT_EQUAL(4, pager.stats().stats);
+  TEST_ASSERT_FALSE(pager.entry(199).sized);
+  for (int i = 200; i < 204; i++) {
+    TEST_ASSERT_TRUE(pager.entry(i).sized);
+  }
+  TEST_ASSERT_FALSE(pager.entry(204).sized);
+  while (pager.step(DIR_PAGE)) {
+  }
+  TEST_ASSERT_EQUAL(FACE_FILES, pager.stats().stats);
+  // face_<n> was written with ((n * 7919^-1) mod 300) % 50 bytes, check
+  // against the file itself
+  for (int i = 0; i < FACE_FILES; i += 37) {
+    char full[192];
+    snprintf(full, sizeof(full), "%s/%s", p, pager.entry(i).name);
+    struct stat st;
+    stat(full, &st);
+    TEST_ASSERT_EQUAL((uint32_t)st.st_size, pager.entry(i).size);
+  }
+}
+
+void test_meta_cache(void) {
+  char p[160];
+  path_of(p, sizeof(p), "extracted");
+  DirPager pager;
+  pager.open(p);
+  while (pager.step(DIR_PAGE)) {
+  }
+  TEST_ASSERT_EQUAL(FACE_FILES, pager.stats().stats);
+
+  // opened again: every size is known as soon as its name is read
+  pager.open(p);
+  pager.step(DIR_PAGE);
+  TEST_ASSERT_TRUE(pager.entry(0).sized);
+  while (pager.step(DIR_PAGE)) {
+  }
+  TEST_ASSERT_EQUAL(0, pager.stats().stats);
+  TEST_ASSERT_EQUAL(FACE_FILES, pager.stats().hits);
+
+  // a rewritten file is read again once forgotten
+  write_file(p, "face_007.bin", 4000);
+  char full[192];
+  snprintf(full, sizeof(full), "%s/face_007.bin", p);
+  dir_meta_forget(full);
+  pager.open(p);
+  while (pager.step(DIR_PAGE)) {
+  }
+  TEST_ASSERT_EQUAL(1, pager.stats().stats);
+  TEST_ASSERT_EQUAL(4000, pager.entry(7).size);
+}
+
+void test_trailing_slash_and_missing(void) {
+  char p[160];
+  snprintf(p, sizeof(p), "%s/", root);
+  DirPager pager;
+  TEST_ASSERT_TRUE(pager.open(p));
+  while (pager.step(DIR_PAGE)) {
+  }
+  TEST_ASSERT_EQUAL(7, pager.count());
+  TEST_ASSERT_EQUAL_STRING(root, pager.path());
+
+  path_of(p, sizeof(p), "nothing");
+  TEST_ASSERT_FALSE(pager.open(p));
+  TEST_ASSERT_FALSE(pager.step(DIR_PAGE));
+  TEST_ASSERT_EQUAL(0, pager.count());
+}
+
+void test_long_names_skipped(void) {
+  char name[DIR_NAME_MAX + 8];
+  memset(name, 'a', sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+  write_file(root, name, 1);
+  DirPager pager;
+  pager.open(root);
+  while (pager.step(DIR_PAGE)) {
+  }
+  TEST_ASSERT_EQUAL(7, pager.count());
+  TEST_ASSERT_EQUAL(1, pager.stats().skipped);
+}
+
+void test_format_size(void) {
+  char out[16];
+  DirEntry e = {"a", 0, DIR_TYPE_FACE, false};
+  dir_format_size(e, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("...", out);
+  e.sized = true;
+  e.size = 453;
+  dir_format_size(e, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("453 B", out);
+  e.size = 152453;
+  dir_format_size(e, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("149 KB", out);
+  e.size = 3 * 1024 * 1024 + 600 * 1024;
+  dir_format_size(e, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("3.5 MB", out);
+  e.type = DIR_TYPE_DIR;
+  dir_format_size(e, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("", out);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_root_listing);
+  RUN_TEST(test_first_page_before_sizes);
+  RUN_TEST(test_sizes_from_focus);
+  RUN_TEST(test_meta_cache);
+  RUN_TEST(test_trailing_slash_and_missing);
+  RUN_TEST(test_long_names_skipped);
+  RUN_TEST(test_format_size);
+  return UNITY_END();
+}
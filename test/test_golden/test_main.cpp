@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include "golden_image.h"
+
+#define W 24
+#define H 16
+
+static uint16_t expected[W * H];
+static uint16_t actual[W * H];
+static char path[64];
+
+static const GoldenTolerance exact = {0, 0};
+
+void setUp(void) {
+  for (int i = 0; i < W * H; i++) {
+    expected[i] = (uint16_t)(i * 977);
+  }
+  memcpy(actual, expected, sizeof(actual));
+  snprintf(path, sizeof(path), "/tmp/golden_%d.g565", (int)getpid());
+}
+
+void tearDown(void) { remove(path); }
+
+void test_identical(void) {
+  GoldenResult r = golden_compare(actual, expected, W, H, exact, false);
+  TEST_ASSERT_TRUE(r.match);
+  TEST_ASSERT_EQUAL(0, r.differing);
+  TEST_ASSERT_EQUAL(0, r.max_delta);
+}
+
+void test_one_pixel_differs(void) {
+  actual[5 * W + 7] ^= 0xF800; // red channel
+  GoldenResult r = golden_compare(actual, expected, W, H, exact, false);
+  TEST_ASSERT_FALSE(r.match);
+  TEST_ASSERT_EQUAL(1, r.differing);
+  TEST_ASSERT_EQUAL(7, r.x1);
+  TEST_ASSERT_EQUAL(7, r.x2);
+  TEST_ASSERT_EQUAL(5, r.y1);
+  TEST_ASSERT_EQUAL(5, r.y2);
+}
+
+void test_channel_tolerance(void) {
+  // lowest green bit, about 4 on the 0 - 255 scale
+  actual[0] = expected[0] ^ 0x0020;
+  actual[W * H - 1] = expected[W * H - 1] ^ 0x0020;
+  GoldenTolerance loose = {8, 0};
+  GoldenResult r = golden_compare(actual, expected, W, H, loose, false);
+  TEST_ASSERT_TRUE(r.match);
+  TEST_ASSERT_EQUAL(0, r.differing);
+  TEST_ASSERT_GREATER_THAN(0, r.max_delta);
+  TEST_ASSERT_FALSE(golden_compare(actual, expected, W, H, exact, false).match);
+}
+
+void test_pixel_budget(void) {
+  actual[3] ^= 0xFFFF;
+  actual[W * 4 + 20] ^= 0xFFFF;
+  GoldenTolerance two = {0, 2};
+  GoldenResult r = golden_compare(actual, expected, W, H, two, false);
+  TEST_ASSERT_TRUE(r.match);
+  TEST_ASSERT_EQUAL(2, r.differing);
+  TEST_ASSERT_EQUAL(3, r.x1);
+  TEST_ASSERT_EQUAL(20, r.x2);
+  TEST_ASSERT_EQUAL(0, r.y1);
+  TEST_ASSERT_EQUAL(4, r.y2);
+  actual[W * 9] ^= 0xFFFF;
+  TEST_ASSERT_FALSE(golden_compare(actual, expected, W, H, two, false).match);
+}
+
+void test_swapped_order(void) {
+  // the same 1 bit change reads differently in swapped order
+  actual[0] = expected[0] ^ 0x0001;
+  GoldenTolerance loose = {8, 0};
+  TEST_ASSERT_TRUE(golden_compare(actual, expected, W, H, loose, false).match);
+  TEST_ASSERT_FALSE(golden_compare(actual, expected, W, H, loose, true).match);
+}
+
+void test_save_load(void) {
+  TEST_ASSERT_TRUE(golden_save(path, expected, W, H, true));
+  static uint16_t back[W * H];
+  uint16_t w = 0, h = 0;
+  TEST_ASSERT_TRUE(golden_load(path, back, W * H, &w, &h, true));
+  TEST_ASSERT_EQUAL(W, w);
+  TEST_ASSERT_EQUAL(H, h);
+  TEST_ASSERT_EQUAL_MEMORY(expected, back, sizeof(back));
+  // stored unswapped, loading without the swap gives the byte swapped image
+  golden_load(path, back, W * H, &w, &h, false);
+  TEST_ASSERT_EQUAL_HEX16((uint16_t)((expected[1] >> 8) | (expected[1] << 8)),
+                          back[1]);
+  TEST_ASSERT_FALSE(golden_load(path, back, W * H - 1, &w, &h, true));
+  TEST_ASSERT_FALSE(golden_load("/tmp/missing.g565", back, W * H, &w, &h,
+                                true));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_identical);
+  RUN_TEST(test_one_pixel_differs);
+  RUN_TEST(test_channel_tolerance);
+  RUN_TEST(test_pixel_budget);
+  RUN_TEST(test_swapped_order);
+  RUN_TEST(test_save_load);
+  return UNITY_END();
+}
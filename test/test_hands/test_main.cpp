@@ -0,0 +1,138 @@
+#include <string.h>
+#include <unity.h>
+
+#include "analog_hands.h"
+
+/* A long thin hand: two rotated frames do not fit in HANDS_CACHE_SIZE */
+#define LONG_W 16
+#define LONG_H 130
+/* A shorter one, a few of its frames fit in the cache of the hand */
+#define HAND_W 10
+#define HAND_H 80
+
+static lv_color_t long_px[LONG_W * LONG_H];
+static const lv_img_dsc_t long_img = {
+    {LV_IMG_CF_TRUE_COLOR, 0, 0, LONG_W, LONG_H},
+    sizeof(long_px),
+    (const uint8_t *)long_px};
+
+static lv_color_t hand_px[HAND_W * HAND_H];
+static const lv_img_dsc_t hand_img = {
+    {LV_IMG_CF_TRUE_COLOR, 0, 0, HAND_W, HAND_H},
+    sizeof(hand_px),
+    (const uint8_t *)hand_px};
+
+static lv_disp_draw_buf_t draw_buf;
+static lv_color_t draw_px[240 * 10];
+static lv_disp_drv_t disp_drv;
+static lv_obj_t *scr;
+
+static void flush_cb(lv_disp_drv_t *drv, const lv_area_t *area,
+                     lv_color_t *color_p) {
+  lv_disp_flush_ready(drv);
+}
+
+static HandConfig config(void) {
+  HandConfig cfg;
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.cx = 120;
+  cfg.cy = 120;
+  cfg.img = &hand_img;
+  cfg.pivot_x = HAND_W / 2;
+  cfg.pivot_y = HAND_H - 10;
+  return cfg;
+}
+
+void setUp(void) {
+  scr = lv_obj_create(NULL);
+  hands_stats_reset();
+}
+
+void tearDown(void) { lv_obj_del(scr); }
+
+void test_sin(void) {
+  TEST_ASSERT_EQUAL(0, hand_sin(0));
+  TEST_ASSERT_EQUAL(16384, hand_sin(HAND_STEPS / 4));
+  TEST_ASSERT_EQUAL(-16384, hand_sin(HAND_STEPS * 3 / 4));
+  TEST_ASSERT_EQUAL(hand_sin(10), hand_sin(HAND_STEPS / 2 - 10));
+  TEST_ASSERT_EQUAL(hand_sin(0), hand_cos(HAND_STEPS * 3 / 4));
+}
+
+void test_large_frames_use_transform(void) {
+  HandConfig cfg = config();
+  cfg.img = &long_img;
+  hand_t *hand = hand_create(scr, cfg, HAND_MODE_TABLE);
+  TEST_ASSERT_EQUAL(HAND_MODE_TRANSFORM, hand_mode(hand));
+  TEST_ASSERT_EQUAL(0, hands_stats().cache_used);
+  hand_delete(hand);
+}
+
+void test_cache_per_hand(void) {
+  hand_t *minute = hand_create(scr, config(), HAND_MODE_TABLE);
+  hand_t *second = hand_create(scr, config(), HAND_MODE_TABLE);
+  TEST_ASSERT_EQUAL(HAND_MODE_TABLE, hand_mode(minute));
+  TEST_ASSERT_EQUAL(HAND_MODE_TABLE, hand_mode(second));
+  hand_set_step(minute, 14);
+  hand_set_step(minute, 15);
+
+  // the seconds hand going round does not evict the minute hand
+  for (uint16_t step = 0; step < HAND_STEPS; step += 2) {
+    hand_set_step(second, step);
+  }
+  hand_set_step(minute, 14);
+  TEST_ASSERT_EQUAL(1, hands_stats().cache_hits);
+  TEST_ASSERT_TRUE(hands_stats().cache_used <= 2 * HANDS_CACHE_SIZE);
+
+  hand_delete(minute);
+  hand_delete(second);
+  TEST_ASSERT_EQUAL(0, hands_stats().cache_used);
+}
+
+void test_release_keeps_shown_frame(void) {
+  hand_t *hand = hand_create(scr, config(), HAND_MODE_TABLE);
+  hand_set_step(hand, 1);
+  hand_set_step(hand, 2);
+  hand_set_step(hand, 1); // cached
+  TEST_ASSERT_EQUAL(1, hands_stats().cache_hits);
+
+  hands_cache_release(0);
+  const lv_img_dsc_t *shown =
+      (const lv_img_dsc_t *)lv_img_get_src(hand_obj(hand));
+  TEST_ASSERT_EQUAL(shown->data_size, hands_stats().cache_used);
+  hand_delete(hand);
+}
+
+void test_screen_delete_releases(void) {
+  // a face evicted with its hands, repeatedly
+  for (int round = 0; round < 3; round++) {
+    lv_obj_t *face = lv_obj_create(NULL);
+    for (int i = 0; i < HANDS_MAX; i++) {
+      hand_t *hand = hand_create(face, config(), HAND_MODE_TABLE);
+      TEST_ASSERT_NOT_NULL(hand);
+      hand_set_step(hand, i);
+    }
+    TEST_ASSERT_TRUE(hands_stats().cache_used > 0);
+    lv_obj_del(face);
+    TEST_ASSERT_EQUAL(0, hands_stats().cache_used);
+  }
+}
+
+int main(int argc, char **argv) {
+  lv_init();
+  lv_disp_draw_buf_init(&draw_buf, draw_px, NULL,
+                        sizeof(draw_px) / sizeof(draw_px[0]));
+  lv_disp_drv_init(&disp_drv);
+  disp_drv.hor_res = 240;
+  disp_drv.ver_res = 240;
+  disp_drv.flush_cb = flush_cb;
+  disp_drv.draw_buf = &draw_buf;
+  lv_disp_drv_register(&disp_drv);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_sin);
+  RUN_TEST(test_large_frames_use_transform);
+  RUN_TEST(test_cache_per_hand);
+  RUN_TEST(test_release_keeps_shown_frame);
+  RUN_TEST(test_screen_delete_releases);
+  return UNITY_END();
+}
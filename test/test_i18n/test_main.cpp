@@ -0,0 +1,135 @@
+#include <string.h>
+#include <unity.h>
+
+#include "i18n.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static uint32_t utf8_next(const char **s) {
+  const uint8_t *p = (const uint8_t *)*s;
+  uint32_t cp;
+  int extra;
+  if (p[0] < 0x80) {
+    cp = p[0], extra = 0;
+  } else if (p[0] < 0xE0) {
+    cp = p[0] & 0x1F, extra = 1;
+  } else if (p[0] < 0xF0) {
+    cp = p[0] & 0x0F, extra = 2;
+  } else {
+    cp = p[0] & 0x07, extra = 3;
+  }
+  for (int i = 1; i <= extra; i++) {
+    cp = (cp << 6) | (p[i] & 0x3F);
+  }
+  *s += extra + 1;
+  return cp;
+}
+
+static bool listed(const I18nLanguageDesc &l, uint32_t cp) {
+  for (uint16_t i = 0; i < l.glyph_count; i++) {
+    if (l.glyphs[i] == cp) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void test_tables_complete(void) {
+  for (int lang = 0; lang < LANG_COUNT; lang++) {
+    const I18nLanguageDesc &l = i18n_languages[lang];
+    TEST_ASSERT_EQUAL(2, strlen(l.code));
+    TEST_ASSERT_TRUE(strlen(l.name) > 0);
+    for (int id = 0; id < STR_COUNT; id++) {
+      TEST_ASSERT_NOT_NULL(l.strings[id]);
+      TEST_ASSERT_TRUE(strlen(l.strings[id]) > 0);
+    }
+  }
+}
+
+void test_glyphs_sorted_and_used(void) {
+  for (int lang = 0; lang < LANG_COUNT; lang++) {
+    const I18nLanguageDesc &l = i18n_languages[lang];
+    for (uint16_t i = 1; i < l.glyph_count; i++) {
+      TEST_ASSERT_TRUE(l.glyphs[i] > l.glyphs[i - 1]);
+    }
+    // every code point of every string is listed
+    for (int id = 0; id < STR_COUNT; id++) {
+      const char *s = l.strings[id];
+      while (*s) {
+        TEST_ASSERT_TRUE(listed(l, utf8_next(&s)));
+      }
+    }
+  }
+}
+
+void test_text_and_fallback(void) {
+  TEST_ASSERT_EQUAL_STRING("Settings", i18n_text(LANG_EN, STR_SETTINGS));
+  TEST_ASSERT_EQUAL_STRING("设置", i18n_text(LANG_ZH, STR_SETTINGS));
+  TEST_ASSERT_EQUAL_STRING("Settings", i18n_text((I18nLanguage)99, STR_SETTINGS));
+  TEST_ASSERT_EQUAL_STRING("", i18n_text(LANG_EN, STR_COUNT));
+  TEST_ASSERT_EQUAL(LANG_ZH, i18n_language_from(1));
+  TEST_ASSERT_EQUAL(LANG_EN, i18n_language_from(-1));
+  TEST_ASSERT_EQUAL(LANG_EN, i18n_language_from(LANG_COUNT));
+}
+
+void test_lookup(void) {
+  TEST_ASSERT_EQUAL(STR_BRIGHTNESS, i18n_lookup(LANG_EN, "Brightness"));
+  TEST_ASSERT_EQUAL(STR_BRIGHTNESS, i18n_lookup(LANG_ZH, "亮度"));
+  TEST_ASSERT_EQUAL(-1, i18n_lookup(LANG_ZH, "Brightness"));
+  TEST_ASSERT_EQUAL(-1, i18n_lookup(LANG_EN, "12:34"));
+  TEST_ASSERT_EQUAL(-1, i18n_lookup(LANG_EN, NULL));
+}
+
+void test_dropdown_options(void) {
+  // one line per language, in enum order
+  const char *opts = I18N_LANGUAGE_OPTIONS;
+  for (int lang = 0; lang < LANG_COUNT; lang++) {
+    size_t n = strlen(i18n_languages[lang].name);
+    TEST_ASSERT_EQUAL(0, strncmp(opts, i18n_languages[lang].name, n));
+    opts += n;
+    TEST_ASSERT_TRUE(*opts == (lang + 1 < LANG_COUNT ? '\n' : '\0'));
+    opts += *opts ? 1 : 0;
+  }
+}
+
+/* Like the built in Montserrat fonts: printable ASCII only */
+static bool ascii_font(uint32_t cp, void *ctx) {
+  (*(int *)ctx)++;
+  return cp >= 0x20 && cp < 0x7F;
+}
+
+/* ASCII and a few CJK code points */
+static bool cjk_font(uint32_t cp, void *ctx) {
+  return ascii_font(cp, ctx) || (cp >= 0x4E00 && cp < 0x8000);
+}
+
+void test_missing_glyphs(void) {
+  int calls = 0;
+  uint32_t first = 0;
+  TEST_ASSERT_EQUAL(0, i18n_missing_glyphs(LANG_EN, ascii_font, &calls, &first));
+  TEST_ASSERT_EQUAL(i18n_languages[LANG_EN].glyph_count, calls);
+  TEST_ASSERT_EQUAL(0, i18n_missing_glyphs(LANG_ID, ascii_font, &calls, NULL));
+
+  uint16_t missing = i18n_missing_glyphs(LANG_ZH, ascii_font, &calls, &first);
+  TEST_ASSERT_TRUE(missing > 0);
+  TEST_ASSERT_TRUE(first >= 0x4E00);
+
+  // a font covering only part of the range reports the rest
+  uint16_t partial = i18n_missing_glyphs(LANG_ZH, cjk_font, &calls, &first);
+  TEST_ASSERT_TRUE(partial < missing);
+  if (partial) {
+    TEST_ASSERT_TRUE(first >= 0x8000);
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_tables_complete);
+  RUN_TEST(test_glyphs_sorted_and_used);
+  RUN_TEST(test_text_and_fallback);
+  RUN_TEST(test_lookup);
+  RUN_TEST(test_dropdown_options);
+  RUN_TEST(test_missing_glyphs);
+  return UNITY_END();
+}
@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+
+#include "chronos_payloads.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static bool parseWeather(JsonIngest &ingest, const std::string &json,
+                         WeatherPayload &out) {
+  IngestBuffer src(json.data(), json.size());
+  return ingest_weather(ingest, src, out);
+}
+
+/* A forecast with `days` entries carrying more members than the watch uses */
+static std::string forecast(int days) {
+  std::string json = "{\"city\":\"Nairobi\",\"hour\":14,\"minute\":5,"
+                     "\"source\":{\"name\":\"weather api\",\"id\":[1,2,3]},"
+                     "\"days\":[";
+  char item[256];
+  for (int i = 0; i < days; i++) {
+    snprintf(item, sizeof(item),
+             "%s{\"icon\":%d,\"day\":%d,\"temp\":%d,\"high\":%d,\"low\":%d,"
+             "\"humidity\":%d,\"wind\":{\"speed\":12.5,\"dir\":\"NE\"},"
+             "\"summary\":\"Partly cloudy with a chance of rain later\"}",
+             i ? "," : "", i % 8, i % 7, 20 + i % 5, 25 + i % 3, 12 + i % 4,
+             40 + i % 50);
+    json += item;
+  }
+  json += "],\"units\":\"metric\"}";
+  return json;
+}
+
+void test_weather_payload(void) {
+  JsonIngest ingest;
+  WeatherPayload w;
+  TEST_ASSERT_TRUE(parseWeather(ingest, forecast(5), w));
+  TEST_ASSERT_EQUAL_STRING("Nairobi", w.city);
+  TEST_ASSERT_EQUAL(14, w.hour);
+  TEST_ASSERT_EQUAL(5, w.minute);
+  TEST_ASSERT_EQUAL(5, w.count);
+  TEST_ASSERT_EQUAL(3, w.days[3].icon);
+  TEST_ASSERT_EQUAL(3, w.days[3].day);
+  TEST_ASSERT_EQUAL(23, w.days[3].temp);
+  TEST_ASSERT_EQUAL(25, w.days[3].high);
+  TEST_ASSERT_EQUAL(15, w.days[3].low);
+
+  WeatherModel model;
+  weather_apply(w, model);
+  TEST_ASSERT_EQUAL(5, model.count());
+  TEST_ASSERT_EQUAL_STRING("Nairobi", model.city());
+  TEST_ASSERT_EQUAL(14 * 60 + 5, model.updated());
+}
+
+void test_weather_values(void) {
+  JsonIngest ingest;
+  WeatherPayload w;
+  TEST_ASSERT_TRUE(parseWeather(
+      ingest,
+      " { \"days\" : [ {\"temp\": -3.7, \"low\": -8, \"high\": 1e1} ] ,"
+      "\"hour\": \"late\" } ",
+      w));
+  TEST_ASSERT_EQUAL(1, w.count);
+  TEST_ASSERT_EQUAL(-3, w.days[0].temp);
+  TEST_ASSERT_EQUAL(-8, w.days[0].low);
+  TEST_ASSERT_EQUAL(10, w.days[0].high);
+  TEST_ASSERT_EQUAL(0, w.hour); // wrong type, skipped
+  TEST_ASSERT_EQUAL_STRING("", w.city);
+
+  // the forecast is required
+  TEST_ASSERT_FALSE(parseWeather(ingest, "{\"city\":\"Lagos\"}", w));
+  TEST_ASSERT_FALSE(parseWeather(ingest, "{\"days\":{\"icon\":1}}", w));
+}
+
+void test_long_forecast_flat_memory(void) {
+  JsonIngest ingest;
+  WeatherPayload w;
+  TEST_ASSERT_TRUE(parseWeather(ingest, forecast(7), w));
+  uint32_t week = ingest.stats().last_peak;
+
+  std::string big = forecast(500);
+  TEST_ASSERT_TRUE(big.size() > 64 * 1024);
+  TEST_ASSERT_TRUE(parseWeather(ingest, big, w));
+  TEST_ASSERT_EQUAL(WEATHER_DAYS, w.count);
+  TEST_ASSERT_EQUAL(6, w.days[6].icon);
+  TEST_ASSERT_EQUAL(big.size(), ingest.stats().last_bytes);
+  // one element at a time: the size of the forecast does not matter
+  TEST_ASSERT_TRUE(ingest.stats().last_peak <= week);
+  TEST_ASSERT_TRUE(ingest.stats().peak <= INGEST_HEAP_LIMIT);
+
+  // a document of the whole payload for comparison
+  BoundedAllocator full(1 << 26);
+  {
+    JsonDocument doc(&full);
+    TEST_ASSERT_FALSE(deserializeJson(doc, big.c_str()));
+  }
+  TEST_ASSERT_TRUE(full.peak() > 4 * ingest.stats().last_peak);
+  TEST_ASSERT_EQUAL(0, full.used());
+}
+
+void test_bounded_allocator(void) {
+  JsonIngest tiny(64);
+  WeatherPayload w;
+  TEST_ASSERT_FALSE(parseWeather(tiny, forecast(3), w));
+  TEST_ASSERT_TRUE(tiny.error() == DeserializationError::NoMemory);
+  TEST_ASSERT_EQUAL(1, tiny.stats().failures);
+  TEST_ASSERT_TRUE(tiny.stats().peak <= 64);
+
+  BoundedAllocator a(100);
+  void *p = a.allocate(40);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_NULL(a.allocate(80));
+  TEST_ASSERT_EQUAL(1, a.failures());
+  TEST_ASSERT_NULL(a.reallocate(p, 120));
+  p = a.reallocate(p, 60);
+  TEST_ASSERT_NOT_NULL(p);
+  a.deallocate(p);
+  TEST_ASSERT_EQUAL(0, a.used());
+  TEST_ASSERT_TRUE(a.peak() <= 100);
+}
+
+static bool parseNotification(JsonIngest &ingest, const char *json,
+                              NotificationRecord &out) {
+  IngestBuffer src(json, strlen(json));
+  return ingest_notification(ingest, src, out);
+}
+
+void test_notification_payload(void) {
+  JsonIngest ingest;
+  NotificationRecord n;
+  TEST_ASSERT_TRUE(parseNotification(
+      ingest,
+      "{\"id\":4000000000,\"icon\":3,\"app\":\"Skype\",\"time\":\"14:05\","
+      "\"actions\":[{\"title\":\"Reply\"}],"
+      "\"message\":\"Caf\\u00e9 at 5?\\n\\\"ok\\\" \\ud83d\\ude00 \xc3\xa9\"}",
+      n));
+  TEST_ASSERT_EQUAL_UINT32(4000000000UL, n.id);
+  TEST_ASSERT_EQUAL(3, n.icon);
+  TEST_ASSERT_EQUAL_STRING("Skype", n.app);
+  TEST_ASSERT_EQUAL_STRING("14:05", n.time);
+  TEST_ASSERT_EQUAL_STRING("Caf\xc3\xa9 at 5?\n\"ok\" \xf0\x9f\x98\x80 \xc3\xa9",
+                           n.message);
+
+  TEST_ASSERT_FALSE(parseNotification(ingest, "{\"app\":\"Skype\"}", n));
+}
+
+void test_long_message_cut_on_character(void) {
+  std::string json = "{\"app\":\"A very long application name\",\"message\":\"";
+  for (int i = 0; i < 1000; i++) {
+    json += "\xc3\xa9"; // é
+  }
+  json += "\"}";
+  JsonIngest ingest;
+  NotificationRecord n;
+  IngestBuffer src(json.data(), json.size());
+  TEST_ASSERT_TRUE(ingest_notification(ingest, src, n));
+  TEST_ASSERT_EQUAL(NOTIFICATION_TEXT_MAX - 2, strlen(n.message));
+  TEST_ASSERT_EQUAL_HEX8(0xA9, (uint8_t)n.message[NOTIFICATION_TEXT_MAX - 3]);
+  TEST_ASSERT_EQUAL_STRING("A very long applica", n.app);
+  // strings go straight into the record, no document memory
+  TEST_ASSERT_EQUAL(0, ingest.stats().last_peak);
+}
+
+void test_links_payload(void) {
+  const char *json = "{\"links\":[\"https://chronos.ke/a\",7,"
+                     "\"https://chronos.ke/b\",\"c\",\"d\",\"e\"]}";
+  JsonIngest ingest;
+  LinksPayload links;
+  IngestBuffer src(json, strlen(json));
+  TEST_ASSERT_TRUE(ingest_links(ingest, src, links));
+  TEST_ASSERT_EQUAL(LINKS_MAX, links.count);
+  TEST_ASSERT_EQUAL_STRING("https://chronos.ke/a", links.link[0]);
+  TEST_ASSERT_EQUAL_STRING("https://chronos.ke/b", links.link[1]);
+  TEST_ASSERT_EQUAL_STRING("d", links.link[3]);
+}
+
+void test_settings_payload(void) {
+  const char *json = "{\"brightness\":120,\"language\":\"en\",\"unknown\":5,"
+                     "\"aod\":true,\"timeout\":3}";
+  JsonIngest ingest;
+  SettingsPayload s;
+  IngestBuffer src(json, strlen(json));
+  TEST_ASSERT_TRUE(ingest_settings(ingest, src, s));
+  TEST_ASSERT_EQUAL_HEX32((1 << SETTING_BRIGHTNESS) | (1 << SETTING_AOD) |
+                              (1 << SETTING_TIMEOUT),
+                          s.present);
+  TEST_ASSERT_EQUAL(120, s.values[SETTING_BRIGHTNESS]);
+  TEST_ASSERT_EQUAL(3, s.values[SETTING_TIMEOUT]);
+  TEST_ASSERT_EQUAL(1, s.values[SETTING_AOD]);
+}
+
+static const IngestField noFields[] = {INGEST_ARRAY_FIELD("x", NULL, NULL)};
+
+static DeserializationError parseError(const char *json) {
+  JsonIngest ingest;
+  IngestBuffer src(json, strlen(json));
+  int dummy;
+  ingest.parse(src, noFields, 1, &dummy);
+  return ingest.error();
+}
+
+void test_invalid_input(void) {
+  TEST_ASSERT_TRUE(parseError("") == DeserializationError::EmptyInput);
+  TEST_ASSERT_TRUE(parseError("[1,2]") == DeserializationError::InvalidInput);
+  TEST_ASSERT_TRUE(parseError("{\"a\":1") ==
+                   DeserializationError::IncompleteInput);
+  TEST_ASSERT_TRUE(parseError("{\"a\":{\"b\":") ==
+                   DeserializationError::IncompleteInput);
+  TEST_ASSERT_TRUE(parseError("{\"a\" 1}") ==
+                   DeserializationError::InvalidInput);
+  TEST_ASSERT_TRUE(parseError("{\"a\":1;}") ==
+                   DeserializationError::InvalidInput);
+  TEST_ASSERT_TRUE(parseError("{\"x\":[1,2,]}") ==
+                   DeserializationError::InvalidInput);
+  TEST_ASSERT_TRUE(parseError("{\"x\":[[[[[[[[[[1]]]]]]]]]]}") ==
+                   DeserializationError::TooDeep);
+  TEST_ASSERT_TRUE(parseError("{\"a\":1,\"x\":[{},{}],\"b\":null}") ==
+                   DeserializationError::Ok);
+}
+
+static uint32_t fake_us;
+static uint32_t fakeClock() {
+  fake_us += 500;
+  return fake_us;
+}
+
+void test_stats(void) {
+  JsonIngest ingest(INGEST_HEAP_LIMIT, fakeClock);
+  std::string json = forecast(7);
+  WeatherPayload w;
+  TEST_ASSERT_TRUE(parseWeather(ingest, json, w));
+  TEST_ASSERT_FALSE(parseWeather(ingest, "{", w));
+  const IngestStats &s = ingest.stats();
+  TEST_ASSERT_EQUAL(2, s.payloads);
+  TEST_ASSERT_EQUAL(1, s.failures);
+  TEST_ASSERT_EQUAL(json.size() + 1, s.total_bytes);
+  TEST_ASSERT_EQUAL(500, s.last_us);
+  TEST_ASSERT_EQUAL((json.size() + 1) * 1000, ingest.bytesPerSecond());
+
+  char line[96];
+  ingest.format(line, sizeof(line));
+  TEST_ASSERT_NOT_NULL(strstr(line, "2 payloads, 1 failed"));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_weather_payload);
+  RUN_TEST(test_weather_values);
+  RUN_TEST(test_long_forecast_flat_memory);
+  RUN_TEST(test_bounded_allocator);
+  RUN_TEST(test_notification_payload);
+  RUN_TEST(test_long_message_cut_on_character);
+  RUN_TEST(test_links_payload);
+  RUN_TEST(test_settings_payload);
+  RUN_TEST(test_invalid_input);
+  RUN_TEST(test_stats);
+  return UNITY_END();
+}
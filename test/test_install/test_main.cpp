@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include "face_catalog.h"
+#include "face_install.h"
+
+#define FILE_SIZE 20000
+#define CHUNK 512
+
+static char root[64];
+static uint8_t file[FILE_SIZE];
+static uint32_t file_crc;
+
+static void remove_all() {
+  const char *names[] = {"face.bin", "face.bin.part", "other.bin.part",
+                         "install.jnl", "faces.cat"};
+  char p[96];
+  for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    snprintf(p, sizeof(p), "%s/%s", root, names[i]);
+    remove(p);
+  }
+}
+
+static bool installed_matches() {
+  char p[96];
+  snprintf(p, sizeof(p), "%s/face.bin", root);
+  FILE *f = fopen(p, "rb");
+  if (f == NULL) {
+    return false;
+  }
+  static uint8_t back[FILE_SIZE + 1];
+  size_t n = fread(back, 1, sizeof(back), f);
+  fclose(f);
+  return n == FILE_SIZE && memcmp(back, file, FILE_SIZE) == 0;
+}
+
+static InstallStatus send(FaceInstaller &installer, uint32_t offset,
+                          uint32_t len) {
+  if (offset + len > FILE_SIZE) {
+    len = FILE_SIZE - offset;
+  }
+  return installer.write(offset, file + offset, len,
+                         install_crc32(0, file + offset, len));
+}
+
+void setUp(void) {
+  remove_all();
+  srand(1);
+  for (int i = 0; i < FILE_SIZE; i++) {
+    file[i] = rand();
+  }
+  file_crc = install_crc32(0, file, FILE_SIZE);
+}
+
+void tearDown(void) { remove_all(); }
+
+void test_in_order(void) {
+  FileInstallStorage storage(root);
+  FaceInstaller installer(storage, 4096);
+  TEST_ASSERT_EQUAL(INSTALL_OK, installer.begin("face.bin", FILE_SIZE,
+                                                file_crc));
+  InstallStatus status = INSTALL_OK;
+  for (uint32_t off = 0; off < FILE_SIZE; off += CHUNK) {
+    status = send(installer, off, CHUNK);
+  }
+  TEST_ASSERT_EQUAL(INSTALL_DONE, status);
+  TEST_ASSERT_TRUE(installed_matches());
+  TEST_ASSERT_EQUAL(FILE_SIZE, installer.installed().size);
+  TEST_ASSERT_EQUAL_HEX32(file_crc, installer.installed().crc);
+  TEST_ASSERT_NULL(installer.pending());
+}
+
+void test_duplicates_gaps_and_crc_errors(void) {
+  FileInstallStorage storage(root);
+  FaceInstaller installer(storage, 4096);
+  installer.begin("face.bin", FILE_SIZE, file_crc);
+
+  TEST_ASSERT_EQUAL(INSTALL_OK, send(installer, 0, CHUNK));
+  TEST_ASSERT_EQUAL(INSTALL_DUPLICATE, send(installer, 0, CHUNK));
+  TEST_ASSERT_EQUAL(INSTALL_RESEND, send(installer, 2 * CHUNK, CHUNK));
+  uint8_t bad[CHUNK];
+  memcpy(bad, file + CHUNK, CHUNK);
+  bad[7] ^= 0x10;
+  TEST_ASSERT_EQUAL(INSTALL_RESEND,
+                    installer.write(CHUNK, bad, CHUNK,
+                                    install_crc32(0, file + CHUNK, CHUNK)));
+  TEST_ASSERT_EQUAL(CHUNK, installer.offset());
+
+  // a resend overlapping stored data only appends the new part
+  TEST_ASSERT_EQUAL(INSTALL_OK, send(installer, CHUNK / 2, CHUNK));
+  InstallStatus status = INSTALL_OK;
+  for (uint32_t off = installer.offset(); off < FILE_SIZE; off += CHUNK) {
+    status = send(installer, off, CHUNK);
+  }
+  TEST_ASSERT_EQUAL(INSTALL_DONE, status);
+  TEST_ASSERT_TRUE(installed_matches());
+  TEST_ASSERT_EQUAL(1, installer.stats().duplicates);
+  TEST_ASSERT_EQUAL(2, installer.stats().resends);
+}
+
+void test_resume_after_drop(void) {
+  {
+    FileInstallStorage storage(root);
+    FaceInstaller installer(storage, 4096);
+    installer.begin("face.bin", FILE_SIZE, file_crc);
+    for (uint32_t off = 0; off < 9000; off += CHUNK) {
+      send(installer, off, CHUNK);
+    }
+    installer.suspend();
+  }
+  FileInstallStorage storage(root);
+  FaceInstaller installer(storage, 4096);
+  TEST_ASSERT_NOT_NULL(installer.pending());
+  TEST_ASSERT_EQUAL_STRING("face.bin", installer.pending());
+  TEST_ASSERT_EQUAL(INSTALL_OK, installer.begin("face.bin", FILE_SIZE,
+                                                file_crc));
+  TEST_ASSERT_EQUAL(9216, installer.offset()); // 18 chunks kept
+  InstallStatus status = INSTALL_OK;
+  for (uint32_t off = installer.offset(); off < FILE_SIZE; off += CHUNK) {
+    status = send(installer, off, CHUNK);
+  }
+  TEST_ASSERT_EQUAL(INSTALL_DONE, status);
+  TEST_ASSERT_TRUE(installed_matches());
+  TEST_ASSERT_EQUAL(1, installer.stats().resumes);
+}
+
+void test_other_file_restarts(void) {
+  {
+    FileInstallStorage storage(root);
+    FaceInstaller installer(storage, 4096);
+    installer.begin("other.bin", 100, 0);
+    installer.write(0, file, 50, install_crc32(0, file, 50));
+    installer.suspend();
+  }
+  FileInstallStorage storage(root);
+  FaceInstaller installer(storage, 4096);
+  TEST_ASSERT_EQUAL(INSTALL_OK, installer.begin("face.bin", FILE_SIZE,
+                                                file_crc));
+  TEST_ASSERT_EQUAL(0, installer.offset());
+  TEST_ASSERT_EQUAL(0, storage.tempSize("other.bin"));
+}
+
+void test_whole_file_crc(void) {
+  FileInstallStorage storage(root);
+  FaceInstaller installer(storage, 4096);
+  installer.begin("face.bin", FILE_SIZE, file_crc ^ 1);
+  InstallStatus status = INSTALL_OK;
+  for (uint32_t off = 0; off < FILE_SIZE; off += CHUNK) {
+    status = send(installer, off, CHUNK);
+  }
+  TEST_ASSERT_EQUAL(INSTALL_FILE_CRC, status);
+  TEST_ASSERT_FALSE(installed_matches());
+  TEST_ASSERT_EQUAL(0, storage.tempSize("face.bin"));
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    p[i] = v >> (8 * i);
+  }
+}
+
+static uint32_t reply_offset(const uint8_t *reply) {
+  return reply[2] | reply[3] << 8 | reply[4] << 16 | (uint32_t)reply[5] << 24;
+}
+
+static bool reject_all(InstallStorage &storage, const char *name,
+                       uint32_t size, FaceSummary &summary) {
+  return false;
+}
+
+void test_packets(void) {
+  FileInstallStorage storage(root);
+  FaceInstaller installer(storage, 4096);
+  uint8_t packet[9 + CHUNK], reply[INSTALL_REPLY_SIZE];
+
+  packet[0] = INSTALL_PACKET_BEGIN;
+  put_u32(packet + 1, FILE_SIZE);
+  put_u32(packet + 5, file_crc);
+  memcpy(packet + 9, "face.bin", 8);
+  TEST_ASSERT_TRUE(FaceInstaller::isPacket(packet, 17));
+  TEST_ASSERT_EQUAL(INSTALL_OK, installer.packet(packet, 17, reply));
+  TEST_ASSERT_EQUAL(INSTALL_PACKET_REPLY, reply[0]);
+  TEST_ASSERT_EQUAL(INSTALL_OK, reply[1]);
+
+  InstallStatus status = INSTALL_OK;
+  for (uint32_t off = 0; off < FILE_SIZE; off += CHUNK) {
+    uint32_t len = off + CHUNK > FILE_SIZE ? FILE_SIZE - off : CHUNK;
+    packet[0] = INSTALL_PACKET_CHUNK;
+    put_u32(packet + 1, off);
+    put_u32(packet + 5, install_crc32(0, file + off, len));
+    memcpy(packet + 9, file + off, len);
+    status = installer.packet(packet, 9 + len, reply);
+    TEST_ASSERT_EQUAL(status, reply[1]);
+    TEST_ASSERT_EQUAL(off + len, reply_offset(reply));
+  }
+  TEST_ASSERT_EQUAL(INSTALL_DONE, status);
+  TEST_ASSERT_TRUE(installed_matches());
+
+  // a short chunk asks for a resend, other traffic is not an install packet
+  packet[0] = INSTALL_PACKET_CHUNK;
+  TEST_ASSERT_EQUAL(INSTALL_RESEND, installer.packet(packet, 5, reply));
+  const uint8_t chronos[] = {0xAB, 0x00, 0x04};
+  TEST_ASSERT_FALSE(FaceInstaller::isPacket(chronos, sizeof(chronos)));
+}
+
+void test_validator_rejects(void) {
+  FileInstallStorage storage(root);
+  FaceInstaller installer(storage, 4096);
+  installer.setValidator(reject_all);
+  installer.begin("face.bin", FILE_SIZE, file_crc);
+  InstallStatus status = INSTALL_OK;
+  for (uint32_t off = 0; off < FILE_SIZE; off += CHUNK) {
+    status = send(installer, off, CHUNK);
+  }
+  TEST_ASSERT_EQUAL(INSTALL_INVALID, status);
+  TEST_ASSERT_FALSE(installed_matches());
+  TEST_ASSERT_NULL(installer.pending());
+}
+
+void test_rejects_bad_names(void) {
+  FileInstallStorage storage(root);
+  FaceInstaller installer(storage, 4096);
+  installer.setExtension(".bin");
+  const char *names[] = {"", "../face.bin", "/face.bin", "dir/face.bin",
+                         "face..bin", "face.wf", ".bin"};
+  for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    TEST_ASSERT_EQUAL(INSTALL_INVALID,
+                      installer.begin(names[i], FILE_SIZE, file_crc));
+    TEST_ASSERT_FALSE(installer.active());
+  }
+  TEST_ASSERT_NULL(installer.pending());
+
+  // a bad BEGIN does not stop the transfer in progress
+  TEST_ASSERT_EQUAL(INSTALL_OK,
+                    installer.begin("face.bin", FILE_SIZE, file_crc));
+  TEST_ASSERT_EQUAL(INSTALL_INVALID,
+                    installer.begin("../face.bin", FILE_SIZE, file_crc));
+  InstallStatus status = INSTALL_OK;
+  for (uint32_t off = 0; off < FILE_SIZE; off += CHUNK) {
+    status = send(installer, off, CHUNK);
+  }
+  TEST_ASSERT_EQUAL(INSTALL_DONE, status);
+  TEST_ASSERT_TRUE(installed_matches());
+}
+
+static bool parse_any(const char *path, CatalogEntry &entry) {
+  strcpy(entry.name, "Face");
+  return true;
+}
+
+void test_commit_updates_catalog(void) {
+  FaceCatalog catalog(root, ".bin", parse_any);
+  FileInstallStorage storage(root, &catalog);
+  FaceInstaller installer(storage, 4096);
+  installer.begin("face.bin", FILE_SIZE, file_crc);
+  for (uint32_t off = 0; off < FILE_SIZE; off += CHUNK) {
+    send(installer, off, CHUNK);
+  }
+  TEST_ASSERT_EQUAL(1, catalog.count());
+  TEST_ASSERT_EQUAL(FILE_SIZE, catalog.entry(0).size);
+
+  // stored, the next boot finds nothing to parse
+  FaceCatalog reloaded(root, ".bin", parse_any);
+  TEST_ASSERT_TRUE(reloaded.load());
+  CatalogSync sync = reloaded.sync();
+  TEST_ASSERT_EQUAL(1, sync.kept);
+  TEST_ASSERT_EQUAL(0, sync.parsed);
+  TEST_ASSERT_FALSE(sync.saved);
+}
+
+int main(int argc, char **argv) {
+  strcpy(root, "/tmp/face_installXXXXXX");
+  if (mkdtemp(root) == NULL) {
+    return 1;
+  }
+  UNITY_BEGIN();
+  RUN_TEST(test_in_order);
+  RUN_TEST(test_duplicates_gaps_and_crc_errors);
+  RUN_TEST(test_resume_after_drop);
+  RUN_TEST(test_other_file_restarts);
+  RUN_TEST(test_whole_file_crc);
+  RUN_TEST(test_packets);
+  RUN_TEST(test_validator_rejects);
+  RUN_TEST(test_rejects_bad_names);
+  RUN_TEST(test_commit_updates_catalog);
+  int failures = UNITY_END();
+  rmdir(root);
+  return failures;
+}
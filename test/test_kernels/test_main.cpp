@@ -0,0 +1,131 @@
+#include <string.h>
+#include <unity.h>
+
+#include "asset.h"
+#include "blit.h"
+
+#define FB_W 16
+#define FB_H 12
+
+static uint16_t pixels[FB_W * FB_H];
+static const Framebuffer fb = {pixels, FB_W, FB_H};
+
+void setUp(void) { memset(pixels, 0, sizeof(pixels)); }
+void tearDown(void) {}
+
+static int count(uint16_t color) {
+  int n = 0;
+  for (int i = 0; i < FB_W * FB_H; i++) {
+    n += pixels[i] == color;
+  }
+  return n;
+}
+
+void test_fill_inside(void) {
+  blit_fill(fb, 2, 3, 4, 5, 0xF800);
+  TEST_ASSERT_EQUAL(20, count(0xF800));
+  TEST_ASSERT_EQUAL_HEX16(0xF800, pixels[3 * FB_W + 2]);
+  TEST_ASSERT_EQUAL_HEX16(0xF800, pixels[7 * FB_W + 5]);
+  TEST_ASSERT_EQUAL_HEX16(0, pixels[8 * FB_W + 5]);
+}
+
+void test_fill_clipped(void) {
+  blit_fill(fb, -3, -2, 5, 4, 0x07E0);
+  TEST_ASSERT_EQUAL(4, count(0x07E0));
+  blit_fill(fb, FB_W - 1, FB_H - 1, 10, 10, 0x001F);
+  TEST_ASSERT_EQUAL(1, count(0x001F));
+  blit_fill(fb, FB_W, 0, 4, 4, 0xFFFF);
+  blit_fill(fb, 0, -10, 4, 4, 0xFFFF);
+  TEST_ASSERT_EQUAL(0, count(0xFFFF));
+}
+
+void test_sprite_color_key(void) {
+  const uint16_t key = 0xF81F;
+  const uint16_t sprite[4] = {1, key, key, 2};
+  blit_fill(fb, 0, 0, FB_W, FB_H, 7);
+  blit_sprite(fb, 4, 4, sprite, 2, 2, key);
+  TEST_ASSERT_EQUAL_HEX16(1, pixels[4 * FB_W + 4]);
+  TEST_ASSERT_EQUAL_HEX16(7, pixels[4 * FB_W + 5]);
+  TEST_ASSERT_EQUAL_HEX16(7, pixels[5 * FB_W + 4]);
+  TEST_ASSERT_EQUAL_HEX16(2, pixels[5 * FB_W + 5]);
+}
+
+void test_copy_clipped(void) {
+  const uint16_t sprite[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  blit_copy(fb, -1, -1, sprite, 3, 3);
+  TEST_ASSERT_EQUAL_HEX16(5, pixels[0]);
+  TEST_ASSERT_EQUAL_HEX16(6, pixels[1]);
+  TEST_ASSERT_EQUAL_HEX16(8, pixels[FB_W]);
+  TEST_ASSERT_EQUAL_HEX16(9, pixels[FB_W + 1]);
+  TEST_ASSERT_EQUAL(FB_W * FB_H - 4, count(0));
+}
+
+/* A sheet with runs, literals and a run longer than 128 pixels */
+#define SHEET_W 200
+#define SHEET_H 6
+
+static uint16_t image[SHEET_W * SHEET_H];
+static uint8_t packed[SHEET_W * SHEET_H * 3];
+static uint32_t rows[SHEET_H];
+
+static asset_sheet_t pack_sheet(uint8_t codec) {
+  for (int y = 0; y < SHEET_H; y++) {
+    for (int x = 0; x < SHEET_W; x++) {
+      image[y * SHEET_W + x] = x < 150 ? 0x1234 : (uint16_t)(x * 31 + y);
+    }
+  }
+  uint32_t size = 0;
+  for (int y = 0; y < SHEET_H; y++) {
+    rows[y] = size;
+    const uint8_t *src = (const uint8_t *)&image[y * SHEET_W];
+    if (codec == ASSET_CODEC_RLE) {
+      size += asset_rle_encode_row(src, SHEET_W, 2, packed + size);
+    } else {
+      memcpy(packed + size, src, SHEET_W * 2);
+      size += SHEET_W * 2;
+    }
+  }
+  asset_sheet_t sheet = {SHEET_W, SHEET_H, ASSET_FORMAT_RGB565, codec,
+                         rows,    packed,  size};
+  return sheet;
+}
+
+void test_rle_round_trip(void) {
+  asset_sheet_t sheet = pack_sheet(ASSET_CODEC_RLE);
+  TEST_ASSERT_LESS_THAN(SHEET_W * SHEET_H * 2, sheet.data_size);
+  asset_t frame = {&sheet, 0, 0, SHEET_W, SHEET_H};
+  static uint16_t out[SHEET_W * SHEET_H];
+  TEST_ASSERT_EQUAL(sizeof(out), asset_decoded_size(&frame));
+  asset_decode(&frame, (uint8_t *)out);
+  TEST_ASSERT_EQUAL_MEMORY(image, out, sizeof(out));
+}
+
+void test_rle_partial_line(void) {
+  asset_sheet_t sheet = pack_sheet(ASSET_CODEC_RLE);
+  asset_t frame = {&sheet, 140, 2, 40, 3};
+  uint16_t line[20];
+  // starts inside the long run and ends in the literals
+  asset_decode_line(&frame, 5, 1, 20, (uint8_t *)line);
+  TEST_ASSERT_EQUAL_HEX16_ARRAY(&image[3 * SHEET_W + 145], line, 20);
+}
+
+void test_raw_frame(void) {
+  asset_sheet_t sheet = pack_sheet(ASSET_CODEC_RAW);
+  asset_t frame = {&sheet, 10, 1, 8, 2};
+  uint16_t out[16];
+  asset_decode(&frame, (uint8_t *)out);
+  TEST_ASSERT_EQUAL_HEX16_ARRAY(&image[SHEET_W + 10], out, 8);
+  TEST_ASSERT_EQUAL_HEX16_ARRAY(&image[2 * SHEET_W + 10], out + 8, 8);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fill_inside);
+  RUN_TEST(test_fill_clipped);
+  RUN_TEST(test_sprite_color_key);
+  RUN_TEST(test_copy_clipped);
+  RUN_TEST(test_rle_round_trip);
+  RUN_TEST(test_rle_partial_line);
+  RUN_TEST(test_raw_frame);
+  return UNITY_END();
+}
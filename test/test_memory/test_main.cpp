@@ -0,0 +1,181 @@
+#include <string.h>
+#include <unity.h>
+
+#include "mem_governor.h"
+
+/* The heaps as the actions see them, sys is not tracked */
+static MemUsage heap;
+static MemUsage fake_usage() { return heap; }
+
+static int cache_runs, screen_runs, degrade_runs;
+static int restore_runs, buffer_restores;
+static uint32_t cache_gain, screen_gain, buffer_cost;
+
+static void shed_caches(uint32_t deficit) {
+  cache_runs++;
+  heap.lvgl_free += cache_gain;
+  heap.lvgl_block += cache_gain;
+}
+
+static void shed_screens(uint32_t deficit) {
+  screen_runs++;
+  heap.lvgl_free += screen_gain;
+  heap.lvgl_block += screen_gain;
+}
+
+static void degrade(uint32_t deficit) { degrade_runs++; }
+static void restore(void) { restore_runs++; }
+
+/* A second buffer given back, allocated again on restore */
+static void drop_buffer(uint32_t deficit) {}
+static void restore_buffer(void) {
+  buffer_restores++;
+  heap.lvgl_free -= buffer_cost;
+  heap.lvgl_block -= buffer_cost;
+}
+
+static void set_free(uint32_t bytes) {
+  heap.lvgl_free = bytes;
+  heap.lvgl_block = bytes;
+}
+
+static const MemBudget budget = {10000, 5000, 0, 0};
+
+void setUp(void) {
+  heap.sys_free = UINT32_MAX;
+  heap.sys_block = UINT32_MAX;
+  set_free(20000);
+  cache_runs = screen_runs = degrade_runs = 0;
+  restore_runs = buffer_restores = 0;
+  cache_gain = 0;
+  screen_gain = 0;
+  buffer_cost = 0;
+  mem_governor_set_usage(fake_usage);
+  mem_governor_begin(budget, NULL);
+}
+
+void tearDown(void) {}
+
+/* the actions are kept across tests, the registry has no reset */
+static void add_actions(void) {
+  static bool added;
+  if (!added) {
+    mem_governor_add(MEM_SHED_CACHES, "caches", shed_caches);
+    mem_governor_add(MEM_UNLOAD_SCREENS, "screens", shed_screens);
+    mem_governor_add(MEM_DEGRADE, "degrade", degrade, restore);
+    mem_governor_add(MEM_DEGRADE, "buffer", drop_buffer, restore_buffer);
+    added = true;
+  }
+}
+
+void test_inside_budget(void) {
+  add_actions();
+  uint8_t decisions = mem_governor_decision_count();
+  TEST_ASSERT_EQUAL(MEM_OK, mem_governor_check());
+  TEST_ASSERT_EQUAL(0, cache_runs);
+  TEST_ASSERT_EQUAL(decisions, mem_governor_decision_count());
+}
+
+void test_levels_in_order(void) {
+  add_actions();
+  set_free(6000);
+  cache_gain = 1000;  // not enough
+  screen_gain = 5000; // back inside
+  TEST_ASSERT_EQUAL(MEM_UNLOAD_SCREENS, mem_governor_check());
+  TEST_ASSERT_EQUAL(1, cache_runs);
+  TEST_ASSERT_EQUAL(1, screen_runs);
+  TEST_ASSERT_EQUAL(0, degrade_runs);
+  TEST_ASSERT_EQUAL(MEM_UNLOAD_SCREENS, mem_governor_level());
+  const MemDecision *d =
+      mem_governor_decision(mem_governor_decision_count() - 1);
+  TEST_ASSERT_EQUAL_STRING("screens", d->action);
+  TEST_ASSERT_EQUAL(5000, d->lvgl_gain);
+}
+
+void test_low_heap_sheds_once(void) {
+  add_actions();
+  set_free(4000); // nothing helps
+  TEST_ASSERT_EQUAL(MEM_DEGRADE, mem_governor_check());
+  for (int i = 0; i < 10; i++) {
+    TEST_ASSERT_EQUAL(MEM_OK, mem_governor_check());
+  }
+  TEST_ASSERT_EQUAL(1, cache_runs);
+  TEST_ASSERT_EQUAL(1, screen_runs);
+  TEST_ASSERT_EQUAL(1, degrade_runs);
+  TEST_ASSERT_EQUAL(MEM_DEGRADE, mem_governor_level());
+
+  // inside the budget but under the high-water mark, still the same episode
+  set_free(12000);
+  mem_governor_check();
+  set_free(4000);
+  mem_governor_check();
+  TEST_ASSERT_EQUAL(1, cache_runs);
+
+  // recovered, the next deficit starts over
+  set_free(budget.lvgl_min_free * MEM_RECOVER_PCT / 100);
+  TEST_ASSERT_EQUAL(MEM_OK, mem_governor_check());
+  TEST_ASSERT_EQUAL(MEM_OK, mem_governor_level());
+  set_free(4000);
+  mem_governor_check();
+  TEST_ASSERT_EQUAL(2, cache_runs);
+  TEST_ASSERT_EQUAL(2, degrade_runs);
+}
+
+void test_reserve_runs_again(void) {
+  add_actions();
+  set_free(8000);
+  cache_gain = 4000;
+  mem_governor_check();
+  TEST_ASSERT_EQUAL(1, cache_runs);
+  // an allocation does not wait for the episode to end
+  TEST_ASSERT_TRUE(mem_governor_reserve(4000, 0));
+  TEST_ASSERT_EQUAL(2, cache_runs);
+  cache_gain = 0;
+  screen_gain = 0;
+  // degraded modes only run from the loop check
+  TEST_ASSERT_FALSE(mem_governor_reserve(50000, 0));
+  TEST_ASSERT_EQUAL(3, cache_runs);
+  TEST_ASSERT_EQUAL(0, degrade_runs);
+  set_free(4000);
+  TEST_ASSERT_EQUAL(MEM_DEGRADE, mem_governor_check());
+  TEST_ASSERT_EQUAL(1, degrade_runs);
+}
+
+void test_recovery_restores(void) {
+  add_actions();
+  set_free(4000);
+  TEST_ASSERT_EQUAL(MEM_DEGRADE, mem_governor_check());
+
+  // inside the budget is not enough
+  set_free(12000);
+  mem_governor_check();
+  TEST_ASSERT_EQUAL(0, buffer_restores);
+
+  // the buffer comes back first, it takes the heap under the high-water
+  // mark and the other mode waits for the next check
+  uint32_t high = budget.lvgl_min_free * MEM_RECOVER_PCT / 100;
+  buffer_cost = 2000;
+  set_free(high + 1000);
+  mem_governor_check();
+  TEST_ASSERT_EQUAL(1, buffer_restores);
+  TEST_ASSERT_EQUAL(0, restore_runs);
+  TEST_ASSERT_EQUAL(MEM_DEGRADE, mem_governor_level());
+
+  set_free(high);
+  TEST_ASSERT_EQUAL(MEM_OK, mem_governor_check());
+  TEST_ASSERT_EQUAL(1, buffer_restores);
+  TEST_ASSERT_EQUAL(1, restore_runs);
+  TEST_ASSERT_EQUAL(MEM_OK, mem_governor_level());
+  mem_governor_check();
+  TEST_ASSERT_EQUAL(1, restore_runs);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_inside_budget);
+  RUN_TEST(test_levels_in_order);
+  RUN_TEST(test_low_heap_sheds_once);
+  RUN_TEST(test_reserve_runs_again);
+  RUN_TEST(test_recovery_restores);
+  return UNITY_END();
+}
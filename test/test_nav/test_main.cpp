@@ -0,0 +1,164 @@
+#include <unity.h>
+
+#include "nav_graph.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/* home in the middle: weather to the right, notifications below, control
+ * above */
+static NavGraph graph;
+static int8_t home, weather, notifications, control;
+
+static void make_graph(void) {
+  graph = NavGraph();
+  home = graph.add("home");
+  weather = graph.add("weather");
+  notifications = graph.add("notifications");
+  control = graph.add("control");
+  graph.link(home, NAV_LEFT, weather);
+  graph.link(weather, NAV_RIGHT, home);
+  graph.link(home, NAV_UP, notifications);
+  graph.link(notifications, NAV_DOWN, home);
+  graph.link(home, NAV_DOWN, control);
+  graph.link(control, NAV_UP, home);
+}
+
+void test_graph(void) {
+  make_graph();
+  TEST_ASSERT_EQUAL(4, graph.count());
+  TEST_ASSERT_EQUAL(weather, graph.neighbour(home, NAV_LEFT));
+  TEST_ASSERT_EQUAL(-1, graph.neighbour(home, NAV_RIGHT));
+  TEST_ASSERT_EQUAL(home, graph.neighbour(control, NAV_UP));
+  TEST_ASSERT_EQUAL(-1, graph.neighbour(9, NAV_UP));
+  TEST_ASSERT_EQUAL_STRING("control", graph.name(control));
+}
+
+void test_graph_full(void) {
+  NavGraph g;
+  for (int i = 0; i < NAV_SCREENS_MAX; i++) {
+    TEST_ASSERT_EQUAL(i, g.add("s"));
+  }
+  TEST_ASSERT_EQUAL(-1, g.add("s"));
+}
+
+void test_likely(void) {
+  make_graph();
+  // nothing visited: the first linked direction
+  TEST_ASSERT_EQUAL(weather, graph.likely(home));
+  graph.visited(home, notifications);
+  graph.visited(home, notifications);
+  graph.visited(home, weather);
+  TEST_ASSERT_EQUAL(notifications, graph.likely(home));
+  graph.visited(home, home); // not a neighbour, ignored
+  TEST_ASSERT_EQUAL(notifications, graph.likely(home));
+  TEST_ASSERT_EQUAL(home, graph.likely(weather));
+  NavGraph empty;
+  empty.add("alone");
+  TEST_ASSERT_EQUAL(-1, empty.likely(0));
+}
+
+void test_gesture_swipe(void) {
+  NavGesture g;
+  TEST_ASSERT_EQUAL(NAV_GESTURE_NONE, g.feed(120, 120, false));
+  TEST_ASSERT_EQUAL(NAV_GESTURE_PRESS, g.feed(120, 120, true));
+  TEST_ASSERT_EQUAL(NAV_GESTURE_NONE, g.feed(115, 121, true));
+  TEST_ASSERT_FALSE(g.swiping());
+  TEST_ASSERT_EQUAL(NAV_GESTURE_START, g.feed(108, 122, true));
+  TEST_ASSERT_EQUAL(NAV_LEFT, g.dir());
+  TEST_ASSERT_EQUAL(NAV_GESTURE_NONE, g.feed(90, 123, true));
+  TEST_ASSERT_EQUAL(NAV_GESTURE_NONE, g.feed(60, 125, true));
+  // the release sample repeats the last point
+  TEST_ASSERT_EQUAL(NAV_GESTURE_SWIPE, g.feed(60, 125, false));
+  TEST_ASSERT_EQUAL(NAV_GESTURE_NONE, g.feed(60, 125, false));
+}
+
+void test_gesture_short_and_turn(void) {
+  NavGesture g;
+  g.feed(100, 100, true);
+  TEST_ASSERT_EQUAL(NAV_GESTURE_START, g.feed(100, 115, true));
+  TEST_ASSERT_EQUAL(NAV_GESTURE_NONE, g.feed(100, 130, true));
+  TEST_ASSERT_EQUAL(NAV_DOWN, g.dir());
+  TEST_ASSERT_EQUAL(NAV_GESTURE_CANCEL, g.feed(100, 130, false)); // 30 px
+
+  // turning to the other axis restarts with the new direction
+  g.feed(100, 100, true);
+  TEST_ASSERT_EQUAL(NAV_GESTURE_START, g.feed(100, 88, true));
+  TEST_ASSERT_EQUAL(NAV_UP, g.dir());
+  TEST_ASSERT_EQUAL(NAV_GESTURE_START, g.feed(130, 92, true));
+  TEST_ASSERT_EQUAL(NAV_RIGHT, g.dir());
+  g.feed(170, 92, true);
+  TEST_ASSERT_EQUAL(NAV_GESTURE_SWIPE, g.feed(170, 92, false));
+
+  // a tap is cancelled
+  g.feed(50, 50, true);
+  TEST_ASSERT_EQUAL(NAV_GESTURE_CANCEL, g.feed(52, 51, false));
+}
+
+static uint32_t now_us;
+static uint32_t fake_clock() { return now_us; }
+
+struct Job {
+  uint16_t steps;    // steps of each screen
+  uint32_t cost_us;  // time of one step
+  uint16_t calls;
+  uint8_t last_target;
+};
+
+static bool fake_step(uint8_t target, uint16_t step, void *ctx) {
+  Job *j = (Job *)ctx;
+  j->calls++;
+  j->last_target = target;
+  now_us += j->cost_us;
+  return step + 1 < j->steps;
+}
+
+void test_prefetch_budget(void) {
+  Job job = {10, 1000, 0, 0};
+  NavPrefetch p(fake_step, &job, fake_clock);
+  TEST_ASSERT_FALSE(p.run(4000)); // nothing to do
+  p.start(2);
+  TEST_ASSERT_TRUE(p.active());
+  TEST_ASSERT_TRUE(p.run(4000));
+  TEST_ASSERT_EQUAL(4, job.calls); // 4 ms of steps in a 4 ms budget
+  TEST_ASSERT_EQUAL(2, job.last_target);
+  TEST_ASSERT_FALSE(p.ready());
+  p.start(2); // same target keeps its progress
+  TEST_ASSERT_TRUE(p.run(4000));
+  TEST_ASSERT_FALSE(p.run(4000));
+  TEST_ASSERT_EQUAL(10, job.calls);
+  TEST_ASSERT_TRUE(p.ready());
+  TEST_ASSERT_EQUAL(10000, p.busy_us());
+  TEST_ASSERT_FALSE(p.run(4000));
+  TEST_ASSERT_EQUAL(10, job.calls);
+}
+
+void test_prefetch_long_step_and_restart(void) {
+  Job job = {3, 9000, 0, 0};
+  NavPrefetch p(fake_step, &job, fake_clock);
+  p.start(1);
+  p.run(4000); // one step over the budget runs alone
+  TEST_ASSERT_EQUAL(1, job.calls);
+  TEST_ASSERT_EQUAL(1, p.steps());
+  p.start(3); // another target starts over
+  TEST_ASSERT_EQUAL(0, p.steps());
+  p.run(4000);
+  TEST_ASSERT_EQUAL(3, job.last_target);
+  p.cancel();
+  TEST_ASSERT_FALSE(p.active());
+  TEST_ASSERT_FALSE(p.ready());
+  TEST_ASSERT_FALSE(p.run(4000));
+  TEST_ASSERT_EQUAL(2, job.calls);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_graph);
+  RUN_TEST(test_graph_full);
+  RUN_TEST(test_likely);
+  RUN_TEST(test_gesture_swipe);
+  RUN_TEST(test_gesture_short_and_turn);
+  RUN_TEST(test_prefetch_budget);
+  RUN_TEST(test_prefetch_long_step_and_restart);
+  return UNITY_END();
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "notification_store.h"
+
+static NotificationStore store;
+
+void setUp(void) { store.clear(); }
+void tearDown(void) {}
+
+void test_newest_first(void) {
+  store.add(1, "Skype", "09:30", "first");
+  store.add(2, "Telegram", "09:31", "second");
+  TEST_ASSERT_EQUAL(2, store.count());
+  TEST_ASSERT_EQUAL_STRING("second", store.get(0).message);
+  TEST_ASSERT_EQUAL_STRING("Telegram", store.get(0).app);
+  TEST_ASSERT_EQUAL_STRING("first", store.get(1).message);
+  TEST_ASSERT_EQUAL(1, store.get(1).icon);
+}
+
+void test_drops_oldest(void) {
+  char text[16];
+  uint32_t first = 0;
+  for (int i = 0; i < NOTIFICATION_MAX + 3; i++) {
+    snprintf(text, sizeof(text), "n%d", i);
+    uint32_t id = store.add(0, "app", "00:00", text).id;
+    if (i == 0) {
+      first = id;
+    }
+  }
+  TEST_ASSERT_EQUAL(NOTIFICATION_MAX, store.count());
+  snprintf(text, sizeof(text), "n%d", NOTIFICATION_MAX + 2);
+  TEST_ASSERT_EQUAL_STRING(text, store.get(0).message);
+  TEST_ASSERT_EQUAL_STRING("n3", store.get(NOTIFICATION_MAX - 1).message);
+  TEST_ASSERT_EQUAL(-1, store.find(first));
+}
+
+void test_find_by_id(void) {
+  uint32_t a = store.add(0, "a", "", "a").id;
+  uint32_t b = store.add(0, "b", "", "b").id;
+  TEST_ASSERT_EQUAL(1, store.find(a));
+  TEST_ASSERT_EQUAL(0, store.find(b));
+}
+
+void test_revision_changes(void) {
+  uint32_t r = store.revision();
+  store.add(0, "a", "", "a");
+  TEST_ASSERT_TRUE(store.revision() != r);
+  r = store.revision();
+  store.clear();
+  TEST_ASSERT_TRUE(store.revision() != r);
+  TEST_ASSERT_EQUAL(0, store.count());
+}
+
+void test_long_message_truncated(void) {
+  char text[NOTIFICATION_TEXT_MAX * 2];
+  memset(text, 'x', sizeof(text) - 1);
+  text[sizeof(text) - 1] = '\0';
+  const NotificationRecord &r = store.add(0, "app", "00:00", text);
+  TEST_ASSERT_EQUAL(NOTIFICATION_TEXT_MAX - 1, strlen(r.message));
+}
+
+void test_utf8_boundary(void) {
+  char out[6];
+  // "aé€" is 1 + 2 + 3 bytes, the euro sign does not fit in 5 bytes
+  TEST_ASSERT_EQUAL(3, utf8_copy(out, "a\xC3\xA9\xE2\x82\xAC", sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("a\xC3\xA9", out);
+  char small[3];
+  // the cut lands inside "é", drop it entirely
+  TEST_ASSERT_EQUAL(1, utf8_copy(small, "a\xC3\xA9", sizeof(small)));
+  TEST_ASSERT_EQUAL_STRING("a", small);
+  TEST_ASSERT_EQUAL(0, utf8_copy(small, "", sizeof(small)));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_newest_first);
+  RUN_TEST(test_drops_oldest);
+  RUN_TEST(test_find_by_id);
+  RUN_TEST(test_revision_changes);
+  RUN_TEST(test_long_message_truncated);
+  RUN_TEST(test_utf8_boundary);
+  return UNITY_END();
+}
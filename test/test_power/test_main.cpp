@@ -0,0 +1,121 @@
+#include <unity.h>
+
+#include "power_governor.h"
+
+#define TIMEOUT_MS 20000
+
+static PowerConfig config;
+
+static void check_outputs(const PowerGovernor &governor, PowerState state,
+                          uint32_t refresh, uint32_t loop, uint8_t level) {
+  TEST_ASSERT_EQUAL_STRING(PowerGovernor::name(state),
+                           PowerGovernor::name(governor.state()));
+  TEST_ASSERT_EQUAL(refresh, governor.refreshPeriod());
+  TEST_ASSERT_EQUAL(loop, governor.loopDelay());
+  TEST_ASSERT_EQUAL(level, governor.brightness());
+}
+
+void setUp(void) { config = PowerConfig(); }
+void tearDown(void) {}
+
+void test_every_timeout(void) {
+  PowerGovernor governor(config);
+  governor.setBrightness(180);
+  governor.setTimeout(TIMEOUT_MS);
+  governor.begin(1000);
+
+  TEST_ASSERT_FALSE(governor.update(1000));
+  check_outputs(governor, POWER_ACTIVE, config.active_refr_ms,
+                config.active_loop_ms, 180);
+
+  uint32_t t = 1000 + config.idle_after_ms - 1;
+  TEST_ASSERT_FALSE(governor.update(t));
+  TEST_ASSERT_TRUE(governor.update(t + 1));
+  check_outputs(governor, POWER_IDLE, config.idle_refr_ms, config.idle_loop_ms,
+                180);
+
+  t = 1000 + TIMEOUT_MS - config.dim_before_ms;
+  TEST_ASSERT_FALSE(governor.update(t - 1));
+  TEST_ASSERT_TRUE(governor.update(t));
+  check_outputs(governor, POWER_DIM, config.idle_refr_ms, config.idle_loop_ms,
+                config.dim_brightness);
+
+  t = 1000 + TIMEOUT_MS;
+  TEST_ASSERT_FALSE(governor.update(t - 1));
+  TEST_ASSERT_TRUE(governor.update(t));
+  check_outputs(governor, POWER_OFF, config.off_refr_ms, config.off_loop_ms,
+                0);
+
+  // a touch wakes it at full brightness
+  governor.activity(t + 5000);
+  TEST_ASSERT_TRUE(governor.update(t + 5000));
+  check_outputs(governor, POWER_ACTIVE, config.active_refr_ms,
+                config.active_loop_ms, 180);
+
+  TEST_ASSERT_EQUAL(config.idle_after_ms, governor.timeIn(POWER_ACTIVE));
+  TEST_ASSERT_EQUAL(TIMEOUT_MS - config.dim_before_ms - config.idle_after_ms,
+                    governor.timeIn(POWER_IDLE));
+  TEST_ASSERT_EQUAL(config.dim_before_ms, governor.timeIn(POWER_DIM));
+  TEST_ASSERT_EQUAL(5000, governor.timeIn(POWER_OFF));
+}
+
+void test_animation_keeps_refresh_not_screen(void) {
+  PowerGovernor governor(config);
+  governor.setTimeout(TIMEOUT_MS);
+  governor.begin(0);
+
+  // an animation running the whole time keeps the fast refresh
+  uint32_t t;
+  for (t = 0; t < TIMEOUT_MS - config.dim_before_ms; t += 100) {
+    governor.animating(t);
+    governor.update(t);
+    TEST_ASSERT_EQUAL(POWER_ACTIVE, governor.state());
+  }
+  // but does not keep the screen on
+  governor.animating(t);
+  governor.update(t);
+  TEST_ASSERT_EQUAL(POWER_DIM, governor.state());
+  governor.animating(TIMEOUT_MS);
+  governor.update(TIMEOUT_MS);
+  TEST_ASSERT_EQUAL(POWER_OFF, governor.state());
+}
+
+void test_always_on(void) {
+  PowerGovernor governor(config);
+  governor.setBrightness(120);
+  governor.setTimeout(0);
+  governor.begin(0);
+  governor.update(3600000);
+  check_outputs(governor, POWER_IDLE, config.idle_refr_ms, config.idle_loop_ms,
+                120);
+}
+
+void test_dim_keeps_lower_level(void) {
+  PowerGovernor governor(config);
+  governor.setBrightness(config.dim_brightness / 2);
+  governor.setTimeout(TIMEOUT_MS);
+  governor.begin(0);
+  governor.update(TIMEOUT_MS - 1);
+  TEST_ASSERT_EQUAL(POWER_DIM, governor.state());
+  TEST_ASSERT_EQUAL(config.dim_brightness / 2, governor.brightness());
+}
+
+void test_short_timeout_skips_dim(void) {
+  PowerGovernor governor(config);
+  governor.setTimeout(config.dim_before_ms);
+  governor.begin(0);
+  governor.update(config.dim_before_ms - 1);
+  TEST_ASSERT_EQUAL(POWER_IDLE, governor.state());
+  governor.update(config.dim_before_ms);
+  TEST_ASSERT_EQUAL(POWER_OFF, governor.state());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_every_timeout);
+  RUN_TEST(test_animation_keeps_refresh_not_screen);
+  RUN_TEST(test_always_on);
+  RUN_TEST(test_dim_keeps_lower_level);
+  RUN_TEST(test_short_timeout_skips_dim);
+  return UNITY_END();
+}
@@ -0,0 +1,150 @@
+#include <unity.h>
+
+#include "settings_store.h"
+
+#define SETTLE_MS 2000
+#define MAX_DELAY_MS 10000
+
+/* Memory backend that can fail a key or the commit */
+class FlakyBackend : public MemorySettingsBackend {
+public:
+  FlakyBackend() : fail_commit(false), fail_key(-1) {}
+  bool write(const SettingDesc &desc, int32_t value) {
+    if (&desc - settingDescs == fail_key) {
+      return false;
+    }
+    return MemorySettingsBackend::write(desc, value);
+  }
+  bool commit() {
+    if (fail_commit) {
+      return false;
+    }
+    return MemorySettingsBackend::commit();
+  }
+
+  bool fail_commit;
+  int fail_key;
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_rapid_changes_one_commit(void) {
+  MemorySettingsBackend backend;
+  SettingsStore store(backend, SETTLE_MS, MAX_DELAY_MS);
+  store.begin();
+
+  // a brightness slider dragged for one second
+  uint32_t now = 0;
+  for (int i = 0; i < 50; i++) {
+    store.set(SETTING_BRIGHTNESS, i * 5, now);
+    TEST_ASSERT_FALSE(store.loop(now));
+    now += 20;
+  }
+  store.set(SETTING_TIMEOUT, 3, now);
+  TEST_ASSERT_EQUAL(0, backend.commits);
+  TEST_ASSERT_EQUAL(245, store.get(SETTING_BRIGHTNESS));
+
+  TEST_ASSERT_FALSE(store.loop(now + SETTLE_MS - 1));
+  TEST_ASSERT_TRUE(store.loop(now + SETTLE_MS));
+  TEST_ASSERT_EQUAL(1, backend.commits);
+  TEST_ASSERT_EQUAL(2, backend.writes); // one per changed key
+  TEST_ASSERT_FALSE(store.pending());
+  TEST_ASSERT_FALSE(store.loop(now + 2 * SETTLE_MS));
+  TEST_ASSERT_EQUAL(1, backend.commits);
+
+  SettingsStore reloaded(backend);
+  reloaded.begin();
+  TEST_ASSERT_EQUAL(245, reloaded.get(SETTING_BRIGHTNESS));
+  TEST_ASSERT_EQUAL(3, reloaded.get(SETTING_TIMEOUT));
+}
+
+void test_steady_changes_bounded(void) {
+  MemorySettingsBackend backend;
+  SettingsStore store(backend, SETTLE_MS, MAX_DELAY_MS);
+  store.begin();
+
+  // never settles: one change every 100 ms for a minute
+  uint32_t last_commit = 0;
+  uint32_t commits = 0;
+  for (uint32_t now = 0; now < 60000; now += 100) {
+    store.set(SETTING_BRIGHTNESS, (now / 100) % 2 ? 10 : 20, now);
+    if (store.loop(now)) {
+      if (commits > 0) {
+        TEST_ASSERT_TRUE(now - last_commit >= MAX_DELAY_MS);
+      }
+      last_commit = now;
+      commits++;
+    }
+  }
+  TEST_ASSERT_EQUAL(commits, backend.commits);
+  TEST_ASSERT_TRUE(commits >= 5);
+  TEST_ASSERT_TRUE(commits <= 60000 / MAX_DELAY_MS);
+}
+
+void test_unchanged_value_not_written(void) {
+  MemorySettingsBackend backend;
+  SettingsStore store(backend, SETTLE_MS, MAX_DELAY_MS);
+  store.begin();
+  store.set(SETTING_BRIGHTNESS, settingDescs[SETTING_BRIGHTNESS].def, 0);
+  TEST_ASSERT_FALSE(store.pending());
+  store.set(SETTING_BRIGHTNESS, 300, 0); // clamped to a u8
+  TEST_ASSERT_EQUAL(255, store.get(SETTING_BRIGHTNESS));
+  TEST_ASSERT_TRUE(store.flush());
+  TEST_ASSERT_FALSE(store.flush());
+}
+
+void test_failed_commit_stays_dirty(void) {
+  FlakyBackend backend;
+  SettingsStore store(backend, SETTLE_MS, MAX_DELAY_MS);
+  store.begin();
+  store.set(SETTING_BRIGHTNESS, 50, 0);
+  store.set(SETTING_AOD, 1, 0);
+
+  backend.fail_commit = true;
+  TEST_ASSERT_FALSE(store.loop(SETTLE_MS));
+  TEST_ASSERT_TRUE(store.pending());
+  // the retry waits for the changes to settle again
+  uint32_t writes = backend.writes;
+  TEST_ASSERT_FALSE(store.loop(SETTLE_MS + 1));
+  TEST_ASSERT_EQUAL(writes, backend.writes);
+
+  backend.fail_commit = false;
+  TEST_ASSERT_TRUE(store.loop(2 * SETTLE_MS));
+  TEST_ASSERT_FALSE(store.pending());
+  TEST_ASSERT_EQUAL(1, backend.commits);
+}
+
+void test_failed_key_stays_dirty(void) {
+  FlakyBackend backend;
+  SettingsStore store(backend, SETTLE_MS, MAX_DELAY_MS);
+  store.begin();
+  store.set(SETTING_BRIGHTNESS, 50, 0);
+  store.set(SETTING_AOD, 1, 0);
+
+  backend.fail_key = SETTING_AOD;
+  TEST_ASSERT_FALSE(store.flush());
+  TEST_ASSERT_TRUE(store.pending());
+  TEST_ASSERT_EQUAL(1, backend.writes);
+
+  // only the key that failed is written again
+  backend.fail_key = -1;
+  TEST_ASSERT_TRUE(store.flush());
+  TEST_ASSERT_EQUAL(2, backend.writes);
+  TEST_ASSERT_FALSE(store.pending());
+
+  SettingsStore reloaded(backend);
+  reloaded.begin();
+  TEST_ASSERT_EQUAL(50, reloaded.get(SETTING_BRIGHTNESS));
+  TEST_ASSERT_TRUE(reloaded.getBool(SETTING_AOD));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_rapid_changes_one_commit);
+  RUN_TEST(test_steady_changes_bounded);
+  RUN_TEST(test_unchanged_value_not_written);
+  RUN_TEST(test_failed_commit_stays_dirty);
+  RUN_TEST(test_failed_key_stays_dirty);
+  return UNITY_END();
+}
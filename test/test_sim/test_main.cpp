@@ -0,0 +1,123 @@
+#include <unity.h>
+
+#include "sim_clock.h"
+
+static uint64_t ticked;
+static uint32_t ticks;
+
+static void tick(uint32_t ms) {
+  ticked += ms;
+  ticks++;
+}
+
+static SimClock *clock_under_test;
+static uint64_t fired_at[16];
+static uint32_t fired;
+
+static void record(uint32_t count) {
+  if (fired < 16) {
+    fired_at[fired] = clock_under_test->millis();
+  }
+  fired++;
+}
+
+static uint32_t minutes;
+static void minute(uint32_t count) { minutes = count; }
+
+static uint32_t hours;
+static void hour(uint32_t count) { hours = count; }
+
+void setUp(void) {
+  ticked = 0;
+  ticks = 0;
+  fired = 0;
+  minutes = 0;
+  hours = 0;
+}
+void tearDown(void) {}
+
+void test_advance_ticks_and_time(void) {
+  SimClock clock(1000000, tick);
+  clock.advance(5);
+  clock.advance(1500);
+  TEST_ASSERT_EQUAL(1505, (uint32_t)clock.millis());
+  TEST_ASSERT_EQUAL(1505, (uint32_t)ticked);
+  TEST_ASSERT_EQUAL(1000001, (long)clock.time());
+  TEST_ASSERT_EQUAL(505, clock.millisOfSecond());
+}
+
+void test_events_fire_at_their_time(void) {
+  SimClock clock(0, tick);
+  clock_under_test = &clock;
+  TEST_ASSERT_TRUE(clock.every(100, record));
+  clock.advance(350); // crosses three events in one step
+  TEST_ASSERT_EQUAL(3, fired);
+  TEST_ASSERT_EQUAL(100, (uint32_t)fired_at[0]);
+  TEST_ASSERT_EQUAL(200, (uint32_t)fired_at[1]);
+  TEST_ASSERT_EQUAL(300, (uint32_t)fired_at[2]);
+  TEST_ASSERT_EQUAL(350, (uint32_t)ticked);
+  TEST_ASSERT_EQUAL(50, clock.untilNext());
+}
+
+void test_events_in_order(void) {
+  SimClock clock(0, tick);
+  clock_under_test = &clock;
+  clock.every(300, record);
+  clock.every(200, record);
+  clock.advance(600);
+  // 200, 300, 400, then 600 twice with the first registered first
+  TEST_ASSERT_EQUAL(5, fired);
+  TEST_ASSERT_EQUAL(200, (uint32_t)fired_at[0]);
+  TEST_ASSERT_EQUAL(300, (uint32_t)fired_at[1]);
+  TEST_ASSERT_EQUAL(400, (uint32_t)fired_at[2]);
+  TEST_ASSERT_EQUAL(600, (uint32_t)fired_at[3]);
+  TEST_ASSERT_EQUAL(600, (uint32_t)fired_at[4]);
+}
+
+void test_event_limit(void) {
+  SimClock clock;
+  for (uint8_t i = 0; i < SIM_EVENTS_MAX; i++) {
+    TEST_ASSERT_TRUE(clock.every(1000, minute));
+  }
+  TEST_ASSERT_FALSE(clock.every(1000, minute));
+  TEST_ASSERT_FALSE(SimClock().every(0, minute));
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, SimClock().untilNext());
+}
+
+void test_simulated_day(void) {
+  SimClock clock(0, tick);
+  clock.every(60000, minute);
+  clock.every(3600000, hour);
+  // a 5 ms loop for a day
+  for (uint32_t i = 0; i < 24 * 3600 * 200; i++) {
+    clock.advance(5);
+  }
+  TEST_ASSERT_EQUAL(24 * 60, minutes);
+  TEST_ASSERT_EQUAL(24, hours);
+  TEST_ASSERT_EQUAL(24 * 60 + 24, clock.fired());
+  TEST_ASSERT_EQUAL(86400, (long)clock.time());
+  TEST_ASSERT_EQUAL(86400000, (uint32_t)ticked);
+}
+
+void test_begin_resets(void) {
+  SimClock clock(0, tick);
+  clock.every(10, minute);
+  clock.advance(100);
+  clock.begin(500, NULL);
+  clock.advance(100);
+  TEST_ASSERT_EQUAL(100, (uint32_t)clock.millis());
+  TEST_ASSERT_EQUAL(500, (long)clock.time());
+  TEST_ASSERT_EQUAL(0, clock.fired());
+  TEST_ASSERT_EQUAL(100, (uint32_t)ticked); // nothing after begin
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_advance_ticks_and_time);
+  RUN_TEST(test_events_fire_at_their_time);
+  RUN_TEST(test_events_in_order);
+  RUN_TEST(test_event_limit);
+  RUN_TEST(test_simulated_day);
+  RUN_TEST(test_begin_resets);
+  return UNITY_END();
+}
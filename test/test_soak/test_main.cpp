@@ -0,0 +1,131 @@
+#include <string.h>
+#include <unity.h>
+
+#include "soak_monitor.h"
+
+static SoakSample sample(uint32_t used, uint32_t free_block, uint32_t objects) {
+  SoakSample s = {used, free_block, objects};
+  return s;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_flat_run_passes(void) {
+  SoakMonitor m;
+  for (int i = 0; i < 50; i++) {
+    // the same screens rebuilt, the heap moves around a fixed level
+    m.add(sample(30000 + (i % 5) * 300, 20000 - (i % 3) * 500, 180));
+  }
+  TEST_ASSERT_TRUE(m.passed());
+  TEST_ASSERT_EQUAL(SOAK_STABLE, m.trend(SOAK_USED));
+  TEST_ASSERT_EQUAL(SOAK_STABLE, m.trend(SOAK_FREE_BLOCK));
+  TEST_ASSERT_EQUAL(SOAK_STABLE, m.trend(SOAK_OBJECTS));
+}
+
+void test_warmup_ignored(void) {
+  SoakMonitor m;
+  m.add(sample(10000, 40000, 50)); // first builds
+  m.add(sample(25000, 25000, 150));
+  for (int i = 0; i < 10; i++) {
+    m.add(sample(30000, 20000, 180));
+  }
+  TEST_ASSERT_TRUE(m.passed());
+  TEST_ASSERT_EQUAL(0, m.drift(SOAK_USED));
+}
+
+void test_steady_leak_fails(void) {
+  SoakMonitor m;
+  for (int i = 0; i < 20; i++) {
+    m.add(sample(30000 + i * 120, 20000, 180)); // 120 bytes per checkpoint
+  }
+  TEST_ASSERT_EQUAL(SOAK_MONOTONIC, m.trend(SOAK_USED));
+  TEST_ASSERT_EQUAL(17 * 120, m.drift(SOAK_USED));
+  TEST_ASSERT_FALSE(m.passed());
+}
+
+void test_small_growth_within_slack(void) {
+  SoakMonitor m;
+  for (int i = 0; i < 20; i++) {
+    m.add(sample(30000 + i * 10, 20000, 180));
+  }
+  TEST_ASSERT_EQUAL(SOAK_STABLE, m.trend(SOAK_USED));
+}
+
+void test_noisy_leak_fails(void) {
+  SoakMonitor m;
+  for (int i = 0; i < 90; i++) {
+    // 100 bytes per checkpoint under 1500 bytes of noise, never monotonic
+    uint32_t noise = (i % 2) ? 1500 : 0;
+    m.add(sample(30000 + i * 100 + noise, 20000, 180));
+  }
+  TEST_ASSERT_EQUAL(SOAK_SUSTAINED, m.trend(SOAK_USED));
+  TEST_ASSERT_FALSE(m.passed());
+}
+
+void test_fragmentation_fails(void) {
+  SoakMonitor m;
+  for (int i = 0; i < 20; i++) {
+    // the same memory in use, the largest block keeps shrinking
+    m.add(sample(30000, 20000 - i * 400, 180));
+  }
+  TEST_ASSERT_EQUAL(SOAK_STABLE, m.trend(SOAK_USED));
+  TEST_ASSERT_EQUAL(SOAK_MONOTONIC, m.trend(SOAK_FREE_BLOCK));
+  TEST_ASSERT_EQUAL(17 * 400, m.drift(SOAK_FREE_BLOCK));
+}
+
+void test_object_leak_fails(void) {
+  SoakMonitor m;
+  for (int i = 0; i < 10; i++) {
+    m.add(sample(30000, 20000, 180 + i / 4)); // one object now and then
+  }
+  TEST_ASSERT_EQUAL(SOAK_MONOTONIC, m.trend(SOAK_OBJECTS));
+}
+
+void test_too_short(void) {
+  SoakMonitor m;
+  for (int i = 0; i < 4; i++) {
+    m.add(sample(30000 + i * 5000, 20000, 180 + i));
+  }
+  TEST_ASSERT_TRUE(m.passed());
+}
+
+void test_capacity(void) {
+  SoakMonitor m;
+  for (int i = 0; i < SOAK_CHECKPOINTS_MAX; i++) {
+    TEST_ASSERT_TRUE(m.add(sample(1, 1, 1)));
+  }
+  TEST_ASSERT_FALSE(m.add(sample(1, 1, 1)));
+  TEST_ASSERT_EQUAL(SOAK_CHECKPOINTS_MAX, m.count());
+}
+
+void test_format(void) {
+  SoakMonitor m;
+  for (int i = 0; i < 10; i++) {
+    m.add(sample(30000 + i * 200, 20000 - i * 100, 180));
+  }
+  char out[256];
+  m.format(out, sizeof(out));
+  TEST_ASSERT_NOT_NULL(
+      strstr(out, "heap used  first 30400 last 31800 min 30400 max 31800 "
+                  "GROWING\n"));
+  TEST_ASSERT_NOT_NULL(
+      strstr(out, "free block first 19800 last 19100 min 19100 max 19800 "
+                  "stable\n"));
+  TEST_ASSERT_NOT_NULL(strstr(out, "objects    first 180 last 180"));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_flat_run_passes);
+  RUN_TEST(test_warmup_ignored);
+  RUN_TEST(test_steady_leak_fails);
+  RUN_TEST(test_small_growth_within_slack);
+  RUN_TEST(test_noisy_leak_fails);
+  RUN_TEST(test_fragmentation_fails);
+  RUN_TEST(test_object_leak_fails);
+  RUN_TEST(test_too_short);
+  RUN_TEST(test_capacity);
+  RUN_TEST(test_format);
+  return UNITY_END();
+}
@@ -0,0 +1,190 @@
+#include <string.h>
+#include <unity.h>
+
+#include "text_layout.h"
+
+#define CHAR_W 6
+
+static uint32_t breaks; // calls of the breaker, the work the cache saves
+
+/* Monospace word wrap, enough to check what the cache stores */
+static uint32_t mono_break(const char *text, const void *font, int16_t width,
+                           int16_t letter_space, uint8_t flags,
+                           int16_t *line_width) {
+  breaks++;
+  int16_t advance = CHAR_W + letter_space;
+  uint32_t fit = width / advance;
+  uint32_t n = 0, last_space = 0;
+  while (text[n] && text[n] != '\n' && n < fit) {
+    if (text[n] == ' ') {
+      last_space = n + 1;
+    }
+    n++;
+  }
+  if (text[n] == '\n') {
+    n++;
+  } else if (text[n] && last_space) {
+    n = last_space; // break after the last space that fits
+  }
+  *line_width = n * advance;
+  return n;
+}
+
+static const char font_a = 'a', font_b = 'b'; // only the addresses count
+static const char *message =
+    "Hey there! Just reminding you about our meeting at 10:00 AM. Please "
+    "make sure to prepare the presentation slides and gather all necessary "
+    "documents beforehand. Looking forward to a productive discussion!";
+
+void setUp(void) { breaks = 0; }
+void tearDown(void) {}
+
+void test_lines_cover_text(void) {
+  TextLayoutCache cache(mono_break);
+  const TextLayout *l = cache.get(message, &font_a, 120, 0, 0);
+  TEST_ASSERT_NOT_NULL(l);
+  TEST_ASSERT_TRUE(l->count > 5);
+  uint32_t pos = 0;
+  for (uint16_t i = 0; i < l->count; i++) {
+    TEST_ASSERT_EQUAL(pos, l->lines[i].start);
+    TEST_ASSERT_TRUE(l->lines[i].width <= 120);
+    TEST_ASSERT_TRUE(l->lines[i].width <= l->max_width);
+    pos += l->lines[i].length;
+  }
+  TEST_ASSERT_EQUAL(strlen(message), pos);
+  TEST_ASSERT_EQUAL(0, memcmp(message, "Hey there! Just ", l->lines[0].length));
+}
+
+void test_redraw_hits(void) {
+  TextLayoutCache cache(mono_break);
+  const TextLayout *first = cache.get(message, &font_a, 120, 0, 0);
+  uint32_t work = breaks;
+  for (int i = 0; i < 24; i++) { // one frame in 10 line bands
+    TEST_ASSERT_EQUAL_PTR(first, cache.get(message, &font_a, 120, 0, 0));
+  }
+  TEST_ASSERT_EQUAL(work, breaks);
+  TEST_ASSERT_EQUAL(24, cache.stats().hits);
+  TEST_ASSERT_EQUAL(1, cache.stats().misses);
+}
+
+void test_same_text_other_buffer(void) {
+  TextLayoutCache cache(mono_break);
+  char copy[256];
+  strcpy(copy, message);
+  cache.get(message, &font_a, 120, 0, 0);
+  cache.get(copy, &font_a, 120, 0, 0); // the label copies the text
+  TEST_ASSERT_EQUAL(1, cache.stats().hits);
+}
+
+void test_text_and_style_are_keys(void) {
+  TextLayoutCache cache(mono_break);
+  cache.get(message, &font_a, 120, 0, 0);
+  cache.get("Short", &font_a, 120, 0, 0);
+  cache.get(message, &font_b, 120, 0, 0);
+  cache.get(message, &font_a, 100, 0, 0);
+  const TextLayout *spaced = cache.get(message, &font_a, 120, 2, 0);
+  TEST_ASSERT_EQUAL(5, cache.stats().misses);
+  TEST_ASSERT_EQUAL(0, cache.stats().hits);
+  TEST_ASSERT_EQUAL(8 * 11, spaced->lines[0].width); // "Hey there! " at 8 px
+}
+
+void test_reopen_after_others(void) {
+  TextLayoutCache cache(mono_break);
+  const char *others[] = {"one two three", "four five", "six"};
+  cache.get(message, &font_a, 120, 0, 0);
+  for (uint8_t i = 0; i < TEXT_LAYOUT_ENTRIES - 1; i++) {
+    cache.get(others[i % 3], &font_a, 120 - i, 0, 0);
+  }
+  cache.get(message, &font_a, 120, 0, 0);
+  TEST_ASSERT_EQUAL(1, cache.stats().hits);
+}
+
+void test_least_recently_used_evicted(void) {
+  TextLayoutCache cache(mono_break);
+  for (uint8_t i = 0; i < TEXT_LAYOUT_ENTRIES; i++) {
+    cache.get(message, &font_a, 100 + i, 0, 0);
+  }
+  cache.get(message, &font_a, 100, 0, 0); // 100 is now the newest
+  cache.get(message, &font_a, 50, 0, 0);  // evicts 101
+  cache.get(message, &font_a, 100, 0, 0);
+  TEST_ASSERT_EQUAL(2, cache.stats().hits);
+  cache.get(message, &font_a, 101, 0, 0);
+  TEST_ASSERT_EQUAL(2, cache.stats().hits);
+}
+
+void test_newlines(void) {
+  TextLayoutCache cache(mono_break);
+  const TextLayout *l = cache.get("a\n\nbc\n", &font_a, 120, 0, 0);
+  TEST_ASSERT_EQUAL(3, l->count);
+  TEST_ASSERT_EQUAL(2, l->lines[0].length);
+  TEST_ASSERT_EQUAL(1, l->lines[1].length);
+  TEST_ASSERT_EQUAL(3, l->lines[2].start);
+  TEST_ASSERT_EQUAL(3, l->lines[2].length);
+}
+
+void test_too_many_lines(void) {
+  TextLayoutCache cache(mono_break);
+  char text[TEXT_LAYOUT_LINES * 2 + 3];
+  for (int i = 0; i < TEXT_LAYOUT_LINES + 1; i++) {
+    text[i * 2] = 'x';
+    text[i * 2 + 1] = '\n';
+  }
+  text[(TEXT_LAYOUT_LINES + 1) * 2] = '\0';
+  TEST_ASSERT_NULL(cache.get(text, &font_a, 120, 0, 0));
+  TEST_ASSERT_EQUAL(1, cache.stats().too_long);
+  text[TEXT_LAYOUT_LINES * 2] = '\0'; // exactly full
+  TEST_ASSERT_NOT_NULL(cache.get(text, &font_a, 120, 0, 0));
+  // the failed layout did not take an entry
+  TEST_ASSERT_EQUAL(1, cache.stats().misses);
+}
+
+void test_invalidate_font(void) {
+  TextLayoutCache cache(mono_break);
+  cache.get(message, &font_a, 120, 0, 0);
+  cache.get(message, &font_b, 120, 0, 0);
+  cache.invalidate(&font_b);
+  cache.get(message, &font_a, 120, 0, 0);
+  cache.get(message, &font_b, 120, 0, 0);
+  TEST_ASSERT_EQUAL(1, cache.stats().hits);
+  cache.invalidate();
+  cache.get(message, &font_a, 120, 0, 0);
+  TEST_ASSERT_EQUAL(1, cache.stats().hits);
+}
+
+void test_hash_collision(void) {
+  // same FNV-1a hash and length
+  uint32_t a_len, b_len;
+  TEST_ASSERT_EQUAL_HEX32(TextLayoutCache::hash("m0641f0", &a_len),
+                          TextLayoutCache::hash("m0cac42", &b_len));
+  TEST_ASSERT_EQUAL(a_len, b_len);
+
+  TextLayoutCache cache(mono_break);
+  cache.get("m0641f0", &font_a, 120, 0, 0);
+  const TextLayout *l = cache.get("m0cac42", &font_a, 120, 0, 0);
+  TEST_ASSERT_EQUAL(0, cache.stats().hits);
+  TEST_ASSERT_EQUAL(2, cache.stats().misses);
+  TEST_ASSERT_EQUAL_STRING("m0cac42", l->text);
+}
+
+void test_empty_text(void) {
+  TextLayoutCache cache(mono_break);
+  const TextLayout *l = cache.get("", &font_a, 120, 0, 0);
+  TEST_ASSERT_NOT_NULL(l);
+  TEST_ASSERT_EQUAL(0, l->count);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_lines_cover_text);
+  RUN_TEST(test_redraw_hits);
+  RUN_TEST(test_same_text_other_buffer);
+  RUN_TEST(test_text_and_style_are_keys);
+  RUN_TEST(test_reopen_after_others);
+  RUN_TEST(test_least_recently_used_evicted);
+  RUN_TEST(test_newlines);
+  RUN_TEST(test_too_many_lines);
+  RUN_TEST(test_invalidate_font);
+  RUN_TEST(test_hash_collision);
+  RUN_TEST(test_empty_text);
+  return UNITY_END();
+}
@@ -0,0 +1,88 @@
+#include <string.h>
+#include <unity.h>
+
+#include "time_format.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static ClockTime at(uint8_t hour, uint8_t minute) {
+  struct tm tm;
+  memset(&tm, 0, sizeof(tm));
+  tm.tm_year = 124; // 2024
+  tm.tm_mon = 4;    // May
+  tm.tm_mday = 11;
+  tm.tm_wday = 6;
+  tm.tm_hour = hour;
+  tm.tm_min = minute;
+  return clock_time(tm);
+}
+
+void test_clock_fields(void) {
+  ClockTime t = at(9, 5);
+  TEST_ASSERT_EQUAL(2024, t.year);
+  TEST_ASSERT_EQUAL(5, t.month);
+  TEST_ASSERT_EQUAL(11, t.day);
+  TEST_ASSERT_EQUAL_STRING("Saturday", clock_weekday_name(t.weekday));
+  TEST_ASSERT_EQUAL_STRING("May", clock_month_name(t.month));
+  TEST_ASSERT_EQUAL_STRING("", clock_weekday_name(7));
+  TEST_ASSERT_EQUAL_STRING("", clock_month_name(0));
+  TEST_ASSERT_EQUAL_STRING("", clock_month_name(13));
+}
+
+void test_display_hour(void) {
+  TEST_ASSERT_EQUAL(0, clock_display_hour(0, true));
+  TEST_ASSERT_EQUAL(12, clock_display_hour(0, false));
+  TEST_ASSERT_EQUAL(12, clock_display_hour(12, false));
+  TEST_ASSERT_EQUAL(1, clock_display_hour(13, false));
+  TEST_ASSERT_EQUAL(11, clock_display_hour(23, false));
+}
+
+void test_format_time(void) {
+  char out[16];
+  TEST_ASSERT_EQUAL(5, clock_format_time(out, sizeof(out), at(9, 5), true));
+  TEST_ASSERT_EQUAL_STRING("09:05", out);
+  clock_format_time(out, sizeof(out), at(0, 30), false);
+  TEST_ASSERT_EQUAL_STRING("12:30 AM", out);
+  clock_format_time(out, sizeof(out), at(12, 0), false);
+  TEST_ASSERT_EQUAL_STRING("12:00 PM", out);
+  clock_format_time(out, sizeof(out), at(23, 59), false);
+  TEST_ASSERT_EQUAL_STRING("11:59 PM", out);
+}
+
+void test_format_truncates(void) {
+  char out[4];
+  TEST_ASSERT_EQUAL(3, clock_format_time(out, sizeof(out), at(9, 5), true));
+  TEST_ASSERT_EQUAL_STRING("09:", out);
+}
+
+void test_format_date(void) {
+  char out[24];
+  clock_format_date(out, sizeof(out), at(9, 5));
+  TEST_ASSERT_EQUAL_STRING("11\nMay", out);
+}
+
+void test_format_age(void) {
+  char out[16];
+  clock_format_age(out, sizeof(out), 59);
+  TEST_ASSERT_EQUAL_STRING("now", out);
+  clock_format_age(out, sizeof(out), 60);
+  TEST_ASSERT_EQUAL_STRING("1 min", out);
+  clock_format_age(out, sizeof(out), 3599);
+  TEST_ASSERT_EQUAL_STRING("59 min", out);
+  clock_format_age(out, sizeof(out), 7200);
+  TEST_ASSERT_EQUAL_STRING("2 h", out);
+  clock_format_age(out, sizeof(out), 3 * 86400 + 5);
+  TEST_ASSERT_EQUAL_STRING("3 d", out);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_clock_fields);
+  RUN_TEST(test_display_hour);
+  RUN_TEST(test_format_time);
+  RUN_TEST(test_format_truncates);
+  RUN_TEST(test_format_date);
+  RUN_TEST(test_format_age);
+  return UNITY_END();
+}
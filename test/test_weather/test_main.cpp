@@ -0,0 +1,88 @@
+#include <unity.h>
+
+#include "weather_model.h"
+
+static WeatherModel model;
+
+static const WeatherDay week[WEATHER_DAYS] = {
+    {0, 0, 21, 22, 18}, {4, 1, 25, 26, 24}, {5, 2, 23, 24, 17},
+    {2, 3, 20, 23, 12}, {0, 4, 27, 27, 23}, {3, 5, 22, 25, 18},
+    {2, 6, 24, 26, 19},
+};
+
+void setUp(void) {
+  model = WeatherModel();
+  model.update(week, WEATHER_DAYS);
+  model.takeChanges();
+}
+void tearDown(void) {}
+
+void test_update_marks_all(void) {
+  WeatherModel fresh;
+  fresh.update(week, WEATHER_DAYS);
+  TEST_ASSERT_EQUAL(WEATHER_DAYS, fresh.count());
+  TEST_ASSERT_EQUAL(0x7F, fresh.takeChanges());
+  TEST_ASSERT_EQUAL(0, fresh.takeChanges());
+}
+
+void test_same_update_no_changes(void) {
+  model.update(week, WEATHER_DAYS);
+  TEST_ASSERT_EQUAL(0, model.takeChanges());
+}
+
+void test_single_day_change(void) {
+  WeatherDay d = week[3];
+  d.temp = 30;
+  TEST_ASSERT_TRUE(model.set(3, d));
+  TEST_ASSERT_FALSE(model.set(3, d));
+  TEST_ASSERT_EQUAL(1 << 3, model.takeChanges());
+  TEST_ASSERT_EQUAL(30, model.day(3).temp);
+  TEST_ASSERT_FALSE(model.set(WEATHER_DAYS, d));
+}
+
+void test_shorter_forecast(void) {
+  model.update(week, 3);
+  TEST_ASSERT_EQUAL(3, model.count());
+  TEST_ASSERT_EQUAL(0x78, model.takeChanges()); // days 3 - 6 removed
+}
+
+void test_info_changes(void) {
+  model.setCity("Nairobi");
+  model.setUpdated(10, 47);
+  TEST_ASSERT_EQUAL(WEATHER_CHANGED_INFO, model.takeChanges());
+  model.setCity("Nairobi");
+  model.setUpdated(10, 47);
+  TEST_ASSERT_EQUAL(0, model.takeChanges());
+  TEST_ASSERT_EQUAL_STRING("Nairobi", model.city());
+  TEST_ASSERT_EQUAL(10 * 60 + 47, model.updated());
+}
+
+void test_advance_day(void) {
+  model.advance(2);
+  TEST_ASSERT_EQUAL(WEATHER_DAYS - 2, model.count());
+  TEST_ASSERT_EQUAL(2, model.today().day);
+  TEST_ASSERT_EQUAL(23, model.today().temp);
+  TEST_ASSERT_EQUAL(6, model.day(model.count() - 1).day);
+  TEST_ASSERT_EQUAL(0x7F, model.takeChanges());
+  model.advance(2); // already today
+  TEST_ASSERT_EQUAL(0, model.takeChanges());
+}
+
+void test_advance_past_forecast(void) {
+  model.update(week, 2);
+  model.takeChanges();
+  model.advance(5);
+  TEST_ASSERT_EQUAL(0, model.count());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_update_marks_all);
+  RUN_TEST(test_same_update_no_changes);
+  RUN_TEST(test_single_day_change);
+  RUN_TEST(test_shorter_forecast);
+  RUN_TEST(test_info_changes);
+  RUN_TEST(test_advance_day);
+  RUN_TEST(test_advance_past_forecast);
+  return UNITY_END();
+}